@@ -0,0 +1,131 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/bench/CMakeLists.txt"
+  "/root/repo/lib/googletest-release-1.10.0/CMakeLists.txt"
+  "/root/repo/lib/googletest-release-1.10.0/googlemock/CMakeLists.txt"
+  "/root/repo/lib/googletest-release-1.10.0/googlemock/cmake/gmock.pc.in"
+  "/root/repo/lib/googletest-release-1.10.0/googlemock/cmake/gmock_main.pc.in"
+  "/root/repo/lib/googletest-release-1.10.0/googletest/CMakeLists.txt"
+  "/root/repo/lib/googletest-release-1.10.0/googletest/cmake/Config.cmake.in"
+  "/root/repo/lib/googletest-release-1.10.0/googletest/cmake/gtest.pc.in"
+  "/root/repo/lib/googletest-release-1.10.0/googletest/cmake/gtest_main.pc.in"
+  "/root/repo/lib/googletest-release-1.10.0/googletest/cmake/internal_utils.cmake"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/test/CMakeLists.txt"
+  "/root/repo/tools/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-AnyNewerVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDependentOption.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseArguments.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPythonInterp.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "lib/googletest-release-1.10.0/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "lib/googletest-release-1.10.0/googletest/generated/gmock.pc"
+  "lib/googletest-release-1.10.0/googletest/generated/gmock_main.pc"
+  "lib/googletest-release-1.10.0/googlemock/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "lib/googletest-release-1.10.0/googletest/generated/GTestConfigVersion.cmake"
+  "lib/googletest-release-1.10.0/googletest/generated/GTestConfig.cmake"
+  "lib/googletest-release-1.10.0/googletest/generated/gtest.pc"
+  "lib/googletest-release-1.10.0/googletest/generated/gtest_main.pc"
+  "lib/googletest-release-1.10.0/googletest/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "bench/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "lib/googletest-release-1.10.0/googlemock/CMakeFiles/gmock.dir/DependInfo.cmake"
+  "lib/googletest-release-1.10.0/googlemock/CMakeFiles/gmock_main.dir/DependInfo.cmake"
+  "lib/googletest-release-1.10.0/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  "lib/googletest-release-1.10.0/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "src/CMakeFiles/libIME2_core.dir/DependInfo.cmake"
+  "test/CMakeFiles/TextExtentCache_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CandidateList_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CandidateArena_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CandidatePainter_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CandidateUIState_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CandidatePrefixIndex_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/HandleRegistry_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/WindowPool_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/UpdateScheduler_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/ResourceCache_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/DisplayAttributeRegistry_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CompositionState_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/OnceInit_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/DictionaryFile_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/SpscRing_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/EngineChannel_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/EngineData_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/RegistrationPlan_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/Utf_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/ChineseConverter_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/FullWidth_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/DoubleArrayTrie_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/Lexicon_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/CompletionIndex_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/SyllableLattice_test.dir/DependInfo.cmake"
+  "bench/CMakeFiles/CandidateList_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/CandidateArena_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/OnceInit_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/EngineRoundTrip_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/RegistrationPlan_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/Utf_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/ChineseConverter_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/FullWidth_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/DoubleArrayTrie_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/Lexicon_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/CompletionIndex_bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/SyllableLattice_bench.dir/DependInfo.cmake"
+  "tools/CMakeFiles/ime-engine-standin.dir/DependInfo.cmake"
+  "tools/CMakeFiles/ime-dictc.dir/DependInfo.cmake"
+  "tools/CMakeFiles/ime-dictcheck.dir/DependInfo.cmake"
+  )
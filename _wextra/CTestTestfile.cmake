@@ -0,0 +1,11 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_wextra
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("lib/googletest-release-1.10.0")
+subdirs("src")
+subdirs("test")
+subdirs("bench")
+subdirs("tools")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidateArena_bench.dir/CandidateArena_bench.cpp.o"
+  "CMakeFiles/CandidateArena_bench.dir/CandidateArena_bench.cpp.o.d"
+  "CandidateArena_bench"
+  "CandidateArena_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidateArena_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidateList_bench.dir/CandidateList_bench.cpp.o"
+  "CMakeFiles/CandidateList_bench.dir/CandidateList_bench.cpp.o.d"
+  "CandidateList_bench"
+  "CandidateList_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidateList_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
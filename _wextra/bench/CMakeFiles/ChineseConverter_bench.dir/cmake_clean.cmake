@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ChineseConverter_bench.dir/ChineseConverter_bench.cpp.o"
+  "CMakeFiles/ChineseConverter_bench.dir/ChineseConverter_bench.cpp.o.d"
+  "ChineseConverter_bench"
+  "ChineseConverter_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ChineseConverter_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CompletionIndex_bench.dir/CompletionIndex_bench.cpp.o"
+  "CMakeFiles/CompletionIndex_bench.dir/CompletionIndex_bench.cpp.o.d"
+  "CompletionIndex_bench"
+  "CompletionIndex_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CompletionIndex_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/DoubleArrayTrie_bench.dir/DoubleArrayTrie_bench.cpp.o"
+  "CMakeFiles/DoubleArrayTrie_bench.dir/DoubleArrayTrie_bench.cpp.o.d"
+  "DoubleArrayTrie_bench"
+  "DoubleArrayTrie_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/DoubleArrayTrie_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/EngineRoundTrip_bench.dir/EngineRoundTrip_bench.cpp.o"
+  "CMakeFiles/EngineRoundTrip_bench.dir/EngineRoundTrip_bench.cpp.o.d"
+  "EngineRoundTrip_bench"
+  "EngineRoundTrip_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/EngineRoundTrip_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
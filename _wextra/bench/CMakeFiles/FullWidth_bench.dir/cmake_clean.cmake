@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/FullWidth_bench.dir/FullWidth_bench.cpp.o"
+  "CMakeFiles/FullWidth_bench.dir/FullWidth_bench.cpp.o.d"
+  "FullWidth_bench"
+  "FullWidth_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/FullWidth_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Lexicon_bench.dir/Lexicon_bench.cpp.o"
+  "CMakeFiles/Lexicon_bench.dir/Lexicon_bench.cpp.o.d"
+  "Lexicon_bench"
+  "Lexicon_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Lexicon_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
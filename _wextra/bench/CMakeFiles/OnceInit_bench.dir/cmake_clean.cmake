@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OnceInit_bench.dir/OnceInit_bench.cpp.o"
+  "CMakeFiles/OnceInit_bench.dir/OnceInit_bench.cpp.o.d"
+  "OnceInit_bench"
+  "OnceInit_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/OnceInit_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
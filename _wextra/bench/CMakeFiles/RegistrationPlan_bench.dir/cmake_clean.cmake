@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/RegistrationPlan_bench.dir/RegistrationPlan_bench.cpp.o"
+  "CMakeFiles/RegistrationPlan_bench.dir/RegistrationPlan_bench.cpp.o.d"
+  "RegistrationPlan_bench"
+  "RegistrationPlan_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/RegistrationPlan_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SyllableLattice_bench.dir/SyllableLattice_bench.cpp.o"
+  "CMakeFiles/SyllableLattice_bench.dir/SyllableLattice_bench.cpp.o.d"
+  "SyllableLattice_bench"
+  "SyllableLattice_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SyllableLattice_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Utf_bench.dir/Utf_bench.cpp.o"
+  "CMakeFiles/Utf_bench.dir/Utf_bench.cpp.o.d"
+  "Utf_bench"
+  "Utf_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Utf_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
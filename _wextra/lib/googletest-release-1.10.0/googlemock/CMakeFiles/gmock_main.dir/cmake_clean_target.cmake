@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "../../libgmock_main.a"
+)
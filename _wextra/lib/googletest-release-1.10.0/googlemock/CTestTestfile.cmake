@@ -0,0 +1,7 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/lib/googletest-release-1.10.0/googlemock
+# Build directory: /root/repo/_wextra/lib/googletest-release-1.10.0/googlemock
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("../googletest")
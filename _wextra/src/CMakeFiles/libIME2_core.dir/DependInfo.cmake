@@ -0,0 +1,48 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/CandidateArena.cpp" "src/CMakeFiles/libIME2_core.dir/CandidateArena.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CandidateArena.cpp.o.d"
+  "/root/repo/src/CandidateList.cpp" "src/CMakeFiles/libIME2_core.dir/CandidateList.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CandidateList.cpp.o.d"
+  "/root/repo/src/CandidatePainter.cpp" "src/CMakeFiles/libIME2_core.dir/CandidatePainter.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CandidatePainter.cpp.o.d"
+  "/root/repo/src/CandidatePrefixIndex.cpp" "src/CMakeFiles/libIME2_core.dir/CandidatePrefixIndex.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CandidatePrefixIndex.cpp.o.d"
+  "/root/repo/src/CandidateUIState.cpp" "src/CMakeFiles/libIME2_core.dir/CandidateUIState.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CandidateUIState.cpp.o.d"
+  "/root/repo/src/ChineseConverter.cpp" "src/CMakeFiles/libIME2_core.dir/ChineseConverter.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/ChineseConverter.cpp.o.d"
+  "/root/repo/src/CompletionIndex.cpp" "src/CMakeFiles/libIME2_core.dir/CompletionIndex.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CompletionIndex.cpp.o.d"
+  "/root/repo/src/CompositionState.cpp" "src/CMakeFiles/libIME2_core.dir/CompositionState.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/CompositionState.cpp.o.d"
+  "/root/repo/src/DictionaryFile.cpp" "src/CMakeFiles/libIME2_core.dir/DictionaryFile.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/DictionaryFile.cpp.o.d"
+  "/root/repo/src/DictionaryService.cpp" "src/CMakeFiles/libIME2_core.dir/DictionaryService.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/DictionaryService.cpp.o.d"
+  "/root/repo/src/DoubleArrayTrie.cpp" "src/CMakeFiles/libIME2_core.dir/DoubleArrayTrie.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/DoubleArrayTrie.cpp.o.d"
+  "/root/repo/src/EngineChannel.cpp" "src/CMakeFiles/libIME2_core.dir/EngineChannel.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/EngineChannel.cpp.o.d"
+  "/root/repo/src/EngineClient.cpp" "src/CMakeFiles/libIME2_core.dir/EngineClient.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/EngineClient.cpp.o.d"
+  "/root/repo/src/EngineServer.cpp" "src/CMakeFiles/libIME2_core.dir/EngineServer.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/EngineServer.cpp.o.d"
+  "/root/repo/src/FullWidth.cpp" "src/CMakeFiles/libIME2_core.dir/FullWidth.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/FullWidth.cpp.o.d"
+  "/root/repo/src/HandleRegistry.cpp" "src/CMakeFiles/libIME2_core.dir/HandleRegistry.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/HandleRegistry.cpp.o.d"
+  "/root/repo/src/Lexicon.cpp" "src/CMakeFiles/libIME2_core.dir/Lexicon.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/Lexicon.cpp.o.d"
+  "/root/repo/src/MappedFile.cpp" "src/CMakeFiles/libIME2_core.dir/MappedFile.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/MappedFile.cpp.o.d"
+  "/root/repo/src/RegistrationPlan.cpp" "src/CMakeFiles/libIME2_core.dir/RegistrationPlan.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/RegistrationPlan.cpp.o.d"
+  "/root/repo/src/RegistryBackend.cpp" "src/CMakeFiles/libIME2_core.dir/RegistryBackend.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/RegistryBackend.cpp.o.d"
+  "/root/repo/src/ResourceCache.cpp" "src/CMakeFiles/libIME2_core.dir/ResourceCache.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/ResourceCache.cpp.o.d"
+  "/root/repo/src/SharedMemory.cpp" "src/CMakeFiles/libIME2_core.dir/SharedMemory.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/SharedMemory.cpp.o.d"
+  "/root/repo/src/SharedSignal.cpp" "src/CMakeFiles/libIME2_core.dir/SharedSignal.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/SharedSignal.cpp.o.d"
+  "/root/repo/src/SpscRing.cpp" "src/CMakeFiles/libIME2_core.dir/SpscRing.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/SpscRing.cpp.o.d"
+  "/root/repo/src/StandInEngine.cpp" "src/CMakeFiles/libIME2_core.dir/StandInEngine.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/StandInEngine.cpp.o.d"
+  "/root/repo/src/SyllableLattice.cpp" "src/CMakeFiles/libIME2_core.dir/SyllableLattice.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/SyllableLattice.cpp.o.d"
+  "/root/repo/src/TextExtentCache.cpp" "src/CMakeFiles/libIME2_core.dir/TextExtentCache.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/TextExtentCache.cpp.o.d"
+  "/root/repo/src/UpdateScheduler.cpp" "src/CMakeFiles/libIME2_core.dir/UpdateScheduler.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/UpdateScheduler.cpp.o.d"
+  "/root/repo/src/Utf.cpp" "src/CMakeFiles/libIME2_core.dir/Utf.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/Utf.cpp.o.d"
+  "/root/repo/src/WindowPool.cpp" "src/CMakeFiles/libIME2_core.dir/WindowPool.cpp.o" "gcc" "src/CMakeFiles/libIME2_core.dir/WindowPool.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
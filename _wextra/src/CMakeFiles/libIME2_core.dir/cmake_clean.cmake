@@ -0,0 +1,69 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libIME2_core.dir/CandidateArena.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CandidateArena.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CandidateList.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CandidateList.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CandidatePainter.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CandidatePainter.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CandidatePrefixIndex.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CandidatePrefixIndex.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CandidateUIState.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CandidateUIState.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/ChineseConverter.cpp.o"
+  "CMakeFiles/libIME2_core.dir/ChineseConverter.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CompletionIndex.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CompletionIndex.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/CompositionState.cpp.o"
+  "CMakeFiles/libIME2_core.dir/CompositionState.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/DictionaryFile.cpp.o"
+  "CMakeFiles/libIME2_core.dir/DictionaryFile.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/DictionaryService.cpp.o"
+  "CMakeFiles/libIME2_core.dir/DictionaryService.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/DoubleArrayTrie.cpp.o"
+  "CMakeFiles/libIME2_core.dir/DoubleArrayTrie.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/EngineChannel.cpp.o"
+  "CMakeFiles/libIME2_core.dir/EngineChannel.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/EngineClient.cpp.o"
+  "CMakeFiles/libIME2_core.dir/EngineClient.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/EngineServer.cpp.o"
+  "CMakeFiles/libIME2_core.dir/EngineServer.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/FullWidth.cpp.o"
+  "CMakeFiles/libIME2_core.dir/FullWidth.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/HandleRegistry.cpp.o"
+  "CMakeFiles/libIME2_core.dir/HandleRegistry.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/Lexicon.cpp.o"
+  "CMakeFiles/libIME2_core.dir/Lexicon.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/MappedFile.cpp.o"
+  "CMakeFiles/libIME2_core.dir/MappedFile.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/RegistrationPlan.cpp.o"
+  "CMakeFiles/libIME2_core.dir/RegistrationPlan.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/RegistryBackend.cpp.o"
+  "CMakeFiles/libIME2_core.dir/RegistryBackend.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/ResourceCache.cpp.o"
+  "CMakeFiles/libIME2_core.dir/ResourceCache.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/SharedMemory.cpp.o"
+  "CMakeFiles/libIME2_core.dir/SharedMemory.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/SharedSignal.cpp.o"
+  "CMakeFiles/libIME2_core.dir/SharedSignal.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/SpscRing.cpp.o"
+  "CMakeFiles/libIME2_core.dir/SpscRing.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/StandInEngine.cpp.o"
+  "CMakeFiles/libIME2_core.dir/StandInEngine.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/SyllableLattice.cpp.o"
+  "CMakeFiles/libIME2_core.dir/SyllableLattice.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/TextExtentCache.cpp.o"
+  "CMakeFiles/libIME2_core.dir/TextExtentCache.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/UpdateScheduler.cpp.o"
+  "CMakeFiles/libIME2_core.dir/UpdateScheduler.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/Utf.cpp.o"
+  "CMakeFiles/libIME2_core.dir/Utf.cpp.o.d"
+  "CMakeFiles/libIME2_core.dir/WindowPool.cpp.o"
+  "CMakeFiles/libIME2_core.dir/WindowPool.cpp.o.d"
+  "liblibIME2_core.a"
+  "liblibIME2_core.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/libIME2_core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
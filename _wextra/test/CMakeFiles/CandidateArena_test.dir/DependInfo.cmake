@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/CandidateArena_test.cpp" "test/CMakeFiles/CandidateArena_test.dir/CandidateArena_test.cpp.o" "gcc" "test/CMakeFiles/CandidateArena_test.dir/CandidateArena_test.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_wextra/src/CMakeFiles/libIME2_core.dir/DependInfo.cmake"
+  "/root/repo/_wextra/lib/googletest-release-1.10.0/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "/root/repo/_wextra/lib/googletest-release-1.10.0/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
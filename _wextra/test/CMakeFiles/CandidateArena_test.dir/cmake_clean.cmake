@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidateArena_test.dir/CandidateArena_test.cpp.o"
+  "CMakeFiles/CandidateArena_test.dir/CandidateArena_test.cpp.o.d"
+  "CandidateArena_test"
+  "CandidateArena_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidateArena_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
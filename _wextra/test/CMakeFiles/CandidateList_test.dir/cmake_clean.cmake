@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidateList_test.dir/CandidateList_test.cpp.o"
+  "CMakeFiles/CandidateList_test.dir/CandidateList_test.cpp.o.d"
+  "CandidateList_test"
+  "CandidateList_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidateList_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidatePainter_test.dir/CandidatePainter_test.cpp.o"
+  "CMakeFiles/CandidatePainter_test.dir/CandidatePainter_test.cpp.o.d"
+  "CandidatePainter_test"
+  "CandidatePainter_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidatePainter_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidatePrefixIndex_test.dir/CandidatePrefixIndex_test.cpp.o"
+  "CMakeFiles/CandidatePrefixIndex_test.dir/CandidatePrefixIndex_test.cpp.o.d"
+  "CandidatePrefixIndex_test"
+  "CandidatePrefixIndex_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidatePrefixIndex_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CandidateUIState_test.dir/CandidateUIState_test.cpp.o"
+  "CMakeFiles/CandidateUIState_test.dir/CandidateUIState_test.cpp.o.d"
+  "CandidateUIState_test"
+  "CandidateUIState_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CandidateUIState_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
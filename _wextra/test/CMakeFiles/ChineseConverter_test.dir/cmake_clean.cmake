@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ChineseConverter_test.dir/ChineseConverter_test.cpp.o"
+  "CMakeFiles/ChineseConverter_test.dir/ChineseConverter_test.cpp.o.d"
+  "ChineseConverter_test"
+  "ChineseConverter_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ChineseConverter_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CompletionIndex_test.dir/CompletionIndex_test.cpp.o"
+  "CMakeFiles/CompletionIndex_test.dir/CompletionIndex_test.cpp.o.d"
+  "CompletionIndex_test"
+  "CompletionIndex_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CompletionIndex_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
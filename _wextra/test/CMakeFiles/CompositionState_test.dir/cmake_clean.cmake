@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/CompositionState_test.dir/CompositionState_test.cpp.o"
+  "CMakeFiles/CompositionState_test.dir/CompositionState_test.cpp.o.d"
+  "CompositionState_test"
+  "CompositionState_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/CompositionState_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
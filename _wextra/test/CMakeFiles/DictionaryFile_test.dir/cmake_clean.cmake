@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/DictionaryFile_test.dir/DictionaryFile_test.cpp.o"
+  "CMakeFiles/DictionaryFile_test.dir/DictionaryFile_test.cpp.o.d"
+  "DictionaryFile_test"
+  "DictionaryFile_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/DictionaryFile_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/DisplayAttributeRegistry_test.dir/DisplayAttributeRegistry_test.cpp.o"
+  "CMakeFiles/DisplayAttributeRegistry_test.dir/DisplayAttributeRegistry_test.cpp.o.d"
+  "DisplayAttributeRegistry_test"
+  "DisplayAttributeRegistry_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/DisplayAttributeRegistry_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/DoubleArrayTrie_test.dir/DoubleArrayTrie_test.cpp.o"
+  "CMakeFiles/DoubleArrayTrie_test.dir/DoubleArrayTrie_test.cpp.o.d"
+  "DoubleArrayTrie_test"
+  "DoubleArrayTrie_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/DoubleArrayTrie_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
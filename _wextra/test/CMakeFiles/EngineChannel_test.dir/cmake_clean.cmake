@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/EngineChannel_test.dir/EngineChannel_test.cpp.o"
+  "CMakeFiles/EngineChannel_test.dir/EngineChannel_test.cpp.o.d"
+  "EngineChannel_test"
+  "EngineChannel_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/EngineChannel_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/EngineData_test.dir/EngineData_test.cpp.o"
+  "CMakeFiles/EngineData_test.dir/EngineData_test.cpp.o.d"
+  "EngineData_test"
+  "EngineData_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/EngineData_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/FullWidth_test.dir/FullWidth_test.cpp.o"
+  "CMakeFiles/FullWidth_test.dir/FullWidth_test.cpp.o.d"
+  "FullWidth_test"
+  "FullWidth_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/FullWidth_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/HandleRegistry_test.dir/HandleRegistry_test.cpp.o"
+  "CMakeFiles/HandleRegistry_test.dir/HandleRegistry_test.cpp.o.d"
+  "HandleRegistry_test"
+  "HandleRegistry_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/HandleRegistry_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
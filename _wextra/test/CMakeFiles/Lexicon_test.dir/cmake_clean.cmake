@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Lexicon_test.dir/Lexicon_test.cpp.o"
+  "CMakeFiles/Lexicon_test.dir/Lexicon_test.cpp.o.d"
+  "Lexicon_test"
+  "Lexicon_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Lexicon_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
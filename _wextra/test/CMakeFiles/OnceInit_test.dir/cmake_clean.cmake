@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OnceInit_test.dir/OnceInit_test.cpp.o"
+  "CMakeFiles/OnceInit_test.dir/OnceInit_test.cpp.o.d"
+  "OnceInit_test"
+  "OnceInit_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/OnceInit_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
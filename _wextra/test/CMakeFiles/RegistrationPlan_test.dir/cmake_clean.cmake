@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/RegistrationPlan_test.dir/RegistrationPlan_test.cpp.o"
+  "CMakeFiles/RegistrationPlan_test.dir/RegistrationPlan_test.cpp.o.d"
+  "RegistrationPlan_test"
+  "RegistrationPlan_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/RegistrationPlan_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
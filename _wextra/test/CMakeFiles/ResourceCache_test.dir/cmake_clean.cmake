@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ResourceCache_test.dir/ResourceCache_test.cpp.o"
+  "CMakeFiles/ResourceCache_test.dir/ResourceCache_test.cpp.o.d"
+  "ResourceCache_test"
+  "ResourceCache_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ResourceCache_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
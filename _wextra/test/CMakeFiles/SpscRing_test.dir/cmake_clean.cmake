@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SpscRing_test.dir/SpscRing_test.cpp.o"
+  "CMakeFiles/SpscRing_test.dir/SpscRing_test.cpp.o.d"
+  "SpscRing_test"
+  "SpscRing_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SpscRing_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
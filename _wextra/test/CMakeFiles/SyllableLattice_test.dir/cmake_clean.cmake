@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SyllableLattice_test.dir/SyllableLattice_test.cpp.o"
+  "CMakeFiles/SyllableLattice_test.dir/SyllableLattice_test.cpp.o.d"
+  "SyllableLattice_test"
+  "SyllableLattice_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SyllableLattice_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/TextExtentCache_test.dir/TextExtentCache_test.cpp.o"
+  "CMakeFiles/TextExtentCache_test.dir/TextExtentCache_test.cpp.o.d"
+  "TextExtentCache_test"
+  "TextExtentCache_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TextExtentCache_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
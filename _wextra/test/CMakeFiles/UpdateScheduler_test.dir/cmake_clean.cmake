@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UpdateScheduler_test.dir/UpdateScheduler_test.cpp.o"
+  "CMakeFiles/UpdateScheduler_test.dir/UpdateScheduler_test.cpp.o.d"
+  "UpdateScheduler_test"
+  "UpdateScheduler_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UpdateScheduler_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Utf_test.dir/Utf_test.cpp.o"
+  "CMakeFiles/Utf_test.dir/Utf_test.cpp.o.d"
+  "Utf_test"
+  "Utf_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Utf_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
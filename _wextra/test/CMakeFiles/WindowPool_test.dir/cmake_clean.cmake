@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/WindowPool_test.dir/WindowPool_test.cpp.o"
+  "CMakeFiles/WindowPool_test.dir/WindowPool_test.cpp.o.d"
+  "WindowPool_test"
+  "WindowPool_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/WindowPool_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
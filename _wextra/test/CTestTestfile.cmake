@@ -0,0 +1,56 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/_wextra/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(TextExtentCache_test "/root/repo/_wextra/test/TextExtentCache_test")
+set_tests_properties(TextExtentCache_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;18;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CandidateList_test "/root/repo/_wextra/test/CandidateList_test")
+set_tests_properties(CandidateList_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;22;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CandidateArena_test "/root/repo/_wextra/test/CandidateArena_test")
+set_tests_properties(CandidateArena_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;26;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CandidatePainter_test "/root/repo/_wextra/test/CandidatePainter_test")
+set_tests_properties(CandidatePainter_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;30;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CandidateUIState_test "/root/repo/_wextra/test/CandidateUIState_test")
+set_tests_properties(CandidateUIState_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;34;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CandidatePrefixIndex_test "/root/repo/_wextra/test/CandidatePrefixIndex_test")
+set_tests_properties(CandidatePrefixIndex_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;38;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(HandleRegistry_test "/root/repo/_wextra/test/HandleRegistry_test")
+set_tests_properties(HandleRegistry_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;42;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(WindowPool_test "/root/repo/_wextra/test/WindowPool_test")
+set_tests_properties(WindowPool_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;46;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(UpdateScheduler_test "/root/repo/_wextra/test/UpdateScheduler_test")
+set_tests_properties(UpdateScheduler_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;50;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(ResourceCache_test "/root/repo/_wextra/test/ResourceCache_test")
+set_tests_properties(ResourceCache_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;54;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(DisplayAttributeRegistry_test "/root/repo/_wextra/test/DisplayAttributeRegistry_test")
+set_tests_properties(DisplayAttributeRegistry_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;58;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CompositionState_test "/root/repo/_wextra/test/CompositionState_test")
+set_tests_properties(CompositionState_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;62;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(OnceInit_test "/root/repo/_wextra/test/OnceInit_test")
+set_tests_properties(OnceInit_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;66;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(DictionaryFile_test "/root/repo/_wextra/test/DictionaryFile_test")
+set_tests_properties(DictionaryFile_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;70;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(SpscRing_test "/root/repo/_wextra/test/SpscRing_test")
+set_tests_properties(SpscRing_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;74;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(EngineChannel_test "/root/repo/_wextra/test/EngineChannel_test")
+set_tests_properties(EngineChannel_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;78;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(EngineData_test "/root/repo/_wextra/test/EngineData_test")
+set_tests_properties(EngineData_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;82;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(RegistrationPlan_test "/root/repo/_wextra/test/RegistrationPlan_test")
+set_tests_properties(RegistrationPlan_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;86;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(Utf_test "/root/repo/_wextra/test/Utf_test")
+set_tests_properties(Utf_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;90;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(ChineseConverter_test "/root/repo/_wextra/test/ChineseConverter_test")
+set_tests_properties(ChineseConverter_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;94;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(FullWidth_test "/root/repo/_wextra/test/FullWidth_test")
+set_tests_properties(FullWidth_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;98;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(DoubleArrayTrie_test "/root/repo/_wextra/test/DoubleArrayTrie_test")
+set_tests_properties(DoubleArrayTrie_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;102;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(Lexicon_test "/root/repo/_wextra/test/Lexicon_test")
+set_tests_properties(Lexicon_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;106;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(CompletionIndex_test "/root/repo/_wextra/test/CompletionIndex_test")
+set_tests_properties(CompletionIndex_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;110;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(SyllableLattice_test "/root/repo/_wextra/test/SyllableLattice_test")
+set_tests_properties(SyllableLattice_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;114;add_test;/root/repo/test/CMakeLists.txt;0;")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ime-dictc.dir/DictionaryCompiler.cpp.o"
+  "CMakeFiles/ime-dictc.dir/DictionaryCompiler.cpp.o.d"
+  "ime-dictc"
+  "ime-dictc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ime-dictc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
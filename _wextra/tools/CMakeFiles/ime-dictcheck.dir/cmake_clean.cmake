@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ime-dictcheck.dir/DictionaryCheck.cpp.o"
+  "CMakeFiles/ime-dictcheck.dir/DictionaryCheck.cpp.o.d"
+  "ime-dictcheck"
+  "ime-dictcheck.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ime-dictcheck.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ime-engine-standin.dir/StandInEngineServer.cpp.o"
+  "CMakeFiles/ime-engine-standin.dir/StandInEngineServer.cpp.o.d"
+  "ime-engine-standin"
+  "ime-engine-standin.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ime-engine-standin.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,124 @@
+// Memory and throughput of candidate storage:
+// std::vector<std::wstring> (one heap block per long candidate) against
+// CandidateArena (one contiguous buffer, reused when the list is refreshed).
+//
+// "refill" rebuilds a list of 5,000 candidates as an engine does on every keystroke.
+// "scan" walks all candidates and hashes them, as measuring and painting do.
+
+#include "CandidateArena.h"
+#include "TextExtentCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+static size_t allocCount = 0;
+static size_t allocBytes = 0;
+
+void* operator new(size_t size) {
+    ++allocCount;
+    allocBytes += size;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const int candidateCount = 5000;
+const int rounds = 200;
+
+std::vector<std::wstring> makeCandidates() {
+    std::vector<std::wstring> candidates;
+    for (int i = 0; i < candidateCount; ++i) {
+        // phrases of 1 to 8 chars
+        std::wstring candidate;
+        for (int j = 0; j <= i % 8; ++j) {
+            candidate += wchar_t(0x4e00 + (i * 31 + j * 7) % 20000);
+        }
+        candidates.push_back(candidate);
+    }
+    return candidates;
+}
+
+template <typename Func>
+double timeIt(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+uint64_t sink = 0;
+
+}
+
+int main() {
+    const std::vector<std::wstring> source = makeCandidates();
+
+    // the current representation
+    std::vector<std::wstring> items;
+    size_t vectorAllocs = allocCount;
+    size_t vectorBytes = allocBytes;
+    double vectorRefill = timeIt([&]() {
+        items.clear();
+        for (const auto& candidate : source) {
+            items.push_back(std::wstring(candidate.data(), candidate.length()));
+        }
+    });
+    vectorAllocs = (allocCount - vectorAllocs) / rounds;
+    vectorBytes = (allocBytes - vectorBytes) / rounds;
+    double vectorScan = timeIt([&]() {
+        for (const auto& item : items) {
+            sink += Ime::TextExtentCache::hash(item.data(), item.length());
+        }
+    });
+
+    // the arena
+    Ime::CandidateArena arena;
+    size_t arenaAllocs = allocCount;
+    size_t arenaBytes = allocBytes;
+    double arenaRefill = timeIt([&]() {
+        arena.clear();
+        for (const auto& candidate : source) {
+            arena.append(candidate);
+        }
+    });
+    arenaAllocs = (allocCount - arenaAllocs) / rounds;
+    arenaBytes = (allocBytes - arenaBytes) / rounds;
+    double arenaScan = timeIt([&]() {
+        for (int i = 0; i < arena.size(); ++i) {
+            sink += arena.hash(i);
+        }
+    });
+
+    size_t vectorFootprint = items.capacity() * sizeof(std::wstring);
+    for (const auto& item : items) {
+        if (item.capacity() * sizeof(wchar_t) > sizeof(std::wstring) - sizeof(size_t) * 2) {
+            vectorFootprint += (item.capacity() + 1) * sizeof(wchar_t);  // not in the small string buffer
+        }
+    }
+
+    std::printf("%d candidates, sizeof(wchar_t) = %d\n", candidateCount, int(sizeof(wchar_t)));
+    std::printf("                       vector<wstring>   CandidateArena\n");
+    std::printf("  footprint (bytes)   %16zu %16zu\n", vectorFootprint, arena.memoryUsage());
+    std::printf("  allocs per refill   %16zu %16zu\n", vectorAllocs, arenaAllocs);
+    std::printf("  bytes per refill    %16zu %16zu\n", vectorBytes, arenaBytes);
+    std::printf("  refill (us)         %16.2f %16.2f\n", vectorRefill, arenaRefill);
+    std::printf("  scan + hash (us)    %16.2f %16.2f\n", vectorScan, arenaScan);
+    return sink == 0;
+}
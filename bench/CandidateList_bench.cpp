@@ -0,0 +1,112 @@
+// Time to first paint of a candidate list with 5,000 candidates.
+//
+// "copy all" is what CandidateWindow used to do: the engine builds the whole
+// list, setItems() copies it and every candidate is measured.
+// "pull page" uses a CandidateSource: only the first page is generated,
+// pulled and measured.
+// Text measurement is done by a fake measurer without caching so that only the
+// work done by the library is timed.
+
+#include "CandidateList.h"
+#include "TextExtentCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int candidateCount = 5000;
+const int rounds = 200;
+
+class FakeMeasurer: public Ime::TextMeasurer {
+public:
+    Ime::TextExtent measure(const wchar_t* str, size_t len) override {
+        int width = 0;
+        for (size_t i = 0; i < len; ++i) {
+            width += str[i] >= 0x3000 ? 16 : 8;
+        }
+        return Ime::TextExtent{ width, 20 };
+    }
+};
+
+std::wstring makeCandidate(int i) {
+    std::wstring candidate;
+    candidate += wchar_t(0x4e00 + i % 20000);
+    candidate += wchar_t(0x4e00 + (i * 7) % 20000);
+    return candidate;
+}
+
+// generates the candidates when the list asks for them
+class RankedSource: public Ime::CandidateSource {
+public:
+    int count() override {
+        return int(items_.size());
+    }
+
+    std::wstring get(int i) override {
+        return items_[i];
+    }
+
+    bool fetch(int n) override {
+        while (int(items_.size()) < n && int(items_.size()) < candidateCount) {
+            items_.push_back(makeCandidate(int(items_.size())));
+        }
+        return n <= candidateCount;
+    }
+
+    bool isComplete() override {
+        return items_.size() == candidateCount;
+    }
+
+private:
+    std::vector<std::wstring> items_;
+};
+
+template <typename Func>
+double timeIt(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+int sink = 0;
+
+void measure(std::wstring_view item, FakeMeasurer& measurer) {
+    sink += measurer.measure(item.data(), item.length()).width;
+    sink += measurer.measure(L"1. ", 3).width;
+}
+
+}
+
+int main() {
+    FakeMeasurer measurer;
+
+    double copyAll = timeIt([&]() {
+        std::vector<std::wstring> items;
+        for (int i = 0; i < candidateCount; ++i) {
+            items.push_back(makeCandidate(i));
+        }
+        std::vector<std::wstring> copied = items;
+        for (const auto& item : copied) {
+            measure(item, measurer);
+        }
+    });
+
+    double pullPage = timeIt([&]() {
+        Ime::CandidateList list;
+        list.setSource(std::make_shared<RankedSource>());
+        for (int slot = 0; slot < list.currentPageSize(); ++slot) {
+            measure(list.pageItem(slot), measurer);
+        }
+    });
+
+    std::printf("time to first paint, %d candidates\n", candidateCount);
+    std::printf("  copy all:  %10.2f us\n", copyAll);
+    std::printf("  pull page: %10.2f us\n", pullPage);
+    return sink == 0;
+}
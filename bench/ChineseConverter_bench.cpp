@@ -0,0 +1,118 @@
+// Throughput of Traditional <=> Simplified conversion.
+//
+// tradToSimpChinese() in Utils.cpp uses LCMapStringW(), which is Windows-only and
+// maps char by char. ChineseConverter uses a compiled table with phrases. The table
+// here is synthetic but has the size of a real one (OpenCC has ~4000 chars and ~50000
+// phrases for each direction). A conversion with hash maps, trying every phrase
+// length at every position, is shown for comparison.
+
+#include "ChineseConverter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+const size_t charCount = 4000;
+const size_t phraseCount = 50000;
+const size_t maxPhraseLength = 6;
+const size_t corpusLength = 4 << 20;  // UTF-16 units, 8 MB
+const int rounds = 5;
+
+char16_t cjk(std::mt19937& rng) {
+    return char16_t(0x4e00 + rng() % 8000);
+}
+
+template <typename Func>
+double megabytesPerSecond(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(corpusLength * sizeof(char16_t)) * rounds / elapsed.count() / 1e6;
+}
+
+volatile size_t sink = 0;
+
+}
+
+int main() {
+    std::mt19937 rng(42);
+    Ime::ChineseConversionTableBuilder builder;
+    std::unordered_map<char16_t, char16_t> charMap;
+    std::unordered_map<std::u16string, std::u16string> phraseMap;
+    std::vector<std::u16string> phrases;
+    for (size_t i = 0; i < charCount; ++i) {
+        char16_t from = cjk(rng);
+        char16_t to = cjk(rng);
+        builder.add(std::u16string(1, from), std::u16string(1, to));
+        charMap[from] = to;
+    }
+    for (size_t i = 0; i < phraseCount; ++i) {
+        std::u16string from;
+        std::u16string to;
+        size_t length = 2 + rng() % (maxPhraseLength - 1);
+        for (size_t k = 0; k < length; ++k) {
+            from += cjk(rng);
+            to += cjk(rng);
+        }
+        builder.add(from, to);
+        phraseMap[from] = to;
+        phrases.push_back(from);
+    }
+    std::string table = builder.build();
+    Ime::ChineseConverter converter;
+    converter.attach(table);
+
+    // mostly CJK, some ASCII, and a phrase now and then
+    std::u16string corpus;
+    while (corpus.size() < corpusLength) {
+        unsigned r = rng() % 100;
+        if (r < 10)
+            corpus += char16_t(0x20 + rng() % 95);
+        else if (r < 15)
+            corpus += phrases[rng() % phrases.size()];
+        else
+            corpus += cjk(rng);
+    }
+    corpus.resize(corpusLength);
+
+    std::u16string out;
+    double table_ = megabytesPerSecond([&]() {
+        converter.convert(corpus, out);
+        sink = out.size();
+    });
+
+    double hashMaps = megabytesPerSecond([&]() {
+        std::u16string result;
+        for (size_t i = 0; i < corpus.size(); ) {
+            bool found = false;
+            for (size_t length = std::min(maxPhraseLength, corpus.size() - i); length >= 2; --length) {
+                auto it = phraseMap.find(corpus.substr(i, length));
+                if (it != phraseMap.end()) {
+                    result += it->second;
+                    i += length;
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                continue;
+            auto it = charMap.find(corpus[i]);
+            result += it != charMap.end() ? it->second : corpus[i];
+            ++i;
+        }
+        sink = result.size();
+    });
+
+    std::printf("%zu chars, %zu phrases, table %zu KB, corpus %zu MB\n", charCount, phraseCount, table.size() / 1024,
+        corpusLength * sizeof(char16_t) >> 20);
+    std::printf("  ChineseConverter: %7.1f MB/s\n", table_);
+    std::printf("  hash maps:        %7.1f MB/s\n", hashMaps);
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Top-10 predictive completion of short prefixes (one or two bopomofo symbols)
+// in a 500k-phrase lexicon.
+//
+// Without an index, completing a prefix means enumerating every reading below
+// it and sorting the phrases by frequency, so a one-symbol prefix touches a
+// large part of the lexicon. Ime::CompletionIndex keeps the highest frequency
+// of each subtree and searches best first, only visiting the nodes on the way
+// to the k results.
+
+#include "CompletionIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t phraseCount = 500000;
+const size_t k = 10;
+
+const std::u16string initials = u"ㄅㄆㄇㄈㄉㄊㄋㄌㄍㄎㄏㄐㄑㄒㄓㄔㄕㄖㄗㄘㄙ";
+const std::u16string finals = u"ㄚㄛㄜㄝㄞㄟㄠㄡㄢㄣㄤㄥㄦ";
+const std::u16string tones = u"ˊˇˋ˙";
+
+void addPhrases(Ime::LexiconBuilder& builder) {
+    std::mt19937 random(1);
+    for (size_t i = 0; i < phraseCount; ++i) {
+        std::u16string reading;
+        std::u16string phrase;
+        size_t length = 1 + random() % 4;
+        for (size_t j = 0; j < length; ++j) {
+            reading += initials[random() % initials.size()];
+            reading += finals[random() % finals.size()];
+            reading += tones[random() % tones.size()];
+            phrase += char16_t(0x4e00 + random() % 20000);
+        }
+        builder.add(reading, phrase, random() % 100000);
+    }
+}
+
+// enumerate the subtree and keep the k most frequent phrases
+size_t sortAll(const Ime::Lexicon& lexicon, std::u16string_view prefix, std::vector<const Ime::LexiconPhrase*>& phrases) {
+    phrases.clear();
+    lexicon.readings().forEachWithPrefix(prefix, [&](std::u16string_view, uint32_t readingIndex) {
+        for (const auto& phrase : lexicon.phrasesOf(readingIndex))
+            phrases.push_back(&phrase);
+        return true;
+    });
+    size_t count = std::min(k, phrases.size());
+    std::partial_sort(phrases.begin(), phrases.begin() + count, phrases.end(),
+        [](const Ime::LexiconPhrase* a, const Ime::LexiconPhrase* b) {
+            return a->frequency > b->frequency;
+        });
+    return count;
+}
+
+template <typename Func>
+double microseconds(const std::vector<std::u16string>& prefixes, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& prefix : prefixes) {
+        func(prefix);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / prefixes.size();
+}
+
+volatile size_t sink = 0;
+
+}
+
+int main() {
+    auto path = std::filesystem::temp_directory_path() / ("libime_completion_" + std::to_string(getpid()) + ".dict");
+    {
+        Ime::LexiconBuilder builder;
+        addPhrases(builder);
+        Ime::DictionaryFileWriter writer;
+        builder.addSectionsTo(writer);
+        writer.write(path);
+    }
+    Ime::DictionaryFile file;
+    file.open(path);
+    Ime::Lexicon lexicon;
+    lexicon.attach(file);
+    Ime::CompletionIndex index;
+    if (!index.attach(file, lexicon)) {
+        std::printf("no completion index\n");
+        return 1;
+    }
+
+    std::vector<std::u16string> oneUnit;
+    std::vector<std::u16string> twoUnits;
+    for (char16_t initial : initials) {
+        oneUnit.push_back(std::u16string(1, initial));
+        for (char16_t final : finals)
+            twoUnits.push_back(std::u16string{initial, final});
+    }
+
+    std::printf("%zu phrases, %zu readings, completion index %.1f MB, top %zu\n", lexicon.phraseCount(),
+        lexicon.readingCount(), lexicon.readings().unitCount() * sizeof(Ime::CompletionNode) / 1e6, k);
+    std::vector<const Ime::LexiconPhrase*> phrases;
+    for (const auto* prefixes : {&oneUnit, &twoUnits}) {
+        size_t candidates = 0;
+        for (const auto& prefix : *prefixes) {
+            sortAll(lexicon, prefix, phrases);
+            candidates += phrases.size();
+        }
+        double all = microseconds(*prefixes, [&](const std::u16string& prefix) {
+            sink = sortAll(lexicon, prefix, phrases);
+        });
+        double best = microseconds(*prefixes, [&](const std::u16string& prefix) {
+            sink = index.complete(prefix, k).size();
+        });
+        std::printf("  %zu-unit prefixes (%zu phrases each): sort all %9.1f us, best first %6.2f us\n",
+            prefixes->front().size(), candidates / prefixes->size(), all, best);
+    }
+    file.close();
+    std::filesystem::remove(path);
+    return 0;
+}
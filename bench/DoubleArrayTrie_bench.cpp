@@ -0,0 +1,203 @@
+// Reading -> phrase lookups in a 500k-entry lexicon, with the readings as
+// UTF-16 bopomofo and as syllable ids (one unit per syllable).
+//
+// Engines usually keep their lexicon in a std::map or std::unordered_map of
+// strings, which allocates a node (and often a string) per entry.
+// Ime::DoubleArrayTrie is one flat table: a lookup follows one array slot per
+// key unit. Memory is counted with an allocator for the maps, and is the size
+// of the table for the trie.
+
+#include "DoubleArrayTrie.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const size_t entryCount = 500000;
+
+size_t allocatedBytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        allocatedBytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        allocatedBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {
+        return false;
+    }
+};
+
+using Key = std::basic_string<char16_t, std::char_traits<char16_t>, CountingAllocator<char16_t>>;
+
+struct KeyHash {
+    size_t operator()(const Key& key) const {
+        return std::hash<std::u16string_view>()(std::u16string_view(key.data(), key.size()));
+    }
+};
+
+using Map = std::map<Key, uint32_t, std::less<Key>, CountingAllocator<std::pair<const Key, uint32_t>>>;
+using HashMap = std::unordered_map<Key, uint32_t, KeyHash, std::equal_to<Key>, CountingAllocator<std::pair<const Key, uint32_t>>>;
+
+struct Lexicon {
+    std::vector<std::u16string> readings;  // bopomofo, such as ㄓㄨㄥㄨㄣˊ
+    std::vector<std::u16string> syllableIds;
+};
+
+// words of 1 to 4 syllables
+Lexicon makeLexicon(std::mt19937& random) {
+    const std::u16string initials = u"ㄅㄆㄇㄈㄉㄊㄋㄌㄍㄎㄏㄐㄑㄒㄓㄔㄕㄖㄗㄘㄙ";
+    const std::u16string medials = u"ㄧㄨㄩ";
+    const std::u16string finals = u"ㄚㄛㄜㄝㄞㄟㄠㄡㄢㄣㄤㄥㄦ";
+    const std::u16string tones = u"ˊˇˋ˙";
+    std::vector<std::u16string> syllables;
+    for (size_t i = 0; i < 1300; ++i) {
+        std::u16string syllable;
+        syllable += initials[random() % initials.size()];
+        if (random() % 2)
+            syllable += medials[random() % medials.size()];
+        syllable += finals[random() % finals.size()];
+        if (random() % 5)
+            syllable += tones[random() % tones.size()];
+        syllables.push_back(syllable);
+    }
+    std::sort(syllables.begin(), syllables.end());
+    syllables.erase(std::unique(syllables.begin(), syllables.end()), syllables.end());
+
+    Lexicon lexicon;
+    std::map<std::u16string, bool> seen;
+    while (lexicon.readings.size() < entryCount) {
+        std::u16string reading;
+        std::u16string ids;
+        size_t length = 1 + random() % 4;
+        for (size_t i = 0; i < length; ++i) {
+            // common syllables are used more, like in real text
+            size_t index = std::min(random() % syllables.size(), random() % syllables.size());
+            reading += syllables[index];
+            ids += char16_t(1 + index);
+        }
+        if (seen.emplace(ids, true).second) {
+            lexicon.readings.push_back(reading);
+            lexicon.syllableIds.push_back(ids);
+        }
+    }
+    return lexicon;
+}
+
+template <typename Func>
+double lookupsPerSecond(size_t count, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return count / elapsed.count();
+}
+
+volatile uint64_t sink = 0;
+
+void run(const char* name, const std::vector<std::u16string>& keys, std::mt19937& random) {
+    size_t units = 0;
+    for (const auto& key : keys)
+        units += key.size();
+
+    // half hits in random order, half misses which share a long prefix with a key
+    std::vector<std::u16string> queries;
+    for (size_t i = 0; i < 1000000; ++i) {
+        std::u16string query = keys[random() % keys.size()];
+        if (i % 2)
+            query += char16_t(1);
+        queries.push_back(query);
+    }
+    std::vector<Key> mapQueries;
+    for (const auto& query : queries)
+        mapQueries.emplace_back(query.data(), query.size());
+
+    auto start = std::chrono::steady_clock::now();
+    Ime::DoubleArrayTrieBuilder builder;
+    for (size_t i = 0; i < keys.size(); ++i)
+        builder.add(keys[i], uint32_t(i));
+    std::string table = builder.build();
+    std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - start;
+    Ime::DoubleArrayTrie trie;
+    trie.attach(table);
+
+    allocatedBytes = 0;
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i)
+        map.emplace(Key(keys[i].data(), keys[i].size()), uint32_t(i));
+    size_t mapBytes = allocatedBytes;
+
+    allocatedBytes = 0;
+    HashMap hashMap;
+    for (size_t i = 0; i < keys.size(); ++i)
+        hashMap.emplace(Key(keys[i].data(), keys[i].size()), uint32_t(i));
+    size_t hashMapBytes = allocatedBytes;
+
+    double trieRate = lookupsPerSecond(queries.size(), [&]() {
+        uint64_t found = 0;
+        for (const auto& query : queries)
+            found += trie.find(query) != Ime::DoubleArrayTrie::NOT_FOUND;
+        sink = found;
+    });
+    double mapRate = lookupsPerSecond(queries.size(), [&]() {
+        uint64_t found = 0;
+        for (const auto& query : mapQueries)
+            found += map.find(query) != map.end();
+        sink = found;
+    });
+    double hashMapRate = lookupsPerSecond(queries.size(), [&]() {
+        uint64_t found = 0;
+        for (const auto& query : mapQueries)
+            found += hashMap.find(query) != hashMap.end();
+        sink = found;
+    });
+    double prefixRate = lookupsPerSecond(queries.size(), [&]() {
+        Ime::DoubleArrayTrie::Match matches[16];
+        uint64_t found = 0;
+        for (const auto& query : queries)
+            found += trie.commonPrefixSearch(query, matches, 16);
+        sink = found;
+    });
+
+    std::printf("%s: %zu entries, %.1f units per key, trie built in %.2f s, %zu units\n",
+        name, keys.size(), double(units) / keys.size(), buildTime.count(), trie.unitCount());
+    std::printf("  %-22s %6.2f M lookups/s %6.1f bytes/entry\n", "std::map", mapRate / 1e6, double(mapBytes) / keys.size());
+    std::printf("  %-22s %6.2f M lookups/s %6.1f bytes/entry\n", "std::unordered_map", hashMapRate / 1e6, double(hashMapBytes) / keys.size());
+    std::printf("  %-22s %6.2f M lookups/s %6.1f bytes/entry\n", "DoubleArrayTrie", trieRate / 1e6, double(table.size()) / keys.size());
+    std::printf("  %-22s %6.2f M searches/s\n", "  commonPrefixSearch", prefixRate / 1e6);
+}
+
+}
+
+int main() {
+    std::mt19937 random(1);
+    Lexicon lexicon = makeLexicon(random);
+    run("bopomofo", lexicon.readings, random);
+    run("syllable ids", lexicon.syllableIds, random);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Round trip latency of a key event sent to an engine server in another process.
+//
+// The server process runs the stand-in engine, the client sends key down
+// requests and waits for each reply, like TextService::onKeyDown() does.
+// Every few keys the stand-in engine replies with candidates, which the client
+// reads in place from the shared memory.
+// Replies are waited for by spinning shortly, then sleeping on a futex, except
+// on single CPU machines where spinning would only delay the server; the
+// futex-only numbers show the latency when the wait does not spin.
+
+#include "EngineClient.h"
+#include "EngineServer.h"
+#include "StandInEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int warmup = 1000;
+const int rounds = 100000;
+
+size_t sink = 0;
+
+void report(const char* title, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples[std::min(samples.size() - 1, size_t(p * samples.size()))];
+    };
+    std::printf("%s, %zu round trips\n", title, samples.size());
+    std::printf("  p50:   %8.2f us\n", percentile(0.50));
+    std::printf("  p90:   %8.2f us\n", percentile(0.90));
+    std::printf("  p99:   %8.2f us\n", percentile(0.99));
+    std::printf("  p99.9: %8.2f us\n", percentile(0.999));
+    std::printf("  max:   %8.2f us\n", samples.back());
+}
+
+bool run(const std::string& name, int spinCount, std::vector<double>& samples) {
+    Ime::EngineClient client;
+    for (int i = 0; i < 1000 && !client.connect(name); ++i) {
+        usleep(1000);  // wait for the server to start
+    }
+    if (!client.isConnected())
+        return false;
+    if (spinCount >= 0)
+        client.setSpinCount(spinCount);
+
+    Ime::EngineReply reply;
+    samples.clear();
+    for (int i = 0; i < warmup + rounds; ++i) {
+        // type 8 letters, list the candidates, and cancel
+        int step = i % 10;
+        uint32_t keyCode = step < 8 ? 'A' + (i % 26) : step == 8 ? 0x20 : 0x1b;
+        auto start = std::chrono::steady_clock::now();
+        if (!client.request(Ime::ENGINE_KEY_DOWN, Ime::EngineKeyEvent{keyCode, 0, 0, 0}, reply))
+            return false;
+        for (size_t j = 0; j < reply.candidateCount(); ++j) {
+            sink += reply.candidate(j).length();
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        if (i >= warmup)
+            samples.push_back(elapsed.count());
+    }
+    return true;
+}
+
+}
+
+int main() {
+#ifdef __linux__
+    std::string name = "libime-bench-" + std::to_string(getpid());
+    pid_t server = fork();
+    if (server == 0) {
+        // wait for SIGTERM, then stop the server so its shared memory is removed
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &signals, nullptr);
+        {
+            Ime::EngineServer engineServer;
+            if (!engineServer.create(name, 2))
+                _exit(1);
+            engineServer.start([]() { return std::make_unique<Ime::StandInEngine>(); });
+            int signal;
+            sigwait(&signals, &signal);
+        }
+        _exit(0);
+    }
+
+    std::vector<double> samples;
+    bool ok = run(name, -1, samples);
+    if (ok)
+        report("default wait", samples);
+    ok = ok && run(name, 0, samples);
+    if (ok)
+        report("futex only", samples);
+    if (!ok)
+        std::printf("cannot talk to the engine server\n");
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return ok && sink ? 0 : 1;
+#else
+    std::printf("this benchmark only runs on Linux\n");
+    return 0;
+#endif
+}
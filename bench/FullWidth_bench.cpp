@@ -0,0 +1,138 @@
+// Full-width / half-width and punctuation conversion throughput.
+//
+// Engines map chars one at a time with a switch statement on the char code
+// and append the result to a new string. The "switch" columns do that; the
+// Ime:: kernels convert blocks of letters, digits and CJK chars with SIMD
+// into a buffer which is reused.
+
+#include "FullWidth.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const size_t textSize = 1 << 20;
+const int rounds = 50;
+
+char16_t switchFullWidth(char16_t c) {
+    switch (c) {
+    case u' ':
+        return 0x3000;
+    case 0xa2:
+        return 0xffe0;
+    case 0xa3:
+        return 0xffe1;
+    case 0xa5:
+        return 0xffe5;
+    default:
+        if (c >= 0x21 && c <= 0x7e)
+            return char16_t(c + 0xfee0);
+        return c;
+    }
+}
+
+char16_t switchHalfWidth(char16_t c) {
+    switch (c) {
+    case 0x3000:
+        return u' ';
+    case 0xffe0:
+        return 0xa2;
+    case 0xffe1:
+        return 0xa3;
+    case 0xffe5:
+        return 0xa5;
+    default:
+        if (c >= 0xff01 && c <= 0xff5e)
+            return char16_t(c - 0xfee0);
+        return c;
+    }
+}
+
+std::u16string switchPunctuation(const std::u16string& text) {
+    std::u16string out;
+    for (char16_t c : text) {
+        switch (c) {
+        case u',':
+            out += u"，";
+            break;
+        case u'.':
+            out += u"。";
+            break;
+        case u'!':
+            out += u"！";
+            break;
+        case u'?':
+            out += u"？";
+            break;
+        case u'^':
+            out += u"……";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::u16string makeText(const std::u16string& sample) {
+    std::u16string text;
+    while (text.size() < textSize) {
+        text += sample;
+    }
+    return text;
+}
+
+template <typename Func>
+double megabytesPerSecond(size_t bytes, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(bytes) * rounds / elapsed.count() / 1e6;
+}
+
+volatile size_t sink = 0;
+
+void run(const char* name, const std::u16string& text) {
+    size_t bytes = text.size() * sizeof(char16_t);
+    std::u16string full(text.size(), u'\0');
+    Ime::toFullWidth(text, &full[0]);
+    std::u16string out(text.size(), u'\0');
+    Ime::PunctuationMap map = Ime::PunctuationMap::chinese();
+    std::u16string mapped;
+    mapped.reserve(text.size() * 2);
+
+    double switchFull = megabytesPerSecond(bytes, [&]() {
+        std::u16string result;
+        for (char16_t c : text)
+            result += switchFullWidth(c);
+        sink = result.size();
+    });
+    double kernelFull = megabytesPerSecond(bytes, [&]() { Ime::toFullWidth(text, &out[0]); sink = out[0]; });
+    double switchHalf = megabytesPerSecond(bytes, [&]() {
+        std::u16string result;
+        for (char16_t c : full)
+            result += switchHalfWidth(c);
+        sink = result.size();
+    });
+    double kernelHalf = megabytesPerSecond(bytes, [&]() { Ime::toHalfWidth(full, &out[0]); sink = out[0]; });
+    double switchPunct = megabytesPerSecond(bytes, [&]() { sink = switchPunctuation(text).size(); });
+    double kernelPunct = megabytesPerSecond(bytes, [&]() { map.convert(text, mapped); sink = mapped.size(); });
+
+    std::printf("%-6s to full width: switch %6.0f MB/s, Ime::toFullWidth %6.0f MB/s\n", name, switchFull, kernelFull);
+    std::printf("%-6s to half width: switch %6.0f MB/s, Ime::toHalfWidth %6.0f MB/s\n", name, switchHalf, kernelHalf);
+    std::printf("%-6s punctuation:   switch %6.0f MB/s, PunctuationMap   %6.0f MB/s\n", name, switchPunct, kernelPunct);
+}
+
+}
+
+int main() {
+    // throughput is in MB of UTF-16
+    run("ascii", makeText(u"The quick brown fox jumps over the lazy dog, 1234567890 times! Why? "));
+    run("cjk", makeText(u"中文輸入法是一種輸入中文字的方法，注音、倉頡、拼音都是常見的輸入法。"));
+    run("mixed", makeText(u"IME 輸入法 (input method) v2.0，支援 Windows 8 與 Windows 10. "));
+    return 0;
+}
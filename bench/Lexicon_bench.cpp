@@ -0,0 +1,152 @@
+// Time from activation to the first lookup, for a 500k-phrase lexicon.
+//
+// "text" reads the source lexicon and parses it into an unordered_map of
+// readings to phrases, which is what input methods do when they start.
+// "compiled" opens the dictionary file made by ime-dictc (LexiconBuilder here)
+// and attaches the lexicon to it, which maps the file and parses nothing.
+// The file is in the page cache for both.
+
+#include "Lexicon.h"
+#include "Utf.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t phraseCount = 500000;
+
+// reading<TAB>phrase<TAB>frequency lines with bopomofo readings and CJK phrases
+std::string makeSource() {
+    std::mt19937 random(1);
+    const std::u16string initials = u"ㄅㄆㄇㄈㄉㄊㄋㄌㄍㄎㄏㄐㄑㄒㄓㄔㄕㄖㄗㄘㄙ";
+    const std::u16string finals = u"ㄚㄛㄜㄝㄞㄟㄠㄡㄢㄣㄤㄥㄦ";
+    const std::u16string tones = u"ˊˇˋ˙";
+    std::string source;
+    std::string utf8;
+    for (size_t i = 0; i < phraseCount; ++i) {
+        std::u16string reading;
+        std::u16string phrase;
+        size_t length = 1 + random() % 4;
+        for (size_t j = 0; j < length; ++j) {
+            reading += initials[random() % initials.size()];
+            reading += finals[random() % finals.size()];
+            reading += tones[random() % tones.size()];
+            phrase += char16_t(0x4e00 + random() % 20000);
+        }
+        Ime::utf16ToUtf8(reading, utf8);
+        source += utf8;
+        source += '\t';
+        Ime::utf16ToUtf8(phrase, utf8);
+        source += utf8;
+        source += '\t';
+        source += std::to_string(random() % 10000);
+        source += '\n';
+    }
+    return source;
+}
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+struct Phrase {
+    std::u16string text;
+    uint32_t frequency;
+};
+
+// what an input method without compiled dictionaries does
+std::unordered_map<std::u16string, std::vector<Phrase>> parseSource(const std::string& text) {
+    std::unordered_map<std::u16string, std::vector<Phrase>> lexicon;
+    std::u16string reading;
+    std::u16string phrase;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string_view line(text.data() + start, end - start);
+        start = end + 1;
+        size_t tab = line.find('\t');
+        size_t secondTab = line.find('\t', tab + 1);
+        Ime::utf8ToUtf16(line.substr(0, tab), reading);
+        Ime::utf8ToUtf16(line.substr(tab + 1, secondTab - tab - 1), phrase);
+        uint32_t frequency = uint32_t(std::stoul(std::string(line.substr(secondTab + 1))));
+        lexicon[reading].push_back(Phrase{phrase, frequency});
+    }
+    return lexicon;
+}
+
+template <typename Func>
+double milliseconds(int rounds, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+volatile size_t sink = 0;
+
+}
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path();
+    auto sourcePath = dir / ("libime_lexicon_" + std::to_string(getpid()) + ".txt");
+    auto dictPath = dir / ("libime_lexicon_" + std::to_string(getpid()) + ".dict");
+    std::string source = makeSource();
+    std::ofstream(sourcePath, std::ios::binary).write(source.data(), source.size());
+    std::u16string firstReading;
+    Ime::utf8ToUtf16(std::string_view(source).substr(0, source.find('\t')), firstReading);
+
+    double compile = milliseconds(1, [&]() {
+        Ime::LexiconBuilder builder;
+        builder.addText(readFile(sourcePath));
+        Ime::DictionaryFileWriter writer;
+        builder.addSectionsTo(writer);
+        writer.write(dictPath);
+    });
+
+    double text = milliseconds(3, [&]() {
+        auto lexicon = parseSource(readFile(sourcePath));
+        sink = lexicon[firstReading].size();
+    });
+    double compiled = milliseconds(100, [&]() {
+        Ime::DictionaryFile file;
+        file.open(dictPath);
+        Ime::Lexicon lexicon;
+        lexicon.attach(file);
+        sink = lexicon.lookup(firstReading).size();
+    });
+    double verify = milliseconds(3, [&]() {
+        Ime::DictionaryFile file;
+        file.open(dictPath);
+        sink = size_t(file.verify());
+    });
+
+    std::printf("%zu phrases, source %.1f MB, dictionary %.1f MB, compiled in %.0f ms\n", phraseCount,
+        source.size() / 1e6, std::filesystem::file_size(dictPath) / 1e6, compile);
+    std::printf("  activation to first lookup: text %8.2f ms, compiled %8.3f ms\n", text, compiled);
+    std::printf("  checksums of the whole file (ime-dictcheck): %.1f ms\n", verify);
+    std::filesystem::remove(sourcePath);
+    std::filesystem::remove(dictPath);
+    return 0;
+}
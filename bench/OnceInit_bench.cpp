@@ -0,0 +1,57 @@
+// Cost of the lazy initialization check done by ImeModule::ensureInitialized().
+//
+// ImeModule::CreateInstance() calls ensureInitialized() for every text service
+// and display attribute provider, so the fast path of OnceInit needs to be as
+// cheap as reading a member. std::call_once is shown for comparison.
+// The time spent in the deferred initialization is reported at runtime by
+// ImeModule::initStats(), since the module itself only builds on Windows.
+
+#include "OnceInit.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+const int rounds = 10000000;
+
+volatile int sink = 0;
+
+template <typename Func>
+double timeIt(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+}
+
+int main() {
+    int value = 0;
+
+    double plain = timeIt([&]() {
+        sink = value;
+    });
+
+    Ime::OnceInit once;
+    double onceInit = timeIt([&]() {
+        once.run([&]() { value = 1; return true; });
+        sink = value;
+    });
+
+    std::once_flag flag;
+    double callOnce = timeIt([&]() {
+        std::call_once(flag, [&]() { value = 2; });
+        sink = value;
+    });
+
+    std::printf("initialized check, per call\n");
+    std::printf("  no check:       %6.2f ns\n", plain);
+    std::printf("  OnceInit:       %6.2f ns\n", onceInit);
+    std::printf("  std::call_once: %6.2f ns\n", callOnce);
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Registering the text service on a machine with many user profiles.
+//
+// The old registration code rewrote every value for every user on each install,
+// upgrade and uninstall. RegistrationPlan reads the current state and only writes
+// what differs. The in-memory backend counts the calls, so the number of registry
+// writes (which are what's slow on a real machine, each one is flushed to the hive
+// of the user) can be compared with what the old code did.
+
+#include "RegistrationPlan.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const int userCount = 500;
+
+Ime::RegistrationSpec makeSpec() {
+    Ime::RegistrationSpec spec;
+    spec.clsid = L"{11111111-2222-3333-4444-555555555555}";
+    spec.name = L"Bench IME";
+    spec.modulePath = L"C:\\Program Files\\BenchIME\\BenchIME.dll";
+    const wchar_t* locales[] = {L"zh-Hant-TW", L"zh-Hans-CN", L"ja-JP"};
+    const uint16_t langIds[] = {0x0404, 0x0804, 0x0411};
+    for (int i = 0; i < 3; ++i) {
+        std::wstring guid = L"{AAAAAAAA-0000-0000-0000-00000000000" + std::to_wstring(i) + L"}";
+        spec.profiles.push_back({Ime::LanguageProfile{langIds[i], guid, L"Bench", L"icon.ico", i}, locales[i]});
+    }
+    spec.categories = {L"{CAT-1}", L"{CAT-2}", L"{CAT-3}", L"{CAT-4}", L"{CAT-5}", L"{CAT-6}"};
+    spec.userProfiles = true;
+    return spec;
+}
+
+void run(const char* name, Ime::MemoryRegistryBackend& backend, const Ime::RegistrationSpec& spec, bool unregister) {
+    backend.resetStats();
+    auto start = std::chrono::steady_clock::now();
+    Ime::RegistrationPlan plan(backend);
+    if (unregister)
+        plan.planUnregister(spec.clsid, true);
+    else
+        plan.planRegister(spec);
+    plan.apply();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-10s %6zu reads %6zu writes %8.2f ms\n", name, backend.readCount(), backend.writeCount(), elapsed.count());
+}
+
+}
+
+int main() {
+    Ime::MemoryRegistryBackend backend;
+    for (int i = 0; i < userCount; ++i) {
+        std::wstring sid = L"S-1-5-21-" + std::to_wstring(1000 + i);
+        backend.setValue(Ime::RegistryRoot::USERS, sid + L"\\Environment", L"TEMP", Ime::RegistryValue::string(L"C:\\Temp"));
+        backend.setValue(Ime::RegistryRoot::USERS, sid + L"\\Control Panel\\International\\User Profile\\en-US",
+            L"0409:00000409", Ime::RegistryValue::dword(1));
+    }
+    auto spec = makeSpec();
+    size_t profiles = spec.profiles.size();
+
+    // what the old code wrote on every install: the 3 server values, Register() and
+    // AddLanguageProfile() for each profile, the categories, and one value per profile per user
+    size_t oldWrites = 3 + 2 * profiles + spec.categories.size() + profiles * userCount;
+    std::printf("%d users, %zu profiles\n", userCount, profiles);
+    std::printf("  old code:  %6zu writes for every install or upgrade\n", oldWrites);
+
+    run("install", backend, spec, false);
+    run("reinstall", backend, spec, false);
+    spec.profiles[0].profile.name = L"Bench 2";
+    spec.profiles.pop_back();
+    run("upgrade", backend, spec, false);
+    run("uninstall", backend, spec, true);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Segmentation of 40-key pinyin inputs into syllables.
+//
+// Engines which resolve ambiguous input like "xian" (xian or xi'an) by trying
+// every split recursively build a vector per segmentation, and the number of
+// segmentations grows exponentially with the input. Ime::SyllableLattice
+// keeps every segmentation in one graph of O(keys) nodes and edges, built
+// with one trie walk per position, and reuses its arrays between keystrokes.
+
+#include "SyllableLattice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t inputLength = 40;
+const size_t inputCount = 200;
+
+const char16_t* pinyin =
+    u"a ai an ang ao ba bai ban bang bao bei ben beng bi bian biao bie bin bing bo bu "
+    u"ca cai can cang cao ce cen ceng cha chai chan chang chao che chen cheng chi chong "
+    u"chou chu chua chuai chuan chuang chui chun chuo ci cong cou cu cuan cui cun cuo "
+    u"da dai dan dang dao de dei den deng di dia dian diao die ding diu dong dou du duan "
+    u"dui dun duo e ei en eng er fa fan fang fei fen feng fo fou fu ga gai gan gang gao "
+    u"ge gei gen geng gong gou gu gua guai guan guang gui gun guo ha hai han hang hao he "
+    u"hei hen heng hong hou hu hua huai huan huang hui hun huo ji jia jian jiang jiao jie "
+    u"jin jing jiong jiu ju juan jue jun ka kai kan kang kao ke ken keng kong kou ku kua "
+    u"kuai kuan kuang kui kun kuo la lai lan lang lao le lei leng li lia lian liang liao "
+    u"lie lin ling liu long lou lu luan lun luo lv lve ma mai man mang mao me mei men meng "
+    u"mi mian miao mie min ming miu mo mou mu na nai nan nang nao ne nei nen neng ni nian "
+    u"niang niao nie nin ning niu nong nou nu nuan nuo nv nve o ou pa pai pan pang pao pei "
+    u"pen peng pi pian piao pie pin ping po pou pu qi qia qian qiang qiao qie qin qing "
+    u"qiong qiu qu quan que qun ran rang rao re ren reng ri rong rou ru ruan rui run ruo "
+    u"sa sai san sang sao se sen seng sha shai shan shang shao she shei shen sheng shi "
+    u"shou shu shua shuai shuan shuang shui shun shuo si song sou su suan sui sun suo ta "
+    u"tai tan tang tao te teng ti tian tiao tie ting tong tou tu tuan tui tun tuo wa wai "
+    u"wan wang wei wen weng wo wu xi xia xian xiang xiao xie xin xing xiong xiu xu xuan "
+    u"xue xun ya yan yang yao ye yi yin ying yo yong you yu yuan yue yun za zai zan zang "
+    u"zao ze zei zen zeng zha zhai zhan zhang zhao zhe zhei zhen zheng zhi zhong zhou zhu "
+    u"zhua zhuai zhuan zhuang zhui zhun zhuo zi zong zou zu zuan zui zun zuo";
+
+std::vector<std::u16string> splitSyllables() {
+    std::vector<std::u16string> syllables;
+    std::u16string_view all(pinyin);
+    size_t start = 0;
+    while (start < all.size()) {
+        size_t end = all.find(u' ', start);
+        if (end == std::u16string_view::npos)
+            end = all.size();
+        syllables.emplace_back(all.substr(start, end - start));
+        start = end + 1;
+    }
+    return syllables;
+}
+
+// all the segmentations, one vector of syllable ids each
+void enumerate(const Ime::DoubleArrayTrie& trie, std::u16string_view input, std::vector<uint32_t>& current,
+    std::vector<std::vector<uint32_t>>& results) {
+    if (input.empty()) {
+        results.push_back(current);
+        return;
+    }
+    Ime::DoubleArrayTrie::Match matches[16];
+    size_t count = std::min(trie.commonPrefixSearch(input, matches, 16), size_t(16));
+    for (size_t i = 0; i < count; ++i) {
+        if (matches[i].length == 0)
+            continue;
+        current.push_back(matches[i].value);
+        enumerate(trie, input.substr(matches[i].length), current, results);
+        current.pop_back();
+    }
+}
+
+template <typename Func>
+double microseconds(int rounds, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+volatile size_t sink = 0;
+
+}
+
+int main() {
+    std::vector<std::u16string> syllables = splitSyllables();
+    Ime::DoubleArrayTrieBuilder builder;
+    for (size_t i = 0; i < syllables.size(); ++i)
+        builder.add(syllables[i], uint32_t(i));
+    std::string table = builder.build();
+    Ime::DoubleArrayTrie trie;
+    trie.attach(table);
+
+    // random sentences of whole syllables, cut to 40 keys at a syllable boundary
+    std::mt19937 random(1);
+    std::vector<std::u16string> inputs;
+    while (inputs.size() < inputCount) {
+        std::u16string input;
+        for (;;) {
+            const std::u16string& syllable = syllables[random() % syllables.size()];
+            if (input.size() + syllable.size() > inputLength)
+                break;
+            input += syllable;
+        }
+        inputs.push_back(input);
+    }
+
+    Ime::SyllableLattice lattice;
+    double segmentations = 0;
+    size_t edges = 0;
+    for (const auto& input : inputs) {
+        lattice.build(trie, input);
+        segmentations += double(lattice.segmentationCount());
+        edges += lattice.edgeCount();
+    }
+
+    double enumeration = microseconds(1, [&]() {
+        std::vector<uint32_t> current;
+        for (const auto& input : inputs) {
+            std::vector<std::vector<uint32_t>> results;
+            enumerate(trie, input, current, results);
+            sink = results.size();
+        }
+    }) / inputs.size();
+    std::vector<uint32_t> path;
+    double latticeTime = microseconds(20, [&]() {
+        for (const auto& input : inputs) {
+            lattice.build(trie, input);
+            sink = lattice.bestPath(path);
+        }
+    }) / inputs.size();
+
+    std::printf("%zu syllables, %zu inputs of up to %zu keys, %.0f segmentations and %zu edges each\n",
+        syllables.size(), inputs.size(), inputLength, segmentations / inputs.size(), edges / inputs.size());
+    std::printf("  enumerate every segmentation %10.2f us\n", enumeration);
+    std::printf("  lattice and best path        %10.2f us\n", latticeTime);
+    return 0;
+}
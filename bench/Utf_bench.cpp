@@ -0,0 +1,142 @@
+// UTF-8 <=> UTF-16 throughput.
+//
+// utf8ToUtf16() and utf16ToUtf8() in Utils.cpp call MultiByteToWideChar() and
+// WideCharToMultiByte() twice, once to get the length and once to convert,
+// on a null-terminated string, and allocate a new string every time.
+// The Windows API is not available here, so "two-pass" is a scalar decoder
+// used the same way. Ime::convertUtf8ToUtf16() and friends convert in one pass
+// into a buffer which is reused.
+
+#include "Utf.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const size_t textSize = 1 << 20;
+const int rounds = 50;
+
+// decode one code point, no validation, like a simple scalar implementation
+uint32_t decode(const unsigned char*& p) {
+    uint32_t c = *p++;
+    if (c < 0x80)
+        return c;
+    int extra = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : 1;
+    c &= 0x3f >> extra;
+    while (extra--) {
+        c = (c << 6) | (*p++ & 0x3f);
+    }
+    return c;
+}
+
+std::u16string twoPassUtf8ToUtf16(const char* text) {
+    size_t len = 0;
+    auto p = reinterpret_cast<const unsigned char*>(text);
+    while (*p) {
+        len += decode(p) >= 0x10000 ? 2 : 1;
+    }
+    std::u16string out(len, u'\0');
+    p = reinterpret_cast<const unsigned char*>(text);
+    size_t o = 0;
+    while (*p) {
+        uint32_t c = decode(p);
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            out[o++] = char16_t(0xd800 + (c >> 10));
+            out[o++] = char16_t(0xdc00 + (c & 0x3ff));
+        }
+        else {
+            out[o++] = char16_t(c);
+        }
+    }
+    return out;
+}
+
+size_t encode(const char16_t*& p, char* out) {
+    uint32_t c = *p++;
+    if (c >= 0xd800 && c < 0xdc00)
+        c = 0x10000 + ((c - 0xd800) << 10) + (*p++ - 0xdc00);
+    if (c < 0x80) {
+        out[0] = char(c);
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = char(0xc0 | (c >> 6));
+        out[1] = char(0x80 | (c & 0x3f));
+        return 2;
+    }
+    if (c < 0x10000) {
+        out[0] = char(0xe0 | (c >> 12));
+        out[1] = char(0x80 | ((c >> 6) & 0x3f));
+        out[2] = char(0x80 | (c & 0x3f));
+        return 3;
+    }
+    out[0] = char(0xf0 | (c >> 18));
+    out[1] = char(0x80 | ((c >> 12) & 0x3f));
+    out[2] = char(0x80 | ((c >> 6) & 0x3f));
+    out[3] = char(0x80 | (c & 0x3f));
+    return 4;
+}
+
+std::string twoPassUtf16ToUtf8(const char16_t* text) {
+    char buf[4];
+    size_t len = 0;
+    for (const char16_t* p = text; *p; ) {
+        len += encode(p, buf);
+    }
+    std::string out(len, '\0');
+    size_t o = 0;
+    for (const char16_t* p = text; *p; ) {
+        o += encode(p, &out[o]);
+    }
+    return out;
+}
+
+std::string makeText(const char* sample) {
+    std::string text;
+    while (text.size() < textSize) {
+        text += sample;
+    }
+    return text;
+}
+
+template <typename Func>
+double megabytesPerSecond(size_t bytes, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        func();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(bytes) * rounds / elapsed.count() / 1e6;
+}
+
+volatile size_t sink = 0;
+
+void run(const char* name, const std::string& utf8) {
+    std::u16string utf16;
+    Ime::utf8ToUtf16(utf8, utf16);
+    std::u16string out16;
+    std::string out8;
+    out16.reserve(Ime::utf16BufferSize(utf8.size()));
+    out8.reserve(Ime::utf8BufferSize(utf16.size()));
+
+    double twoPass16 = megabytesPerSecond(utf8.size(), [&]() { sink = twoPassUtf8ToUtf16(utf8.c_str()).size(); });
+    double onePass16 = megabytesPerSecond(utf8.size(), [&]() { Ime::utf8ToUtf16(utf8, out16); sink = out16.size(); });
+    double twoPass8 = megabytesPerSecond(utf8.size(), [&]() { sink = twoPassUtf16ToUtf8(utf16.c_str()).size(); });
+    double onePass8 = megabytesPerSecond(utf8.size(), [&]() { Ime::utf16ToUtf8(utf16, out8); sink = out8.size(); });
+    std::printf("%-8s UTF-8 -> UTF-16: two-pass %7.0f MB/s, Ime::utf8ToUtf16 %7.0f MB/s\n", name, twoPass16, onePass16);
+    std::printf("%-8s UTF-16 -> UTF-8: two-pass %7.0f MB/s, Ime::utf16ToUtf8 %7.0f MB/s\n", name, twoPass8, onePass8);
+}
+
+}
+
+int main() {
+    // throughput is in MB of UTF-8
+    run("ascii", makeText("{\"type\": \"keyDown\", \"keyCode\": 65, \"charCode\": 97, \"seqNum\": 12345}\n"));
+    run("cjk", makeText("\xe4\xb8\xad\xe6\x96\x87\xe8\xbc\xb8\xe5\x85\xa5\xe6\xb3\x95\xe6\x98\xaf\xe4\xb8\x80\xe7\xa8\xae\xe8\xbc\xb8\xe5\x85\xa5\xe4\xb8\xad\xe6\x96\x87\xe5\xad\x97\xe7\x9a\x84\xe6\x96\xb9\xe6\xb3\x95\xe3\x80\x82"));
+    run("mixed", makeText("IME \xe8\xbc\xb8\xe5\x85\xa5\xe6\xb3\x95 (input method) \xe2\x80\x94 caf\xc3\xa9 \xf0\x9f\x98\x80 "));
+    return 0;
+}
@@ -0,0 +1,59 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CandidateArena.h"
+#include "TextExtentCache.h"
+
+namespace Ime {
+
+CandidateArena::CandidateArena():
+    offsets_(1, 0) {
+}
+
+void CandidateArena::append(std::wstring_view str) {
+    chars_.insert(chars_.end(), str.begin(), str.end());
+    offsets_.push_back(uint32_t(chars_.size()));
+    hashes_.push_back(TextExtentCache::hash(str.data(), str.length()));
+}
+
+void CandidateArena::removeLast() {
+    offsets_.pop_back();
+    chars_.resize(offsets_.back());
+    hashes_.pop_back();
+}
+
+void CandidateArena::clear() {
+    chars_.clear();
+    offsets_.resize(1);
+    hashes_.clear();
+}
+
+void CandidateArena::reserve(size_t itemCount, size_t charCount) {
+    chars_.reserve(charCount);
+    offsets_.reserve(itemCount + 1);
+    hashes_.reserve(itemCount);
+}
+
+size_t CandidateArena::memoryUsage() const {
+    return chars_.capacity() * sizeof(wchar_t)
+        + offsets_.capacity() * sizeof(uint32_t)
+        + hashes_.capacity() * sizeof(uint64_t);
+}
+
+} // namespace Ime
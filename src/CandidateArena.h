@@ -0,0 +1,81 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_ARENA_H
+#define IME_CANDIDATE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Ime {
+
+// Compact storage of candidate strings.
+// All the strings live in a single contiguous UTF-16 buffer, addressed by an
+// offset array, and the hash of every string is computed once when it's added.
+// clear() keeps the allocated memory, so an arena which is refilled for every
+// keystroke stops allocating after a while.
+class CandidateArena {
+public:
+    CandidateArena();
+
+    int size() const {
+        return int(hashes_.size());
+    }
+
+    bool empty() const {
+        return hashes_.empty();
+    }
+
+    std::wstring_view operator[](int i) const {
+        return std::wstring_view(chars_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    // same as TextExtentCache::hash() of the string
+    uint64_t hash(int i) const {
+        return hashes_[i];
+    }
+
+    void append(std::wstring_view str);
+
+    // remove the last string, the arena must not be empty.
+    void removeLast();
+
+    void clear();
+
+    void reserve(size_t itemCount, size_t charCount);
+
+    // number of UTF-16 code units of all the strings
+    size_t charCount() const {
+        return chars_.size();
+    }
+
+    // bytes allocated by the arena
+    size_t memoryUsage() const;
+
+private:
+    std::vector<wchar_t> chars_;
+    std::vector<uint32_t> offsets_;  // size() + 1 entries, the last one is the end of the buffer
+    std::vector<uint64_t> hashes_;
+};
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CandidateList.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace Ime {
+
+CandidateList::CandidateList():
+    ownItems_(nullptr),
+    candPerRow_(1),
+    rowsPerPage_(10),
+    currentSel_(0),
+    itemsVersion_(0),
+    pagesVersion_(0) {
+}
+
+void CandidateList::setSource(std::shared_ptr<CandidateSource> source) {
+    resetFilter();
+    source_ = std::move(source);
+    ownItems_ = nullptr;
+    pageStarts_.clear();
+    ++itemsVersion_;
+    currentSel_ = 0;
+    loadPage();
+}
+
+void CandidateList::setItems(std::vector<std::wstring> items) {
+    CandidateArena arena = recycleItems();
+    size_t charCount = 0;
+    for(const auto& item: items)
+        charCount += item.length();
+    arena.reserve(items.size(), charCount);
+    for(const auto& item: items)
+        arena.append(item);
+    setItems(std::move(arena));
+}
+
+void CandidateList::setItems(CandidateArena&& items) {
+    auto source = std::make_shared<ArenaCandidateSource>(std::move(items));
+    setSource(source);
+    ownItems_ = source.get();
+}
+
+CandidateArena CandidateList::recycleItems() {
+    resetFilter();
+    CandidateArena arena;
+    if(ownItems_ && source_.use_count() == 1) { // nobody else is using the source
+        arena = std::move(ownItems_->items());
+        arena.clear();
+    }
+    source_ = nullptr;
+    ownItems_ = nullptr;
+    pageItems_.clear();
+    pageAnnotations_.clear();
+    pageStarts_.clear();
+    currentSel_ = 0;
+    ++itemsVersion_;
+    return arena;
+}
+
+void CandidateList::add(std::wstring item, wchar_t selKey) {
+    if(filterBase_) {
+        resetFilter();
+        currentSel_ = 0;
+        loadPage();
+    }
+    if(!ownItems_)
+        setItems(CandidateArena());
+    ownItems_->items().append(item);
+    ++itemsVersion_;
+    // Selection keys belong to the slots of a page. A key which is already
+    // used is the one of an item on a later page.
+    if(selKey && find(selKeys_.begin(), selKeys_.end(), selKey) == selKeys_.end()
+        && int(selKeys_.size()) < candPerRow_ * rowsPerPage_) {
+        selKeys_.push_back(selKey);
+        ++pagesVersion_;
+    }
+    if(pageOf(count() - 1) == currentPage())
+        loadPage();
+}
+
+void CandidateList::clear() {
+    resetFilter();
+    source_ = nullptr;
+    ownItems_ = nullptr;
+    pageItems_.clear();
+    pageAnnotations_.clear();
+    selKeys_.clear();
+    pageStarts_.clear();
+    currentSel_ = 0;
+    ++itemsVersion_;
+}
+
+void CandidateList::setSelKeys(std::vector<wchar_t> selKeys) {
+    selKeys_ = std::move(selKeys);
+    ++pagesVersion_;
+    loadPage();
+}
+
+void CandidateList::setCandPerRow(int n) {
+    candPerRow_ = max(n, 1);
+    ++pagesVersion_;
+    loadPage();
+}
+
+void CandidateList::setRowsPerPage(int n) {
+    rowsPerPage_ = max(n, 1);
+    ++pagesVersion_;
+    loadPage();
+}
+
+int CandidateList::pageCount() const {
+    if(count() == 0)
+        return 1;
+    if(!pageStarts_.empty())
+        return int(pageStarts_.size());
+    return (count() + pageSize() - 1) / pageSize();
+}
+
+int CandidateList::pageStart(int page) const {
+    if(!pageStarts_.empty())
+        return page < int(pageStarts_.size()) ? pageStarts_[page] : count();
+    return min(page * pageSize(), count());
+}
+
+int CandidateList::pageEnd(int page) const {
+    if(!pageStarts_.empty())
+        return page + 1 < int(pageStarts_.size()) ? pageStarts_[page + 1] : count();
+    return min((page + 1) * pageSize(), count());
+}
+
+int CandidateList::pageOf(int index) const {
+    if(!pageStarts_.empty()) {
+        auto it = upper_bound(pageStarts_.begin(), pageStarts_.end(), index);
+        return max(int(it - pageStarts_.begin()) - 1, 0);
+    }
+    return index / pageSize();
+}
+
+bool CandidateList::setPageStarts(std::vector<int> starts) {
+    if(!starts.empty()) {
+        if(starts[0] != 0)
+            return false;
+        for(size_t i = 1; i < starts.size(); ++i) {
+            if(starts[i] <= starts[i - 1] || starts[i] >= count())
+                return false;
+        }
+    }
+    pageStarts_ = std::move(starts);
+    ++pagesVersion_;
+    loadPage();
+    return true;
+}
+
+bool CandidateList::setCurrentPage(int page) {
+    if(page < 0)
+        return false;
+    if(page >= pageCount() && (!pageStarts_.empty() || !ensureCount(page * pageSize() + 1)))
+        return false;
+    int slot = currentSlot();
+    int start = pageStart(page);
+    int last = max(pageEnd(page) - 1, start);
+    return setCurrentSel(min(start + slot, last));
+}
+
+bool CandidateList::setCurrentSel(int sel) {
+    if(sel < 0 || sel >= count())
+        sel = 0;
+    if(sel == currentSel_)
+        return false;
+    int oldPage = currentPage();
+    currentSel_ = sel;
+    if(currentPage() != oldPage)
+        loadPage();
+    return true;
+}
+
+bool CandidateList::moveUp() {
+    if(currentSlot() - candPerRow_ >= 0)
+        return setCurrentSel(currentSel_ - candPerRow_);
+    // go to the last row of the previous page
+    int page = currentPage();
+    if(page == 0)
+        return false;
+    int start = pageStart(page - 1);
+    int size = pageEnd(page - 1) - start;
+    int col = currentSlot() % candPerRow_;
+    int lastRowStart = (size - 1) / candPerRow_ * candPerRow_;
+    return setCurrentSel(start + min(lastRowStart + col, size - 1));
+}
+
+bool CandidateList::moveDown() {
+    int size = currentPageSize();
+    int slot = currentSlot();
+    if(slot / candPerRow_ < (size - 1) / candPerRow_) // not in the last row yet
+        return setCurrentSel(currentPageStart() + min(slot + candPerRow_, size - 1));
+    // go to the first row of the next page
+    int page = currentPage();
+    if(page + 1 >= pageCount() && (!pageStarts_.empty() || !ensureCount(pageEnd(page) + 1)))
+        return false;
+    int start = pageStart(page + 1);
+    int col = slot % candPerRow_;
+    return setCurrentSel(start + min(col, pageEnd(page + 1) - start - 1));
+}
+
+bool CandidateList::moveLeft() {
+    if(currentSel_ > 0)
+        return setCurrentSel(currentSel_ - 1);
+    return false;
+}
+
+bool CandidateList::moveRight() {
+    if(currentSel_ + 1 < count() || ensureCount(currentSel_ + 2))
+        return setCurrentSel(currentSel_ + 1);
+    return false;
+}
+
+bool CandidateList::nextPage() {
+    return setCurrentPage(currentPage() + 1);
+}
+
+bool CandidateList::prevPage() {
+    return setCurrentPage(currentPage() - 1);
+}
+
+int CandidateList::filter(std::wstring_view prefix) {
+    if(!filterBase_) {
+        if(!source_)
+            return 0;
+        filterBase_ = source_;
+        prefixIndex_.build(*filterBase_);
+    }
+    if(prefix.empty()) {
+        source_ = filterBase_;
+        filtered_ = nullptr;
+    }
+    else {
+        filtered_ = std::make_shared<FilteredCandidateSource>(filterBase_, prefixIndex_.match(prefix));
+        source_ = filtered_;
+    }
+    pageStarts_.clear();
+    currentSel_ = 0;
+    ++itemsVersion_;
+    loadPage();
+    return count();
+}
+
+int CandidateList::unfilteredIndex(int i) const {
+    return filtered_ ? filtered_->baseIndex(i) : i;
+}
+
+void CandidateList::resetFilter() {
+    if(filterBase_) {
+        source_ = filterBase_;
+        filterBase_ = nullptr;
+        filtered_ = nullptr;
+        prefixIndex_.clear();
+    }
+}
+
+bool CandidateList::ensureCount(int n) {
+    if(!source_)
+        return false;
+    if(count() >= n)
+        return true;
+    if(source_->isComplete())
+        return false;
+    return source_->fetch(n) && count() >= n;
+}
+
+void CandidateList::loadPage() {
+    pageItems_.clear();
+    pageAnnotations_.clear();
+    if(!source_)
+        return;
+    int page = currentPage();
+    // make the page full if the source can generate more candidates
+    if(pageStarts_.empty())
+        ensureCount((page + 1) * pageSize());
+    for(int i = pageStart(page), end = pageEnd(page); i < end; ++i) {
+        source_->copyTo(i, pageItems_);
+        source_->copyAnnotationTo(i, pageAnnotations_);
+    }
+}
+
+} // namespace Ime
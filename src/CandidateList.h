@@ -0,0 +1,221 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_LIST_H
+#define IME_CANDIDATE_LIST_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CandidatePrefixIndex.h"
+#include "CandidateSource.h"
+
+namespace Ime {
+
+// The page model behind CandidateWindow.
+// Candidates are shown one page at a time. A page has candPerRow() * rowsPerPage()
+// items unless the application sets its own page boundaries with setPageStarts().
+// Selection keys are assigned to the slots of a page, not to the candidates.
+// The current selection is an index into the whole list and the current page
+// always follows it.
+// Candidates are pulled from a CandidateSource and only the items on the
+// current page are materialized.
+class CandidateList {
+public:
+    CandidateList();
+
+    const std::shared_ptr<CandidateSource>& source() const {
+        return source_;
+    }
+
+    void setSource(std::shared_ptr<CandidateSource> source);
+
+    // the items are moved in, pass an rvalue to avoid copying the whole list.
+    void setItems(std::vector<std::wstring> items);
+
+    // Bulk API for engines. The arena is moved in and can be taken back
+    // with recycleItems() when the list is refreshed, so its memory is reused.
+    void setItems(CandidateArena&& items);
+
+    // clear the list and give back the (empty) arena passed to setItems().
+    CandidateArena recycleItems();
+
+    // the filter is reset.
+    void add(std::wstring item, wchar_t selKey);
+
+    void clear();
+
+    // number of candidates known so far
+    int count() const {
+        return source_ ? source_->count() : 0;
+    }
+
+    // the i-th item of the whole list, pulled from the source.
+    std::wstring item(int i) const {
+        return source_->get(i);
+    }
+
+    const std::vector<wchar_t>& selKeys() const {
+        return selKeys_;
+    }
+
+    // the keys also limit the size of a page, see pageSize().
+    void setSelKeys(std::vector<wchar_t> selKeys);
+
+    // selection key of the n-th slot of a page, or 0 if there is none.
+    wchar_t selKey(int slot) const {
+        return slot >= 0 && slot < int(selKeys_.size()) ? selKeys_[slot] : 0;
+    }
+
+    int candPerRow() const {
+        return candPerRow_;
+    }
+    void setCandPerRow(int n);
+
+    int rowsPerPage() const {
+        return rowsPerPage_;
+    }
+    void setRowsPerPage(int n);
+
+    // number of items on a full page, no more than the selection keys if there are
+    // any, so every item on a page can be picked by a key
+    int pageSize() const {
+        int size = candPerRow_ * rowsPerPage_;
+        return selKeys_.empty() ? size : std::min(size, int(selKeys_.size()));
+    }
+
+    int pageCount() const;
+
+    // index of the first item on the page
+    int pageStart(int page) const;
+
+    // index past the last item on the page
+    int pageEnd(int page) const;
+
+    int pageOf(int index) const;
+
+    // set page boundaries explicitly (ITfCandidateListUIElement::SetPageIndex()).
+    // starts must begin with 0 and be strictly increasing.
+    // Passing an empty list goes back to evenly sized pages.
+    bool setPageStarts(std::vector<int> starts);
+
+    int currentPage() const {
+        return pageOf(currentSel_);
+    }
+
+    // go to the page and select the item in the same slot as the current one.
+    bool setCurrentPage(int page);
+
+    int currentPageStart() const {
+        return pageStart(currentPage());
+    }
+
+    int currentPageSize() const {
+        int page = currentPage();
+        return pageEnd(page) - pageStart(page);
+    }
+
+    // the n-th item on the current page
+    std::wstring_view pageItem(int slot) const {
+        return pageItems_[slot];
+    }
+
+    // hash of the n-th item on the current page, see TextExtentCache::hash().
+    uint64_t pageItemHash(int slot) const {
+        return pageItems_.hash(slot);
+    }
+
+    std::wstring_view pageAnnotation(int slot) const {
+        return pageAnnotations_[slot];
+    }
+
+    // index of the selected item in the whole list.
+    int currentSel() const {
+        return currentSel_;
+    }
+    bool setCurrentSel(int sel);
+
+    // index of the selected item on the current page.
+    int currentSlot() const {
+        return currentSel_ - currentPageStart();
+    }
+
+    // Keep only the candidates whose annotation (reading) starts with the prefix,
+    // in their original order, and select the first one. Candidates without an
+    // annotation, such as those passed to setItems() or add(), are matched by
+    // their text. An empty prefix shows all of them again. Typing more keys
+    // narrows the previous match in logarithmic time instead of rebuilding the list.
+    // Sources generating candidates on demand are only filtered over the
+    // candidates fetched so far, the others are not generated.
+    // Returns the number of matching candidates.
+    int filter(std::wstring_view prefix);
+
+    bool isFiltered() const {
+        return filterBase_ != nullptr;
+    }
+
+    // index of the i-th (filtered) candidate in the list passed to setItems() or setSource().
+    int unfilteredIndex(int i) const;
+
+    // incremented whenever the candidates are replaced or added.
+    unsigned int itemsVersion() const {
+        return itemsVersion_;
+    }
+
+    // incremented whenever the page layout or boundaries are changed.
+    unsigned int pagesVersion() const {
+        return pagesVersion_;
+    }
+
+    // keyboard navigation. All of them return true if the selection is changed.
+    // Moving beyond the edges of the current page flips the page.
+    bool moveUp();
+    bool moveDown();
+    bool moveLeft();
+    bool moveRight();
+    bool nextPage();
+    bool prevPage();
+
+private:
+    // ask sources generating candidates on demand for more of them
+    bool ensureCount(int n);
+    void resetFilter();
+    void loadPage();
+
+private:
+    std::shared_ptr<CandidateSource> source_;
+    ArenaCandidateSource* ownItems_;  // the source used by setItems() and add(), if any
+    std::shared_ptr<CandidateSource> filterBase_;  // the unfiltered source if a filter is applied
+    std::shared_ptr<FilteredCandidateSource> filtered_;
+    CandidatePrefixIndex prefixIndex_;  // built on the first call to filter()
+    CandidateArena pageItems_;
+    CandidateArena pageAnnotations_;
+    std::vector<wchar_t> selKeys_;
+    std::vector<int> pageStarts_;  // empty if pages are evenly sized
+    int candPerRow_;
+    int rowsPerPage_;
+    int currentSel_;
+    unsigned int itemsVersion_;
+    unsigned int pagesVersion_;
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CandidatePainter.h"
+#include "CandidateList.h"
+
+namespace Ime {
+
+CandidatePainter::CandidatePainter():
+    layout_{0, 0, 0, 0, 0, 0, 0, 0, 1},
+    fullRepaint_(true) {
+}
+
+void CandidatePainter::setLayout(const CandidateLayout& layout) {
+    CandidateLayout newLayout = layout;
+    if(newLayout.candPerRow <= 0)
+        newLayout.candPerRow = 1;
+    if(newLayout == layout_)
+        return;
+    layout_ = newLayout;
+    invalidateAll();
+}
+
+PaintRect CandidatePainter::itemRect(int slot) const {
+    int row = slot / layout_.candPerRow;
+    int col = slot % layout_.candPerRow;
+    PaintRect rect;
+    rect.left = layout_.margin + col * (layout_.selKeyWidth + layout_.textWidth + layout_.colSpacing);
+    rect.top = layout_.margin + row * (layout_.itemHeight + layout_.rowSpacing);
+    rect.right = rect.left + layout_.selKeyWidth + layout_.textWidth;
+    rect.bottom = rect.top + layout_.itemHeight;
+    return rect;
+}
+
+CandidatePainter::ItemState CandidatePainter::itemState(const CandidateList& list, int slot, bool useCursor) const {
+    ItemState state;
+    state.hash = list.pageItemHash(slot);
+    state.length = list.pageItem(slot).length();
+    state.selKey = list.selKey(slot);
+    state.selected = useCursor && slot == list.currentSlot();
+    return state;
+}
+
+bool CandidatePainter::isItemDirty(const CandidateList& list, int slot, bool useCursor) const {
+    return slot >= int(painted_.size()) || !(painted_[slot] == itemState(list, slot, useCursor));
+}
+
+PaintRect CandidatePainter::dirtyRect(const CandidateList& list, bool useCursor) const {
+    int itemCount = list.currentPageSize();
+    if(fullRepaint_ || itemCount != int(painted_.size()))
+        return PaintRect{0, 0, layout_.width, layout_.height};
+    PaintRect dirty{0, 0, 0, 0};
+    for(int slot = 0; slot < itemCount; ++slot) {
+        if(isItemDirty(list, slot, useCursor))
+            dirty.unite(itemRect(slot));
+    }
+    return dirty;
+}
+
+void CandidatePainter::paint(const CandidateList& list, bool useCursor, PaintBackend& backend, const PaintRect& exposed) {
+    int itemCount = list.currentPageSize();
+    PaintRect dirty = exposed;
+    if(fullRepaint_ || itemCount != int(painted_.size())) {
+        // the number of items changed, so some slots need to be erased as well
+        PaintRect all{0, 0, layout_.width, layout_.height};
+        backend.drawFrame(all);
+        painted_.clear();
+        for(int slot = 0; slot < itemCount; ++slot)
+            paintItem(list, slot, useCursor, backend);
+        fullRepaint_ = false;
+        dirty = all;
+    }
+    else {
+        for(int slot = 0; slot < itemCount; ++slot) {
+            if(isItemDirty(list, slot, useCursor)) {
+                paintItem(list, slot, useCursor, backend);
+                dirty.unite(itemRect(slot));
+            }
+        }
+    }
+    if(!dirty.isEmpty())
+        backend.present(dirty);
+}
+
+void CandidatePainter::paintItem(const CandidateList& list, int slot, bool useCursor, PaintBackend& backend) {
+    ItemState state = itemState(list, slot, useCursor);
+    PaintRect rect = itemRect(slot);
+
+    // the selection key
+    wchar_t selKey[] = L"?. ";
+    selKey[0] = state.selKey ? state.selKey : L' ';
+    PaintRect selKeyRect = rect;
+    selKeyRect.right = selKeyRect.left + layout_.selKeyWidth;
+    backend.drawText(selKeyRect, std::wstring_view(selKey, 3), PaintColor::SEL_KEY, PaintColor::WINDOW);
+
+    // the candidate string, highlighted if it's selected
+    PaintRect textRect = rect;
+    textRect.left = selKeyRect.right;
+    if(state.selected)
+        backend.drawText(textRect, list.pageItem(slot), PaintColor::HIGHLIGHT_TEXT, PaintColor::HIGHLIGHT);
+    else
+        backend.drawText(textRect, list.pageItem(slot), PaintColor::WINDOW_TEXT, PaintColor::WINDOW);
+
+    if(slot >= int(painted_.size()))
+        painted_.resize(slot + 1);
+    painted_[slot] = state;
+}
+
+} // namespace Ime
@@ -0,0 +1,108 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_PAINTER_H
+#define IME_CANDIDATE_PAINTER_H
+
+#include <cstdint>
+#include <vector>
+#include "PaintBackend.h"
+
+namespace Ime {
+
+class CandidateList;
+
+// geometry of the candidate window, computed by CandidateWindow::recalculateSize()
+struct CandidateLayout {
+    int width;
+    int height;
+    int margin;
+    int rowSpacing;
+    int colSpacing;
+    int selKeyWidth;
+    int textWidth;
+    int itemHeight;
+    int candPerRow;
+
+    bool operator==(const CandidateLayout& other) const {
+        return width == other.width && height == other.height && margin == other.margin
+            && rowSpacing == other.rowSpacing && colSpacing == other.colSpacing
+            && selKeyWidth == other.selKeyWidth && textWidth == other.textWidth
+            && itemHeight == other.itemHeight && candPerRow == other.candPerRow;
+    }
+};
+
+// Paints the current page of a candidate list to a persistent back buffer.
+// The painter remembers what every item looked like when it was last painted,
+// so only items whose text, selection key or selected state changed are
+// repainted, and only the union of their rects is copied to the screen.
+class CandidatePainter {
+public:
+    CandidatePainter();
+
+    const CandidateLayout& layout() const {
+        return layout_;
+    }
+
+    // a different layout invalidates the whole back buffer.
+    void setLayout(const CandidateLayout& layout);
+
+    PaintRect itemRect(int slot) const;
+
+    // the back buffer is lost (e.g. recreated) and everything needs to be painted again.
+    void invalidateAll() {
+        fullRepaint_ = true;
+    }
+
+    bool needsFullRepaint() const {
+        return fullRepaint_;
+    }
+
+    // the area which paint() would update, empty if the back buffer is up to date.
+    PaintRect dirtyRect(const CandidateList& list, bool useCursor) const;
+
+    // paint the changed items, then copy them and the exposed area to the screen.
+    void paint(const CandidateList& list, bool useCursor, PaintBackend& backend, const PaintRect& exposed = PaintRect{0, 0, 0, 0});
+
+private:
+    // what an item looked like when it was painted
+    struct ItemState {
+        uint64_t hash;
+        size_t length;
+        wchar_t selKey;
+        bool selected;
+
+        bool operator==(const ItemState& other) const {
+            return hash == other.hash && length == other.length && selKey == other.selKey && selected == other.selected;
+        }
+    };
+
+    ItemState itemState(const CandidateList& list, int slot, bool useCursor) const;
+    bool isItemDirty(const CandidateList& list, int slot, bool useCursor) const;
+    void paintItem(const CandidateList& list, int slot, bool useCursor, PaintBackend& backend);
+
+private:
+    CandidateLayout layout_;
+    std::vector<ItemState> painted_;  // items in the back buffer
+    bool fullRepaint_;
+};
+
+}
+
+#endif
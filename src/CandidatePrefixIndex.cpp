@@ -0,0 +1,108 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CandidatePrefixIndex.h"
+#include "CandidateSource.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace Ime {
+
+CandidatePrefixIndex::CandidatePrefixIndex():
+    lastBegin_(0),
+    lastEnd_(0),
+    comparisons_(0) {
+}
+
+void CandidatePrefixIndex::build(CandidateSource& source) {
+    keys_.clear();
+    for(int i = 0, n = source.count(); i < n; ++i) {
+        source.copyAnnotationTo(i, keys_);
+        if(keys_[i].empty()) {
+            keys_.removeLast();
+            source.copyTo(i, keys_);
+        }
+    }
+    sortKeys();
+}
+
+void CandidatePrefixIndex::build(const std::vector<std::wstring>& keys) {
+    keys_.clear();
+    for(const auto& key: keys)
+        keys_.append(key);
+    sortKeys();
+}
+
+void CandidatePrefixIndex::clear() {
+    keys_.clear();
+    sorted_.clear();
+    lastPrefix_.clear();
+    lastBegin_ = lastEnd_ = 0;
+}
+
+void CandidatePrefixIndex::sortKeys() {
+    sorted_.resize(keys_.size());
+    iota(sorted_.begin(), sorted_.end(), 0);
+    // candidates with the same key keep their order
+    stable_sort(sorted_.begin(), sorted_.end(), [this](int a, int b) {
+        return keys_[a] < keys_[b];
+    });
+    // the empty prefix matches everything
+    lastPrefix_.clear();
+    lastBegin_ = 0;
+    lastEnd_ = sorted_.size();
+}
+
+int CandidatePrefixIndex::comparePrefix(int item, std::wstring_view prefix) {
+    ++comparisons_;
+    return keys_[item].substr(0, prefix.length()).compare(prefix);
+}
+
+std::vector<int> CandidatePrefixIndex::match(std::wstring_view prefix) {
+    size_t begin = 0;
+    size_t end = sorted_.size();
+    // narrowing the last match only needs to search its range
+    if(prefix.length() >= lastPrefix_.length() && prefix.substr(0, lastPrefix_.length()) == lastPrefix_) {
+        begin = lastBegin_;
+        end = lastEnd_;
+    }
+
+    auto first = sorted_.begin() + begin;
+    auto last = sorted_.begin() + end;
+    first = lower_bound(first, last, prefix, [this](int item, std::wstring_view p) {
+        return comparePrefix(item, p) < 0;
+    });
+    last = upper_bound(first, last, prefix, [this](std::wstring_view p, int item) {
+        return comparePrefix(item, p) > 0;
+    });
+
+    lastPrefix_ = prefix;
+    lastBegin_ = first - sorted_.begin();
+    lastEnd_ = last - sorted_.begin();
+
+    // back to the original (ranked) order
+    std::vector<int> result(first, last);
+    sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace Ime
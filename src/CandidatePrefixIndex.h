@@ -0,0 +1,85 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_PREFIX_INDEX_H
+#define IME_CANDIDATE_PREFIX_INDEX_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CandidateArena.h"
+
+namespace Ime {
+
+class CandidateSource;
+
+// Finds the candidates whose key (usually the reading given as annotation)
+// starts with a prefix.
+// The keys are sorted once, so a prefix is a range of the sorted order found
+// by binary search. When the prefix is extended by more keys, as the user
+// keeps typing, only the range of the previous prefix is searched again.
+class CandidatePrefixIndex {
+public:
+    CandidatePrefixIndex();
+
+    // index the annotations of all the candidates known by the source,
+    // or their text for the candidates without one.
+    void build(CandidateSource& source);
+
+    void build(const std::vector<std::wstring>& keys);
+
+    void clear();
+
+    int size() const {
+        return keys_.size();
+    }
+
+    // indices of the candidates with keys starting with the prefix, in their original order.
+    std::vector<int> match(std::wstring_view prefix);
+
+    // number of keys compared by the binary searches so far
+    size_t comparisons() const {
+        return comparisons_;
+    }
+
+    void resetStats() {
+        comparisons_ = 0;
+    }
+
+private:
+    void sortKeys();
+    // compare the first len chars of the key of the item with the prefix
+    int comparePrefix(int item, std::wstring_view prefix);
+
+private:
+    CandidateArena keys_;
+    std::vector<int> sorted_;  // candidate indices sorted by their keys
+
+    // the last match, the next one is searched in its range if the prefix is extended
+    std::wstring lastPrefix_;
+    size_t lastBegin_;
+    size_t lastEnd_;
+
+    size_t comparisons_;
+};
+
+}
+
+#endif
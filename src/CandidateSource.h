@@ -0,0 +1,172 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_SOURCE_H
+#define IME_CANDIDATE_SOURCE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "CandidateArena.h"
+
+namespace Ime {
+
+// Candidates are pulled from a source by the candidate window one page at a time,
+// so the engine does not need to build the whole list up front.
+class CandidateSource {
+public:
+    virtual ~CandidateSource() {}
+
+    // number of candidates available so far.
+    virtual int count() = 0;
+
+    // the i-th candidate, 0 <= i < count().
+    virtual std::wstring get(int i) = 0;
+
+    // optional annotation of the i-th candidate, such as its reading.
+    virtual std::wstring annotation(int /* i */) {
+        return std::wstring();
+    }
+
+    // append the i-th candidate to the arena.
+    // Sources which already store their strings can avoid the temporary string of get().
+    virtual void copyTo(int i, CandidateArena& arena) {
+        arena.append(get(i));
+    }
+
+    virtual void copyAnnotationTo(int i, CandidateArena& arena) {
+        arena.append(annotation(i));
+    }
+
+    // Sources generating candidates on demand (e.g. from a ranked iterator)
+    // are asked to make at least n candidates available before a page is shown.
+    // Return false if there are fewer than n candidates in total.
+    virtual bool fetch(int n) {
+        return n <= count();
+    }
+
+    // true if count() is the final number of candidates.
+    virtual bool isComplete() {
+        return true;
+    }
+};
+
+// a source with all the candidates already in a vector.
+class VectorCandidateSource: public CandidateSource {
+public:
+    VectorCandidateSource() {}
+
+    explicit VectorCandidateSource(std::vector<std::wstring> items, std::vector<std::wstring> annotations = {}):
+        items_(std::move(items)),
+        annotations_(std::move(annotations)) {
+    }
+
+    int count() override {
+        return int(items_.size());
+    }
+
+    std::wstring get(int i) override {
+        return items_[i];
+    }
+
+    std::wstring annotation(int i) override {
+        return i < int(annotations_.size()) ? annotations_[i] : std::wstring();
+    }
+
+    void add(std::wstring item, std::wstring annotation = std::wstring()) {
+        items_.push_back(std::move(item));
+        if(!annotation.empty()) {
+            annotations_.resize(items_.size() - 1);
+            annotations_.push_back(std::move(annotation));
+        }
+    }
+
+private:
+    std::vector<std::wstring> items_;
+    std::vector<std::wstring> annotations_;
+};
+
+// a source with all the candidates stored in an arena.
+class ArenaCandidateSource: public CandidateSource {
+public:
+    explicit ArenaCandidateSource(CandidateArena items):
+        items_(std::move(items)) {
+    }
+
+    int count() override {
+        return items_.size();
+    }
+
+    std::wstring get(int i) override {
+        return std::wstring(items_[i]);
+    }
+
+    void copyTo(int i, CandidateArena& arena) override {
+        arena.append(items_[i]);
+    }
+
+    CandidateArena& items() {
+        return items_;
+    }
+
+private:
+    CandidateArena items_;
+};
+
+// a subset of the candidates of another source, see CandidateList::filter().
+class FilteredCandidateSource: public CandidateSource {
+public:
+    FilteredCandidateSource(std::shared_ptr<CandidateSource> base, std::vector<int> indices):
+        base_(std::move(base)),
+        indices_(std::move(indices)) {
+    }
+
+    int count() override {
+        return int(indices_.size());
+    }
+
+    std::wstring get(int i) override {
+        return base_->get(indices_[i]);
+    }
+
+    std::wstring annotation(int i) override {
+        return base_->annotation(indices_[i]);
+    }
+
+    void copyTo(int i, CandidateArena& arena) override {
+        base_->copyTo(indices_[i], arena);
+    }
+
+    void copyAnnotationTo(int i, CandidateArena& arena) override {
+        base_->copyAnnotationTo(indices_[i], arena);
+    }
+
+    // index of the i-th candidate in the base source
+    int baseIndex(int i) const {
+        return indices_[i];
+    }
+
+private:
+    std::shared_ptr<CandidateSource> base_;
+    std::vector<int> indices_;
+};
+
+}
+
+#endif
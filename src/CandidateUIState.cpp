@@ -0,0 +1,100 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CandidateUIState.h"
+#include "CandidateList.h"
+
+namespace Ime {
+
+CandidateUIState::CandidateUIState():
+    seen_{nullptr, 0, 0, 0, 0, 0, 0},
+    updatedFlags_(0),
+    elementId_(0),
+    begun_(false),
+    show_(true) {
+}
+
+// static
+CandidateUIState::Snapshot CandidateUIState::snapshot(const CandidateList& list, const void* documentMgr) {
+    Snapshot s;
+    s.documentMgr = documentMgr;
+    s.count = list.count();
+    s.selection = list.currentSel();
+    s.currentPage = list.currentPage();
+    s.pageSize = list.pageSize();
+    s.itemsVersion = list.itemsVersion();
+    s.pagesVersion = list.pagesVersion();
+    return s;
+}
+
+// static
+uint32_t CandidateUIState::diff(const Snapshot& before, const Snapshot& after) {
+    uint32_t flags = 0;
+    if(before.documentMgr != after.documentMgr)
+        flags |= CANDIDATE_UI_DOCUMENTMGR;
+    if(before.count != after.count)
+        flags |= CANDIDATE_UI_COUNT | CANDIDATE_UI_STRING | CANDIDATE_UI_PAGEINDEX;
+    if(before.itemsVersion != after.itemsVersion)
+        flags |= CANDIDATE_UI_STRING;
+    if(before.selection != after.selection)
+        flags |= CANDIDATE_UI_SELECTION;
+    if(before.currentPage != after.currentPage)
+        flags |= CANDIDATE_UI_CURRENTPAGE;
+    if(before.pageSize != after.pageSize || before.pagesVersion != after.pagesVersion)
+        flags |= CANDIDATE_UI_PAGEINDEX;
+    return flags;
+}
+
+void CandidateUIState::sync(const CandidateList& list, const void* documentMgr, UIElementHost& host) {
+    Snapshot now = snapshot(list, documentMgr);
+    if(!begun_) {
+        // the application fetches everything when the element begins,
+        // it may ask for the flags while BeginUIElement() runs
+        bool show = true;
+        updatedFlags_ = CANDIDATE_UI_ALL;
+        if(!host.beginUIElement(elementId_, show)) {
+            updatedFlags_ = 0;
+            return;
+        }
+        begun_ = true;
+        show_ = show;
+        seen_ = now;
+        return;
+    }
+
+    uint32_t flags = diff(seen_, now);
+    if(flags == 0)
+        return;
+    // the flags are kept until the next update, in case the application
+    // asks for them after UpdateUIElement() returns.
+    updatedFlags_ = flags;
+    seen_ = now;
+    host.updateUIElement(elementId_);
+}
+
+void CandidateUIState::end(UIElementHost& host) {
+    if(!begun_)
+        return;
+    host.endUIElement(elementId_);
+    begun_ = false;
+    show_ = true;
+    updatedFlags_ = 0;
+}
+
+} // namespace Ime
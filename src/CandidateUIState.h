@@ -0,0 +1,111 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CANDIDATE_UI_STATE_H
+#define IME_CANDIDATE_UI_STATE_H
+
+#include <cstdint>
+
+namespace Ime {
+
+class CandidateList;
+
+// same values as TF_CLUIE_* in msctf.h
+enum CandidateUIFlags: uint32_t {
+    CANDIDATE_UI_DOCUMENTMGR = 0x00000001,
+    CANDIDATE_UI_COUNT = 0x00000002,
+    CANDIDATE_UI_SELECTION = 0x00000004,
+    CANDIDATE_UI_STRING = 0x00000008,
+    CANDIDATE_UI_PAGEINDEX = 0x00000010,
+    CANDIDATE_UI_CURRENTPAGE = 0x00000020,
+    CANDIDATE_UI_ALL = 0x0000003f
+};
+
+// the parts of ITfUIElementMgr used to report a UI element to the application.
+class UIElementHost {
+public:
+    virtual ~UIElementHost() {}
+
+    // return false on failure. show is set to false if the application
+    // draws the UI itself (UI-less mode) and the IME should not show its window.
+    virtual bool beginUIElement(uint32_t& elementId, bool& show) = 0;
+
+    // the application calls back GetUpdatedFlags() and fetches the changed data.
+    virtual void updateUIElement(uint32_t elementId) = 0;
+
+    virtual void endUIElement(uint32_t elementId) = 0;
+};
+
+// Tracks which parts of the candidate list changed since the application
+// last saw it, so UI-less hosts, such as full screen games, only refetch
+// those instead of every string on every update.
+class CandidateUIState {
+public:
+    CandidateUIState();
+
+    // TF_CLUIE_* flags of the last update, for ITfCandidateListUIElement::GetUpdatedFlags()
+    uint32_t updatedFlags() const {
+        return updatedFlags_;
+    }
+
+    bool isBegun() const {
+        return begun_;
+    }
+
+    uint32_t elementId() const {
+        return elementId_;
+    }
+
+    // false if the application asked the IME not to show its own window
+    bool shouldShow() const {
+        return show_;
+    }
+
+    // compare the list with what the application has seen, and begin or
+    // update the UI element only if something changed.
+    // documentMgr identifies the document manager of the current context.
+    void sync(const CandidateList& list, const void* documentMgr, UIElementHost& host);
+
+    void end(UIElementHost& host);
+
+private:
+    struct Snapshot {
+        const void* documentMgr;
+        int count;
+        int selection;
+        int currentPage;
+        int pageSize;
+        unsigned int itemsVersion;
+        unsigned int pagesVersion;
+    };
+
+    static Snapshot snapshot(const CandidateList& list, const void* documentMgr);
+    static uint32_t diff(const Snapshot& before, const Snapshot& after);
+
+private:
+    Snapshot seen_;  // what the application got last time
+    uint32_t updatedFlags_;
+    uint32_t elementId_;
+    bool begun_;
+    bool show_;
+};
+
+}
+
+#endif
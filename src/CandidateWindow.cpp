@@ -18,7 +18,8 @@
 //
 
 #include "CandidateWindow.h"
-#include "DrawUtils.h"
+#include "GdiPaintBackend.h"
+#include "GdiResources.h"
 #include "TextService.h"
 #include "EditSession.h"
 
@@ -32,13 +33,51 @@ using namespace std;
 
 namespace Ime {
 
+static_assert(CANDIDATE_UI_DOCUMENTMGR == TF_CLUIE_DOCUMENTMGR && CANDIDATE_UI_COUNT == TF_CLUIE_COUNT
+    && CANDIDATE_UI_SELECTION == TF_CLUIE_SELECTION && CANDIDATE_UI_STRING == TF_CLUIE_STRING
+    && CANDIDATE_UI_PAGEINDEX == TF_CLUIE_PAGEINDEX && CANDIDATE_UI_CURRENTPAGE == TF_CLUIE_CURRENTPAGE,
+    "CandidateUIFlags should match TF_CLUIE_*");
+
+namespace {
+
+// reports the candidate window to the ITfUIElementMgr of the thread
+class TsfUIElementHost: public UIElementHost {
+public:
+    TsfUIElementHost(ITfUIElementMgr* mgr, ITfUIElement* element):
+        mgr_(mgr),
+        element_(element) {
+    }
+
+    bool beginUIElement(uint32_t& elementId, bool& show) override {
+        BOOL shown = TRUE;
+        DWORD id = TF_INVALID_UIELEMENTID;
+        if(FAILED(mgr_->BeginUIElement(element_, &shown, &id)))
+            return false;
+        elementId = id;
+        show = !!shown;
+        return true;
+    }
+
+    void updateUIElement(uint32_t elementId) override {
+        mgr_->UpdateUIElement(elementId);
+    }
+
+    void endUIElement(uint32_t elementId) override {
+        mgr_->EndUIElement(elementId);
+    }
+
+private:
+    ITfUIElementMgr* mgr_;
+    ITfUIElement* element_;
+};
+
+}
+
 CandidateWindow::CandidateWindow(TextService* service, EditSession* session):
     ImeWindow(service),
     shown_(false),
-    candPerRow_(1),
     textWidth_(0),
     itemHeight_(0),
-    currentSel_(0),
     hasResult_(false),
     useCursor_(true),
     selKeyWidth_(0) {
@@ -55,7 +94,7 @@ CandidateWindow::CandidateWindow(TextService* service, EditSession* session):
     }
 
     HWND parent = service->compositionWindow(session);
-    create(parent, WS_POPUP|WS_CLIPCHILDREN, WS_EX_TOOLWINDOW|WS_EX_TOPMOST);
+    createWindow(parent);
 }
 
 CandidateWindow::~CandidateWindow(void) {
@@ -78,11 +117,12 @@ STDMETHODIMP CandidateWindow::GetGUID(GUID *pguid) {
 }
 
 STDMETHODIMP CandidateWindow::Show(BOOL bShow) {
+    // the application shows or hides our window, the UI element stays
     shown_ = bShow;
     if (shown_)
-        show();
+        Window::show();
     else
-        hide();
+        Window::hide();
     return S_OK;
 }
 
@@ -97,8 +137,8 @@ STDMETHODIMP CandidateWindow::IsShown(BOOL *pbShow) {
 STDMETHODIMP CandidateWindow::GetUpdatedFlags(DWORD *pdwFlags) {
     if (!pdwFlags)
         return E_INVALIDARG;
-    /// XXX update all!!!
-    *pdwFlags = TF_CLUIE_DOCUMENTMGR | TF_CLUIE_COUNT | TF_CLUIE_SELECTION | TF_CLUIE_STRING | TF_CLUIE_PAGEINDEX | TF_CLUIE_CURRENTPAGE;
+    // only the parts changed by the last update, see updateUIElement().
+    *pdwFlags = uiState_.updatedFlags();
     return S_OK;
 }
 
@@ -111,52 +151,58 @@ STDMETHODIMP CandidateWindow::GetDocumentMgr(ITfDocumentMgr **ppdim) {
 STDMETHODIMP CandidateWindow::GetCount(UINT *puCount) {
     if (!puCount)
         return E_INVALIDARG;
-    *puCount = std::min<UINT>(10, items_.size());
+    *puCount = static_cast<UINT>(list_.count());
     return S_OK;
 }
 
 STDMETHODIMP CandidateWindow::GetSelection(UINT *puIndex) {
-    assert(currentSel_ >= 0);
+    assert(list_.currentSel() >= 0);
     if (!puIndex)
         return E_INVALIDARG;
-    *puIndex = static_cast<UINT>(currentSel_);
+    *puIndex = static_cast<UINT>(list_.currentSel());
     return S_OK;
 }
 
 STDMETHODIMP CandidateWindow::GetString(UINT uIndex, BSTR *pbstr) {
     if (!pbstr)
         return E_INVALIDARG;
-    if (uIndex >= items_.size())
+    if (uIndex >= static_cast<UINT>(list_.count()))
         return E_INVALIDARG;
-    *pbstr = SysAllocString(items_[uIndex].c_str());
+    *pbstr = SysAllocString(list_.item(uIndex).c_str());
     return S_OK;
 }
 
 STDMETHODIMP CandidateWindow::GetPageIndex(UINT *puIndex, UINT uSize, UINT *puPageCnt) {
-    /// XXX Always return the same single page index.
     if (!puPageCnt)
         return E_INVALIDARG;
-    *puPageCnt = 1;
+    UINT pageCount = static_cast<UINT>(list_.pageCount());
+    *puPageCnt = pageCount;
     if (puIndex) {
-        if (uSize < *puPageCnt) {
+        if (uSize < pageCount) {
             return E_INVALIDARG;
         }
-        puIndex[0] = 0;
+        for (UINT page = 0; page < pageCount; ++page) {
+            puIndex[page] = static_cast<UINT>(list_.pageStart(page));
+        }
     }
     return S_OK;
 }
 
 STDMETHODIMP CandidateWindow::SetPageIndex(UINT *puIndex, UINT uPageCnt) {
-    /// XXX Do not let app set page indices.
     if (!puIndex)
         return E_INVALIDARG;
+    // the application wants its own page boundaries.
+    std::vector<int> starts(puIndex, puIndex + uPageCnt);
+    if (!list_.setPageStarts(std::move(starts)))
+        return E_INVALIDARG;
+    onPageChanged();
     return S_OK;
 }
 
 STDMETHODIMP CandidateWindow::GetCurrentPage(UINT *puPage) {
     if (!puPage)
         return E_INVALIDARG;
-    *puPage = 0;
+    *puPage = static_cast<UINT>(list_.currentPage());
     return S_OK;
 }
 
@@ -179,8 +225,13 @@ LRESULT CandidateWindow::wndProc(UINT msg, WPARAM wp , LPARAM lp) {
             break;
         case WM_MOUSEACTIVATE:
             return MA_NOACTIVATE;
+        case WM_SYSCOLORCHANGE:
+        case WM_DPICHANGED:
+            // the back buffer was painted with the old colors or DPI
+            painter_.invalidateAll();
+            return ImeWindow::wndProc(msg, wp, lp);
         default:
-            return Window::wndProc(msg, wp, lp);
+            return ImeWindow::wndProc(msg, wp, lp);
     }
     return 0;
 }
@@ -190,132 +241,140 @@ void CandidateWindow::onPaint(WPARAM wp, LPARAM lp) {
     // in Windows 8 app immersive mode to follow windows 8 UX guidelines
     PAINTSTRUCT ps;
     BeginPaint(hwnd_, &ps);
-    HDC hDC = ps.hdc;
-    HFONT oldFont;
     RECT rc;
+    GetClientRect(hwnd_, &rc);
+    // items are painted to the back buffer only when they change,
+    // the rest of the exposed area is copied from what was painted before.
+    if(backBuffer_.ensureSize(ps.hdc, rc.right - rc.left, rc.bottom - rc.top))
+        painter_.invalidateAll();
+    size_t creations = gdiResources().stats().creations;
+    GdiPaintBackend backend(ps.hdc, backBuffer_, font_, isImmersive());
+    PaintRect exposed = {ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right, ps.rcPaint.bottom};
+    painter_.paint(list_, useCursor_, backend, exposed);
+    lastPaintGdiCreations_ = gdiResources().stats().creations - creations;
+    EndPaint(hwnd_, &ps);
+}
 
-    oldFont = (HFONT)SelectObject(hDC, font_);
-
-    GetClientRect(hwnd_,&rc);
-    SetTextColor(hDC, GetSysColor(COLOR_WINDOWTEXT));
-    SetBkColor(hDC, GetSysColor(COLOR_WINDOW));
-
-    // paint window background and border
-    // draw a flat black border in Windows 8 app immersive mode
-    // draw a 3d border in desktop mode
-    if(isImmersive()) {
-        HPEN pen = ::CreatePen(PS_SOLID, 3, RGB(0, 0, 0));
-        HGDIOBJ oldPen = ::SelectObject(hDC, pen);
-        ::Rectangle(hDC, rc.left, rc.top, rc.right, rc.bottom);
-        ::SelectObject(hDC, oldPen);
-        ::DeleteObject(pen);
-    }
-    else {
-        // draw a 3d border in desktop mode
-        ::FillSolidRect(ps.hdc, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top, GetSysColor(COLOR_WINDOW));
-        ::Draw3DBorder(hDC, &rc, GetSysColor(COLOR_3DFACE), 0);
-    }
-
-    // paint items
-    int col = 0;
-    int x = margin_, y = margin_;
-    for(int i = 0, n = items_.size(); i < n; ++i) {
-        paintItem(hDC, i, x, y);
-        ++col; // go to next column
-        if(col >= candPerRow_) {
-            col = 0;
-            x = margin_;
-            y += itemHeight_ + rowSpacing_;
-        }
-        else {
-            x += colSpacing_ + selKeyWidth_ + textWidth_;
-        }
+// invalidate the items which look different from what is in the back buffer.
+void CandidateWindow::invalidateChangedItems() {
+    if(!isVisible())
+        return;
+    PaintRect dirty = painter_.dirtyRect(list_, useCursor_);
+    if(!dirty.isEmpty()) {
+        RECT rect = {dirty.left, dirty.top, dirty.right, dirty.bottom};
+        ::InvalidateRect(hwnd_, &rect, FALSE);
     }
-    SelectObject(hDC, oldFont);
-    EndPaint(hwnd_, &ps);
 }
 
 void CandidateWindow::recalculateSize() {
-    if(items_.empty()) {
+    // only items on the current page are measured
+    int itemCount = list_.currentPageSize();
+    if(itemCount == 0) {
         resize(margin_ * 2, margin_ * 2);
+        painter_.setLayout(CandidateLayout{margin_ * 2, margin_ * 2, margin_, rowSpacing_, colSpacing_, 0, 0, 0, list_.candPerRow()});
+        return;
     }
 
-    HDC hDC = ::GetWindowDC(hwnd());
     int height = 0;
     int width = 0;
     selKeyWidth_ = 0;
     textWidth_ = 0;
     itemHeight_ = 0;
 
-    HGDIOBJ oldFont = ::SelectObject(hDC, font_);
-    vector<wstring>::const_iterator it;
-    for(int i = 0, n = items_.size(); i < n; ++i) {
-        SIZE selKeySize;
-        int lineHeight = 0;
+    // most of the strings were already measured a keystroke earlier,
+    // so the extent cache can usually answer without touching GDI.
+    WindowTextMeasurer measurer(hwnd_, font_);
+    for(int slot = 0; slot < itemCount; ++slot) {
         // the selection key string
         wchar_t selKey[] = L"?. ";
-        selKey[0] = selKeys_[i];
-        ::GetTextExtentPoint32W(hDC, selKey, 3, &selKeySize);
-        if(selKeySize.cx > selKeyWidth_)
-            selKeyWidth_ = selKeySize.cx;
+        selKey[0] = list_.selKey(slot) ? list_.selKey(slot) : L' ';
+        TextExtent selKeySize = extentCache_.extent(selKey, 3, measurer);
+        if(selKeySize.width > selKeyWidth_)
+            selKeyWidth_ = selKeySize.width;
 
         // the candidate string
-        SIZE candidateSize;
-        wstring& item = items_.at(i);
-        ::GetTextExtentPoint32W(hDC, item.c_str(), item.length(), &candidateSize);
-        if(candidateSize.cx > textWidth_)
-            textWidth_ = candidateSize.cx;
-        int itemHeight = max(candidateSize.cy, selKeySize.cy);
+        wstring_view item = list_.pageItem(slot);
+        TextExtent candidateSize = extentCache_.extent(item.data(), item.length(), list_.pageItemHash(slot), measurer);
+        if(candidateSize.width > textWidth_)
+            textWidth_ = candidateSize.width;
+        int itemHeight = max(candidateSize.height, selKeySize.height);
         if(itemHeight > itemHeight_)
             itemHeight_ = itemHeight;
     }
-    ::SelectObject(hDC, oldFont);
-    ::ReleaseDC(hwnd(), hDC);
 
-    if(items_.size() <= candPerRow_) {
-        width = items_.size() * (selKeyWidth_ + textWidth_);
-        width += colSpacing_ * (items_.size() - 1);
+    int candPerRow = list_.candPerRow();
+    if(itemCount <= candPerRow) {
+        width = itemCount * (selKeyWidth_ + textWidth_);
+        width += colSpacing_ * (itemCount - 1);
         width += margin_ * 2;
         height = itemHeight_ + margin_ * 2;
     }
     else {
-        width = candPerRow_ * (selKeyWidth_ + textWidth_);
-        width += colSpacing_ * (candPerRow_ - 1);
+        width = candPerRow * (selKeyWidth_ + textWidth_);
+        width += colSpacing_ * (candPerRow - 1);
         width += margin_ * 2;
-        int rowCount = items_.size() / candPerRow_;
-        if(items_.size() % candPerRow_)
+        int rowCount = itemCount / candPerRow;
+        if(itemCount % candPerRow)
             ++rowCount;
         height = itemHeight_ * rowCount + rowSpacing_ * (rowCount - 1) + margin_ * 2;
     }
     resize(width, height);
+    painter_.setLayout(CandidateLayout{width, height, margin_, rowSpacing_, colSpacing_,
+        selKeyWidth_, textWidth_, itemHeight_, candPerRow});
 }
 
 void CandidateWindow::setCandPerRow(int n) {
-    if(n != candPerRow_) {
-        candPerRow_ = n;
-        recalculateSize();
+    if(n != list_.candPerRow()) {
+        list_.setCandPerRow(n);
+        scheduleUpdate(UPDATE_LAYOUT);
+    }
+}
+
+void CandidateWindow::setRowsPerPage(int n) {
+    if(n != list_.rowsPerPage()) {
+        list_.setRowsPerPage(n);
+        scheduleUpdate(UPDATE_LAYOUT);
     }
 }
 
+void CandidateWindow::setCurrentPage(int page) {
+    if(list_.setCurrentPage(page))
+        onPageChanged();
+}
+
+// the window shows another page now, measure and paint it.
+void CandidateWindow::onPageChanged() {
+    scheduleUpdate(UPDATE_LAYOUT);
+}
+
+// virtual
+void CandidateWindow::runPaint() {
+    invalidateChangedItems();
+    updateUIElement();
+}
+
 bool CandidateWindow::filterKeyEvent(KeyEvent& keyEvent) {
-    // select item with arrow keys
-    int oldSel = currentSel_;
+    // select item with arrow keys, flip pages with page up/down keys.
+    int oldPage = list_.currentPage();
+    bool changed = false;
     switch(keyEvent.keyCode()) {
     case VK_UP:
-        if(currentSel_ - candPerRow_ >=0)
-            currentSel_ -= candPerRow_;
+        changed = list_.moveUp();
         break;
     case VK_DOWN:
-        if(currentSel_ + candPerRow_ < items_.size())
-            currentSel_ += candPerRow_;
+        changed = list_.moveDown();
         break;
     case VK_LEFT:
-        if(currentSel_ - 1 >=0)
-            --currentSel_;
+        changed = list_.moveLeft();
         break;
     case VK_RIGHT:
-        if(currentSel_ + 1 < items_.size())
-            ++currentSel_;
+        changed = list_.moveRight();
+        break;
+    case VK_PRIOR:
+        changed = list_.prevPage();
+        break;
+    case VK_NEXT:
+        changed = list_.nextPage();
         break;
     case VK_RETURN:
         hasResult_ = true;
@@ -323,79 +382,94 @@ bool CandidateWindow::filterKeyEvent(KeyEvent& keyEvent) {
     default:
         return false;
     }
-    // if currently selected item is changed, redraw
-    if(currentSel_ != oldSel) {
-        // repaint the old and new items
-        RECT rect;
-        itemRect(oldSel, rect);
-        ::InvalidateRect(hwnd_, &rect, TRUE);
-        itemRect(currentSel_, rect);
-        ::InvalidateRect(hwnd_, &rect, TRUE);
-        return true;
+    if(!changed)
+        return false;
+
+    if(list_.currentPage() != oldPage) {
+        onPageChanged();
     }
-    return false;
+    else {
+        // only the old and new selected items are repainted
+        scheduleUpdate(UPDATE_PAINT);
+    }
+    return true;
 }
 
 void CandidateWindow::setCurrentSel(int sel) {
-    if(sel >= items_.size())
-        sel = 0;
-    if (currentSel_ != sel) {
-        currentSel_ = sel;
-        if (isVisible())
-            ::InvalidateRect(hwnd_, NULL, TRUE);
+    int oldPage = list_.currentPage();
+    if (list_.setCurrentSel(sel)) {
+        if (list_.currentPage() != oldPage)
+            onPageChanged();
+        else
+            scheduleUpdate(UPDATE_PAINT);
     }
 }
 
-void CandidateWindow::clear() {
-    items_.clear();
-    selKeys_.clear();
-    currentSel_ = 0;
-    hasResult_ = false;
+int CandidateWindow::filter(std::wstring_view prefix) {
+    int n = list_.filter(prefix);
+    // the surviving items were mostly measured before, so the extent cache
+    // answers without GDI, and if the layout stays the same only the items
+    // which moved are repainted.
+    scheduleUpdate(UPDATE_LAYOUT);
+    return n;
 }
 
-void CandidateWindow::setUseCursor(bool use) {
-    useCursor_ = use;
-    if(isVisible())
-        ::InvalidateRect(hwnd_, NULL, TRUE);
-}
-
-void CandidateWindow::paintItem(HDC hDC, int i,  int x, int y) {
-    RECT textRect = {x, y, 0, y + itemHeight_};
-    wchar_t selKey[] = L"?. ";
-    selKey[0] = selKeys_[i];
-    textRect.right = textRect.left + selKeyWidth_;
-    // FIXME: make the color of strings configurable.
-    COLORREF selKeyColor = RGB(0, 0, 255);
-    COLORREF oldColor = ::SetTextColor(hDC, selKeyColor);
-    // paint the selection key
-    ::ExtTextOut(hDC, textRect.left, textRect.top, ETO_OPAQUE, &textRect, selKey, 3, NULL);
-    ::SetTextColor(hDC, oldColor); // restore text color
-
-    // paint the candidate string
-    wstring& item = items_.at(i);
-    textRect.left += selKeyWidth_;
-    textRect.right = textRect.left + textWidth_;
-    // paint the candidate string
-    ::ExtTextOut(hDC, textRect.left, textRect.top, ETO_OPAQUE, &textRect, item.c_str(), item.length(), NULL);
-
-    if(useCursor_ && i == currentSel_) { // invert the selected item
-        int left = textRect.left; // - selKeyWidth_;
-        int top = textRect.top;
-        int width = textRect.right - left;
-        int height = itemHeight_;
-        ::BitBlt(hDC, left, top, width, itemHeight_, hDC, left, top, NOTSRCCOPY);
+void CandidateWindow::updateUIElement() {
+    if(!textService_ || !textService_->isActivated())
+        return;
+    auto uiElementMgr = textService_->threadMgr().query<ITfUIElementMgr>();
+    if(!uiElementMgr)
+        return;
+    // the document manager is only compared, not kept
+    ComPtr<ITfDocumentMgr> documentMgr;
+    if(auto context = textService_->currentContext())
+        context->GetDocumentMgr(&documentMgr);
+    TsfUIElementHost host(uiElementMgr, static_cast<ITfCandidateListUIElement*>(this));
+    bool begun = uiState_.isBegun();
+    uiState_.sync(list_, static_cast<ITfDocumentMgr*>(documentMgr), host);
+    if(!begun && uiState_.isBegun())
+        textService_->addUIElementWindow(this);
+    if(!uiState_.shouldShow() && isVisible()) // the application draws the candidates itself
+        Window::hide();
+}
+
+void CandidateWindow::endUIElement() {
+    if(!uiState_.isBegun() || !textService_)
+        return;
+    textService_->removeUIElementWindow(this);
+    if(!textService_->isActivated())
+        return;
+    if(auto uiElementMgr = textService_->threadMgr().query<ITfUIElementMgr>()) {
+        // EndUIElement() releases the reference held by TSF, which may be the last one
+        ComPtr<CandidateWindow> self(this);
+        TsfUIElementHost host(uiElementMgr, static_cast<ITfCandidateListUIElement*>(this));
+        uiState_.end(host);
     }
 }
 
-void CandidateWindow::itemRect(int i, RECT& rect) {
-    int row, col;
-    row = i / candPerRow_;
-    col = i % candPerRow_;
-    rect.left = margin_ + col * (selKeyWidth_ + textWidth_ + colSpacing_);
-    rect.top = margin_ + row * (itemHeight_ + rowSpacing_);
-    rect.right = rect.left + (selKeyWidth_ + textWidth_);
-    rect.bottom = rect.top + itemHeight_;
+void CandidateWindow::show() {
+    // the pending update begins the UI element, which tells if the
+    // application draws the candidates itself
+    updateNow();
+    updateUIElement();
+    if(uiState_.shouldShow())
+        Window::show();
+}
+
+void CandidateWindow::hide() {
+    Window::hide();
+    endUIElement();
 }
 
+void CandidateWindow::clear() {
+    list_.clear();
+    hasResult_ = false;
+    endUIElement();
+}
+
+void CandidateWindow::setUseCursor(bool use) {
+    useCursor_ = use;
+    scheduleUpdate(UPDATE_PAINT);
+}
 
 } // namespace Ime
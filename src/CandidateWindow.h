@@ -21,6 +21,10 @@
 #define IME_CANDIDATE_WINDOW_H
 
 #include "ImeWindow.h"
+#include "CandidateList.h"
+#include "CandidatePainter.h"
+#include "CandidateUIState.h"
+#include "GdiPaintBackend.h"
 #include <string>
 #include <vector>
 #include "ComObject.h"
@@ -54,40 +58,117 @@ public:
     STDMETHODIMP SetPageIndex(UINT *puIndex, UINT uPageCnt);
     STDMETHODIMP GetCurrentPage(UINT *puPage);
 
-    const std::vector<std::wstring>& items() const {
-        return items_;
+    // number of candidates known so far
+    int count() const {
+        return list_.count();
     }
 
-    void setItems(const std::vector<std::wstring>& items, const std::vector<wchar_t>& sekKeys) {
-        items_ = items;
-        selKeys_ = selKeys_;
-        recalculateSize();
-        refresh();
+    // the i-th candidate of the whole list
+    std::wstring item(int i) const {
+        return list_.item(i);
+    }
+
+    // Deprecated, use count() and item(i): this copies all the candidates
+    // known so far, candidates of on-demand sources are not fetched.
+    std::vector<std::wstring> items() const {
+        std::vector<std::wstring> result;
+        result.reserve(count());
+        for(int i = 0; i < count(); ++i)
+            result.push_back(item(i));
+        return result;
+    }
+
+    void setItems(const std::vector<std::wstring>& items, const std::vector<wchar_t>& selKeys) {
+        setItems(std::vector<std::wstring>(items), selKeys);
+    }
+
+    // the items are moved in to avoid copying a long list
+    void setItems(std::vector<std::wstring>&& items, const std::vector<wchar_t>& selKeys) {
+        list_.setItems(std::move(items));
+        list_.setSelKeys(selKeys);
+        scheduleUpdate(UPDATE_LAYOUT);
+    }
+
+    // Bulk API for engines: the arena is moved in, and can be taken back
+    // with recycleItems() to reuse its memory for the next list.
+    void setItems(CandidateArena&& items, const std::vector<wchar_t>& selKeys) {
+        list_.setItems(std::move(items));
+        list_.setSelKeys(selKeys);
+        scheduleUpdate(UPDATE_LAYOUT);
+    }
+
+    CandidateArena recycleItems() {
+        return list_.recycleItems();
+    }
+
+    // candidates are pulled from the source when their page is shown.
+    void setSource(std::shared_ptr<CandidateSource> source, const std::vector<wchar_t>& selKeys) {
+        list_.setSource(std::move(source));
+        list_.setSelKeys(selKeys);
+        scheduleUpdate(UPDATE_LAYOUT);
     }
 
     void add(std::wstring item, wchar_t selKey) {
-        items_.push_back(item);
-        selKeys_.push_back(selKey);
+        list_.add(std::move(item), selKey);
     }
 
     void clear();
 
+    // type-to-filter: keep only the candidates whose annotation (reading),
+    // or text if they have none, starts with the prefix. See CandidateList::filter().
+    int filter(std::wstring_view prefix);
+
+    // Tell the application which parts of the candidate list changed
+    // (BeginUIElement() the first time, UpdateUIElement() afterwards).
+    // Nothing is sent if nothing changed since the last call.
+    // Call this after adding items with add().
+    void updateUIElement();
+
+    // The candidate list is closed. TSF keeps a reference to the window until
+    // then, so this is done by hide(), clear() and when the composition ends,
+    // not by the destructor.
+    void endUIElement();
+
+    // the window is not shown if the application draws the candidates itself (UI-less mode).
+    // These override Window::show() and hide(), so calling them through a base class
+    // pointer keeps the UI element in sync too.
+    void show() override;
+
+    // hide the window and end the UI element.
+    void hide() override;
+
+    // the page model of the candidate list
+    const CandidateList& list() const {
+        return list_;
+    }
+
     int candPerRow() const {
-        return candPerRow_;
+        return list_.candPerRow();
     }
     void setCandPerRow(int n);
 
+    int rowsPerPage() const {
+        return list_.rowsPerPage();
+    }
+    void setRowsPerPage(int n);
+
+    int currentPage() const {
+        return list_.currentPage();
+    }
+    void setCurrentPage(int page);
+
     virtual void recalculateSize();
 
     bool filterKeyEvent(KeyEvent& keyEvent);
 
+    // index of the selected item in the whole list
     int currentSel() const {
-        return currentSel_;
+        return list_.currentSel();
     }
     void setCurrentSel(int sel);
 
     wchar_t currentSelKey() const {
-        return selKeys_.at(currentSel_);
+        return list_.selKey(list_.currentSlot());
     }
 
     bool hasResult() const {
@@ -103,8 +184,10 @@ public:
 protected:
     LRESULT wndProc(UINT msg, WPARAM wp , LPARAM lp);
     void onPaint(WPARAM wp, LPARAM lp);
-    void paintItem(HDC hDC, int i, int x, int y);
-    void itemRect(int i, RECT& rect);
+    void invalidateChangedItems();
+    // invalidate the changed items and tell the application about the changes
+    void runPaint() override;
+    void onPageChanged();
 
 protected: // COM object should not be deleted directly. calling Release() instead.
     ~CandidateWindow(void);
@@ -115,12 +198,12 @@ private:
     int selKeyWidth_;
     int textWidth_;
     int itemHeight_;
-    int candPerRow_;
     int colSpacing_;
     int rowSpacing_;
-    std::vector<wchar_t> selKeys_;
-    std::vector<std::wstring> items_;
-    int currentSel_;
+    CandidateList list_;
+    CandidatePainter painter_;
+    BackBuffer backBuffer_;
+    CandidateUIState uiState_;
     bool hasResult_;
     bool useCursor_;
 };
@@ -0,0 +1,367 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "ChineseConverter.h"
+#include "Utf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Ime {
+
+static const char tableMagic[8] = {'I', 'M', 'E', 'Z', 'H', 'C', 'V', '\0'};
+static const size_t pageIndexSize = 256;
+static const size_t pageSize = ChineseConverter::pageSize;
+static const uint16_t MAPPED_IN_EXTRAS = 0xffff;
+// 1M bits, a few % of false positives with 50000 phrases
+static const uint32_t pairFilterWords = (1 << 20) / 32;
+
+static bool isHighSurrogate(char16_t c) {
+    return c >= 0xd800 && c <= 0xdbff;
+}
+
+static bool isLowSurrogate(char16_t c) {
+    return c >= 0xdc00 && c <= 0xdfff;
+}
+
+// the length of a single code point, or 0 if str is not one
+static size_t codePointLength(std::u16string_view str) {
+    if(str.size() == 1 && !isHighSurrogate(str[0]) && !isLowSurrogate(str[0]))
+        return 1;
+    if(str.size() == 2 && isHighSurrogate(str[0]) && isLowSurrogate(str[1]))
+        return 2;
+    return 0;
+}
+
+ChineseConverter::ChineseConverter():
+    header_(nullptr),
+    pageIndex_(nullptr),
+    pages_(nullptr),
+    extras_(nullptr),
+    phrasePageIndex_(nullptr),
+    phrasePages_(nullptr),
+    phrases_(nullptr),
+    pool_(nullptr) {
+}
+
+bool ChineseConverter::attach(std::string_view table) {
+    header_ = nullptr;
+    auto data = reinterpret_cast<const unsigned char*>(table.data());
+    if(table.size() < sizeof(ChineseConversionHeader) || reinterpret_cast<uintptr_t>(data) % 4 != 0)
+        return false;
+    auto header = reinterpret_cast<const ChineseConversionHeader*>(data);
+    if(memcmp(header->magic, tableMagic, sizeof(tableMagic)) != 0 || header->version != VERSION)
+        return false;
+
+    uint64_t pageIndexOffset = sizeof(ChineseConversionHeader);
+    uint64_t pagesOffset = pageIndexOffset + pageIndexSize * sizeof(uint16_t);
+    uint64_t extrasOffset = pagesOffset + uint64_t(header->pageCount) * pageSize * sizeof(uint16_t);
+    uint64_t phrasePageIndexOffset = extrasOffset + uint64_t(header->extraCount) * sizeof(ChineseConversionEntry);
+    uint64_t phrasePagesOffset = phrasePageIndexOffset + pageIndexSize * sizeof(uint16_t);
+    uint64_t pairFilterOffset = phrasePagesOffset + uint64_t(header->phrasePageCount) * (pageSize + 1) * sizeof(uint32_t);
+    uint64_t phrasesOffset = pairFilterOffset + uint64_t(header->pairFilterWords) * sizeof(uint32_t);
+    uint64_t poolOffset = phrasesOffset + uint64_t(header->phraseCount) * sizeof(ChineseConversionEntry);
+    uint64_t end = poolOffset + uint64_t(header->poolLength) * sizeof(char16_t);
+    if(header->pageCount > pageIndexSize || header->phrasePageCount > pageIndexSize || end > table.size()
+        || header->pairFilterWords == 0 || (header->pairFilterWords & (header->pairFilterWords - 1)) != 0)
+        return false;
+
+    auto pageIndex = reinterpret_cast<const uint16_t*>(data + pageIndexOffset);
+    auto phrasePageIndex = reinterpret_cast<const uint16_t*>(data + phrasePageIndexOffset);
+    for(size_t i = 0; i < pageIndexSize; ++i) {
+        if(pageIndex[i] > header->pageCount || phrasePageIndex[i] > header->phrasePageCount)
+            return false;
+    }
+    auto phrasePages = reinterpret_cast<const uint32_t*>(data + phrasePagesOffset);
+    for(size_t i = 0; i < header->phrasePageCount * (pageSize + 1); ++i) {
+        if(phrasePages[i] > header->phraseCount)
+            return false;
+    }
+    // the entries must point into the pool
+    auto validEntries = [header](const ChineseConversionEntry* entries, size_t count) {
+        for(size_t i = 0; i < count; ++i) {
+            const auto& entry = entries[i];
+            if(entry.keyLength == 0 || uint64_t(entry.keyOffset) + entry.keyLength > header->poolLength
+                || uint64_t(entry.valueOffset) + entry.valueLength > header->poolLength
+                || entry.keyLength > header->maxPhraseLength)
+                return false;
+        }
+        return true;
+    };
+    auto extras = reinterpret_cast<const ChineseConversionEntry*>(data + extrasOffset);
+    auto phrases = reinterpret_cast<const ChineseConversionEntry*>(data + phrasesOffset);
+    if(!validEntries(extras, header->extraCount) || !validEntries(phrases, header->phraseCount))
+        return false;
+
+    header_ = header;
+    pageIndex_ = pageIndex;
+    pages_ = reinterpret_cast<const uint16_t*>(data + pagesOffset);
+    extras_ = extras;
+    phrasePageIndex_ = phrasePageIndex;
+    phrasePages_ = phrasePages;
+    pairFilter_ = reinterpret_cast<const uint32_t*>(data + pairFilterOffset);
+    pairFilterMask_ = header->pairFilterWords * 32 - 1;
+    phrases_ = phrases;
+    pool_ = reinterpret_cast<const char16_t*>(data + poolOffset);
+    return true;
+}
+
+ChineseConverter::Result ChineseConverter::convert(std::u16string_view in, char16_t* out, size_t outSize) const {
+    size_t n = in.size();
+    size_t i = 0;
+    size_t o = 0;
+    if(!header_) {  // no table, nothing to convert
+        size_t count = std::min(n, outSize);
+        std::copy(in.data(), in.data() + count, out);
+        return Result{count, count};
+    }
+
+    while(i < n) {
+        char16_t c = in[i];
+        if(i + 1 < n && mayStartPhrase(c, in[i + 1])) {
+            if(auto phrase = longestPhrase(in.data() + i, n - i)) {
+                if(outSize - o < phrase->valueLength)
+                    break;
+                auto text = value(*phrase);
+                std::copy(text.begin(), text.end(), out + o);
+                o += text.size();
+                i += phrase->keyLength;
+                continue;
+            }
+        }
+
+        size_t length = 1;
+        if(isHighSurrogate(c) && i + 1 < n && isLowSurrogate(in[i + 1])) {
+            length = 2;
+        }
+        else {
+            uint16_t page = pageIndex_[c >> 8];
+            uint16_t mapped = page ? pages_[(page - 1) * pageSize + (c & 0xff)] : 0;
+            if(mapped != MAPPED_IN_EXTRAS) {
+                if(o == outSize)
+                    break;
+                out[o++] = mapped ? char16_t(mapped) : c;
+                ++i;
+                continue;
+            }
+        }
+
+        auto extra = header_->extraCount ? findExtra(in.substr(i, length)) : nullptr;
+        auto text = extra ? value(*extra) : in.substr(i, length);
+        if(outSize - o < text.size())
+            break;
+        std::copy(text.begin(), text.end(), out + o);
+        o += text.size();
+        i += length;
+    }
+    return Result{i, o};
+}
+
+void ChineseConverter::convert(std::u16string_view in, std::u16string& out) const {
+    out.resize(in.size());
+    size_t read = 0;
+    size_t written = 0;
+    for(;;) {
+        Result result = convert(in.substr(read), &out[0] + written, out.size() - written);
+        read += result.read;
+        written += result.written;
+        if(read == in.size())
+            break;
+        // some chars are converted to longer strings
+        out.resize(out.size() * 2 + 16);
+    }
+    out.resize(written);
+}
+
+const ChineseConversionEntry* ChineseConverter::findExtra(std::u16string_view str) const {
+    auto end = extras_ + header_->extraCount;
+    auto it = std::lower_bound(extras_, end, str, [this](const ChineseConversionEntry& entry, std::u16string_view str) {
+        return key(entry) < str;
+    });
+    return it != end && key(*it) == str ? it : nullptr;
+}
+
+// The phrases are sorted, so the ones starting with the same k chars are next to each other.
+// The range is narrowed one char at a time like walking down a trie, and the shortest
+// phrase of a range, which is sorted first, is a match if its length is k.
+const ChineseConversionEntry* ChineseConverter::longestPhrase(const char16_t* in, size_t length) const {
+    const uint32_t* range = phraseRange(in[0]);
+    if(!range || range[0] == range[1])
+        return nullptr;
+    const ChineseConversionEntry* first = phrases_ + range[0];
+    const ChineseConversionEntry* last = phrases_ + range[1];
+    const ChineseConversionEntry* match = nullptr;
+    length = std::min(length, size_t(header_->maxPhraseLength));
+    for(size_t k = 1; k < length; ++k) {
+        // the k-th char of the key, or -1 if the key is shorter
+        auto charAt = [this, k](const ChineseConversionEntry& entry) {
+            return entry.keyLength > k ? int(pool_[entry.keyOffset + k]) : -1;
+        };
+        int c = in[k];
+        if(last - first <= 8) {
+            // a linear scan is faster for the few phrases left
+            while(first != last && charAt(*first) < c)
+                ++first;
+            auto end = first;
+            while(end != last && charAt(*end) == c)
+                ++end;
+            last = end;
+        }
+        else {
+            first = std::lower_bound(first, last, c, [&](const ChineseConversionEntry& entry, int c) {
+                return charAt(entry) < c;
+            });
+            last = std::upper_bound(first, last, c, [&](int c, const ChineseConversionEntry& entry) {
+                return c < charAt(entry);
+            });
+        }
+        if(first == last)
+            break;
+        if(first->keyLength == k + 1)
+            match = first;
+    }
+    return match;
+}
+
+void ChineseConversionTableBuilder::add(std::u16string_view from, std::u16string_view to) {
+    if(!from.empty())
+        mappings_[std::u16string(from)] = std::u16string(to);
+}
+
+bool ChineseConversionTableBuilder::addText(std::string_view text) {
+    bool success = true;
+    std::u16string from;
+    std::u16string to;
+    while(!text.empty()) {
+        size_t lineEnd = text.find('\n');
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+        if(!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if(line.empty() || line[0] == '#')
+            continue;
+        size_t tab = line.find('\t');
+        if(tab == std::string_view::npos) {
+            success = false;
+            continue;
+        }
+        std::string_view value = line.substr(tab + 1);
+        value = value.substr(0, value.find(' '));
+        if(!utf8ToUtf16(line.substr(0, tab), from) || !utf8ToUtf16(value, to) || from.empty()) {
+            success = false;
+            continue;
+        }
+        add(from, to);
+    }
+    return success;
+}
+
+std::string ChineseConversionTableBuilder::build() const {
+    std::vector<uint16_t> pageIndex(pageIndexSize, 0);
+    std::vector<uint16_t> pages;
+    std::vector<ChineseConversionEntry> extras;
+    std::vector<uint16_t> phrasePageIndex(pageIndexSize, 0);
+    std::vector<uint32_t> phrasePages;
+    std::vector<uint32_t> pairFilter(pairFilterWords, 0);
+    std::vector<ChineseConversionEntry> phrases;
+    std::u16string pool;
+    uint32_t maxPhraseLength = 0;
+
+    auto makeEntry = [&pool](const std::u16string& key, const std::u16string& value) {
+        ChineseConversionEntry entry{uint32_t(pool.size()), 0, uint16_t(key.size()), uint16_t(value.size())};
+        pool += key;
+        entry.valueOffset = uint32_t(pool.size());
+        pool += value;
+        return entry;
+    };
+
+    // the slot of a BMP char, pages are added on demand
+    auto pageSlot = [&pageIndex, &pages](char16_t c) -> uint16_t& {
+        uint16_t& page = pageIndex[c >> 8];
+        if(!page) {
+            pages.resize(pages.size() + pageSize, 0);
+            page = uint16_t(pages.size() / pageSize);
+        }
+        return pages[(page - 1) * pageSize + (c & 0xff)];
+    };
+
+    // the map is sorted by UTF-16 units, which is the order the converter searches in
+    for(const auto& mapping: mappings_) {
+        const std::u16string& key = mapping.first;
+        const std::u16string& value = mapping.second;
+        maxPhraseLength = std::max(maxPhraseLength, uint32_t(key.size()));
+        size_t length = codePointLength(key);
+        if(length == 1 && value.size() == 1 && value[0] != 0 && value[0] != MAPPED_IN_EXTRAS) {
+            pageSlot(key[0]) = value[0];
+        }
+        else if(length != 0) {
+            if(length == 1)
+                pageSlot(key[0]) = MAPPED_IN_EXTRAS;
+            extras.push_back(makeEntry(key, value));
+        }
+        else {
+            phrases.push_back(makeEntry(key, value));
+        }
+    }
+
+    // ranges of the phrases with the same first char, which are next to each other
+    for(size_t i = 0; i < phrases.size(); ++i) {
+        char16_t c = pool[phrases[i].keyOffset];
+        uint16_t& page = phrasePageIndex[c >> 8];
+        if(!page) {
+            phrasePages.resize(phrasePages.size() + pageSize + 1, uint32_t(i));
+            page = uint16_t(phrasePages.size() / (pageSize + 1));
+        }
+        // the phrases starting with the chars after c in the page start after this one
+        uint32_t* ranges = &phrasePages[(page - 1) * (pageSize + 1)];
+        std::fill(ranges + (c & 0xff) + 1, ranges + pageSize + 1, uint32_t(i + 1));
+
+        uint32_t bit = (ChineseConverter::pairHash(c, pool[phrases[i].keyOffset + 1]) >> 7) & (pairFilterWords * 32 - 1);
+        pairFilter[bit >> 5] |= 1u << (bit & 31);
+    }
+
+    ChineseConversionHeader header;
+    memcpy(header.magic, tableMagic, sizeof(tableMagic));
+    header.version = ChineseConverter::VERSION;
+    header.pageCount = uint32_t(pages.size() / pageSize);
+    header.extraCount = uint32_t(extras.size());
+    header.phrasePageCount = uint32_t(phrasePages.size() / (pageSize + 1));
+    header.phraseCount = uint32_t(phrases.size());
+    header.maxPhraseLength = maxPhraseLength;
+    header.poolLength = uint32_t(pool.size());
+    header.pairFilterWords = pairFilterWords;
+
+    std::string table;
+    auto append = [&table](const void* data, size_t size) {
+        table.append(static_cast<const char*>(data), size);
+    };
+    append(&header, sizeof(header));
+    append(pageIndex.data(), pageIndex.size() * sizeof(uint16_t));
+    append(pages.data(), pages.size() * sizeof(uint16_t));
+    append(extras.data(), extras.size() * sizeof(ChineseConversionEntry));
+    append(phrasePageIndex.data(), phrasePageIndex.size() * sizeof(uint16_t));
+    append(phrasePages.data(), phrasePages.size() * sizeof(uint32_t));
+    append(pairFilter.data(), pairFilter.size() * sizeof(uint32_t));
+    append(phrases.data(), phrases.size() * sizeof(ChineseConversionEntry));
+    append(pool.data(), pool.size() * sizeof(char16_t));
+    return table;
+}
+
+} // namespace Ime
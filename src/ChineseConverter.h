@@ -0,0 +1,170 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_CHINESE_CONVERTER_H
+#define IME_CHINESE_CONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include "DictionaryFile.h"
+
+namespace Ime {
+
+// sections of a dictionary file holding conversion tables
+constexpr uint32_t TRAD_TO_SIMP_SECTION = dictionarySectionId("ZHTS");
+constexpr uint32_t SIMP_TO_TRAD_SECTION = dictionarySectionId("ZHST");
+
+// Layout of a compiled conversion table, little endian, used in place (e.g. mapped from a
+// dictionary file). All offsets are relative to the start of the table.
+//   header
+//   uint16_t pageIndex[256]      BMP chars: page of the high byte, 0 if nothing is mapped
+//   uint16_t pages[pageCount][256]  the mapped char, 0 if not mapped, 0xffff if it's in the extra table
+//   ChineseConversionEntry extras[]  other chars (non-BMP, or mapped to several UTF-16 units), sorted
+//   uint16_t phrasePageIndex[256]  same as pageIndex, for the first UTF-16 unit of the phrases
+//   uint32_t phrasePages[phrasePageCount][257]  the phrases starting with the i-th char of
+//                                the page are phrases[page[i], page[i + 1])
+//   uint32_t pairFilter[pairFilterWords]  bitmap of the hashes of the first 2 units of the phrases,
+//                                so most positions are rejected without looking at the phrases
+//   ChineseConversionEntry phrases[] sorted by key
+//   char16_t pool[]              keys and values of the entries
+struct ChineseConversionHeader {
+    char magic[8];  // "IMEZHCV\0"
+    uint32_t version;
+    uint32_t pageCount;
+    uint32_t extraCount;
+    uint32_t phrasePageCount;
+    uint32_t phraseCount;
+    uint32_t maxPhraseLength;  // in UTF-16 units
+    uint32_t poolLength;       // in UTF-16 units
+    uint32_t pairFilterWords;  // a power of 2
+};
+
+struct ChineseConversionEntry {
+    uint32_t keyOffset;    // in the pool, UTF-16 units
+    uint32_t valueOffset;
+    uint16_t keyLength;
+    uint16_t valueLength;
+};
+
+static_assert(sizeof(ChineseConversionHeader) == 40, "unexpected padding");
+static_assert(sizeof(ChineseConversionEntry) == 12, "unexpected padding");
+
+// Converts between Traditional and Simplified Chinese with a table, one table per direction.
+// At each position the longest phrase in the table is used, so one-to-many mappings such as
+// 发 (發 or 髮) are resolved by phrases (头发 -> 頭髮). Chars not in any phrase are mapped one by one.
+class ChineseConverter {
+public:
+    static const uint32_t VERSION = 1;
+    static const size_t pageSize = 256;
+
+    struct Result {
+        size_t read;     // UTF-16 units of the input converted
+        size_t written;  // UTF-16 units written
+    };
+
+    ChineseConverter();
+
+    // use a compiled table, which must outlive the converter. return false if it's invalid.
+    bool attach(std::string_view table);
+
+    bool isAttached() const {
+        return header_ != nullptr;
+    }
+
+    // Convert into a buffer given by the caller. Conversion stops before a char or phrase
+    // whose output does not fit, so result.read < in.size() means the buffer is full.
+    Result convert(std::u16string_view in, char16_t* out, size_t outSize) const;
+
+    // convert all the input and replace the content of out, whose memory is reused.
+    void convert(std::u16string_view in, std::u16string& out) const;
+
+    size_t phraseCount() const {
+        return header_ ? header_->phraseCount : 0;
+    }
+
+private:
+    friend class ChineseConversionTableBuilder;
+
+    const ChineseConversionEntry* findExtra(std::u16string_view str) const;
+    const ChineseConversionEntry* longestPhrase(const char16_t* in, size_t length) const;
+
+    static uint32_t pairHash(char16_t c0, char16_t c1) {
+        return (uint32_t(c0) * 0x9e3779b1u) ^ (uint32_t(c1) * 0x85ebca6bu);
+    }
+
+    bool mayStartPhrase(char16_t c0, char16_t c1) const {
+        uint32_t bit = (pairHash(c0, c1) >> 7) & pairFilterMask_;
+        return (pairFilter_[bit >> 5] >> (bit & 31)) & 1;
+    }
+
+    // the phrases starting with c
+    const uint32_t* phraseRange(char16_t c) const {
+        uint16_t page = phrasePageIndex_[c >> 8];
+        return page ? phrasePages_ + (page - 1) * (pageSize + 1) + (c & 0xff) : nullptr;
+    }
+
+    std::u16string_view key(const ChineseConversionEntry& entry) const {
+        return std::u16string_view(pool_ + entry.keyOffset, entry.keyLength);
+    }
+
+    std::u16string_view value(const ChineseConversionEntry& entry) const {
+        return std::u16string_view(pool_ + entry.valueOffset, entry.valueLength);
+    }
+
+private:
+    const ChineseConversionHeader* header_;
+    const uint16_t* pageIndex_;
+    const uint16_t* pages_;
+    const ChineseConversionEntry* extras_;
+    const uint16_t* phrasePageIndex_;
+    const uint32_t* phrasePages_;
+    const uint32_t* pairFilter_;
+    uint32_t pairFilterMask_;  // of the bit index
+    const ChineseConversionEntry* phrases_;
+    const char16_t* pool_;
+};
+
+// Compiles a conversion table for ChineseConverter.
+class ChineseConversionTableBuilder {
+public:
+    // a mapping of a single code point is a char, longer ones are phrases.
+    // Adding the same key again replaces the mapping.
+    void add(std::u16string_view from, std::u16string_view to);
+
+    // Lines of "from<TAB>to" in UTF-8, the format of the OpenCC dictionaries.
+    // If there are several values separated by spaces, the first one is used.
+    // return false if there's an invalid line.
+    bool addText(std::string_view text);
+
+    size_t size() const {
+        return mappings_.size();
+    }
+
+    std::string build() const;
+
+private:
+    std::map<std::u16string, std::u16string> mappings_;
+};
+
+}
+
+#endif
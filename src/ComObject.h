@@ -20,6 +20,7 @@
 #pragma once
 
 #include <Unknwn.h>
+#include <atomic>
 #include <cassert>
 
 namespace Ime {
@@ -74,6 +75,8 @@ public:
         return E_NOINTERFACE;
     }
 
+    // the reference count is atomic since COM objects such as display attributes
+    // are shared by the text services of different threads.
     STDMETHODIMP_(ULONG) AddRef() {
         return ++refCount_;
     }
@@ -81,7 +84,7 @@ public:
     STDMETHODIMP_(ULONG) Release() {
         assert(refCount_ > 0);
         const ULONG newCount = --refCount_;
-        if (0 == refCount_) {
+        if (0 == newCount) {
             delete this;
         }
         return newCount;
@@ -100,7 +103,7 @@ private:
     }
 
 private:
-    int refCount_;
+    std::atomic<int> refCount_;
 };
 
 } // namespace Ime
@@ -0,0 +1,256 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CompletionIndex.h"
+#include <algorithm>
+
+namespace Ime {
+
+static std::wstring toWide(std::u16string_view str) {
+    return std::wstring(str.begin(), str.end());
+}
+
+static void appendTo(CandidateArena& arena, std::u16string_view str) {
+#ifdef _WIN32
+    // wchar_t is UTF-16 on Windows, the text of the dictionary is used in place
+    arena.append(std::wstring_view(reinterpret_cast<const wchar_t*>(str.data()), str.size()));
+#else
+    arena.append(toWide(str));
+#endif
+}
+
+CompletionIndex::CompletionIndex():
+    lexicon_(nullptr),
+    nodes_(nullptr) {
+}
+
+bool CompletionIndex::attach(const DictionaryFile& file, const Lexicon& lexicon) {
+    lexicon_ = nullptr;
+    nodes_ = nullptr;
+    std::string_view section = file.section(LEXICON_COMPLETION_SECTION);
+    if(!lexicon.isAttached() || section.size() != lexicon.readings().unitCount() * sizeof(CompletionNode))
+        return false;
+    if(reinterpret_cast<uintptr_t>(section.data()) % alignof(CompletionNode))
+        return false;
+    lexicon_ = &lexicon;
+    nodes_ = reinterpret_cast<const CompletionNode*>(section.data());
+    return true;
+}
+
+uint32_t CompletionIndex::readingIndex(uint32_t unit) const {
+    const DoubleArrayTrie& readings = trie();
+    uint32_t parent = readings.units_[unit].check;
+    if(parent >= readings.header_->unitCount)
+        return DoubleArrayTrie::NOT_FOUND;
+    if(unit == readings.units_[parent].base)  // code 0, the end of a key
+        return readings.units_[unit].base;
+    DoubleArrayTrie::Tail rest;
+    if(readings.isLeaf(unit) && readings.tail(unit, rest))
+        return rest.value;
+    return DoubleArrayTrie::NOT_FOUND;
+}
+
+std::u16string CompletionIndex::reading(const Completion& completion) const {
+    const DoubleArrayTrie& readings = trie();
+    std::u16string key;
+    DoubleArrayTrie::Tail rest;
+    bool leaf = readings.isLeaf(completion.unit) && readings.tail(completion.unit, rest);
+    // walk up to the root, the keys are not longer than maxKeyLength
+    uint32_t t = completion.unit;
+    for(size_t depth = 0; t != 0; ++depth) {
+        uint32_t parent = readings.units_[t].check;
+        if(parent >= readings.header_->unitCount || depth > readings.header_->maxKeyLength)
+            return std::u16string();
+        uint32_t code = t - readings.units_[parent].base;
+        if(code > readings.header_->codeCount)
+            return std::u16string();
+        if(code)
+            key.push_back(char16_t(readings.labels_[code]));
+        t = parent;
+    }
+    std::reverse(key.begin(), key.end());
+    if(leaf)
+        key.append(rest.rest.data(), rest.rest.size());
+    return key;
+}
+
+std::vector<Completion> CompletionIndex::complete(std::u16string_view prefix, size_t maxResults) const {
+    std::vector<Completion> results;
+    CompletionSearch search(*this, prefix);
+    Completion completion;
+    while(results.size() < maxResults && search.next(completion))
+        results.push_back(completion);
+    return results;
+}
+
+// static
+uint32_t CompletionIndex::fill(const DoubleArrayTrie& readings, const std::vector<uint32_t>& bestFrequencies,
+    uint32_t s, size_t depth, std::vector<CompletionNode>& nodes) {
+    auto best = [&bestFrequencies](uint32_t readingIndex) {
+        return readingIndex < bestFrequencies.size() ? bestFrequencies[readingIndex] : 0;
+    };
+    if(depth > readings.header_->maxKeyLength)
+        return 0;
+    // (maxFrequency, code) of the children, in code order
+    std::vector<std::pair<uint32_t, uint32_t>> children;
+    uint32_t c = readings.links_[s].child;
+    for(;;) {
+        uint32_t t = readings.child(s, c);
+        if(t == DoubleArrayTrie::NONE)
+            break;
+        uint32_t frequency;
+        DoubleArrayTrie::Tail rest;
+        if(c == 0)
+            frequency = best(readings.units_[t].base);
+        else if(readings.isLeaf(t))
+            frequency = readings.tail(t, rest) ? best(rest.value) : 0;
+        else
+            frequency = fill(readings, bestFrequencies, t, depth + 1, nodes);
+        nodes[t].maxFrequency = frequency;
+        children.emplace_back(frequency, c);
+        uint32_t next = readings.links_[t].sibling;
+        if(next <= c)
+            break;
+        c = next;
+    }
+    if(children.empty())
+        return 0;
+
+    // ties stay in code order, which CompletionSearch relies on
+    std::stable_sort(children.begin(), children.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    uint32_t base = readings.units_[s].base;
+    for(size_t i = 0; i < children.size(); ++i) {
+        size_t next = i + 1 < children.size() ? i + 1 : i;
+        nodes[base + children[i].second].nextBest = uint16_t(children[next].second);
+    }
+    nodes[s].bestChild = uint16_t(children[0].second);
+    nodes[s].maxFrequency = children[0].first;
+    return children[0].first;
+}
+
+// static
+std::string CompletionIndex::buildTable(const DoubleArrayTrie& readings, const std::vector<uint32_t>& bestFrequencies) {
+    std::vector<CompletionNode> nodes(readings.unitCount(), CompletionNode{0, 0, 0});
+    if(!nodes.empty())
+        fill(readings, bestFrequencies, 0, 0, nodes);
+    return std::string(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(CompletionNode));
+}
+
+CompletionSearch::CompletionSearch(const CompletionIndex& index, std::u16string_view prefix):
+    index_(index) {
+    if(!index.isAttached())
+        return;
+    size_t length;
+    uint32_t root = index.trie().node(prefix, length);
+    // the siblings of the root do not start with the prefix
+    if(root != DoubleArrayTrie::NONE)
+        pushNode(root, NODE, 0);
+}
+
+void CompletionSearch::push(const Item& item) {
+    heap_.push_back(item);
+    std::push_heap(heap_.begin(), heap_.end(), lowerPriority);
+}
+
+void CompletionSearch::pushNode(uint32_t unit, uint32_t position, uint32_t depth) {
+    push(Item{index_.nodes_[unit].maxFrequency, unit, position, depth});
+}
+
+bool CompletionSearch::next(Completion& completion) {
+    const DoubleArrayTrie& readings = index_.trie();
+    const Lexicon& lexicon = index_.lexicon();
+    while(!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end(), lowerPriority);
+        Item item = heap_.back();
+        heap_.pop_back();
+
+        if(item.position < NODE_WITH_SIBLINGS) {
+            // a phrase, the next one of the reading is not more frequent
+            uint32_t readingIndex = index_.readingIndex(item.unit);
+            LexiconPhrases phrases = lexicon.phrasesOf(readingIndex);
+            if(item.position >= phrases.size())
+                continue;
+            if(item.position + 1 < phrases.size())
+                push(Item{phrases[item.position + 1].frequency, item.unit, item.position + 1, item.depth});
+            completion = Completion{item.unit, readingIndex, &phrases[item.position]};
+            return true;
+        }
+
+        const CompletionNode& node = index_.nodes_[item.unit];
+        if(item.position == NODE_WITH_SIBLINGS) {
+            uint32_t parent = readings.units_[item.unit].check;
+            uint32_t code = item.unit - readings.units_[parent].base;
+            if(node.nextBest != code) {
+                // siblings are chained by decreasing (maxFrequency, -code),
+                // anything else is a bad table which could loop
+                uint32_t sibling = readings.child(parent, node.nextBest);
+                if(sibling != DoubleArrayTrie::NONE) {
+                    uint32_t frequency = index_.nodes_[sibling].maxFrequency;
+                    if(frequency < node.maxFrequency || (frequency == node.maxFrequency && node.nextBest > code))
+                        pushNode(sibling, NODE_WITH_SIBLINGS, item.depth);
+                }
+            }
+        }
+
+        uint32_t readingIndex = index_.readingIndex(item.unit);
+        if(readingIndex != DoubleArrayTrie::NOT_FOUND) {
+            LexiconPhrases phrases = lexicon.phrasesOf(readingIndex);
+            if(!phrases.empty())
+                push(Item{phrases[0].frequency, item.unit, 0, item.depth});
+        }
+        else if(item.depth <= readings.header_->maxKeyLength) {
+            uint32_t child = readings.child(item.unit, node.bestChild);
+            if(child != DoubleArrayTrie::NONE)
+                pushNode(child, NODE_WITH_SIBLINGS, item.depth + 1);
+        }
+    }
+    return false;
+}
+
+CompletionCandidateSource::CompletionCandidateSource(const CompletionIndex& index, std::u16string_view prefix):
+    index_(index),
+    search_(index, prefix) {
+}
+
+std::wstring CompletionCandidateSource::get(int i) {
+    return toWide(index_.lexicon().text(*completions_[i].phrase));
+}
+
+std::wstring CompletionCandidateSource::annotation(int i) {
+    return toWide(index_.reading(completions_[i]));
+}
+
+void CompletionCandidateSource::copyTo(int i, CandidateArena& arena) {
+    appendTo(arena, index_.lexicon().text(*completions_[i].phrase));
+}
+
+void CompletionCandidateSource::copyAnnotationTo(int i, CandidateArena& arena) {
+    appendTo(arena, index_.reading(completions_[i]));
+}
+
+bool CompletionCandidateSource::fetch(int n) {
+    Completion completion;
+    while(int(completions_.size()) < n && search_.next(completion))
+        completions_.push_back(completion);
+    return n <= int(completions_.size());
+}
+
+} // namespace Ime
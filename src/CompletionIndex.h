@@ -0,0 +1,177 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_COMPLETION_INDEX_H
+#define IME_COMPLETION_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CandidateSource.h"
+#include "DictionaryFile.h"
+#include "DoubleArrayTrie.h"
+#include "Lexicon.h"
+
+namespace Ime {
+
+// Per node data of the readings trie of a lexicon, in the LXCP section, one
+// entry per unit of the trie. The children of a node are chained from the
+// most frequent down, so the best completions are found without visiting the
+// rest of the subtree.
+struct CompletionNode {
+    uint32_t maxFrequency;  // of the phrases of all the readings below the node
+    uint16_t bestChild;     // code of the child with the highest maxFrequency
+    uint16_t nextBest;      // code of the next sibling in that order, the own code for the last one
+};
+
+static_assert(sizeof(CompletionNode) == 8, "unexpected padding");
+
+// a phrase of a reading starting with the prefix
+struct Completion {
+    uint32_t unit;  // trie unit of the end of the reading, see CompletionIndex::reading()
+    uint32_t readingIndex;
+    const LexiconPhrase* phrase;
+};
+
+// Predictive completion over a Lexicon: the k most frequent phrases whose
+// readings start with a prefix. Attaching it only checks the section size.
+class CompletionIndex {
+public:
+    CompletionIndex();
+
+    // the dictionary and the lexicon must outlive the index.
+    // return false if the dictionary has no completion section for the lexicon.
+    bool attach(const DictionaryFile& file, const Lexicon& lexicon);
+
+    bool isAttached() const {
+        return nodes_ != nullptr;
+    }
+
+    const Lexicon& lexicon() const {
+        return *lexicon_;
+    }
+
+    // the reading of a completion, rebuilt from the trie
+    std::u16string reading(const Completion& completion) const;
+
+    // at most maxResults completions of the prefix, most frequent first
+    std::vector<Completion> complete(std::u16string_view prefix, size_t maxResults) const;
+
+    // the section for the readings trie of a lexicon, given the highest phrase
+    // frequency of each reading, used by LexiconBuilder.
+    static std::string buildTable(const DoubleArrayTrie& readings, const std::vector<uint32_t>& bestFrequencies);
+
+private:
+    friend class CompletionSearch;
+
+    const DoubleArrayTrie& trie() const {
+        return lexicon_->readings();
+    }
+
+    // the reading index of the end of a reading (a terminal or a leaf), NOT_FOUND if it's not one
+    uint32_t readingIndex(uint32_t unit) const;
+
+    static uint32_t fill(const DoubleArrayTrie& readings, const std::vector<uint32_t>& bestFrequencies,
+        uint32_t s, size_t depth, std::vector<CompletionNode>& nodes);
+
+private:
+    const Lexicon* lexicon_;
+    const CompletionNode* nodes_;
+};
+
+// Best-first search of the completions of a prefix. Nodes are popped from a
+// heap in decreasing maxFrequency. Popping one pushes its next best sibling
+// and its best child, so every result costs O(depth log k) heap operations
+// whatever the size of the subtree. The search is resumable: next() can be
+// called again later to get the following completions.
+class CompletionSearch {
+public:
+    CompletionSearch(const CompletionIndex& index, std::u16string_view prefix);
+
+    // the next completion, false if there are no more
+    bool next(Completion& completion);
+
+    bool done() const {
+        return heap_.empty();
+    }
+
+private:
+    // position of node items, other items are phrases at a position in their reading
+    static const uint32_t NODE = 0xffffffff;
+    static const uint32_t NODE_WITH_SIBLINGS = 0xfffffffe;
+
+    struct Item {
+        uint32_t priority;
+        uint32_t unit;
+        uint32_t position;
+        uint32_t depth;
+    };
+
+    static bool lowerPriority(const Item& a, const Item& b) {
+        return a.priority < b.priority;
+    }
+
+    void push(const Item& item);
+    void pushNode(uint32_t unit, uint32_t position, uint32_t depth);
+
+private:
+    const CompletionIndex& index_;
+    std::vector<Item> heap_;
+};
+
+// Completions shown in a candidate window. They are searched on demand when
+// CandidateList fills a page, with the readings as annotations.
+// The index must outlive the source.
+class CompletionCandidateSource: public CandidateSource {
+public:
+    CompletionCandidateSource(const CompletionIndex& index, std::u16string_view prefix);
+
+    int count() override {
+        return int(completions_.size());
+    }
+
+    std::wstring get(int i) override;
+
+    std::wstring annotation(int i) override;
+
+    void copyTo(int i, CandidateArena& arena) override;
+
+    void copyAnnotationTo(int i, CandidateArena& arena) override;
+
+    bool fetch(int n) override;
+
+    bool isComplete() override {
+        return search_.done();
+    }
+
+    const Completion& completion(int i) const {
+        return completions_[i];
+    }
+
+private:
+    const CompletionIndex& index_;
+    CompletionSearch search_;
+    std::vector<Completion> completions_;
+};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "CompositionState.h"
+#include <algorithm>
+
+namespace Ime {
+
+void CompositionState::update(std::wstring_view text, const CompositionClause* clauses, int clauseCount,
+                              uint32_t defaultAttr, CompositionUpdate& result) {
+    const int oldLen = int(text_.length());
+    const int newLen = int(text.length());
+
+    newAttrs_.assign(newLen, defaultAttr);
+    for(int i = 0; i < clauseCount; ++i) {
+        int start = std::max(clauses[i].start, 0);
+        int end = std::min(clauses[i].end, newLen);
+        if(start < end)
+            std::fill(newAttrs_.begin() + start, newAttrs_.begin() + end, clauses[i].attr);
+    }
+
+    // the changed text is what's left after removing the common prefix and suffix.
+    int prefix = 0;
+    int maxCommon = std::min(oldLen, newLen);
+    while(prefix < maxCommon && text_[prefix] == text[prefix])
+        ++prefix;
+    int suffix = 0;
+    while(suffix < maxCommon - prefix && text_[oldLen - 1 - suffix] == text[newLen - 1 - suffix])
+        ++suffix;
+    // do not split a surrogate pair
+    if(prefix > 0 && prefix < newLen && (text[prefix - 1] & 0xfc00) == 0xd800)
+        --prefix;
+    if(suffix > 0 && suffix < newLen && (text[newLen - suffix] & 0xfc00) == 0xdc00)
+        --suffix;
+
+    result.textStart = prefix;
+    result.removedLength = oldLen - prefix - suffix;
+    result.insertedLength = newLen - prefix - suffix;
+    result.runs.clear();
+
+    // collect runs of characters whose attribute need to be applied
+    const int changedEnd = newLen - suffix;
+    for(int i = 0; i < newLen;) {
+        bool dirty;
+        if(i < prefix)
+            dirty = attrs_[i] != newAttrs_[i];
+        else if(i < changedEnd)
+            dirty = true;
+        else
+            dirty = attrs_[i - newLen + oldLen] != newAttrs_[i];
+        if(!dirty) {
+            ++i;
+            continue;
+        }
+        uint32_t attr = newAttrs_[i];
+        if(!result.runs.empty() && result.runs.back().end == i && result.runs.back().attr == attr)
+            ++result.runs.back().end;
+        else
+            result.runs.push_back(CompositionClause{i, i + 1, attr});
+        ++i;
+    }
+
+    text_.assign(text.data(), text.length());
+    attrs_.swap(newAttrs_);
+}
+
+} // namespace Ime
@@ -0,0 +1,97 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_COMPOSITION_STATE_H
+#define IME_COMPOSITION_STATE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ime {
+
+// a clause of the composition string, [start, end) in UTF-16 code units,
+// displayed with a display attribute atom (TfGuidAtom). 0 means no attribute.
+struct CompositionClause {
+    int start;
+    int end;
+    uint32_t attr;
+};
+
+// What needs to be written to the document to turn the last composition string
+// into the new one. Everything outside the text edit and the attribute runs is unchanged.
+struct CompositionUpdate {
+    // replace [textStart, textStart + removedLength) of the old string with
+    // [textStart, textStart + insertedLength) of the new string.
+    int textStart;
+    int removedLength;
+    int insertedLength;
+
+    // attributes to apply, in positions of the new string.
+    std::vector<CompositionClause> runs;
+
+    bool textChanged() const {
+        return removedLength != 0 || insertedLength != 0;
+    }
+
+    bool empty() const {
+        return !textChanged() && runs.empty();
+    }
+};
+
+// Remembers the composition string and its per-character attributes as last
+// written to the document, so an update only touches the changed text and the
+// characters whose attributes changed. Rich text hosts can be slow to re-stamp
+// properties on the whole composition for every key.
+class CompositionState {
+public:
+    CompositionState() {}
+
+    // Compute the changes from the last update and remember the new state.
+    // Characters not covered by any clause get defaultAttr.
+    // Characters in the replaced text always get their attributes applied,
+    // since the document does not keep properties of replaced text.
+    void update(std::wstring_view text, const CompositionClause* clauses, int clauseCount,
+                uint32_t defaultAttr, CompositionUpdate& result);
+
+    // forget the last state, so the next update rewrites the whole composition.
+    // should be called when a composition starts or ends.
+    void reset() {
+        text_.clear();
+        attrs_.clear();
+    }
+
+    const std::wstring& text() const {
+        return text_;
+    }
+
+    const std::vector<uint32_t>& attrs() const {
+        return attrs_;
+    }
+
+private:
+    std::wstring text_;
+    std::vector<uint32_t> attrs_;  // one for each UTF-16 code unit of text_
+    std::vector<uint32_t> newAttrs_;  // kept to avoid allocations
+};
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "DictionaryFile.h"
+#include <cstring>
+#include <fstream>
+
+namespace Ime {
+
+static const char dictionaryMagic[8] = {'I', 'M', 'E', 'D', 'I', 'C', 'T', '\0'};
+
+const char* dictionaryErrorString(DictionaryError error) {
+    switch(error) {
+    case DictionaryError::NONE:
+        return "no error";
+    case DictionaryError::OPEN_FAILED:
+        return "cannot open the file";
+    case DictionaryError::BAD_HEADER:
+        return "not a dictionary file";
+    case DictionaryError::UNSUPPORTED_VERSION:
+        return "unsupported version";
+    case DictionaryError::BAD_SECTION_TABLE:
+        return "corrupted section table";
+    case DictionaryError::BAD_CHECKSUM:
+        return "corrupted section";
+    }
+    return "unknown error";
+}
+
+uint32_t dictionaryChecksum(std::string_view data) {
+    static const struct Table {
+        uint32_t entries[256];
+
+        Table() {
+            for(uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for(int bit = 0; bit < 8; ++bit)
+                    crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320u : 0);
+                entries[i] = crc;
+            }
+        }
+    } table;
+
+    uint32_t crc = 0xffffffffu;
+    for(unsigned char c: data)
+        crc = table.entries[(crc ^ c) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+DictionaryFile::DictionaryFile() {
+}
+
+DictionaryError DictionaryFile::open(const std::filesystem::path& path) {
+    close();
+    if(!file_.open(path))
+        return DictionaryError::OPEN_FAILED;
+    DictionaryError error = validate(file_.data(), file_.size());
+    if(error != DictionaryError::NONE)
+        file_.close();
+    return error;
+}
+
+void DictionaryFile::close() {
+    file_.close();
+}
+
+// static
+DictionaryError DictionaryFile::validate(const unsigned char* data, size_t size) {
+    if(size < sizeof(DictionaryHeader))
+        return DictionaryError::BAD_HEADER;
+    auto header = reinterpret_cast<const DictionaryHeader*>(data);
+    if(std::memcmp(header->magic, dictionaryMagic, sizeof(dictionaryMagic)) != 0 || header->fileSize != size)
+        return DictionaryError::BAD_HEADER;
+    if(header->version != VERSION)
+        return DictionaryError::UNSUPPORTED_VERSION;
+    if(header->sectionCount > (size - sizeof(DictionaryHeader)) / sizeof(DictionarySectionEntry))
+        return DictionaryError::BAD_SECTION_TABLE;
+    auto sections = reinterpret_cast<const DictionarySectionEntry*>(data + sizeof(DictionaryHeader));
+    for(uint32_t i = 0; i < header->sectionCount; ++i) {
+        auto& section = sections[i];
+        if(section.offset % SECTION_ALIGNMENT != 0 || section.offset > size || section.size > size - section.offset)
+            return DictionaryError::BAD_SECTION_TABLE;
+    }
+    return DictionaryError::NONE;
+}
+
+DictionaryError DictionaryFile::verify() const {
+    if(!isOpen())
+        return DictionaryError::OPEN_FAILED;
+    auto table = sections();
+    for(size_t i = 0; i < sectionCount(); ++i) {
+        auto data = std::string_view(reinterpret_cast<const char*>(file_.data() + table[i].offset), size_t(table[i].size));
+        if(dictionaryChecksum(data) != table[i].checksum)
+            return DictionaryError::BAD_CHECKSUM;
+    }
+    return DictionaryError::NONE;
+}
+
+const DictionarySectionEntry* DictionaryFile::findSection(uint32_t id) const {
+    // there are only a few sections, a linear scan is fine.
+    auto table = sections();
+    for(size_t i = 0; i < sectionCount(); ++i) {
+        if(table[i].id == id)
+            return &table[i];
+    }
+    return nullptr;
+}
+
+std::string_view DictionaryFile::section(uint32_t id) const {
+    if(auto entry = findSection(id))
+        return std::string_view(reinterpret_cast<const char*>(file_.data() + entry->offset), size_t(entry->size));
+    return std::string_view();
+}
+
+void DictionaryFileWriter::addSection(uint32_t id, std::string_view data) {
+    sections_.push_back(Section{id, std::string(data)});
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string DictionaryFileWriter::build() const {
+    uint64_t offset = sizeof(DictionaryHeader) + sections_.size() * sizeof(DictionarySectionEntry);
+    std::vector<DictionarySectionEntry> table;
+    for(auto& section: sections_) {
+        offset = alignUp(offset, DictionaryFile::SECTION_ALIGNMENT);
+        table.push_back(DictionarySectionEntry{section.id, dictionaryChecksum(section.data), offset, section.data.size()});
+        offset += section.data.size();
+    }
+
+    DictionaryHeader header;
+    std::memcpy(header.magic, dictionaryMagic, sizeof(dictionaryMagic));
+    header.version = DictionaryFile::VERSION;
+    header.sectionCount = uint32_t(sections_.size());
+    header.fileSize = offset;
+
+    std::string result(size_t(offset), '\0');
+    std::memcpy(&result[0], &header, sizeof(header));
+    if(!table.empty())
+        std::memcpy(&result[sizeof(header)], table.data(), table.size() * sizeof(DictionarySectionEntry));
+    for(size_t i = 0; i < sections_.size(); ++i) {
+        auto& data = sections_[i].data;
+        std::copy(data.begin(), data.end(), result.begin() + size_t(table[i].offset));
+    }
+    return result;
+}
+
+bool DictionaryFileWriter::write(const std::filesystem::path& path) const {
+    std::string data = build();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), std::streamsize(data.size()));
+    file.close();
+    return bool(file);
+}
+
+} // namespace Ime
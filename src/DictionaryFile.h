@@ -0,0 +1,153 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_DICTIONARY_FILE_H
+#define IME_DICTIONARY_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+namespace Ime {
+
+// id of a section, four ASCII chars such as "KEYS"
+constexpr uint32_t dictionarySectionId(const char (&name)[5]) {
+    return uint32_t(uint8_t(name[0])) | (uint32_t(uint8_t(name[1])) << 8)
+        | (uint32_t(uint8_t(name[2])) << 16) | (uint32_t(uint8_t(name[3])) << 24);
+}
+
+// On-disk layout of a compiled dictionary, little endian:
+// a header, a table of sections, then the sections, each starting at a page boundary.
+// The content of the sections is defined by the dictionary format built on top of this
+// (see Lexicon.h), and is used in place: it has offsets instead of pointers.
+struct DictionaryHeader {
+    char magic[8];  // "IMEDICT\0"
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+};
+
+struct DictionarySectionEntry {
+    uint32_t id;
+    uint32_t checksum;  // dictionaryChecksum() of the section
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(DictionaryHeader) == 24, "unexpected padding");
+static_assert(sizeof(DictionarySectionEntry) == 24, "unexpected padding");
+
+enum class DictionaryError {
+    NONE,
+    OPEN_FAILED,
+    BAD_HEADER,
+    UNSUPPORTED_VERSION,
+    BAD_SECTION_TABLE,
+    BAD_CHECKSUM
+};
+
+const char* dictionaryErrorString(DictionaryError error);
+
+// CRC-32 (the one of zip and PNG) of the data
+uint32_t dictionaryChecksum(std::string_view data);
+
+// A read-only compiled dictionary mapped into memory.
+// Opening a dictionary only validates the header and the section table,
+// the sections are used in place, so loading is O(number of sections).
+// The checksums, which need to read the whole file, are only checked by verify().
+class DictionaryFile {
+public:
+    // 2: checksums of the sections
+    static const uint32_t VERSION = 2;
+    static const size_t SECTION_ALIGNMENT = 4096;
+
+    DictionaryFile();
+
+    DictionaryError open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const {
+        return file_.isOpen();
+    }
+
+    // return an empty view if there is no such section.
+    std::string_view section(uint32_t id) const;
+
+    bool hasSection(uint32_t id) const {
+        return findSection(id) != nullptr;
+    }
+
+    const DictionaryHeader& header() const {
+        return *reinterpret_cast<const DictionaryHeader*>(file_.data());
+    }
+
+    const DictionarySectionEntry* sections() const {
+        return reinterpret_cast<const DictionarySectionEntry*>(file_.data() + sizeof(DictionaryHeader));
+    }
+
+    size_t sectionCount() const {
+        return isOpen() ? header().sectionCount : 0;
+    }
+
+    size_t size() const {
+        return file_.size();
+    }
+
+    // compare the checksums of all the sections, e.g. after a dictionary is installed.
+    DictionaryError verify() const;
+
+    // validate a mapped image, used by open().
+    static DictionaryError validate(const unsigned char* data, size_t size);
+
+private:
+    const DictionarySectionEntry* findSection(uint32_t id) const;
+
+private:
+    MappedFile file_;
+};
+
+// Builds a dictionary file out of sections.
+class DictionaryFileWriter {
+public:
+    void addSection(uint32_t id, std::string_view data);
+
+    void addSection(uint32_t id, const void* data, size_t size) {
+        addSection(id, std::string_view(static_cast<const char*>(data), size));
+    }
+
+    // the whole file in memory
+    std::string build() const;
+
+    bool write(const std::filesystem::path& path) const;
+
+private:
+    struct Section {
+        uint32_t id;
+        std::string data;
+    };
+    std::vector<Section> sections_;
+};
+
+}
+
+#endif
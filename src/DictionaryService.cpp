@@ -0,0 +1,68 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "DictionaryService.h"
+
+namespace Ime {
+
+std::shared_ptr<const DictionaryFile> DictionaryService::open(const std::filesystem::path& path, DictionaryError* error) {
+    std::error_code ec;
+    auto key = std::filesystem::weakly_canonical(path, ec);
+    if(ec)
+        key = path;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& cached = files_[key];
+    if(auto file = cached.lock()) {
+        if(error)
+            *error = DictionaryError::NONE;
+        return file;
+    }
+
+    auto file = std::make_shared<DictionaryFile>();
+    DictionaryError result = file->open(path);
+    if(error)
+        *error = result;
+    if(result != DictionaryError::NONE) {
+        files_.erase(key);
+        return nullptr;
+    }
+    cached = file;
+
+    // forget the dictionaries nobody uses anymore
+    for(auto it = files_.begin(); it != files_.end();) {
+        if(it->second.expired())
+            it = files_.erase(it);
+        else
+            ++it;
+    }
+    return file;
+}
+
+size_t DictionaryService::openCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for(auto& item: files_) {
+        if(!item.second.expired())
+            ++count;
+    }
+    return count;
+}
+
+} // namespace Ime
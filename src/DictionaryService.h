@@ -0,0 +1,52 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_DICTIONARY_SERVICE_H
+#define IME_DICTIONARY_SERVICE_H
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "DictionaryFile.h"
+
+namespace Ime {
+
+// Opens compiled dictionaries for all the text services of the process, see ImeModule::dictionaries().
+// A dictionary file is mapped only once per process and stays mapped while anyone uses it.
+// Since the mapping is read-only and backed by the file, its pages are shared with every
+// other process which has the same dictionary open. Thread safe.
+class DictionaryService {
+public:
+    DictionaryService() {}
+
+    // return nullptr if the file cannot be opened, and the reason in error if it's not null.
+    std::shared_ptr<const DictionaryFile> open(const std::filesystem::path& path, DictionaryError* error = nullptr);
+
+    // number of dictionaries which are currently open
+    size_t openCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::filesystem::path, std::weak_ptr<const DictionaryFile>> files_;
+};
+
+}
+
+#endif
@@ -25,9 +25,13 @@
 namespace Ime {
 
 DisplayAttributeInfoEnum::DisplayAttributeInfoEnum(ComPtr<DisplayAttributeProvider> provider):
-    provider_(std::move(provider)) {
-    auto displayAttrInfos = provider_->imeModule_->displayAttrInfos();
-    iterator_ = displayAttrInfos.begin();
+    provider_(std::move(provider)),
+    cursor_(provider_->imeModule_->displayAttrInfos().cursor()) {
+}
+
+DisplayAttributeInfoEnum::DisplayAttributeInfoEnum(ComPtr<DisplayAttributeProvider> provider, const Cursor& cursor):
+    provider_(std::move(provider)),
+    cursor_(cursor) {
 }
 
 DisplayAttributeInfoEnum::~DisplayAttributeInfoEnum(void) {
@@ -35,19 +39,18 @@ DisplayAttributeInfoEnum::~DisplayAttributeInfoEnum(void) {
 
 // IEnumTfDisplayAttributeInfo
 STDMETHODIMP DisplayAttributeInfoEnum::Clone(IEnumTfDisplayAttributeInfo **ppEnum) {
-    *ppEnum = static_cast<IEnumTfDisplayAttributeInfo*>(new DisplayAttributeInfoEnum(*this));
+    // the clone shares the snapshot and the position, but not the reference count
+    *ppEnum = static_cast<IEnumTfDisplayAttributeInfo*>(new DisplayAttributeInfoEnum(provider_, cursor_));
     return S_OK;
 }
 
 STDMETHODIMP DisplayAttributeInfoEnum::Next(ULONG ulCount, ITfDisplayAttributeInfo **rgInfo, ULONG *pcFetched) {
     ULONG n = 0;
     if (rgInfo != nullptr) {
-        auto& displayAttrInfos = provider_->imeModule_->displayAttrInfos();
-        for (; n < ulCount && iterator_ != displayAttrInfos.end(); ++n, ++iterator_) {
-            auto& info = *iterator_;
+        n = ULONG(cursor_.next(ulCount, [&](const ComPtr<DisplayAttributeInfo>& info) {
             info->AddRef();
-            rgInfo[n] = info;
-        }
+            rgInfo[n++] = info;
+        }));
     }
     if (pcFetched) {
         *pcFetched = n;
@@ -56,20 +59,12 @@ STDMETHODIMP DisplayAttributeInfoEnum::Next(ULONG ulCount, ITfDisplayAttributeIn
 }
 
 STDMETHODIMP DisplayAttributeInfoEnum::Reset() {
-    auto& displayAttrInfos = provider_->imeModule_->displayAttrInfos();
-    iterator_ = displayAttrInfos.begin();
+    cursor_.reset();
     return S_OK;
 }
 
 STDMETHODIMP DisplayAttributeInfoEnum::Skip(ULONG ulCount) {
-    auto& displayAttrInfos = provider_->imeModule_->displayAttrInfos();
-    ULONG n = 0;
-    while (n < ulCount && iterator_ != displayAttrInfos.end()) {
-        ++iterator_;
-        ++n;
-    }
-    return S_OK;
+    return cursor_.skip(ulCount) < ulCount ? S_FALSE : S_OK;
 }
 
 } // namespace Ime
-
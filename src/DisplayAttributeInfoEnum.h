@@ -20,8 +20,8 @@
 #pragma once
 
 #include <msctf.h>
-#include <list>
 #include "DisplayAttributeInfo.h"
+#include "DisplayAttributeRegistry.h"
 #include "ComPtr.h"
 #include "ComObject.h"
 
@@ -29,6 +29,8 @@ namespace Ime {
 
 class DisplayAttributeProvider;
 
+// Enumerates an immutable snapshot of the display attributes of the IME module,
+// so attributes added later do not invalidate it.
 class DisplayAttributeInfoEnum: public ComObject<ComInterface<IEnumTfDisplayAttributeInfo>> {
 public:
     DisplayAttributeInfoEnum(ComPtr<DisplayAttributeProvider> provider);
@@ -43,8 +45,13 @@ protected: // COM object should not be deleted directly. calling Release() inste
     virtual ~DisplayAttributeInfoEnum(void);
 
 private:
-    std::list<ComPtr<DisplayAttributeInfo>>::iterator iterator_;
+    typedef DisplayAttributeRegistry<ComPtr<DisplayAttributeInfo>>::Cursor Cursor;
+
+    DisplayAttributeInfoEnum(ComPtr<DisplayAttributeProvider> provider, const Cursor& cursor);
+
+private:
     ComPtr<DisplayAttributeProvider> provider_;
+    Cursor cursor_;
 };
 
 }
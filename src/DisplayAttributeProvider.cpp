@@ -43,13 +43,15 @@ STDMETHODIMP DisplayAttributeProvider::EnumDisplayAttributeInfo(IEnumTfDisplayAt
 }
 
 STDMETHODIMP DisplayAttributeProvider::GetDisplayAttributeInfo(REFGUID guidInfo, ITfDisplayAttributeInfo **ppInfo) {
-    for(auto& info: imeModule_->displayAttrInfos()) {
-        if(::IsEqualGUID(info->guid(), guidInfo)) {
-            *ppInfo = info;
-            info->AddRef();
-            return S_OK;
-        }
+    if(!ppInfo)
+        return E_INVALIDARG;
+    ComPtr<DisplayAttributeInfo> info;
+    if(imeModule_->displayAttrInfos().find(AttributeGuid::from(guidInfo), info)) {
+        info->AddRef();
+        *ppInfo = info;
+        return S_OK;
     }
+    *ppInfo = nullptr;
     return E_INVALIDARG;
 }
 
@@ -21,7 +21,6 @@
 #define IME_DISPLAY_ATTRIBUTE_PROVIDER_H
 
 #include <msctf.h>
-#include <list>
 #include "ComPtr.h"
 #include "ComObject.h"
 
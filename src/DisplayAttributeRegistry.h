@@ -0,0 +1,190 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_DISPLAY_ATTRIBUTE_REGISTRY_H
+#define IME_DISPLAY_ATTRIBUTE_REGISTRY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Ime {
+
+// a GUID as 16 raw bytes, so the registry does not depend on Windows headers.
+struct AttributeGuid {
+    uint8_t bytes[16];
+
+    template<typename T>
+    static AttributeGuid from(const T& guid) {
+        static_assert(sizeof(T) == 16, "not a GUID");
+        AttributeGuid result;
+        std::memcpy(result.bytes, &guid, 16);
+        return result;
+    }
+
+    bool operator==(const AttributeGuid& other) const {
+        return std::memcmp(bytes, other.bytes, 16) == 0;
+    }
+};
+
+struct AttributeGuidHash {
+    size_t operator()(const AttributeGuid& guid) const {
+        // GUIDs are random enough, fold the two halves.
+        uint64_t lo, hi;
+        std::memcpy(&lo, guid.bytes, 8);
+        std::memcpy(&hi, guid.bytes + 8, 8);
+        return size_t((lo ^ hi) * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+// Display attributes of an input method, stored in a vector with a GUID to index hash.
+// Adding attributes publishes a new immutable snapshot (copy on write), so readers
+// holding an older snapshot, such as an enumerator handed out to TSF, are never
+// invalidated. Attributes are only added at startup so copying is cheap.
+// All methods are thread safe.
+template<typename Info>
+class DisplayAttributeRegistry {
+public:
+    struct Entry {
+        AttributeGuid guid;
+        Info info;
+    };
+
+    struct Snapshot {
+        std::vector<Entry> entries;
+        std::unordered_map<AttributeGuid, size_t, AttributeGuidHash> index;
+
+        size_t size() const {
+            return entries.size();
+        }
+
+        // return nullptr if the guid is not registered.
+        const Info* find(const AttributeGuid& guid) const {
+            auto it = index.find(guid);
+            return it != index.end() ? &entries[it->second].info : nullptr;
+        }
+    };
+
+    // position of an enumerator in a snapshot, see IEnumTfDisplayAttributeInfo.
+    class Cursor {
+    public:
+        explicit Cursor(std::shared_ptr<const Snapshot> snapshot):
+            snapshot_(std::move(snapshot)),
+            pos_(0) {
+        }
+
+        // call func for at most n entries and return the number of visited entries.
+        template<typename Func>
+        size_t next(size_t n, Func func) {
+            size_t count = 0;
+            for(; count < n && pos_ < snapshot_->size(); ++count, ++pos_) {
+                func(snapshot_->entries[pos_].info);
+            }
+            return count;
+        }
+
+        size_t skip(size_t n) {
+            size_t count = std::min(n, snapshot_->size() - pos_);
+            pos_ += count;
+            return count;
+        }
+
+        void reset() {
+            pos_ = 0;
+        }
+
+        size_t pos() const {
+            return pos_;
+        }
+
+        const Snapshot& snapshot() const {
+            return *snapshot_;
+        }
+
+    private:
+        std::shared_ptr<const Snapshot> snapshot_;
+        size_t pos_;
+    };
+
+    DisplayAttributeRegistry():
+        snapshot_(std::make_shared<Snapshot>()) {
+    }
+
+    std::shared_ptr<const Snapshot> snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return snapshot_;
+    }
+
+    Cursor cursor() const {
+        return Cursor(snapshot());
+    }
+
+    // return false if the guid is already registered.
+    bool add(const AttributeGuid& guid, Info info) {
+        std::vector<Entry> entries;
+        entries.push_back(Entry{guid, std::move(info)});
+        return addAll(std::move(entries)) == 1;
+    }
+
+    // add several attributes with a single new snapshot.
+    // return the number of attributes added, duplicated guids are skipped.
+    size_t addAll(std::vector<Entry> entries) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto next = std::make_shared<Snapshot>(*snapshot_);
+        size_t added = 0;
+        for(auto& entry: entries) {
+            if(next->index.emplace(entry.guid, next->entries.size()).second) {
+                next->entries.push_back(std::move(entry));
+                ++added;
+            }
+        }
+        if(added) {
+            snapshot_ = std::move(next);
+        }
+        return added;
+    }
+
+    // copy the info of the guid, return false if it's not registered.
+    bool find(const AttributeGuid& guid, Info& info) const {
+        auto snapshot = this->snapshot();
+        if(auto found = snapshot->find(guid)) {
+            info = *found;
+            return true;
+        }
+        return false;
+    }
+
+    size_t size() const {
+        return snapshot()->size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const Snapshot> snapshot_;
+};
+
+}
+
+#endif
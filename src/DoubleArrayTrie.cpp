@@ -0,0 +1,465 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "DoubleArrayTrie.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace Ime {
+
+static const char trieMagic[8] = {'I', 'M', 'E', 'D', 'A', 'T', 'R', '\0'};
+static const size_t codePageIndexSize = 256;
+static const size_t codePageSize = 256;
+static const uint32_t FREE = 0xffffffff;
+static const size_t tailHeaderLength = 3;  // value (low, high) and length
+
+const uint32_t DoubleArrayTrie::VERSION;
+const uint32_t DoubleArrayTrie::NOT_FOUND;
+const uint32_t DoubleArrayTrie::TAIL;
+const uint32_t DoubleArrayTrie::NONE;
+
+static size_t labelsSize(uint32_t codeCount) {
+    // padded so the units are aligned
+    return ((codeCount + 1) * sizeof(uint16_t) + 3) & ~size_t(3);
+}
+
+DoubleArrayTrie::DoubleArrayTrie():
+    header_(nullptr),
+    codePageIndex_(nullptr),
+    codePages_(nullptr),
+    labels_(nullptr),
+    units_(nullptr),
+    links_(nullptr),
+    tails_(nullptr) {
+}
+
+bool DoubleArrayTrie::attach(std::string_view table) {
+    header_ = nullptr;
+    auto data = reinterpret_cast<const unsigned char*>(table.data());
+    if(table.size() < sizeof(DoubleArrayTrieHeader) || reinterpret_cast<uintptr_t>(data) % 4 != 0)
+        return false;
+    auto header = reinterpret_cast<const DoubleArrayTrieHeader*>(data);
+    if(memcmp(header->magic, trieMagic, sizeof(trieMagic)) != 0 || header->version != VERSION)
+        return false;
+
+    uint64_t codePageIndexOffset = sizeof(DoubleArrayTrieHeader);
+    uint64_t codePagesOffset = codePageIndexOffset + codePageIndexSize * sizeof(uint16_t);
+    uint64_t labelsOffset = codePagesOffset + uint64_t(header->codePageCount) * codePageSize * sizeof(uint16_t);
+    uint64_t unitsOffset = labelsOffset + labelsSize(header->codeCount);
+    uint64_t linksOffset = unitsOffset + uint64_t(header->unitCount) * sizeof(DoubleArrayUnit);
+    uint64_t tailsOffset = linksOffset + uint64_t(header->unitCount) * sizeof(DoubleArrayLink);
+    uint64_t end = tailsOffset + uint64_t(header->tailLength) * sizeof(uint16_t);
+    if(header->codePageCount > codePageIndexSize || header->codeCount > 0xffff || header->unitCount == 0
+        || header->unitCount >= TAIL || end > table.size())
+        return false;
+
+    // the codes of the key units must have labels, the rest is checked while walking the trie
+    auto codePageIndex = reinterpret_cast<const uint16_t*>(data + codePageIndexOffset);
+    for(size_t i = 0; i < codePageIndexSize; ++i) {
+        if(codePageIndex[i] > header->codePageCount)
+            return false;
+    }
+    auto codePages = reinterpret_cast<const uint16_t*>(data + codePagesOffset);
+    for(size_t i = 0; i < header->codePageCount * codePageSize; ++i) {
+        if(codePages[i] > header->codeCount)
+            return false;
+    }
+
+    header_ = header;
+    codePageIndex_ = codePageIndex;
+    codePages_ = codePages;
+    labels_ = reinterpret_cast<const uint16_t*>(data + labelsOffset);
+    units_ = reinterpret_cast<const DoubleArrayUnit*>(data + unitsOffset);
+    links_ = reinterpret_cast<const DoubleArrayLink*>(data + linksOffset);
+    tails_ = reinterpret_cast<const uint16_t*>(data + tailsOffset);
+    return true;
+}
+
+bool DoubleArrayTrie::tail(uint32_t t, Tail& tail) const {
+    uint64_t offset = units_[t].base & ~TAIL;
+    if(offset + tailHeaderLength > header_->tailLength)
+        return false;
+    const uint16_t* p = tails_ + offset;
+    if(offset + tailHeaderLength + p[2] > header_->tailLength)
+        return false;
+    tail.value = uint32_t(p[0]) | (uint32_t(p[1]) << 16);
+    tail.rest = std::u16string_view(reinterpret_cast<const char16_t*>(p + tailHeaderLength), p[2]);
+    return true;
+}
+
+uint32_t DoubleArrayTrie::node(std::u16string_view prefix, size_t& length) const {
+    length = 0;
+    if(!header_)
+        return NONE;
+    uint32_t s = 0;
+    while(length < prefix.size()) {
+        uint32_t code = this->code(prefix[length]);
+        if(!code)
+            return NONE;
+        s = child(s, code);
+        if(s == NONE)
+            return NONE;
+        ++length;
+        if(isLeaf(s)) {
+            // the rest of the prefix must be in the tail
+            Tail rest;
+            if(!tail(s, rest) || rest.rest.substr(0, prefix.size() - length) != prefix.substr(length))
+                return NONE;
+            break;
+        }
+    }
+    return s;
+}
+
+uint32_t DoubleArrayTrie::find(std::u16string_view key) const {
+    if(!header_)
+        return NOT_FOUND;
+    uint32_t s = 0;
+    for(size_t i = 0; i < key.size(); ++i) {
+        uint32_t code = this->code(key[i]);
+        if(!code)
+            return NOT_FOUND;
+        s = child(s, code);
+        if(s == NONE)
+            return NOT_FOUND;
+        if(isLeaf(s)) {
+            Tail rest;
+            return tail(s, rest) && rest.rest == key.substr(i + 1) ? rest.value : NOT_FOUND;
+        }
+    }
+    uint32_t t = child(s, 0);
+    return t != NONE ? units_[t].base : NOT_FOUND;
+}
+
+size_t DoubleArrayTrie::commonPrefixSearch(std::u16string_view text, Match* matches, size_t maxMatches) const {
+    if(!header_)
+        return 0;
+    size_t count = 0;
+    auto addMatch = [&count, matches, maxMatches](size_t length, uint32_t value) {
+        if(count < maxMatches)
+            matches[count] = Match{length, value};
+        ++count;
+    };
+    uint32_t s = 0;
+    for(size_t i = 0; ; ++i) {
+        uint32_t t = child(s, 0);
+        if(t != NONE)
+            addMatch(i, units_[t].base);
+        if(i == text.size())
+            break;
+        uint32_t code = this->code(text[i]);
+        if(!code)
+            break;
+        s = child(s, code);
+        if(s == NONE)
+            break;
+        if(isLeaf(s)) {
+            Tail rest;
+            if(tail(s, rest) && text.substr(i + 1, rest.rest.size()) == rest.rest)
+                addMatch(i + 1 + rest.rest.size(), rest.value);
+            break;
+        }
+    }
+    return count;
+}
+
+std::vector<std::pair<std::u16string, uint32_t>> DoubleArrayTrie::withPrefix(std::u16string_view prefix, size_t maxResults) const {
+    std::vector<std::pair<std::u16string, uint32_t>> results;
+    if(maxResults == 0)
+        return results;
+    forEachWithPrefix(prefix, [&results, maxResults](std::u16string_view key, uint32_t value) {
+        results.emplace_back(std::u16string(key), value);
+        return results.size() < maxResults;
+    });
+    return results;
+}
+
+void DoubleArrayTrieBuilder::add(std::u16string_view key, uint32_t value) {
+    if(!key.empty())
+        keys_.emplace_back(std::u16string(key), value);
+}
+
+namespace {
+
+// Places the nodes in the double array. The free units form a list in
+// increasing order, so finding a base for the children of a node skips the
+// units which are already used. Free units which were tried many times
+// without success are dropped from the list, they can still be used by the
+// other children of a node, so nodes with many children don't rescan them.
+class DoubleArrayPlacer {
+public:
+    DoubleArrayPlacer():
+        units_(1, DoubleArrayUnit{0, FREE}),
+        links_(1, DoubleArrayLink{0, 0}),
+        nextFree_(1, 0),
+        prevFree_(1, 0),
+        misses_(1, 0),
+        firstFree_(0) {
+    }
+
+    // units which are not used yet are free, the root is 0
+    std::vector<DoubleArrayUnit>& units() {
+        return units_;
+    }
+
+    std::vector<DoubleArrayLink>& links() {
+        return links_;
+    }
+
+    // find a base where the units of all the codes are free, and use them for the children of s
+    uint32_t placeChildren(uint32_t s, const std::vector<uint32_t>& codes) {
+        uint32_t first = codes.front();
+        uint32_t base = 0;
+        for(uint32_t p = firstFree_, next; p != 0; p = next) {
+            next = nextFree_[p];
+            if(p > first && fits(p - first, codes)) {  // base 0 is not allowed, it's the root
+                base = p - first;
+                break;
+            }
+            if(++misses_[p] == maxMisses)
+                unlink(p);
+        }
+        if(!base)  // after the last unit
+            base = std::max<uint32_t>(uint32_t(units_.size()), first + 1) - first;
+        reserve(base + codes.back() + 1);
+
+        units_[s].base = base;
+        links_[s].child = uint16_t(first);
+        for(size_t i = 0; i < codes.size(); ++i) {
+            uint32_t t = base + codes[i];
+            use(t);
+            units_[t].check = s;
+            links_[t].sibling = uint16_t(i + 1 < codes.size() ? codes[i + 1] : 0);
+        }
+        return base;
+    }
+
+    // drop the free units at the end
+    void trim() {
+        size_t size = units_.size();
+        while(size > 1 && units_[size - 1].check == FREE)
+            --size;
+        units_.resize(size);
+        links_.resize(size);
+    }
+
+private:
+    bool fits(uint32_t base, const std::vector<uint32_t>& codes) const {
+        for(uint32_t code: codes) {
+            size_t t = size_t(base) + code;
+            if(t < units_.size() && !isFree(t))
+                return false;
+        }
+        return true;
+    }
+
+    bool isFree(size_t t) const {
+        return t != 0 && units_[t].check == FREE;
+    }
+
+    void reserve(size_t size) {
+        size_t oldSize = units_.size();
+        if(size <= oldSize)
+            return;
+        units_.resize(size, DoubleArrayUnit{0, FREE});
+        links_.resize(size, DoubleArrayLink{0, 0});
+        nextFree_.resize(size, 0);
+        prevFree_.resize(size, 0);
+        misses_.resize(size, 0);
+        // append the new units to the free list
+        uint32_t last = firstFree_ ? prevFree_[firstFree_] : 0;
+        for(size_t i = oldSize; i < size; ++i) {
+            uint32_t t = uint32_t(i);
+            if(last)
+                nextFree_[last] = t;
+            else
+                firstFree_ = t;
+            prevFree_[t] = last;
+            last = t;
+        }
+        nextFree_[last] = 0;
+        prevFree_[firstFree_] = last;  // the head keeps the tail
+    }
+
+    void use(uint32_t t) {
+        if(misses_[t] < maxMisses)
+            unlink(t);
+    }
+
+    void unlink(uint32_t t) {
+        uint32_t prev = prevFree_[t];
+        uint32_t next = nextFree_[t];
+        if(t == firstFree_) {
+            firstFree_ = next;
+            if(next)
+                prevFree_[next] = prev;  // the new head keeps the tail
+        }
+        else {
+            nextFree_[prev] = next;
+            if(next)
+                prevFree_[next] = prev;
+            else
+                prevFree_[firstFree_] = prev;  // t was the tail
+        }
+    }
+
+private:
+    std::vector<DoubleArrayUnit> units_;
+    std::vector<DoubleArrayLink> links_;
+    // list of the free units, 0 ends the list. prevFree_ of the head is the tail.
+    std::vector<uint32_t> nextFree_;
+    std::vector<uint32_t> prevFree_;
+    std::vector<uint8_t> misses_;  // units with maxMisses are not in the list
+    uint32_t firstFree_;
+    static const uint8_t maxMisses = 16;
+};
+
+}
+
+std::string DoubleArrayTrieBuilder::build() const {
+    // sort the keys, the last value of a key added several times wins
+    std::vector<std::pair<std::u16string, uint32_t>> keys = keys_;
+    std::stable_sort(keys.begin(), keys.end(),
+        [](const std::pair<std::u16string, uint32_t>& a, const std::pair<std::u16string, uint32_t>& b) { return a.first < b.first; });
+    std::vector<std::pair<std::u16string, uint32_t>> unique;
+    for(auto& key: keys) {
+        if(!unique.empty() && unique.back().first == key.first)
+            unique.back().second = key.second;
+        else
+            unique.push_back(std::move(key));
+    }
+
+    // codes in the order of the units, so sorting by units also sorts by codes
+    std::vector<uint32_t> codes(0x10000, 0);
+    size_t maxKeyLength = 0;
+    for(const auto& key: unique) {
+        maxKeyLength = std::max(maxKeyLength, key.first.size());
+        for(char16_t c: key.first)
+            codes[c] = 1;
+    }
+    std::vector<uint16_t> labels(1, 0);
+    for(uint32_t c = 0; c < 0x10000; ++c) {
+        if(codes[c]) {
+            if(labels.size() > 0xffff)  // the links only have 16 bits
+                return std::string();
+            codes[c] = uint32_t(labels.size());
+            labels.push_back(uint16_t(c));
+        }
+    }
+    labels.resize(labelsSize(uint32_t(labels.size() - 1)) / sizeof(uint16_t), 0);
+
+    std::vector<uint16_t> codePageIndex(codePageIndexSize, 0);
+    std::vector<uint16_t> codePages;
+    for(uint32_t c = 0; c < 0x10000; ++c) {
+        if(!codes[c])
+            continue;
+        uint16_t& page = codePageIndex[c >> 8];
+        if(!page) {
+            codePages.resize(codePages.size() + codePageSize, 0);
+            page = uint16_t(codePages.size() / codePageSize);
+        }
+        codePages[(page - 1) * codePageSize + (c & 0xff)] = uint16_t(codes[c]);
+    }
+
+    // Breadth first, the nodes are popped from the front of the queue.
+    // The keys of a node are keys[begin, end), which share their first `depth` units.
+    DoubleArrayPlacer placer;
+    std::vector<uint16_t> tails;
+    struct Node {
+        uint32_t index;
+        size_t begin;
+        size_t end;
+        size_t depth;
+    };
+    std::deque<Node> queue;
+    if(!unique.empty())
+        queue.push_back(Node{0, 0, unique.size(), 0});
+    std::vector<uint32_t> childCodes;
+    std::vector<Node> children;
+    while(!queue.empty()) {
+        Node node = queue.front();
+        queue.pop_front();
+        childCodes.clear();
+        children.clear();
+        for(size_t i = node.begin; i < node.end; ) {
+            // a key ending here sorts first and gets code 0
+            const std::u16string& key = unique[i].first;
+            uint32_t code = key.size() == node.depth ? 0 : codes[key[node.depth]];
+            size_t j = i + 1;
+            if(code) {
+                while(j < node.end && unique[j].first[node.depth] == key[node.depth])
+                    ++j;
+            }
+            childCodes.push_back(code);
+            children.push_back(Node{0, i, j, node.depth + 1});
+            i = j;
+        }
+        uint32_t base = placer.placeChildren(node.index, childCodes);
+        for(size_t i = 0; i < childCodes.size(); ++i) {
+            uint32_t t = base + childCodes[i];
+            const Node& child = children[i];
+            if(childCodes[i] == 0) {
+                placer.units()[t].base = unique[child.begin].second;
+            }
+            else if(child.end - child.begin == 1) {
+                // the only key below, the rest of it goes to the tails
+                const auto& key = unique[child.begin];
+                placer.units()[t].base = DoubleArrayTrie::TAIL | uint32_t(tails.size());
+                tails.push_back(uint16_t(key.second));
+                tails.push_back(uint16_t(key.second >> 16));
+                tails.push_back(uint16_t(key.first.size() - child.depth));
+                tails.insert(tails.end(), key.first.begin() + child.depth, key.first.end());
+            }
+            else {
+                children[i].index = t;
+                queue.push_back(children[i]);
+            }
+        }
+    }
+    placer.trim();
+    const auto& units = placer.units();
+    const auto& links = placer.links();
+
+    DoubleArrayTrieHeader header;
+    memcpy(header.magic, trieMagic, sizeof(trieMagic));
+    header.version = DoubleArrayTrie::VERSION;
+    header.keyCount = uint32_t(unique.size());
+    header.unitCount = uint32_t(units.size());
+    header.codeCount = uint32_t(std::count_if(codes.begin(), codes.end(), [](uint32_t code) { return code != 0; }));
+    header.codePageCount = uint32_t(codePages.size() / codePageSize);
+    header.maxKeyLength = uint32_t(maxKeyLength);
+    header.tailLength = uint32_t(tails.size());
+    header.reserved = 0;
+
+    std::string table;
+    auto append = [&table](const void* data, size_t size) {
+        table.append(static_cast<const char*>(data), size);
+    };
+    append(&header, sizeof(header));
+    append(codePageIndex.data(), codePageIndex.size() * sizeof(uint16_t));
+    append(codePages.data(), codePages.size() * sizeof(uint16_t));
+    append(labels.data(), labels.size() * sizeof(uint16_t));
+    append(units.data(), units.size() * sizeof(DoubleArrayUnit));
+    append(links.data(), links.size() * sizeof(DoubleArrayLink));
+    append(tails.data(), tails.size() * sizeof(uint16_t));
+    return table;
+}
+
+} // namespace Ime
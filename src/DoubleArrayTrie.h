@@ -0,0 +1,251 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_DOUBLE_ARRAY_TRIE_H
+#define IME_DOUBLE_ARRAY_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Ime {
+
+// Layout of a compiled trie, little endian, used in place (e.g. mapped from a
+// dictionary file). All offsets are relative to the start of the table.
+//   header
+//   uint16_t codePageIndex[256]   page of the high byte of a key unit, 0 if no key has such units
+//   uint16_t codePages[codePageCount][256]  the code of a key unit, 0 if no key has it
+//   uint16_t labels[codeCount + 1]  the key unit of a code, padded to 4 bytes
+//   DoubleArrayUnit units[unitCount]
+//   DoubleArrayLink links[unitCount]
+//   uint16_t tails[tailLength]    the rest of the keys which share no prefix with others:
+//                                 value (low, high), length, then the units
+// Key units are mapped to dense codes 1..codeCount so the arrays stay small
+// whatever the units are. The child of node s for code c is t = units[s].base + c
+// if units[t].check == s. Code 0 ends a key, the base of that child is the value.
+// A node with only one key below it is a leaf whose base is TAIL | offset of the
+// rest of the key in tails, so most of a long reading is compared as a string
+// instead of taking one random access per unit.
+struct DoubleArrayTrieHeader {
+    char magic[8];  // "IMEDATR\0"
+    uint32_t version;
+    uint32_t keyCount;
+    uint32_t unitCount;
+    uint32_t codeCount;
+    uint32_t codePageCount;
+    uint32_t maxKeyLength;
+    uint32_t tailLength;
+    uint32_t reserved;
+};
+
+struct DoubleArrayUnit {
+    uint32_t base;
+    uint32_t check;  // the parent, 0xffffffff for free units and the root
+};
+
+// Only used to enumerate the keys, which visits the children in order.
+struct DoubleArrayLink {
+    uint16_t child;    // code of the first child
+    uint16_t sibling;  // code of the next sibling, 0 if there is none
+};
+
+static_assert(sizeof(DoubleArrayTrieHeader) == 40, "unexpected padding");
+static_assert(sizeof(DoubleArrayUnit) == 8, "unexpected padding");
+static_assert(sizeof(DoubleArrayLink) == 4, "unexpected padding");
+
+// A read-only double-array trie mapping keys to 32-bit values, for reading -> phrase
+// lookups. Keys are sequences of 16-bit units: UTF-16 readings, or syllable ids
+// stored in a std::u16string. A lookup follows one array slot per key unit
+// until the key is the only one left, with no pointers and no allocations.
+class DoubleArrayTrie {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    struct Match {
+        size_t length;  // of the key
+        uint32_t value;
+    };
+
+    DoubleArrayTrie();
+
+    // use a table built by DoubleArrayTrieBuilder, which must outlive the trie.
+    // return false if the table is invalid.
+    bool attach(std::string_view table);
+
+    bool isAttached() const {
+        return header_ != nullptr;
+    }
+
+    size_t size() const {
+        return header_ ? header_->keyCount : 0;
+    }
+
+    size_t unitCount() const {
+        return header_ ? header_->unitCount : 0;
+    }
+
+    // the value of the key, or NOT_FOUND
+    uint32_t find(std::u16string_view key) const;
+
+    // the keys which are prefixes of the text, shortest first, e.g. the words
+    // at the start of a sentence. return the number of matches, which may be
+    // more than maxMatches, only the first maxMatches are stored.
+    size_t commonPrefixSearch(std::u16string_view text, Match* matches, size_t maxMatches) const;
+
+    // call func(std::u16string_view key, uint32_t value) for the keys starting with the prefix,
+    // in order, until it returns false.
+    template <typename Func>
+    void forEachWithPrefix(std::u16string_view prefix, Func func) const;
+
+    // all the keys starting with the prefix, in order, at most maxResults.
+    std::vector<std::pair<std::u16string, uint32_t>> withPrefix(std::u16string_view prefix, size_t maxResults = size_t(-1)) const;
+
+    // leaves have this bit set in their base, the rest is the offset of the tail
+    static const uint32_t TAIL = 0x80000000;
+
+private:
+    // keep data per node, and walk the nodes in their own order
+    friend class CompletionIndex;
+    friend class CompletionSearch;
+
+    static const uint32_t NONE = 0xffffffff;
+
+    struct Tail {
+        std::u16string_view rest;  // of the key
+        uint32_t value;
+    };
+
+    uint32_t code(char16_t c) const {
+        uint16_t page = codePageIndex_[c >> 8];
+        return page ? codePages_[(page - 1) * 256 + (c & 0xff)] : 0;
+    }
+
+    // the child of node s for the code, or NONE
+    uint32_t child(uint32_t s, uint32_t code) const {
+        uint32_t t = units_[s].base + code;
+        return t < header_->unitCount && units_[t].check == s ? t : NONE;
+    }
+
+    bool isLeaf(uint32_t t) const {
+        return (units_[t].base & TAIL) != 0;
+    }
+
+    // the tail of leaf t, false if it's out of the table
+    bool tail(uint32_t t, Tail& tail) const;
+
+    // Walk down the prefix, return the last node or NONE if no key starts with the prefix.
+    // length is the number of units walked, less than the prefix length if a leaf is
+    // reached, the rest of the prefix is then in its tail.
+    uint32_t node(std::u16string_view prefix, size_t& length) const;
+
+private:
+    const DoubleArrayTrieHeader* header_;
+    const uint16_t* codePageIndex_;
+    const uint16_t* codePages_;
+    const uint16_t* labels_;
+    const DoubleArrayUnit* units_;
+    const DoubleArrayLink* links_;
+    const uint16_t* tails_;
+};
+
+template <typename Func>
+void DoubleArrayTrie::forEachWithPrefix(std::u16string_view prefix, Func func) const {
+    size_t length;
+    uint32_t root = node(prefix, length);
+    if(root == NONE)
+        return;
+    std::u16string key(prefix.substr(0, length));
+    Tail rest;
+    if(isLeaf(root)) {
+        if(tail(root, rest)) {
+            key.append(rest.rest.data(), rest.rest.size());
+            func(std::u16string_view(key), rest.value);
+        }
+        return;
+    }
+    // Depth first with no stack: the parent of a node is its check, and the next
+    // node to visit is its next sibling. Siblings are in increasing order and the
+    // keys are not longer than maxKeyLength, so a bad table cannot loop forever.
+    uint32_t s = root;
+    uint32_t c = links_[s].child;
+    for(;;) {
+        uint32_t t = child(s, c);
+        if(t == NONE || c > header_->codeCount)
+            return;
+        if(c == 0) {
+            if(!func(std::u16string_view(key), units_[t].base))
+                return;
+        }
+        else if(isLeaf(t)) {
+            if(!tail(t, rest))
+                return;
+            size_t keyLength = key.size();
+            key.push_back(char16_t(labels_[c]));
+            key.append(rest.rest.data(), rest.rest.size());
+            bool more = func(std::u16string_view(key), rest.value);
+            key.resize(keyLength);
+            if(!more)
+                return;
+        }
+        else if(key.size() < header_->maxKeyLength) {
+            key.push_back(char16_t(labels_[c]));
+            s = t;
+            c = links_[t].child;
+            continue;
+        }
+        // the next sibling of t, or of the closest ancestor having one
+        for(;;) {
+            uint32_t next = links_[t].sibling;
+            if(next > c) {
+                c = next;
+                break;
+            }
+            if(s == root)
+                return;
+            t = s;
+            s = units_[t].check;
+            c = t - units_[s].base;
+            key.pop_back();
+        }
+    }
+}
+
+// Builds the table of a DoubleArrayTrie.
+class DoubleArrayTrieBuilder {
+public:
+    // add a key, which cannot be empty. If a key is added several times the last value is used.
+    void add(std::u16string_view key, uint32_t value);
+
+    size_t size() const {
+        return keys_.size();
+    }
+
+    std::string build() const;
+
+private:
+    std::vector<std::pair<std::u16string, uint32_t>> keys_;
+};
+
+}
+
+#endif
@@ -18,6 +18,7 @@
 //
 
 #include "DrawUtils.h"
+#include "GdiResources.h"
 
 void FillSolidRect(HDC dc, LPRECT rc, COLORREF color) {
     SetBkColor(dc, color);
@@ -37,18 +38,18 @@ void FillSolidRect(HDC dc, int l, int t, int w, int h, COLORREF color) {
 void Draw3DBorder(HDC hdc, LPRECT rc, COLORREF light, COLORREF dark, int width) {
     MoveToEx(hdc, rc->left, rc->bottom, NULL);
 
-    HPEN light_pen = CreatePen(PS_SOLID|PS_INSIDEFRAME, width, light);
+    // the pens are kept by the resource cache of the thread
+    Ime::ResourceCache& resources = Ime::gdiResources();
+    int dpi = Ime::dpiOf(hdc);
+    HPEN light_pen = (HPEN)resources.insideFramePen(light, width, dpi);
     HGDIOBJ oldPen = SelectObject(hdc, light_pen);
     LineTo(hdc, rc->left, rc->top);
     LineTo(hdc, rc->right-width, rc->top);
-    SelectObject(hdc, oldPen);
-    DeleteObject(light_pen);
 
-    HPEN dark_pen = CreatePen(PS_SOLID|PS_INSIDEFRAME, width, dark);
-    oldPen = SelectObject(hdc, dark_pen);
+    HPEN dark_pen = (HPEN)resources.insideFramePen(dark, width, dpi);
+    SelectObject(hdc, dark_pen);
     LineTo(hdc, rc->right-width, rc->bottom-width);
     LineTo(hdc, rc->left, rc->bottom-width);
-    DeleteObject(dark_pen);
     SelectObject(hdc, oldPen);
 }
 
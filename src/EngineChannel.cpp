@@ -0,0 +1,210 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "EngineChannel.h"
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace Ime {
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// static
+size_t EngineReply::payloadSize(const EngineReplyContent& content) {
+    size_t size = sizeof(EngineReplyHeader) + (content.composition.length() + content.commit.length()) * sizeof(char16_t);
+    size = alignUp(size, sizeof(uint32_t)) + (content.candidateCount + 1) * sizeof(uint32_t);
+    for(size_t i = 0; i < content.candidateCount; ++i) {
+        size += content.candidates[i].length() * sizeof(char16_t);
+    }
+    return size;
+}
+
+// static
+void EngineReply::write(uint32_t serial, const EngineReplyContent& content, void* payload) {
+    auto header = static_cast<EngineReplyHeader*>(payload);
+    header->serial = serial;
+    header->flags = content.flags;
+    header->cursor = content.cursor;
+    header->compositionLength = uint32_t(content.composition.length());
+    header->commitLength = uint32_t(content.commit.length());
+    header->candidateCount = uint32_t(content.candidateCount);
+    header->selectedCandidate = content.selectedCandidate;
+    header->reserved = 0;
+
+    auto chars = reinterpret_cast<char16_t*>(header + 1);
+    chars = std::copy(content.composition.begin(), content.composition.end(), chars);
+    chars = std::copy(content.commit.begin(), content.commit.end(), chars);
+
+    auto base = static_cast<unsigned char*>(payload);
+    auto offsets = reinterpret_cast<uint32_t*>(base + alignUp(reinterpret_cast<unsigned char*>(chars) - base, sizeof(uint32_t)));
+    auto candidateChars = reinterpret_cast<char16_t*>(offsets + content.candidateCount + 1);
+    uint32_t offset = 0;
+    for(size_t i = 0; i < content.candidateCount; ++i) {
+        offsets[i] = offset;
+        auto& candidate = content.candidates[i];
+        std::copy(candidate.begin(), candidate.end(), candidateChars + offset);
+        offset += uint32_t(candidate.length());
+    }
+    offsets[content.candidateCount] = offset;
+}
+
+bool EngineReply::parse(const void* payload, size_t size) {
+    header_ = nullptr;
+    if(size < sizeof(EngineReplyHeader))
+        return false;
+    auto header = static_cast<const EngineReplyHeader*>(payload);
+    uint64_t charsEnd = sizeof(EngineReplyHeader) + (uint64_t(header->compositionLength) + header->commitLength) * sizeof(char16_t);
+    uint64_t offsetsEnd = alignUp(size_t(charsEnd), sizeof(uint32_t)) + (uint64_t(header->candidateCount) + 1) * sizeof(uint32_t);
+    if(offsetsEnd > size)
+        return false;
+    auto base = static_cast<const unsigned char*>(payload);
+    auto offsets = reinterpret_cast<const uint32_t*>(base + offsetsEnd) - (header->candidateCount + 1);
+    for(uint32_t i = 0; i < header->candidateCount; ++i) {
+        if(offsets[i] > offsets[i + 1])
+            return false;
+    }
+    if(offsetsEnd + uint64_t(offsets[header->candidateCount]) * sizeof(char16_t) > size)
+        return false;
+    header_ = header;
+    candidateOffsets_ = offsets;
+    candidateChars_ = reinterpret_cast<const char16_t*>(base + offsetsEnd);
+    return true;
+}
+
+// static
+std::string EngineChannel::channelName(const std::string& serverName, int index) {
+    return serverName + "-" + std::to_string(index);
+}
+
+// static
+size_t EngineChannel::headerSize() {
+    return alignUp(sizeof(EngineChannelHeader), 64);
+}
+
+bool EngineChannel::create(const std::string& name, size_t ringCapacity) {
+    close();
+    size_t ringSize = SpscRing::memorySize(ringCapacity);
+    if(!memory_.create(name, headerSize() + 2 * ringSize))
+        return false;
+    auto base = static_cast<unsigned char*>(memory_.data());
+    auto header = new(base) EngineChannelHeader();
+    header->ringCapacity = ringCapacity;
+    header->owner.store(0, std::memory_order_relaxed);
+    header->nextSerial.store(1, std::memory_order_relaxed);
+    SpscRing::initialize(base + headerSize(), ringCapacity);
+    SpscRing::initialize(base + headerSize() + ringSize, ringCapacity);
+    header->version = VERSION;
+    // the magic is written last, so clients do not use a half initialized channel
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC;
+    return attach(name);
+}
+
+bool EngineChannel::open(const std::string& name) {
+    close();
+    if(!memory_.open(name))
+        return false;
+    auto& header = this->header();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(memory_.size() < headerSize() || header.magic != MAGIC || header.version != VERSION
+        || memory_.size() < headerSize() + 2 * SpscRing::memorySize(size_t(header.ringCapacity))) {
+        close();
+        return false;
+    }
+    return attach(name);
+}
+
+bool EngineChannel::attach(const std::string& name) {
+    auto base = static_cast<unsigned char*>(memory_.data());
+    auto& header = this->header();
+    requests_.attach(base + headerSize());
+    replies_.attach(base + headerSize() + SpscRing::memorySize(size_t(header.ringCapacity)));
+    if(!requestSignal_.attach(&header.requestSignal, name + "-request")
+        || !replySignal_.attach(&header.replySignal, name + "-reply")) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EngineChannel::close() {
+    requestSignal_.detach();
+    replySignal_.detach();
+    memory_.close();
+}
+
+bool EngineChannel::claim() {
+    auto& owner = header().owner;
+    uint32_t self = currentProcessId();
+    uint32_t current = owner.load(std::memory_order_acquire);
+    while(current == 0 || !isProcessAlive(current)) {
+        if(owner.compare_exchange_weak(current, self, std::memory_order_acq_rel))
+            return true;
+    }
+    return false;
+}
+
+void EngineChannel::release() {
+    uint32_t self = currentProcessId();
+    header().owner.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+}
+
+#ifdef _WIN32
+
+// static
+uint32_t EngineChannel::currentProcessId() {
+    return ::GetCurrentProcessId();
+}
+
+// static
+bool EngineChannel::isProcessAlive(uint32_t pid) {
+    HANDLE process = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if(!process)
+        return ::GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD exitCode = 0;
+    bool alive = ::GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    ::CloseHandle(process);
+    return alive;
+}
+
+#else
+
+// static
+uint32_t EngineChannel::currentProcessId() {
+    return uint32_t(::getpid());
+}
+
+// static
+bool EngineChannel::isProcessAlive(uint32_t pid) {
+    return ::kill(pid_t(pid), 0) == 0 || errno == EPERM;
+}
+
+#endif
+
+} // namespace Ime
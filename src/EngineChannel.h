@@ -0,0 +1,241 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_ENGINE_CHANNEL_H
+#define IME_ENGINE_CHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "SharedMemory.h"
+#include "SharedSignal.h"
+#include "SpscRing.h"
+
+namespace Ime {
+
+// Protocol between the text services (clients) and an engine server process.
+// Strings are UTF-16 (char16_t), which is wchar_t on Windows.
+
+enum EngineMessageType: uint32_t {
+    // requests, with an EngineRequest payload
+    ENGINE_CONNECT = 1,  // a new client claimed the channel, forget the previous state
+    ENGINE_FILTER_KEY_DOWN,  // does the engine want the key? (see TextService::filterKeyDown())
+    ENGINE_KEY_DOWN,
+    ENGINE_FILTER_KEY_UP,
+    ENGINE_KEY_UP,
+    ENGINE_RESET,  // the composition was terminated by others
+    // replies, with an EngineReplyHeader payload
+    ENGINE_REPLY = 100
+};
+
+enum EngineModifier: uint32_t {
+    ENGINE_SHIFT = 1,
+    ENGINE_CONTROL = 2,
+    ENGINE_ALT = 4,
+    ENGINE_CAPS_LOCK = 8
+};
+
+struct EngineKeyEvent {
+    uint32_t keyCode;  // Windows virtual key code
+    uint32_t charCode;
+    uint32_t scanCode;
+    uint32_t modifiers;  // EngineModifier flags
+};
+
+struct EngineRequest {
+    uint32_t serial;
+    EngineKeyEvent key;
+};
+
+enum EngineReplyFlag: uint32_t {
+    ENGINE_HANDLED = 1,  // the key is eaten
+    ENGINE_COMPOSITION_CHANGED = 2,
+    ENGINE_CANDIDATES_CHANGED = 4,
+    ENGINE_SHOW_CANDIDATES = 8
+};
+
+// A reply is the header followed by the composition string, the commit string,
+// padding to 4 bytes, candidateCount + 1 offsets of the candidates and their chars.
+struct EngineReplyHeader {
+    uint32_t serial;
+    uint32_t flags;  // EngineReplyFlag
+    int32_t cursor;  // in the composition string
+    uint32_t compositionLength;
+    uint32_t commitLength;
+    uint32_t candidateCount;
+    int32_t selectedCandidate;
+    uint32_t reserved;
+};
+
+// what the engine replies, written to the ring by EngineServer
+struct EngineReplyContent {
+    uint32_t flags = 0;
+    int cursor = 0;
+    std::u16string_view composition;
+    std::u16string_view commit;
+    const std::u16string_view* candidates = nullptr;
+    size_t candidateCount = 0;
+    int selectedCandidate = -1;
+};
+
+// A reply read in place from the shared memory, so the candidates are not copied.
+// The strings are only valid until the next request of the client.
+class EngineReply {
+public:
+    EngineReply():
+        header_(nullptr) {
+    }
+
+    // return false if the payload is malformed.
+    bool parse(const void* payload, size_t size);
+
+    // size of the payload of a reply
+    static size_t payloadSize(const EngineReplyContent& content);
+
+    // write a reply to a buffer of payloadSize() bytes
+    static void write(uint32_t serial, const EngineReplyContent& content, void* payload);
+
+    bool isValid() const {
+        return header_ != nullptr;
+    }
+
+    uint32_t serial() const {
+        return header_->serial;
+    }
+
+    uint32_t flags() const {
+        return header_->flags;
+    }
+
+    bool isHandled() const {
+        return (header_->flags & ENGINE_HANDLED) != 0;
+    }
+
+    int cursor() const {
+        return header_->cursor;
+    }
+
+    std::u16string_view compositionString() const {
+        return std::u16string_view(chars(), header_->compositionLength);
+    }
+
+    std::u16string_view commitString() const {
+        return std::u16string_view(chars() + header_->compositionLength, header_->commitLength);
+    }
+
+    size_t candidateCount() const {
+        return header_->candidateCount;
+    }
+
+    std::u16string_view candidate(size_t i) const {
+        return std::u16string_view(candidateChars_ + candidateOffsets_[i], candidateOffsets_[i + 1] - candidateOffsets_[i]);
+    }
+
+    int selectedCandidate() const {
+        return header_->selectedCandidate;
+    }
+
+private:
+    const char16_t* chars() const {
+        return reinterpret_cast<const char16_t*>(header_ + 1);
+    }
+
+private:
+    const EngineReplyHeader* header_;
+    const uint32_t* candidateOffsets_;
+    const char16_t* candidateChars_;
+};
+
+// header of the shared memory of a channel, followed by the request and the reply rings.
+struct EngineChannelHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringCapacity;
+    std::atomic<uint32_t> owner;  // process id of the client, 0 if the channel is free
+    std::atomic<uint32_t> nextSerial;
+    SharedSignalState requestSignal;
+    SharedSignalState replySignal;
+};
+
+// A pair of rings between one client and the server, in shared memory named "<server name>-<index>".
+// The server creates a fixed number of channels, and each client claims a free one.
+class EngineChannel {
+public:
+    static const uint32_t MAGIC = 0x4e454d49;  // "IMEN"
+    static const uint32_t VERSION = 1;
+
+    EngineChannel() {}
+
+    static std::string channelName(const std::string& serverName, int index);
+
+    bool create(const std::string& name, size_t ringCapacity);
+    bool open(const std::string& name);
+    void close();
+
+    bool isOpen() const {
+        return memory_.isOpen();
+    }
+
+    EngineChannelHeader& header() const {
+        return *static_cast<EngineChannelHeader*>(memory_.data());
+    }
+
+    // client to server
+    SpscRing& requests() {
+        return requests_;
+    }
+
+    SharedSignal& requestSignal() {
+        return requestSignal_;
+    }
+
+    // server to client
+    SpscRing& replies() {
+        return replies_;
+    }
+
+    SharedSignal& replySignal() {
+        return replySignal_;
+    }
+
+    // claim the channel for the calling process. A channel owned by a process
+    // which no longer exists is taken over.
+    bool claim();
+    void release();
+
+    static uint32_t currentProcessId();
+    static bool isProcessAlive(uint32_t pid);
+
+private:
+    static size_t headerSize();
+    bool attach(const std::string& name);
+
+private:
+    SharedMemory memory_;
+    SpscRing requests_;
+    SpscRing replies_;
+    SharedSignal requestSignal_;
+    SharedSignal replySignal_;
+};
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "EngineClient.h"
+
+#include <algorithm>
+
+namespace Ime {
+
+// number of channels tried by connect(), see EngineServer::create()
+static const int maxChannels = 64;
+
+EngineClient::EngineClient():
+    connected_(false),
+    holdingReply_(false),
+    timeout_(200000),
+    reconnectDelay_(100000),
+    minReconnectDelay_(100000),
+    maxReconnectDelay_(5000000) {
+}
+
+EngineClient::~EngineClient() {
+    disconnect();
+}
+
+bool EngineClient::connect(const std::string& serverName) {
+    disconnect();
+    serverName_ = serverName;
+    if(open()) {
+        reconnectDelay_ = minReconnectDelay_;
+        return true;
+    }
+    serverName_.clear();
+    return false;
+}
+
+void EngineClient::disconnect() {
+    close();
+    serverName_.clear();
+}
+
+bool EngineClient::open() {
+    for(int i = 0; i < maxChannels; ++i) {
+        if(!channel_.open(EngineChannel::channelName(serverName_, i)))
+            break;
+        if(channel_.claim()) {
+            connected_ = true;
+            // let the server drop the state of the previous client of the channel
+            EngineReply reply;
+            if(request(ENGINE_CONNECT, EngineKeyEvent{}, reply))
+                return true;
+            break;
+        }
+    }
+    close();
+    return false;
+}
+
+void EngineClient::close() {
+    if(channel_.isOpen()) {
+        discardReply();
+        if(connected_)
+            channel_.release();
+        channel_.close();
+    }
+    connected_ = false;
+}
+
+void EngineClient::lost() {
+    close();
+    nextReconnect_ = std::chrono::steady_clock::now() + std::chrono::microseconds(reconnectDelay_);
+}
+
+bool EngineClient::reconnect() {
+    if(serverName_.empty() || std::chrono::steady_clock::now() < nextReconnect_)
+        return false;
+    if(open()) {
+        reconnectDelay_ = minReconnectDelay_;
+        return true;
+    }
+    reconnectDelay_ = std::min(reconnectDelay_ * 2, maxReconnectDelay_);
+    nextReconnect_ = std::chrono::steady_clock::now() + std::chrono::microseconds(reconnectDelay_);
+    return false;
+}
+
+void EngineClient::discardReply() {
+    if(holdingReply_) {
+        channel_.replies().pop();
+        holdingReply_ = false;
+    }
+}
+
+bool EngineClient::request(uint32_t type, const EngineKeyEvent& key, EngineReply& reply) {
+    if(!connected_ && !reconnect())
+        return false;
+    discardReply();
+
+    EngineRequest request;
+    request.serial = channel_.header().nextSerial.fetch_add(1, std::memory_order_relaxed);
+    request.key = key;
+    if(!channel_.requests().write(type, &request, sizeof(request))) {
+        lost();
+        return false;
+    }
+    channel_.requestSignal().notify();
+
+    auto& replies = channel_.replies();
+    for(;;) {
+        uint32_t seen = channel_.replySignal().sequence();
+        while(auto record = replies.peek()) {
+            // replies to requests of a previous client of the channel, or to requests which timed out
+            if(record->type == ENGINE_REPLY && reply.parse(record->payload(), record->size) && reply.serial() == request.serial) {
+                holdingReply_ = true;
+                return true;
+            }
+            replies.pop();
+        }
+        if(!channel_.replySignal().wait(seen, timeout_))
+            break;
+    }
+    lost();
+    return false;
+}
+
+} // namespace Ime
@@ -0,0 +1,94 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_ENGINE_CLIENT_H
+#define IME_ENGINE_CLIENT_H
+
+#include <chrono>
+#include <string>
+#include "EngineChannel.h"
+
+namespace Ime {
+
+// The text service side of an engine server running in another process.
+// Requests and replies are sent over a channel claimed by the client, see EngineServer.
+// Not thread safe, each text service uses its own client.
+class EngineClient {
+public:
+    EngineClient();
+    ~EngineClient();
+
+    EngineClient(const EngineClient&) = delete;
+    EngineClient& operator=(const EngineClient&) = delete;
+
+    // claim a free channel of the server. return false if the server is not running or busy.
+    bool connect(const std::string& serverName);
+    // disconnect, and do not reconnect.
+    void disconnect();
+
+    bool isConnected() const {
+        return connected_;
+    }
+
+    // Send a request and wait for its reply, which stays valid until the next request.
+    // If the server does not answer in time, the client disconnects itself, so a hung or
+    // crashed server does not block the application for every key. A later request
+    // connects again, e.g. once the server has loaded its dictionaries, but waits longer
+    // after each failed attempt, see setReconnectDelay().
+    bool request(uint32_t type, const EngineKeyEvent& key, EngineReply& reply);
+
+    void setTimeout(int microseconds) {
+        timeout_ = microseconds;
+    }
+
+    // the delay before the first attempt to connect again, doubled after each failed
+    // attempt up to maxMicroseconds.
+    void setReconnectDelay(int microseconds, int maxMicroseconds) {
+        minReconnectDelay_ = reconnectDelay_ = microseconds;
+        maxReconnectDelay_ = maxMicroseconds;
+    }
+
+    // spin count of the wait for a reply, see SharedSignal::setSpinCount().
+    void setSpinCount(int spinCount) {
+        channel_.replySignal().setSpinCount(spinCount);
+    }
+
+private:
+    bool open();
+    void close();
+    // the server did not answer, connect again later
+    void lost();
+    bool reconnect();
+    void discardReply();
+
+private:
+    EngineChannel channel_;
+    std::string serverName_;  // empty if not connected by connect()
+    bool connected_;
+    bool holdingReply_;  // the last reply is still in the ring
+    int timeout_;
+    int reconnectDelay_;
+    int minReconnectDelay_;
+    int maxReconnectDelay_;
+    std::chrono::steady_clock::time_point nextReconnect_;
+};
+
+}
+
+#endif
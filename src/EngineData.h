@@ -0,0 +1,123 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_ENGINE_DATA_H
+#define IME_ENGINE_DATA_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace Ime {
+
+// Immutable data of an input method engine shared by the text services of all
+// UI threads, such as dictionaries, the language model and the configuration.
+// Derive from it, fill it before publishing it, and never modify it afterwards.
+class EngineData {
+public:
+    virtual ~EngineData() {}
+};
+
+// Holds the current engine data of the module, see ImeModule::engineData().
+// Publishing new data (for example after the configuration changed) does not
+// affect the text services still using the old one, which is freed when the
+// last of them moves on.
+class EngineDataStore {
+public:
+    EngineDataStore():
+        generation_(0) {
+    }
+
+    void publish(std::shared_ptr<const EngineData> data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_ = std::move(data);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<const EngineData> current() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return data_;
+    }
+
+    // incremented by every publish()
+    uint64_t generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const EngineData> data_;
+    std::atomic<uint64_t> generation_;
+};
+
+// A reference to the engine data for one text service (one UI thread).
+// Reading only checks the generation of the store, which is a single atomic load,
+// and the store is only locked after something new was published.
+// A reader is used by one thread, while any number of readers share a store.
+class EngineDataReader {
+public:
+    explicit EngineDataReader(const EngineDataStore& store):
+        store_(store),
+        generation_(~uint64_t(0)),
+        refreshes_(0) {
+    }
+
+    // the current data, nullptr if nothing was published. The data stays alive
+    // until the next call even if the store publishes new data meanwhile.
+    const EngineData* get() {
+        if(store_.generation() != generation_)
+            refresh();
+        return data_.get();
+    }
+
+    template<typename Data>
+    const Data* get() {
+        return static_cast<const Data*>(get());
+    }
+
+    // keep the data alive beyond the next call
+    const std::shared_ptr<const EngineData>& share() {
+        get();
+        return data_;
+    }
+
+    // number of times the store was locked
+    uint64_t refreshes() const {
+        return refreshes_;
+    }
+
+private:
+    void refresh() {
+        // read the generation first, so a publish() racing with us is seen next time
+        generation_ = store_.generation();
+        data_ = store_.current();
+        ++refreshes_;
+    }
+
+private:
+    const EngineDataStore& store_;
+    uint64_t generation_;
+    std::shared_ptr<const EngineData> data_;
+    uint64_t refreshes_;
+};
+
+}
+
+#endif
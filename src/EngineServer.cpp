@@ -0,0 +1,106 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "EngineServer.h"
+
+namespace Ime {
+
+// how often the serving threads check stopping_ while idle
+static const int idleTimeout = 100000;
+
+EngineServer::EngineServer():
+    stopping_(false),
+    requestCount_(0) {
+}
+
+EngineServer::~EngineServer() {
+    stop();
+}
+
+bool EngineServer::create(const std::string& name, int channelCount, size_t ringCapacity) {
+    for(int i = 0; i < channelCount; ++i) {
+        auto channel = std::make_unique<EngineChannel>();
+        if(!channel->create(EngineChannel::channelName(name, i), ringCapacity)) {
+            channels_.clear();
+            return false;
+        }
+        channels_.push_back(std::move(channel));
+    }
+    return true;
+}
+
+void EngineServer::start(SessionFactory factory) {
+    stopping_ = false;
+    for(auto& channel: channels_) {
+        threads_.emplace_back([this, &channel, session = factory()]() {
+            serve(*channel, *session);
+        });
+    }
+}
+
+void EngineServer::stop() {
+    stopping_ = true;
+    for(auto& channel: channels_) {
+        // wake up the idle threads
+        channel->requestSignal().notify();
+    }
+    for(auto& thread: threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+void EngineServer::setSpinCount(int spinCount) {
+    for(auto& channel: channels_) {
+        channel->requestSignal().setSpinCount(spinCount);
+    }
+}
+
+void EngineServer::serve(EngineChannel& channel, EngineSession& session) {
+    auto& requests = channel.requests();
+    auto& replies = channel.replies();
+    EngineReplyContent content;
+    while(!stopping_.load(std::memory_order_relaxed)) {
+        uint32_t seen = channel.requestSignal().sequence();
+        while(auto record = requests.peek()) {
+            if(record->size >= sizeof(EngineRequest)) {
+                EngineRequest request = *static_cast<const EngineRequest*>(record->payload());
+                uint32_t type = record->type;
+                requests.pop();
+
+                content = EngineReplyContent();
+                session.handle(type, request, content);
+                // the reply is written in place, and read in place by the client
+                size_t size = EngineReply::payloadSize(content);
+                if(void* payload = replies.reserve(ENGINE_REPLY, size)) {
+                    EngineReply::write(request.serial, content, payload);
+                    replies.commit();
+                    channel.replySignal().notify();
+                }
+                requestCount_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                requests.pop();
+            }
+        }
+        channel.requestSignal().wait(seen, idleTimeout);
+    }
+}
+
+} // namespace Ime
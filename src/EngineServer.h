@@ -0,0 +1,83 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_ENGINE_SERVER_H
+#define IME_ENGINE_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EngineChannel.h"
+
+namespace Ime {
+
+// the state of the engine for one client
+class EngineSession {
+public:
+    virtual ~EngineSession() {}
+
+    // handle a request and fill the reply. The strings of the reply only need to stay
+    // valid until the next call, they are written to the shared memory directly.
+    virtual void handle(uint32_t type, const EngineRequest& request, EngineReplyContent& reply) = 0;
+};
+
+// Serves the text services of all processes. The server creates a fixed number of
+// channels named "<name>-<index>", each with its own thread and engine session,
+// and every connecting client claims one of them.
+class EngineServer {
+public:
+    typedef std::function<std::unique_ptr<EngineSession>()> SessionFactory;
+
+    EngineServer();
+    ~EngineServer();
+
+    bool create(const std::string& name, int channelCount = 8, size_t ringCapacity = 256 * 1024);
+
+    // serve the clients in background threads until stop() is called.
+    void start(SessionFactory factory);
+    void stop();
+
+    // spin count of the wait for requests, see SharedSignal::setSpinCount().
+    void setSpinCount(int spinCount);
+
+    int channelCount() const {
+        return int(channels_.size());
+    }
+
+    // number of requests handled so far
+    uint64_t requestCount() const {
+        return requestCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void serve(EngineChannel& channel, EngineSession& session);
+
+private:
+    std::vector<std::unique_ptr<EngineChannel>> channels_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stopping_;
+    std::atomic<uint64_t> requestCount_;
+};
+
+}
+
+#endif
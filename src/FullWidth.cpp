@@ -0,0 +1,455 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "FullWidth.h"
+#include "Simd.h"
+#include <algorithm>
+
+namespace Ime {
+
+// The pairs which are not in the contiguous ranges, see UAX #11.
+struct WidthPair {
+    char16_t half;
+    char16_t full;
+};
+
+static const WidthPair irregularPairs[] = {
+    {0x0020, 0x3000},  // ideographic space
+    {0x00a2, 0xffe0},  // ¢
+    {0x00a3, 0xffe1},  // £
+    {0x00a5, 0xffe5},  // ¥
+    {0x00a6, 0xffe4},  // ¦
+    {0x00ac, 0xffe2},  // ¬
+    {0x00af, 0xffe3},  // ¯
+    {0x20a9, 0xffe6},  // ₩
+    {0x2985, 0xff5f},  // ⦅
+    {0x2986, 0xff60},  // ⦆
+};
+
+static const char16_t asciiFirst = 0x21;
+static const char16_t asciiLast = 0x7e;
+static const char16_t fullWidthFirst = 0xff01;
+static const char16_t fullWidthLast = 0xff5e;
+static const uint16_t fullWidthOffset = fullWidthFirst - asciiFirst;
+
+// chars converted by the scalar code only, a block containing one of them is
+// not converted with SIMD.
+static const char16_t halfIrregularFirst = 0xa2;
+static const char16_t halfIrregularLast = 0xaf;
+static const char16_t fullIrregularFirst = 0xff5f;
+static const char16_t fullIrregularLast = 0xffe6;
+
+char16_t toFullWidth(char16_t c) {
+    if(c >= asciiFirst && c <= asciiLast)
+        return char16_t(c + fullWidthOffset);
+    if(c == 0x20 || c >= halfIrregularFirst) {
+        for(const auto& pair: irregularPairs) {
+            if(pair.half == c)
+                return pair.full;
+        }
+    }
+    return c;
+}
+
+char16_t toHalfWidth(char16_t c) {
+    if(c >= fullWidthFirst && c <= fullWidthLast)
+        return char16_t(c - fullWidthOffset);
+    if(c == 0x3000 || c >= fullIrregularFirst) {
+        for(const auto& pair: irregularPairs) {
+            if(pair.full == c)
+                return pair.half;
+        }
+    }
+    return c;
+}
+
+// Vector helpers for 16-bit lanes. Comparisons return all ones in the lanes where they hold.
+#if defined(IME_SIMD_AVX2)
+static inline __m256i inRange256(__m256i v, uint16_t first, uint16_t last) {
+    // unsigned v - first <= last - first, SSE and AVX2 only have signed comparisons
+    __m256i offset = _mm256_sub_epi16(v, _mm256_set1_epi16(int16_t(first)));
+    __m256i over = _mm256_subs_epu16(offset, _mm256_set1_epi16(int16_t(last - first)));
+    return _mm256_cmpeq_epi16(over, _mm256_setzero_si256());
+}
+
+static inline __m256i equal256(__m256i v, uint16_t c) {
+    return _mm256_cmpeq_epi16(v, _mm256_set1_epi16(int16_t(c)));
+}
+#endif
+
+#if defined(IME_SIMD_SSE2)
+static inline __m128i inRange128(__m128i v, uint16_t first, uint16_t last) {
+    __m128i offset = _mm_sub_epi16(v, _mm_set1_epi16(int16_t(first)));
+    __m128i over = _mm_subs_epu16(offset, _mm_set1_epi16(int16_t(last - first)));
+    return _mm_cmpeq_epi16(over, _mm_setzero_si128());
+}
+
+static inline __m128i equal128(__m128i v, uint16_t c) {
+    return _mm_cmpeq_epi16(v, _mm_set1_epi16(int16_t(c)));
+}
+#elif defined(IME_SIMD_NEON)
+static inline uint16x8_t inRange128(uint16x8_t v, uint16_t first, uint16_t last) {
+    return vandq_u16(vcgeq_u16(v, vdupq_n_u16(first)), vcleq_u16(v, vdupq_n_u16(last)));
+}
+
+static inline uint16x8_t equal128(uint16x8_t v, uint16_t c) {
+    return vceqq_u16(v, vdupq_n_u16(c));
+}
+#endif
+
+// the scalar code converts this many chars after the SIMD code stops at an irregular char
+static const size_t scalarBlockSize = 16;
+
+// Convert the leading blocks of in[0, n) which have no irregular chars with SIMD.
+// return the number of chars converted.
+static size_t toFullWidthBlocks(const char16_t* in, size_t n, char16_t* out) {
+    size_t i = 0;
+#if defined(IME_SIMD_AVX2)
+    for(; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i irregular = _mm256_or_si256(inRange256(v, halfIrregularFirst, halfIrregularLast),
+            _mm256_or_si256(equal256(v, 0x20a9), inRange256(v, 0x2985, 0x2986)));
+        if(!_mm256_testz_si256(irregular, irregular))
+            break;
+        __m256i printable = _mm256_and_si256(inRange256(v, asciiFirst, asciiLast), _mm256_set1_epi16(int16_t(fullWidthOffset)));
+        __m256i space = _mm256_and_si256(equal256(v, 0x20), _mm256_set1_epi16(0x3000 - 0x20));
+        v = _mm256_add_epi16(v, _mm256_or_si256(printable, space));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+#endif
+#if defined(IME_SIMD_SSE2)
+    for(; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i irregular = _mm_or_si128(inRange128(v, halfIrregularFirst, halfIrregularLast),
+            _mm_or_si128(equal128(v, 0x20a9), inRange128(v, 0x2985, 0x2986)));
+        if(_mm_movemask_epi8(irregular))
+            break;
+        __m128i printable = _mm_and_si128(inRange128(v, asciiFirst, asciiLast), _mm_set1_epi16(int16_t(fullWidthOffset)));
+        __m128i space = _mm_and_si128(equal128(v, 0x20), _mm_set1_epi16(0x3000 - 0x20));
+        v = _mm_add_epi16(v, _mm_or_si128(printable, space));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+#elif defined(IME_SIMD_NEON)
+    for(; i + 8 <= n; i += 8) {
+        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+        uint16x8_t irregular = vorrq_u16(inRange128(v, halfIrregularFirst, halfIrregularLast),
+            vorrq_u16(equal128(v, 0x20a9), inRange128(v, 0x2985, 0x2986)));
+        if(vmaxvq_u16(irregular))
+            break;
+        uint16x8_t printable = vandq_u16(inRange128(v, asciiFirst, asciiLast), vdupq_n_u16(fullWidthOffset));
+        uint16x8_t space = vandq_u16(equal128(v, 0x20), vdupq_n_u16(0x3000 - 0x20));
+        v = vaddq_u16(v, vorrq_u16(printable, space));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i), v);
+    }
+#endif
+    return i;
+}
+
+static size_t toHalfWidthBlocks(const char16_t* in, size_t n, char16_t* out) {
+    size_t i = 0;
+#if defined(IME_SIMD_AVX2)
+    for(; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i irregular = inRange256(v, fullIrregularFirst, fullIrregularLast);
+        if(!_mm256_testz_si256(irregular, irregular))
+            break;
+        __m256i fullWidth = _mm256_and_si256(inRange256(v, fullWidthFirst, fullWidthLast), _mm256_set1_epi16(int16_t(fullWidthOffset)));
+        __m256i space = _mm256_and_si256(equal256(v, 0x3000), _mm256_set1_epi16(0x3000 - 0x20));
+        v = _mm256_sub_epi16(v, _mm256_or_si256(fullWidth, space));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+#endif
+#if defined(IME_SIMD_SSE2)
+    for(; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if(_mm_movemask_epi8(inRange128(v, fullIrregularFirst, fullIrregularLast)))
+            break;
+        __m128i fullWidth = _mm_and_si128(inRange128(v, fullWidthFirst, fullWidthLast), _mm_set1_epi16(int16_t(fullWidthOffset)));
+        __m128i space = _mm_and_si128(equal128(v, 0x3000), _mm_set1_epi16(0x3000 - 0x20));
+        v = _mm_sub_epi16(v, _mm_or_si128(fullWidth, space));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+#elif defined(IME_SIMD_NEON)
+    for(; i + 8 <= n; i += 8) {
+        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+        if(vmaxvq_u16(inRange128(v, fullIrregularFirst, fullIrregularLast)))
+            break;
+        uint16x8_t fullWidth = vandq_u16(inRange128(v, fullWidthFirst, fullWidthLast), vdupq_n_u16(fullWidthOffset));
+        uint16x8_t space = vandq_u16(equal128(v, 0x3000), vdupq_n_u16(0x3000 - 0x20));
+        v = vsubq_u16(v, vorrq_u16(fullWidth, space));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i), v);
+    }
+#endif
+    return i;
+}
+
+void toFullWidth(std::u16string_view in, char16_t* out) {
+    const char16_t* s = in.data();
+    size_t n = in.size();
+    size_t i = 0;
+    while(i < n) {
+        i += toFullWidthBlocks(s + i, n - i, out + i);
+        for(size_t end = std::min(n, i + scalarBlockSize); i < end; ++i)
+            out[i] = toFullWidth(s[i]);
+    }
+}
+
+void toHalfWidth(std::u16string_view in, char16_t* out) {
+    const char16_t* s = in.data();
+    size_t n = in.size();
+    size_t i = 0;
+    while(i < n) {
+        i += toHalfWidthBlocks(s + i, n - i, out + i);
+        for(size_t end = std::min(n, i + scalarBlockSize); i < end; ++i)
+            out[i] = toHalfWidth(s[i]);
+    }
+}
+
+static inline bool isLetterOrDigit(char16_t c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+// The chars copyUnmapped() copies without looking them up: digits, letters, and
+// the space, unless one of them is mapped, and chars above ASCII outside [othersFirst, othersLast].
+// The masks are 0xffff for the classes of ASCII chars which are not mapped, 0 otherwise.
+struct UnmappedChars {
+    uint16_t digits;
+    uint16_t letters;
+    uint16_t space;
+    char16_t othersFirst;
+    char16_t othersLast;
+
+    bool contains(char16_t c) const {
+        if(c > 0x7f)
+            return c < othersFirst || c > othersLast;
+        if(c >= '0' && c <= '9')
+            return digits != 0;
+        if((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+            return letters != 0;
+        return c == ' ' && space != 0;
+    }
+};
+
+#if defined(IME_SIMD_SSE2)
+static inline unsigned int countTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Copy the leading chars of in[0, n) which are in `unmapped` with SIMD.
+// Punctuation is rare, so the first char which may be mapped is found with a
+// bit scan instead of falling back to the scalar code for the whole block.
+// out needs room for n chars. return the number of chars copied.
+static size_t copyUnmapped(const char16_t* in, size_t n, char16_t* out, const UnmappedChars& unmapped) {
+    size_t i = 0;
+#if defined(IME_SIMD_AVX2)
+    const __m256i digits256 = _mm256_set1_epi16(int16_t(unmapped.digits));
+    const __m256i letters256 = _mm256_set1_epi16(int16_t(unmapped.letters));
+    const __m256i space256 = _mm256_set1_epi16(int16_t(unmapped.space));
+    for(; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        // clearing 0x20 moves the lowercase letters onto the uppercase ones
+        __m256i upper = _mm256_andnot_si256(_mm256_set1_epi16(0x20), v);
+        __m256i safe = _mm256_or_si256(_mm256_and_si256(inRange256(v, '0', '9'), digits256),
+            _mm256_or_si256(_mm256_and_si256(inRange256(upper, 'A', 'Z'), letters256), _mm256_and_si256(equal256(v, ' '), space256)));
+        __m256i maybeMapped = _mm256_or_si256(inRange256(v, 0, 0x7f), inRange256(v, unmapped.othersFirst, unmapped.othersLast));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_andnot_si256(safe, maybeMapped)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        if(mask)
+            return i + countTrailingZeros(mask) / 2;
+    }
+#endif
+#if defined(IME_SIMD_SSE2)
+    const __m128i digits = _mm_set1_epi16(int16_t(unmapped.digits));
+    const __m128i letters = _mm_set1_epi16(int16_t(unmapped.letters));
+    const __m128i space = _mm_set1_epi16(int16_t(unmapped.space));
+    for(; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i upper = _mm_andnot_si128(_mm_set1_epi16(0x20), v);
+        __m128i safe = _mm_or_si128(_mm_and_si128(inRange128(v, '0', '9'), digits),
+            _mm_or_si128(_mm_and_si128(inRange128(upper, 'A', 'Z'), letters), _mm_and_si128(equal128(v, ' '), space)));
+        __m128i maybeMapped = _mm_or_si128(inRange128(v, 0, 0x7f), inRange128(v, unmapped.othersFirst, unmapped.othersLast));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_andnot_si128(safe, maybeMapped)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+        if(mask)
+            return i + countTrailingZeros(mask) / 2;
+    }
+#elif defined(IME_SIMD_NEON)
+    const uint16x8_t digits = vdupq_n_u16(unmapped.digits);
+    const uint16x8_t letters = vdupq_n_u16(unmapped.letters);
+    const uint16x8_t space = vdupq_n_u16(unmapped.space);
+    for(; i + 8 <= n; i += 8) {
+        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+        uint16x8_t upper = vbicq_u16(v, vdupq_n_u16(0x20));
+        uint16x8_t safe = vorrq_u16(vandq_u16(inRange128(v, '0', '9'), digits),
+            vorrq_u16(vandq_u16(inRange128(upper, 'A', 'Z'), letters), vandq_u16(equal128(v, ' '), space)));
+        uint16x8_t maybeMapped = vorrq_u16(inRange128(v, 0, 0x7f), inRange128(v, unmapped.othersFirst, unmapped.othersLast));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i), v);
+        if(vmaxvq_u16(vbicq_u16(maybeMapped, safe))) {
+            while(unmapped.contains(in[i]))
+                ++i;
+            return i;
+        }
+    }
+#endif
+    return i;
+}
+
+PunctuationMap::PunctuationMap():
+    ascii_(),
+    count_(0) {
+}
+
+// static
+PunctuationMap PunctuationMap::chinese() {
+    PunctuationMap map;
+    for(char16_t c = asciiFirst; c <= asciiLast; ++c) {
+        if(!isLetterOrDigit(c)) {
+            char16_t full = toFullWidth(c);
+            map.set(c, std::u16string_view(&full, 1));
+        }
+    }
+    map.set(u',', u"，");
+    map.set(u'.', u"。");
+    map.set(u'<', u"《");
+    map.set(u'>', u"》");
+    map.set(u'[', u"「");
+    map.set(u']', u"」");
+    map.set(u'{', u"『");
+    map.set(u'}', u"』");
+    map.set(u'\\', u"、");
+    map.set(u'^', u"……");
+    map.set(u'_', u"——");
+    return map;
+}
+
+void PunctuationMap::set(char16_t from, std::u16string_view to) {
+    if(to.empty()) {
+        remove(from);
+        return;
+    }
+    Replacement r{uint32_t(pool_.size()), uint32_t(to.size())};
+    pool_.append(to.data(), to.size());
+    if(from < 0x80) {
+        if(!ascii_[from].length)
+            ++count_;
+        ascii_[from] = r;
+        return;
+    }
+    auto it = std::lower_bound(others_.begin(), others_.end(), from,
+        [](const std::pair<char16_t, Replacement>& item, char16_t c) { return item.first < c; });
+    if(it != others_.end() && it->first == from) {
+        it->second = r;
+    }
+    else {
+        others_.insert(it, std::make_pair(from, r));
+        ++count_;
+    }
+}
+
+void PunctuationMap::remove(char16_t from) {
+    if(from < 0x80) {
+        if(ascii_[from].length)
+            --count_;
+        ascii_[from] = Replacement{0, 0};
+        return;
+    }
+    auto it = std::lower_bound(others_.begin(), others_.end(), from,
+        [](const std::pair<char16_t, Replacement>& item, char16_t c) { return item.first < c; });
+    if(it != others_.end() && it->first == from) {
+        others_.erase(it);
+        --count_;
+    }
+}
+
+const PunctuationMap::Replacement* PunctuationMap::find(char16_t c) const {
+    if(c < 0x80)
+        return ascii_[c].length ? &ascii_[c] : nullptr;
+    if(others_.empty() || c < others_.front().first || c > others_.back().first)
+        return nullptr;
+    auto it = std::lower_bound(others_.begin(), others_.end(), c,
+        [](const std::pair<char16_t, Replacement>& item, char16_t c) { return item.first < c; });
+    return it != others_.end() && it->first == c ? &it->second : nullptr;
+}
+
+size_t PunctuationMap::maxLength() const {
+    size_t length = 1;
+    for(const auto& r: ascii_)
+        length = std::max(length, size_t(r.length));
+    for(const auto& item: others_)
+        length = std::max(length, size_t(item.second.length));
+    return length;
+}
+
+PunctuationMap::Result PunctuationMap::convert(std::u16string_view in, char16_t* out, size_t outSize) const {
+    auto noneMapped = [this](char16_t first, char16_t last) -> uint16_t {
+        for(char16_t c = first; c <= last; ++c) {
+            if(ascii_[c].length)
+                return 0;
+        }
+        return 0xffff;
+    };
+    UnmappedChars unmapped;
+    unmapped.digits = noneMapped('0', '9');
+    unmapped.letters = noneMapped('A', 'Z') & noneMapped('a', 'z');
+    unmapped.space = noneMapped(' ', ' ');
+    // [0, 0] when nothing above ASCII is mapped, ASCII is handled above
+    unmapped.othersFirst = others_.empty() ? 0 : others_.front().first;
+    unmapped.othersLast = others_.empty() ? 0 : others_.back().first;
+    const char16_t* s = in.data();
+    size_t n = in.size();
+    size_t i = 0;
+    size_t o = 0;
+    while(i < n) {
+        size_t copied = copyUnmapped(s + i, std::min(n - i, outSize - o), out + o, unmapped);
+        i += copied;
+        o += copied;
+        if(i == n)
+            break;
+
+        char16_t c = s[i];
+        if(const Replacement* r = find(c)) {
+            if(outSize - o < r->length)
+                break;
+            std::copy(pool_.data() + r->offset, pool_.data() + r->offset + r->length, out + o);
+            o += r->length;
+        }
+        else {
+            if(o == outSize)
+                break;
+            out[o++] = c;
+        }
+        ++i;
+    }
+    return Result{i, o};
+}
+
+void PunctuationMap::convert(std::u16string_view in, std::u16string& out) const {
+    out.resize(in.size() * maxLength());
+    Result result = convert(in, &out[0], out.size());
+    out.resize(result.written);
+}
+
+} // namespace Ime
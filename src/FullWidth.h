@@ -0,0 +1,106 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_FULL_WIDTH_H
+#define IME_FULL_WIDTH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ime {
+
+// Conversion between ASCII and the full-width forms used in CJK mode, and
+// remapping of punctuation, over UTF-16 text. Printable ASCII and U+FF01-FF5E
+// are contiguous ranges converted with SIMD. The few other pairs (the space and
+// U+3000, U+FF5F-FF60, U+FFE0-FFE6) are looked up in a table.
+
+// the full-width form of c, or c itself if there is none.
+char16_t toFullWidth(char16_t c);
+
+// the half-width (or narrow) form of c, or c itself if there is none.
+char16_t toHalfWidth(char16_t c);
+
+// convert in[0, in.size()) to out[0, in.size()). The length never changes, so
+// out can be in.data() to convert in place.
+void toFullWidth(std::u16string_view in, char16_t* out);
+
+void toHalfWidth(std::u16string_view in, char16_t* out);
+
+// Replace chars of the text with strings, e.g. "," with "，" or "^" with
+// "……". Any BMP char can be mapped, chars which are not mapped are
+// copied as is. Runs of letters, digits, and CJK chars are copied with SIMD.
+class PunctuationMap {
+public:
+    struct Result {
+        size_t read;     // input code units converted
+        size_t written;  // output code units written
+    };
+
+    PunctuationMap();
+
+    // the full-width forms of ASCII punctuation with the usual Chinese
+    // replacements for , . < > [ ] { } \ ^ _. Engines adjust it with set().
+    static PunctuationMap chinese();
+
+    void set(char16_t from, std::u16string_view to);
+
+    void remove(char16_t from);
+
+    // the replacement of c, or an empty string if c is not mapped.
+    std::u16string_view lookup(char16_t c) const {
+        const Replacement* r = find(c);
+        return r ? std::u16string_view(pool_.data() + r->offset, r->length) : std::u16string_view();
+    }
+
+    bool empty() const {
+        return count_ == 0;
+    }
+
+    // convert into a buffer given by the caller. The conversion stops before a
+    // replacement which does not fit in the rest of the buffer.
+    Result convert(std::u16string_view in, char16_t* out, size_t outSize) const;
+
+    // convert all the input and replace the content of out, whose memory is reused.
+    void convert(std::u16string_view in, std::u16string& out) const;
+
+private:
+    struct Replacement {
+        uint32_t offset;   // in pool_
+        uint32_t length;   // 0 if not mapped
+    };
+
+    const Replacement* find(char16_t c) const;
+
+    // the longest replacement, which is how much the text can grow per char
+    size_t maxLength() const;
+
+private:
+    Replacement ascii_[128];
+    // mapped chars above ASCII, sorted
+    std::vector<std::pair<char16_t, Replacement>> others_;
+    std::u16string pool_;
+    size_t count_;
+};
+
+}
+
+#endif
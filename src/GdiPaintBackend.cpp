@@ -0,0 +1,122 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "GdiPaintBackend.h"
+#include "DrawUtils.h"
+#include "GdiResources.h"
+
+namespace Ime {
+
+BackBuffer::BackBuffer():
+    dc_(NULL),
+    bitmap_(NULL),
+    oldBitmap_(NULL),
+    width_(0),
+    height_(0) {
+}
+
+BackBuffer::~BackBuffer() {
+    release();
+}
+
+bool BackBuffer::ensureSize(HDC windowDC, int width, int height) {
+    if(dc_ && width == width_ && height == height_)
+        return false;
+    release();
+    dc_ = ::CreateCompatibleDC(windowDC);
+    bitmap_ = ::CreateCompatibleBitmap(windowDC, width, height);
+    oldBitmap_ = ::SelectObject(dc_, bitmap_);
+    width_ = width;
+    height_ = height;
+    return true;
+}
+
+void BackBuffer::release() {
+    if(dc_) {
+        ::SelectObject(dc_, oldBitmap_);
+        ::DeleteObject(bitmap_);
+        ::DeleteDC(dc_);
+        dc_ = NULL;
+        bitmap_ = NULL;
+        oldBitmap_ = NULL;
+    }
+    width_ = height_ = 0;
+}
+
+GdiPaintBackend::GdiPaintBackend(HDC windowDC, BackBuffer& buffer, HFONT font, bool immersive):
+    windowDC_(windowDC),
+    dc_(buffer.dc()),
+    oldFont_(::SelectObject(buffer.dc(), font)),
+    immersive_(immersive) {
+}
+
+GdiPaintBackend::~GdiPaintBackend() {
+    ::SelectObject(dc_, oldFont_);
+}
+
+// static
+COLORREF GdiPaintBackend::color(PaintColor color) {
+    ResourceCache& resources = gdiResources();
+    switch(color) {
+    case PaintColor::WINDOW_TEXT:
+        return resources.systemColor(COLOR_WINDOWTEXT);
+    case PaintColor::SEL_KEY:
+        // FIXME: make the color of strings configurable.
+        return RGB(0, 0, 255);
+    case PaintColor::HIGHLIGHT:
+        return resources.systemColor(COLOR_HIGHLIGHT);
+    case PaintColor::HIGHLIGHT_TEXT:
+        return resources.systemColor(COLOR_HIGHLIGHTTEXT);
+    case PaintColor::WINDOW:
+    default:
+        return resources.systemColor(COLOR_WINDOW);
+    }
+}
+
+void GdiPaintBackend::drawFrame(const PaintRect& rect) {
+    RECT rc = {rect.left, rect.top, rect.right, rect.bottom};
+    ::FillSolidRect(dc_, &rc, color(PaintColor::WINDOW));
+    // draw a flat black border in Windows 8 app immersive mode
+    // draw a 3d border in desktop mode
+    if(immersive_) {
+        HPEN pen = (HPEN)gdiResources().pen(RGB(0, 0, 0), 3, dpiOf(dc_));
+        HGDIOBJ oldPen = ::SelectObject(dc_, pen);
+        HGDIOBJ oldBrush = ::SelectObject(dc_, ::GetStockObject(NULL_BRUSH));
+        ::Rectangle(dc_, rc.left, rc.top, rc.right, rc.bottom);
+        ::SelectObject(dc_, oldBrush);
+        ::SelectObject(dc_, oldPen);
+    }
+    else {
+        ::Draw3DBorder(dc_, &rc, gdiResources().systemColor(COLOR_3DFACE), 0);
+    }
+}
+
+void GdiPaintBackend::drawText(const PaintRect& rect, std::wstring_view text, PaintColor textColor, PaintColor bkColor) {
+    RECT rc = {rect.left, rect.top, rect.right, rect.bottom};
+    ::SetTextColor(dc_, color(textColor));
+    ::SetBkColor(dc_, color(bkColor));
+    ::ExtTextOutW(dc_, rc.left, rc.top, ETO_OPAQUE, &rc, text.data(), UINT(text.length()), NULL);
+}
+
+void GdiPaintBackend::present(const PaintRect& rect) {
+    ::BitBlt(windowDC_, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
+        dc_, rect.left, rect.top, SRCCOPY);
+}
+
+} // namespace Ime
@@ -0,0 +1,73 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_GDI_PAINT_BACKEND_H
+#define IME_GDI_PAINT_BACKEND_H
+
+#include <windows.h>
+#include "PaintBackend.h"
+
+namespace Ime {
+
+// an off-screen bitmap kept by a window between WM_PAINT messages.
+class BackBuffer {
+public:
+    BackBuffer();
+    ~BackBuffer();
+
+    // (re)create the bitmap if its size is different.
+    // return true if a new bitmap is created, whose content needs to be painted again.
+    bool ensureSize(HDC windowDC, int width, int height);
+
+    void release();
+
+    HDC dc() const {
+        return dc_;
+    }
+
+private:
+    HDC dc_;
+    HBITMAP bitmap_;
+    HGDIOBJ oldBitmap_;
+    int width_;
+    int height_;
+};
+
+// draw to a back buffer with GDI and copy it to the window DC.
+class GdiPaintBackend: public PaintBackend {
+public:
+    GdiPaintBackend(HDC windowDC, BackBuffer& buffer, HFONT font, bool immersive);
+    ~GdiPaintBackend();
+
+    void drawFrame(const PaintRect& rect) override;
+    void drawText(const PaintRect& rect, std::wstring_view text, PaintColor textColor, PaintColor bkColor) override;
+    void present(const PaintRect& rect) override;
+
+    static COLORREF color(PaintColor color);
+
+private:
+    HDC windowDC_;
+    HDC dc_;
+    HGDIOBJ oldFont_;
+    bool immersive_;
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "GdiResources.h"
+
+namespace Ime {
+
+void* Win32ResourceFactory::create(const ResourceKey& key) {
+    // The width is not scaled by the DPI: callers such as Draw3DBorder()
+    // offset their lines by the same width.
+    switch(key.kind) {
+    case RESOURCE_PEN:
+        return ::CreatePen(PS_SOLID, key.width, key.color);
+    case RESOURCE_INSIDE_FRAME_PEN:
+        return ::CreatePen(PS_SOLID|PS_INSIDEFRAME, key.width, key.color);
+    case RESOURCE_BRUSH:
+        return ::CreateSolidBrush(key.color);
+    }
+    return NULL;
+}
+
+void Win32ResourceFactory::destroy(void* resource) {
+    ::DeleteObject((HGDIOBJ)resource);
+}
+
+uint32_t Win32ResourceFactory::systemColor(int index) {
+    return ::GetSysColor(index);
+}
+
+ResourceCache& gdiResources() {
+    static thread_local ResourceCache cache(std::unique_ptr<ResourceFactory>(new Win32ResourceFactory()));
+    return cache;
+}
+
+int dpiOf(HDC dc) {
+    int dpi = ::GetDeviceCaps(dc, LOGPIXELSY);
+    return dpi > 0 ? dpi : 96;
+}
+
+} // namespace Ime
@@ -0,0 +1,43 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_GDI_RESOURCES_H
+#define IME_GDI_RESOURCES_H
+
+#include <windows.h>
+#include "ResourceCache.h"
+
+namespace Ime {
+
+class Win32ResourceFactory: public ResourceFactory {
+public:
+    void* create(const ResourceKey& key) override;
+    void destroy(void* resource) override;
+    uint32_t systemColor(int index) override;
+};
+
+// the GDI resource cache of the calling thread
+ResourceCache& gdiResources();
+
+// the DPI of the device context, for ResourceKey
+int dpiOf(HDC dc);
+
+}
+
+#endif
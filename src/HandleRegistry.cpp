@@ -0,0 +1,95 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "HandleRegistry.h"
+
+namespace Ime {
+
+static const size_t minCapacity = 16;
+
+HandleRegistry::HandleRegistry():
+    slots_(minCapacity, Slot{nullptr, nullptr}),
+    mask_(minCapacity - 1),
+    size_(0) {
+}
+
+// static
+HandleRegistry& HandleRegistry::forCurrentThread() {
+    static thread_local HandleRegistry registry;
+    return registry;
+}
+
+void HandleRegistry::insert(const void* handle, void* object) {
+    if(!handle)
+        return;
+    // keep the load factor below 1/2
+    if((size_ + 1) * 2 > slots_.size())
+        rehash(slots_.size() * 2);
+    for(size_t i = slotOf(handle);; i = (i + 1) & mask_) {
+        Slot& slot = slots_[i];
+        if(slot.handle == handle) {
+            slot.object = object;
+            return;
+        }
+        if(!slot.handle) {
+            slot.handle = handle;
+            slot.object = object;
+            ++size_;
+            return;
+        }
+    }
+}
+
+bool HandleRegistry::erase(const void* handle) {
+    if(size_ == 0 || !handle)
+        return false;
+    size_t i = slotOf(handle);
+    for(;; i = (i + 1) & mask_) {
+        if(slots_[i].handle == handle)
+            break;
+        if(!slots_[i].handle)
+            return false;
+    }
+    // shift the following entries of the probe sequence back into the hole
+    for(size_t j = (i + 1) & mask_; slots_[j].handle; j = (j + 1) & mask_) {
+        size_t home = slotOf(slots_[j].handle);
+        // the entry can move if its home slot is not in (i, j] cyclically
+        bool canMove = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if(canMove) {
+            slots_[i] = slots_[j];
+            i = j;
+        }
+    }
+    slots_[i] = Slot{nullptr, nullptr};
+    --size_;
+    return true;
+}
+
+void HandleRegistry::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{nullptr, nullptr});
+    old.swap(slots_);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for(const Slot& slot: old) {
+        if(slot.handle)
+            insert(slot.handle, slot.object);
+    }
+}
+
+} // namespace Ime
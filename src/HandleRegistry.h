@@ -0,0 +1,95 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_HANDLE_REGISTRY_H
+#define IME_HANDLE_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Ime {
+
+// Maps handles (such as HWND) to objects with an open addressing hash table.
+// Lookups never insert, and erasing uses backward shifting, so there are no
+// tombstones making lookups slower over time.
+// A registry is not synchronized. Windows only receive messages on the thread
+// which created them, so each thread uses its own, see forCurrentThread().
+class HandleRegistry {
+public:
+    HandleRegistry();
+
+    // the registry of the calling thread
+    static HandleRegistry& forCurrentThread();
+
+    // associate the handle with the object, replacing the old one if any.
+    // null handles are not allowed.
+    void insert(const void* handle, void* object);
+
+    // the object associated with the handle, or nullptr.
+    void* find(const void* handle) const {
+        if(size_ == 0 || !handle)
+            return nullptr;
+        for(size_t i = slotOf(handle);; i = (i + 1) & mask_) {
+            const Slot& slot = slots_[i];
+            if(slot.handle == handle)
+                return slot.object;
+            if(!slot.handle)
+                return nullptr;
+        }
+    }
+
+    // return false if the handle is not in the registry.
+    bool erase(const void* handle);
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t capacity() const {
+        return slots_.size();
+    }
+
+private:
+    struct Slot {
+        const void* handle;
+        void* object;
+    };
+
+    size_t slotOf(const void* handle) const {
+        // Fibonacci hashing, handles are usually aligned so the low bits alone are poor.
+        uint64_t h = uint64_t(reinterpret_cast<uintptr_t>(handle)) * 0x9e3779b97f4a7c15ULL;
+        return size_t(h >> 32) & mask_;
+    }
+
+    void rehash(size_t capacity);
+
+private:
+    std::vector<Slot> slots_;  // the size is always a power of 2
+    size_t mask_;
+    size_t size_;
+};
+
+}
+
+#endif
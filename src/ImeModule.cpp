@@ -31,6 +31,8 @@
 #include "Window.h"
 #include "TextService.h"
 #include "DisplayAttributeProvider.h"
+#include "RegistrationPlan.h"
+#include "WinRegistryBackend.h"
 
 using namespace std;
 
@@ -55,29 +57,69 @@ static const GUID g_inputDisplayAttributeGuid =
 
 
 // {E1270AA5-A6B1-4112-9AC7-F5E476C3BD63}
-// static const GUID g_convertedDisplayAttributeGuid = 
-// { 0xe1270aa5, 0xa6b1, 0x4112, { 0x9a, 0xc7, 0xf5, 0xe4, 0x76, 0xc3, 0xbd, 0x63 } };
+static const GUID g_convertedDisplayAttributeGuid = 
+{ 0xe1270aa5, 0xa6b1, 0x4112, { 0x9a, 0xc7, 0xf5, 0xe4, 0x76, 0xc3, 0xbd, 0x63 } };
+
+// {6B5C8E0F-3D2A-4F71-9E4B-21C8A7D05F36}
+static const GUID g_targetDisplayAttributeGuid = 
+{ 0x6b5c8e0f, 0x3d2a, 0x4f71, { 0x9e, 0x4b, 0x21, 0xc8, 0xa7, 0xd0, 0x5f, 0x36 } };
 
 // refCountMutex needs to be static because it may be accessed after Release() calls the destructor.
 std::mutex ImeModule::refCountMutex_;
 
 ImeModule::ImeModule(HMODULE module, const CLSID& textServiceClsid):
     hInstance_(HINSTANCE(module)),
-    textServiceClsid_(textServiceClsid) {
+    textServiceClsid_(textServiceClsid),
+    initStats_{},
+    attribsRegistered_(false) {
+    // nothing else is done here, see initialize().
+}
+
+// called by ensureInitialized() once, or again if it failed.
+bool ImeModule::initialize() {
+    auto start = std::chrono::steady_clock::now();
 
     Window::registerClass(hInstance_);
 
     // regiser default display attributes
-    inputAttrib_ = ComPtr<DisplayAttributeInfo>::make(g_inputDisplayAttributeGuid);
-    inputAttrib_->setTextSysColor(COLOR_WINDOWTEXT);
-    inputAttrib_->setBackgroundSysColor(COLOR_WINDOW);
-    inputAttrib_->setLineStyle(TF_LS_DOT);
-    inputAttrib_->setLineSysColor(COLOR_WINDOWTEXT);
-    displayAttrInfos_.push_back(inputAttrib_);
-    // convertedAttrib_ = new DisplayAttributeInfo(g_convertedDisplayAttributeGuid);
-    // displayAttrInfos_.push_back(convertedAttrib_);
-
-    registerDisplayAttributeInfos();
+    if(!inputAttrib_) {
+        inputAttrib_ = ComPtr<DisplayAttributeInfo>::make(g_inputDisplayAttributeGuid);
+        inputAttrib_->setTextSysColor(COLOR_WINDOWTEXT);
+        inputAttrib_->setBackgroundSysColor(COLOR_WINDOW);
+        inputAttrib_->setLineStyle(TF_LS_DOT);
+        inputAttrib_->setLineSysColor(COLOR_WINDOWTEXT);
+
+        convertedAttrib_ = ComPtr<DisplayAttributeInfo>::make(g_convertedDisplayAttributeGuid);
+        convertedAttrib_->setTextSysColor(COLOR_WINDOWTEXT);
+        convertedAttrib_->setBackgroundSysColor(COLOR_WINDOW);
+        convertedAttrib_->setLineStyle(TF_LS_SOLID);
+        convertedAttrib_->setLineSysColor(COLOR_WINDOWTEXT);
+        convertedAttrib_->setAttrInfo(TF_ATTR_CONVERTED);
+
+        targetAttrib_ = ComPtr<DisplayAttributeInfo>::make(g_targetDisplayAttributeGuid);
+        targetAttrib_->setTextSysColor(COLOR_HIGHLIGHTTEXT);
+        targetAttrib_->setBackgroundSysColor(COLOR_HIGHLIGHT);
+        targetAttrib_->setLineStyle(TF_LS_SOLID);
+        targetAttrib_->setLineSysColor(COLOR_HIGHLIGHTTEXT);
+        targetAttrib_->setLineBold(true);
+        targetAttrib_->setAttrInfo(TF_ATTR_TARGET_CONVERTED);
+    }
+
+    // the default attributes and the ones added before, in one batch
+    bool success;
+    {
+        std::lock_guard<std::mutex> lock(pendingAttribsMutex_);
+        std::vector<ComPtr<DisplayAttributeInfo>> attribs = {inputAttrib_, convertedAttrib_, targetAttrib_};
+        attribs.insert(attribs.end(), pendingAttribs_.begin(), pendingAttribs_.end());
+        success = registerAttributes(attribs.data(), attribs.size());
+        if(success) {
+            attribsRegistered_ = true;
+            pendingAttribs_.clear();
+        }
+    }
+
+    initStats_.initialization += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return success;
 }
 
 ImeModule::~ImeModule(void) {
@@ -102,145 +144,104 @@ HRESULT ImeModule::getClassObject(REFCLSID rclsid, REFIID riid, void **ppvObj) {
     return CLASS_E_CLASSNOTAVAILABLE;
 }
 
-#ifndef _WIN64  // only do this for the 32-bit version dll
-static void loadDefaultUserRegistry(const wchar_t* defaultUserRegKey) {
-    // The registry settings of all newly created users are based on the content of 
-    // "C:\Users\Default User\ntuser.dat", so we need to write our settings to this file so 
-    // the HKEY_CURRENT_USER key of newly created users can also contain our settings.
-    // In order to do this, we need to load the default "hive" to registry first.
-    // Reference: https://msdn.microsoft.com/zh-tw/library/windows/desktop/ms724889(v=vs.85).aspx
-    wchar_t *userProfilesDir = nullptr;
-    if (SUCCEEDED(::SHGetKnownFolderPath(FOLDERID_UserProfiles, 0, NULL, &userProfilesDir))) {
-        // get the path of the default ntuser.dat file
-        std::wstring defaultRegFile = userProfilesDir;
-        ::CoTaskMemFree(userProfilesDir);
-        defaultRegFile += L"\\Default User\\ntuser.dat";
-
-        // loading registry file requires special privileges SE_RESTORE_NAME and SE_BACKUP_NAME.
-        // So let's do privilege elevation for our process.
-        HANDLE processToken = NULL;
-        ::OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES, &processToken);
-        DWORD bufLen = sizeof(TOKEN_PRIVILEGES) + sizeof(LUID_AND_ATTRIBUTES);
-        std::unique_ptr<char> buf(new char[bufLen]);
-        TOKEN_PRIVILEGES* privileges = reinterpret_cast<TOKEN_PRIVILEGES*>(buf.get());
-        privileges->PrivilegeCount = 2;
-        ::LookupPrivilegeValue(NULL, SE_RESTORE_NAME, &privileges->Privileges[0].Luid);
-        privileges->Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
-        ::LookupPrivilegeValue(NULL, SE_BACKUP_NAME, &privileges->Privileges[1].Luid);
-        privileges->Privileges[1].Attributes = SE_PRIVILEGE_ENABLED;
-        ::AdjustTokenPrivileges(processToken, FALSE, privileges, bufLen, NULL, NULL);
-        ::CloseHandle(processToken);
-
-        // load the default registry hive under the specified key name
-        ::RegLoadKeyW(HKEY_USERS, defaultUserRegKey, defaultRegFile.c_str());
-    }
-}
-#endif  // #ifndef _WIN64
-
-HRESULT ImeModule::registerLangProfiles(LangProfileInfo* langs, int langsCount) {
-    // register the language profile
-    ComPtr<ITfInputProcessorProfiles> inputProcessProfiles;
-    if(CoCreateInstance(CLSID_TF_InputProcessorProfiles, NULL, CLSCTX_INPROC_SERVER, IID_ITfInputProcessorProfiles, (void**)&inputProcessProfiles) == S_OK) {
-        for(int i = 0; i < langsCount; ++i) {
-            LangProfileInfo& lang = langs[i];
-            if(inputProcessProfiles->Register(textServiceClsid_) == S_OK) {
-                LCID lcid = LocaleNameToLCID(lang.locale.c_str(), 0);
-                if (lcid == 0 && !lang.fallbackLocale.empty()) { // the conversion fails
-                    // The new RFC4646 locale names are not well-supported in Windows 7/Vista, so
-                    // here we provide a fallback locale which uses the deprecated RFC 1766 format instead.
-                    lcid = LocaleNameToLCID(lang.fallbackLocale.c_str(), 0);
-                }
-                if (lcid != 0) {
-                    LANGID langId = LANGIDFROMLCID(lcid);
-                    if (inputProcessProfiles->AddLanguageProfile(textServiceClsid_, langId, lang.profileGuid,
-                        lang.name.c_str(), lang.name.length(), lang.iconFile.empty() ? NULL : lang.iconFile.c_str(),
-                        lang.iconFile.length(), lang.iconIndex) != S_OK) {
-                        return E_FAIL;
-                    }
-                }
-                else {
-                    return E_FAIL;
-                }
-            }
-        }
-    }
+// name of the key the default user hive is loaded under while registering
+static const wchar_t defaultUserRegKey[] = L"__PIME_Default_user__";
 
-    // NOTE: For Windows newer than Windows 8, we have to manually write some settings
-    //       to the registry so the input methods can appear in the Windows control panel.
-    //
-    //       Registry path: "HKEY_CURRENT_USER\Control Panel\International\User Profile\<locale_name>"
-    //       Sub key: "<lang ID>:{text service GUID}{input module GUID}"
-    //
-    //       Unfortunately, this is not documented officially by Microsoft.
-    //       We found the values with some registry monitor tools:
-    //       These settings are user-specific so they should be written to HKEY_CURRENT_USER of all users.
-    //       This might be achieved by Microsoft Acitve Setup, yet another undocumented feature.
-    //       https://helgeklein.com/blog/2010/04/active-setup-explained/
-    //
-    //       However, there is no way to uninstall keys installed with Active Setup. So let's avoid it.
-    //       References: https://support.microsoft.com/en-us/kb/284193
-    //                   https://blogs.technet.microsoft.com/deploymentguys/2009/10/29/configuring-default-user-settings-full-update-for-windows-7-and-windows-server-2008-r2/
+// NOTE: For Windows newer than Windows 8, we have to manually write some settings
+//       to the registry so the input methods can appear in the Windows control panel.
+//
+//       Registry path: "HKEY_CURRENT_USER\Control Panel\International\User Profile\<locale_name>"
+//       Sub key: "<lang ID>:{text service GUID}{input module GUID}"
+//
+//       Unfortunately, this is not documented officially by Microsoft.
+//       We found the values with some registry monitor tools:
+//       These settings are user-specific so they should be written to HKEY_CURRENT_USER of all users.
+//       This might be achieved by Microsoft Acitve Setup, yet another undocumented feature.
+//       https://helgeklein.com/blog/2010/04/active-setup-explained/
+//
+//       However, there is no way to uninstall keys installed with Active Setup. So let's avoid it.
+//       References: https://support.microsoft.com/en-us/kb/284193
+//                   https://blogs.technet.microsoft.com/deploymentguys/2009/10/29/configuring-default-user-settings-full-update-for-windows-7-and-windows-server-2008-r2/
+static bool needUserProfiles() {
 #ifndef _WIN64  // only do this for the 32-bit version dll
     // The keys under HKCU\Control Panel\ is shared between the x86 and x64 versions and 
     // are not affected by WOW64 redirection. So doing this inside the 32-bit version is enough.
+    return ::IsWindows8OrGreater();
+#else
+    return false;
+#endif
+}
+
+bool ImeModule::registrationSpec(const wchar_t* imeName, LangProfileInfo* langs, int count, RegistrationSpec& spec) {
+    spec.clsid = WinRegistryBackend::guidString(textServiceClsid_);
+    if(imeName)
+        spec.name = imeName;
 
-    if (::IsWindows8OrGreater()) {
-        DWORD sidCount = 0;
-        if (::RegQueryInfoKeyW(HKEY_USERS, NULL, NULL, NULL, &sidCount, NULL, NULL, NULL, NULL, NULL, NULL, NULL) != ERROR_SUCCESS)
-            return E_FAIL;
-        wchar_t* textServiceClsIdStr = nullptr;
-        if (FAILED(::StringFromCLSID(textServiceClsid_, &textServiceClsIdStr)))
-            return E_FAIL;
-
-        const wchar_t* defaultUserRegKey = L"__PIME_Default_user__";
-        loadDefaultUserRegistry(defaultUserRegKey);
-
-        // write the language settings to user-specific registry.
-        wchar_t sid[256];
-        for (DWORD iSid = 0; iSid < sidCount; ++iSid) {
-            DWORD sidLen = sizeof(sid) / sizeof(wchar_t);
-            if (::RegEnumKeyExW(HKEY_USERS, iSid, sid, &sidLen, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                // write settings of each input module to the user's registry
-                for (int i = 0; i < langsCount; ++i) {
-                    auto& lang = langs[i];
-                    std::wstring localeRegPath = sid;
-                    localeRegPath += L"\\Control Panel\\International\\User Profile\\";
-                    localeRegPath += lang.locale;
-                    HKEY localeRegKey = NULL;
-                    DWORD err = ::RegCreateKeyExW(HKEY_USERS, localeRegPath.c_str(), 0, NULL, REG_OPTION_NON_VOLATILE, KEY_ALL_ACCESS, NULL, &localeRegKey, NULL);
-                    if (err == ERROR_SUCCESS) {
-                        LCID lcid = LocaleNameToLCID(lang.locale.c_str(), 0);
-                        if (lcid == 0 && !lang.fallbackLocale.empty()) { // the conversion fails
-                            lcid = LocaleNameToLCID(lang.fallbackLocale.c_str(), 0);  // try the fallback locale name
-                        }
-                        wchar_t lcid_hex[16];
-                        wsprintf(lcid_hex, L"%04x", lcid);
-                        std::wstring valueName = lcid_hex;
-                        valueName += L":";
-                        valueName += textServiceClsIdStr;
-                        wchar_t* profileClsIdStr = nullptr;
-                        if (SUCCEEDED(::StringFromCLSID(lang.profileGuid, &profileClsIdStr))) {
-                            valueName += profileClsIdStr;
-                            ::CoTaskMemFree(profileClsIdStr);
-                            DWORD profileCount = 1;
-                            if (::RegQueryInfoKeyW(localeRegKey, NULL, NULL, NULL, NULL, NULL, NULL, &profileCount, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                                // ::MessageBoxW(0, std::to_wstring(profileCount).c_str(), 0, 0);
-                                ++profileCount;
-                            }
-                            ::RegSetKeyValueW(localeRegKey, NULL, valueName.c_str(), REG_DWORD, &profileCount, sizeof(DWORD));
-                        }
-                        ::RegCloseKey(localeRegKey);
-                    }
-                }
-            }
+    // get path of our module
+    wchar_t modulePath[MAX_PATH];
+    DWORD modulePathLen = GetModuleFileNameW(hInstance_, modulePath, MAX_PATH);
+    spec.modulePath.assign(modulePath, modulePathLen);
+
+    for(int i = 0; i < count; ++i) {
+        LangProfileInfo& lang = langs[i];
+        LCID lcid = LocaleNameToLCID(lang.locale.c_str(), 0);
+        if (lcid == 0 && !lang.fallbackLocale.empty()) { // the conversion fails
+            // The new RFC4646 locale names are not well-supported in Windows 7/Vista, so
+            // here we provide a fallback locale which uses the deprecated RFC 1766 format instead.
+            lcid = LocaleNameToLCID(lang.fallbackLocale.c_str(), 0);
         }
-        ::CoTaskMemFree(textServiceClsIdStr);
+        if(lcid == 0)
+            return false;
+        LanguageProfile profile{LANGIDFROMLCID(lcid), WinRegistryBackend::guidString(lang.profileGuid), lang.name, lang.iconFile, lang.iconIndex};
+        spec.profiles.push_back(RegistrationProfile{profile, lang.locale});
+    }
 
-        // unload the default user registry hive
-        ::RegUnLoadKeyW(HKEY_USERS, defaultUserRegKey);
+    const GUID* categories[] = {
+        &GUID_TFCAT_TIP_KEYBOARD,
+        // register ourself as a display attribute provider
+        // so later we can set change the look and feels of composition string.
+        &GUID_TFCAT_DISPLAYATTRIBUTEPROVIDER,
+        // enable UI less mode
+        &GUID_TFCAT_TIPCAP_INPUTMODECOMPARTMENT,
+        &GUID_TFCAT_TIPCAP_UIELEMENTENABLED
+    };
+    for(auto category: categories) {
+        spec.categories.push_back(WinRegistryBackend::guidString(*category));
     }
-#endif  // #ifndef _WIN64
-    return S_OK;
+    // other categories of our text service are not unregistered, see RegistrationPlan::planCategories().
+    spec.knownCategories = spec.categories;
+    spec.knownCategories.push_back(WinRegistryBackend::guidString(GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT));
+    spec.knownCategories.push_back(WinRegistryBackend::guidString(GUID_TFCAT_TIPCAP_SYSTRAYSUPPORT));
+    if(::IsWindows8OrGreater()) {
+        // for Windows 8 store app support
+        // TODO: according to a exhaustive Google search, I found that
+        // TF_IPP_CAPS_IMMERSIVESUPPORT is required to make the IME work with Windows 8.
+        // http://social.msdn.microsoft.com/Forums/windowsapps/en-US/4c422cf1-ceb4-413b-8a7c-6881946a4c63/how-to-set-a-flag-indicating-tsf-components-compatibility
+        // Quote from the page: "To indicate that your IME is compatible with Windows Store apps, call RegisterCategory with GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT."
+
+        // declare supporting immersive mode
+        spec.categories.push_back(WinRegistryBackend::guidString(GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT));
+        // declare compatibility with Windows 8 system tray
+        spec.categories.push_back(WinRegistryBackend::guidString(GUID_TFCAT_TIPCAP_SYSTRAYSUPPORT));
+    }
+
+    spec.userProfiles = needUserProfiles();
+    return true;
+}
+
+// Only the differences between the current and the desired state are written,
+// so registering again for an upgrade does not rewrite everything for every user.
+// Profiles added to our text service by someone else are kept.
+HRESULT ImeModule::registerLangProfiles(LangProfileInfo* langs, int langsCount) {
+    RegistrationSpec spec;
+    if(!registrationSpec(nullptr, langs, langsCount, spec))
+        return E_FAIL;
+    WinRegistryBackend backend;
+    if(spec.userProfiles)
+        backend.loadDefaultUserHive(defaultUserRegKey);
+    RegistrationPlan plan(backend);
+    plan.planProfiles(spec);
+    return plan.apply() ? S_OK : E_FAIL;
 }
 
 HRESULT ImeModule::registerServer(wchar_t* imeName, LangProfileInfo* langs, int count) {
@@ -252,209 +253,62 @@ HRESULT ImeModule::registerServer(wchar_t* imeName, LangProfileInfo* langs, int
     // a different path to make it coexist with 32 bit version:
     // HKEY_LOCAL_MACHINE\SOFTWARE\Wow6432Node\Classes\CLSID\{xxx-xxx-...}
     // Reference: http://stackoverflow.com/questions/1105031/can-my-32-bit-and-64-bit-com-components-co-reside-on-the-same-machine
-
-    HRESULT result = S_OK;
-
-    // get path of our module
-    wchar_t modulePath[MAX_PATH];
-    DWORD modulePathLen = GetModuleFileNameW(hInstance_, modulePath, MAX_PATH);
-
-    wstring regPath = L"CLSID\\";
-    LPOLESTR clsidStr = NULL;
-    if(StringFromCLSID(textServiceClsid_, &clsidStr) != ERROR_SUCCESS)
+    RegistrationSpec spec;
+    if(!registrationSpec(imeName, langs, count, spec))
         return E_FAIL;
-    regPath += clsidStr;
-    CoTaskMemFree(clsidStr);
-
-    HKEY hkey = NULL;
-    if(::RegCreateKeyExW(HKEY_CLASSES_ROOT, regPath.c_str(), 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hkey, NULL) == ERROR_SUCCESS) {
-        // write name of our IME
-        ::RegSetValueExW(hkey, NULL, 0, REG_SZ, (BYTE*)imeName, sizeof(wchar_t) * (wcslen(imeName) + 1));
-
-        HKEY inProcServer32Key;
-        if(::RegCreateKeyExW(hkey, L"InprocServer32", 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &inProcServer32Key, NULL) == ERROR_SUCCESS) {
-            // store the path of our dll module in the registry
-            ::RegSetValueExW(inProcServer32Key, NULL, 0, REG_SZ, (BYTE*)modulePath, (modulePathLen + 1) * sizeof(wchar_t));
-            // write threading model
-            wchar_t apartmentStr[] = L"Apartment";
-            ::RegSetValueExW(inProcServer32Key, L"ThreadingModel", 0, REG_SZ, (BYTE*)apartmentStr, 10 * sizeof(wchar_t));
-            ::RegCloseKey(inProcServer32Key);
-        }
-        else
-            result = E_FAIL;
-        ::RegCloseKey(hkey);
-    }
-    else
-        result = E_FAIL;
-
-    // register language profiles
-    if(result == S_OK) {
-        result = registerLangProfiles(langs, count);
-    }
-
-    // register category
-    if(result == S_OK) {
-        ITfCategoryMgr *categoryMgr = NULL;
-        if(CoCreateInstance(CLSID_TF_CategoryMgr, NULL, CLSCTX_INPROC_SERVER, IID_ITfCategoryMgr, (void**)&categoryMgr) == S_OK) {
-            if(categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIP_KEYBOARD, textServiceClsid_) != S_OK) {
-                result = E_FAIL;
-            }
-
-            // register ourself as a display attribute provider
-            // so later we can set change the look and feels of composition string.
-            if(categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_DISPLAYATTRIBUTEPROVIDER, textServiceClsid_) != S_OK) {
-                result = E_FAIL;
-            }
-
-            // enable UI less mode
-            if(categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_INPUTMODECOMPARTMENT, textServiceClsid_) != S_OK ||
-                categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_UIELEMENTENABLED, textServiceClsid_) != S_OK) {
-                result  = E_FAIL;
-            }
-
-            if(::IsWindows8OrGreater()) {
-                // for Windows 8 store app support
-                // TODO: according to a exhaustive Google search, I found that
-                // TF_IPP_CAPS_IMMERSIVESUPPORT is required to make the IME work with Windows 8.
-                // http://social.msdn.microsoft.com/Forums/windowsapps/en-US/4c422cf1-ceb4-413b-8a7c-6881946a4c63/how-to-set-a-flag-indicating-tsf-components-compatibility
-                // Quote from the page: "To indicate that your IME is compatible with Windows Store apps, call RegisterCategory with GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT."
-
-                // declare supporting immersive mode
-                if(categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT, textServiceClsid_) != S_OK) {
-                    result = E_FAIL;
-                }
-
-                // declare compatibility with Windows 8 system tray
-                if(categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_SYSTRAYSUPPORT, textServiceClsid_) != S_OK) {
-                    result = E_FAIL;
-                }
-            }
-
-            categoryMgr->Release();
-        }
-    }
-    return result;
+    WinRegistryBackend backend;
+    if(spec.userProfiles)
+        backend.loadDefaultUserHive(defaultUserRegKey);
+    RegistrationPlan plan(backend);
+    plan.planRegister(spec);
+    return plan.apply() ? S_OK : E_FAIL;
 }
 
 HRESULT ImeModule::unregisterServer() {
-    // unregister the language profile
-    ITfInputProcessorProfiles *inputProcessProfiles = NULL;
-    if(CoCreateInstance(CLSID_TF_InputProcessorProfiles, NULL, CLSCTX_INPROC_SERVER, IID_ITfInputProcessorProfiles, (void**)&inputProcessProfiles) == S_OK) {
-        inputProcessProfiles->Unregister(textServiceClsid_);
-        inputProcessProfiles->Release();
-    }
-
-    // unregister categories
-    ITfCategoryMgr *categoryMgr = NULL;
-    if(CoCreateInstance(CLSID_TF_CategoryMgr, NULL, CLSCTX_INPROC_SERVER, IID_ITfCategoryMgr, (void**)&categoryMgr) == S_OK) {
-        categoryMgr->UnregisterCategory(textServiceClsid_, GUID_TFCAT_TIP_KEYBOARD, textServiceClsid_);
-        categoryMgr->UnregisterCategory(textServiceClsid_, GUID_TFCAT_DISPLAYATTRIBUTEPROVIDER, textServiceClsid_);
-        // UI less mode
-        categoryMgr->UnregisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_INPUTMODECOMPARTMENT, textServiceClsid_);
-
-        if(::IsWindows8OrGreater()) {
-            // Windows 8 support
-            categoryMgr->UnregisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_IMMERSIVESUPPORT, textServiceClsid_);
-            categoryMgr->RegisterCategory(textServiceClsid_, GUID_TFCAT_TIPCAP_SYSTRAYSUPPORT, textServiceClsid_);
-        }
-
-        categoryMgr->Release();
-    }
-
-    // delete the registry key
-    wstring regPath = L"CLSID\\";
-    LPOLESTR clsidStr = NULL;
-    if(StringFromCLSID(textServiceClsid_, &clsidStr) == ERROR_SUCCESS) {
-        regPath += clsidStr;
-        CoTaskMemFree(clsidStr);
-        ::SHDeleteKey(HKEY_CLASSES_ROOT, regPath.c_str());
-    }
-
-#ifndef _WIN64  // only do this for the 32-bit version dll
-    // The keys under HKCU\Control Panel\ is shared between the x86 and x64 versions and 
-    // are not affected by WOW64 redirection. So doing this inside the 32-bit version is enough.
-
-    // delete settings under "HKEY_CURRENT_USER\Control Panel\International\User Profile\<locale_name>" for all users
-    if (::IsWindows8OrGreater()) {
-        DWORD sidCount = 0;
-        if (::RegQueryInfoKeyW(HKEY_USERS, NULL, NULL, NULL, &sidCount, NULL, NULL, NULL, NULL, NULL, NULL, NULL) != ERROR_SUCCESS)
-            return E_FAIL;
-        wchar_t* textServiceClsIdStr = nullptr;
-        if (FAILED(::StringFromCLSID(textServiceClsid_, &textServiceClsIdStr)))
-            return E_FAIL;
-
-        const wchar_t* defaultUserRegKey = L"__PIME_Default_user__";
-        loadDefaultUserRegistry(defaultUserRegKey);
-
-        // delete the language settings from user-specific registry.
-        wchar_t sid[256];
-        for (DWORD iSid = 0; iSid < sidCount; ++iSid) {
-            DWORD sidLen = sizeof(sid) / sizeof(wchar_t);
-            if (::RegEnumKeyExW(HKEY_USERS, iSid, sid, &sidLen, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                // remove settings of each input module to the user's registry
-                std::wstring userRegPath = sid;
-                userRegPath += L"\\Control Panel\\International\\User Profile";
-                HKEY userKey = NULL;
-                if (::RegOpenKeyExW(HKEY_USERS, userRegPath.c_str(), 0, KEY_READ, &userKey) == ERROR_SUCCESS) {
-                    DWORD localeCount = 0;
-                    if (::RegQueryInfoKeyW(userKey, NULL, NULL, NULL, &localeCount, NULL, NULL, NULL, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                        // list all locales under this user
-                        wchar_t locale[100];
-                        for (DWORD iLocale = 0; iLocale < localeCount; ++iLocale) {
-                            DWORD localeLen = sizeof(locale) / sizeof(wchar_t);
-                            if (::RegEnumKeyExW(userKey, iLocale, locale, &localeLen, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                                HKEY localeKey = NULL;
-                                if (::RegOpenKeyExW(userKey, locale, 0, KEY_ALL_ACCESS | KEY_READ, &localeKey) == ERROR_SUCCESS) {
-                                    DWORD profileCount = 0;
-                                    ::RegQueryInfoKeyW(localeKey, NULL, NULL, NULL, NULL, NULL, NULL, &profileCount, NULL, NULL, NULL, NULL);
-                                    // list all language profiles under this locale
-                                    std::vector<std::wstring> profiles;
-                                    for (DWORD iProfile = 0; iProfile < profileCount; ++iProfile) {
-                                        wchar_t profile[128];
-                                        DWORD profileLen = sizeof(profile) / sizeof(wchar_t);
-                                        if (::RegEnumValueW(localeKey, iProfile, profile, &profileLen, 0, NULL, NULL, NULL) == ERROR_SUCCESS) {
-                                            if (wcsstr(profile, textServiceClsIdStr)) {  // this profile is registered by us
-                                                profiles.push_back(profile);
-                                            }
-                                        }
-                                    }
-                                    // delete these language profiles beloning to us
-                                    for (const auto& profile : profiles) {
-                                        ::RegDeleteValueW(localeKey, profile.c_str());
-                                    }
-                                    ::RegCloseKey(localeKey);
-                                }
-                            }
-                        }
-                    }
-                    ::RegCloseKey(userKey);
-                }
-            }
-        }
-        ::CoTaskMemFree(textServiceClsIdStr);
-
-        // unload the default user registry hive
-        ::RegUnLoadKeyW(HKEY_USERS, defaultUserRegKey);
-    }
-#endif // #ifndef _WIN64
+    // unregister the language profiles and categories, delete the registry key,
+    // and delete the profiles from "HKEY_CURRENT_USER\Control Panel\International\User Profile\<locale_name>" of all users
+    bool userProfiles = needUserProfiles();
+    WinRegistryBackend backend;
+    if(userProfiles)
+        backend.loadDefaultUserHive(defaultUserRegKey);
+    RegistrationPlan plan(backend);
+    plan.planUnregister(WinRegistryBackend::guidString(textServiceClsid_), userProfiles);
+    plan.apply();
     return S_OK;
 }
 
 
 // display attributes stuff
-bool ImeModule::registerDisplayAttributeInfos() {
+bool ImeModule::addDisplayAttributeInfos(const ComPtr<DisplayAttributeInfo>* infos, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(pendingAttribsMutex_);
+        if(!attribsRegistered_) {
+            // registered by initialize()
+            pendingAttribs_.insert(pendingAttribs_.end(), infos, infos + count);
+            return true;
+        }
+    }
+    return registerAttributes(infos, count);
+}
 
-    // register display attributes
+bool ImeModule::registerAttributes(const ComPtr<DisplayAttributeInfo>* infos, size_t count) {
+    // register all the GUIDs with a single category manager before publishing them,
+    // so text services never see an attribute without its atom.
     ComPtr<ITfCategoryMgr> categoryMgr;
-    if(::CoCreateInstance(CLSID_TF_CategoryMgr, NULL, CLSCTX_INPROC_SERVER, IID_ITfCategoryMgr, (void**)&categoryMgr) == S_OK) {
-        TfGuidAtom atom;
-        categoryMgr->RegisterGUID(g_inputDisplayAttributeGuid, &atom);
-        inputAttrib_->setAtom(atom);
-        // categoryMgr->RegisterGUID(g_convertedDisplayAttributeGuid, &atom);
-        // convertedAttrib_->setAtom(atom);
-        return true;
+    if(::CoCreateInstance(CLSID_TF_CategoryMgr, NULL, CLSCTX_INPROC_SERVER, IID_ITfCategoryMgr, (void**)&categoryMgr) != S_OK)
+        return false;
+    std::vector<DisplayAttributeInfos::Entry> entries;
+    entries.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        auto& info = infos[i];
+        TfGuidAtom atom = TF_INVALID_GUIDATOM;
+        if(categoryMgr->RegisterGUID(info->guid(), &atom) != S_OK)
+            return false;
+        info->setAtom(atom);
+        entries.push_back(DisplayAttributeInfos::Entry{AttributeGuid::from(info->guid()), info});
     }
-    return false;
+    displayAttrInfos_.addAll(std::move(entries));
+    return true;
 }
 
 
@@ -488,6 +342,8 @@ STDMETHODIMP_(ULONG) ImeModule::Release(void) {
 // IClassFactory
 STDMETHODIMP ImeModule::CreateInstance(IUnknown *pUnkOuter, REFIID riid, void **ppvObj) {
     *ppvObj = NULL;
+    if(!ensureInitialized())
+        return E_FAIL;
     if(::IsEqualIID(riid, IID_ITfDisplayAttributeProvider)) {
         auto provider = ComPtr<DisplayAttributeProvider>::make(this);
         if(provider) {
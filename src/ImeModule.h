@@ -24,17 +24,27 @@
 #include <Windows.h>
 
 #include <Ctffunc.h>
+#include <cassert>
 #include <string>
-#include <list>
 #include "ComPtr.h"
 #include "ComObject.h"
+#include "DictionaryService.h"
+#include "DisplayAttributeRegistry.h"
+#include "EngineData.h"
+#include "OnceInit.h"
+#include "RegistrationPlan.h"
+#include <chrono>
+#include <list>
 #include <mutex>
+#include <vector>
 
 namespace Ime {
 
 class TextService;
 class DisplayAttributeInfo;
 
+typedef DisplayAttributeRegistry<ComPtr<DisplayAttributeInfo>> DisplayAttributeInfos;
+
 // language profile info, used to register new language profiles
 struct LangProfileInfo {
     std::wstring name; // should not exceed 32 chars
@@ -76,22 +86,85 @@ public:
     // called when config dialog needs to be launched
     virtual bool onConfigure(HWND hwndParent, LANGID langid, REFGUID rguidProfile);
 
-    // display attributes for composition string
-    std::list<ComPtr<DisplayAttributeInfo>>& displayAttrInfos() {
+    // The DLL is loaded into almost every GUI process, but the IME is only used in a few of them.
+    // So registering the window class and the display attributes is done when the first
+    // text service is created instead of in the constructor. Thread safe.
+    // return false if the initialization failed, it's retried by the next call.
+    // CreateInstance() calls it, so text services and display attribute providers
+    // only exist once the module is initialized.
+    bool ensureInitialized() {
+        return initOnce_.run([this]() { return initialize(); });
+    }
+
+    // time spent in the deferred initialization, including the failed attempts.
+    // This used to be done by the constructor, see bench/ImeModule_bench.cpp for both costs.
+    struct InitStats {
+        std::chrono::microseconds initialization;
+    };
+
+    const InitStats& initStats() const {
+        return initStats_;
+    }
+
+    // compiled dictionaries shared by all the text services, and by all the processes using them.
+    DictionaryService& dictionaries() {
+        return dictionaries_;
+    }
+
+    // immutable engine data shared by the text services of all UI threads.
+    // Each text service reads it without locking, see TextService::engineData().
+    EngineDataStore& engineData() {
+        return engineData_;
+    }
+
+    // display attributes for composition string, thread safe.
+    // Attributes added before the module is initialized are only listed once it is.
+    DisplayAttributeInfos& displayAttrInfos() {
         return displayAttrInfos_;
     }
 
-    bool registerDisplayAttributeInfos();
+    // Deprecated, use displayAttrInfos() which used to return this list: this copies
+    // the attributes registered so far. The copy is const since adding to it would do
+    // nothing, add attributes with addDisplayAttributeInfos() instead.
+    const std::list<ComPtr<DisplayAttributeInfo>> displayAttrInfoList() {
+        std::list<ComPtr<DisplayAttributeInfo>> result;
+        auto snapshot = displayAttrInfos().snapshot();
+        for(auto& entry: snapshot->entries)
+            result.push_back(entry.info);
+        return result;
+    }
 
+    // add display attributes and register their GUIDs with TSF.
+    // Before the module is initialized, e.g. in the constructor of a subclass, the
+    // attributes are kept and registered by ensureInitialized() with the default ones,
+    // so no COM object is created when the DLL is loaded. Thread safe.
+    // return false if the registration failed.
+    bool addDisplayAttributeInfos(const ComPtr<DisplayAttributeInfo>* infos, size_t count);
+
+    // Deprecated, attributes are registered by addDisplayAttributeInfos() now.
+    // This registers the default attributes, and the ones added so far, with the
+    // batch of ensureInitialized().
+    bool registerDisplayAttributeInfos() {
+        return ensureInitialized();
+    }
+
+    // display attributes of the input, converted and target (selected for conversion) clauses.
+    // They are called on every key, so they do not initialize the module but require
+    // ensureInitialized() to have succeeded.
     DisplayAttributeInfo* inputAttrib() {
+        assert(initOnce_.done());
         return inputAttrib_;
     }
 
-    /*
     DisplayAttributeInfo* convertedAttrib() {
+        assert(initOnce_.done());
         return convertedAttrib_;
     }
-    */
+
+    DisplayAttributeInfo* targetAttrib() {
+        assert(initOnce_.done());
+        return targetAttrib_;
+    }
 
     // COM-related stuff
 
@@ -113,16 +186,34 @@ protected:
 protected: // COM object should not be deleted directly. calling Release() instead.
     virtual ~ImeModule(void);
 
+private:
+    bool initialize();
+
+    // register the GUIDs with a single category manager and publish the attributes.
+    bool registerAttributes(const ComPtr<DisplayAttributeInfo>* infos, size_t count);
+
+    // the desired registration state, compared with the current one by RegistrationPlan
+    bool registrationSpec(const wchar_t* imeName, LangProfileInfo* langs, int count, RegistrationSpec& spec);
+
 private:
     // refCountMutex needs to be static because it may be accessed after Release() calls the destructor.
     static std::mutex refCountMutex_;
     HINSTANCE hInstance_;
     CLSID textServiceClsid_;
+    OnceInit initOnce_;
+    InitStats initStats_;
+    DictionaryService dictionaries_;
+    EngineDataStore engineData_;
 
     // display attributes
-    std::list< ComPtr<DisplayAttributeInfo>> displayAttrInfos_;
+    DisplayAttributeInfos displayAttrInfos_;
+    // added before the initialization, protected by pendingAttribsMutex_
+    std::mutex pendingAttribsMutex_;
+    std::vector<ComPtr<DisplayAttributeInfo>> pendingAttribs_;
+    bool attribsRegistered_;
     ComPtr<DisplayAttributeInfo> inputAttrib_;
-    // DisplayAttributeInfo* convertedAttrib_;
+    ComPtr<DisplayAttributeInfo> convertedAttrib_;
+    ComPtr<DisplayAttributeInfo> targetAttrib_;
 };
 
 }
@@ -18,11 +18,54 @@
 //
 
 #include "ImeWindow.h"
+#include "GdiResources.h"
+
+#include <cstddef>
+#include <cstring>
+#include <cwchar>
 
 namespace Ime {
 
+WindowTextMeasurer::WindowTextMeasurer(HWND hwnd, HFONT font):
+    hwnd_(hwnd),
+    font_(font),
+    dc_(NULL),
+    oldFont_(NULL) {
+}
+
+WindowTextMeasurer::~WindowTextMeasurer() {
+    if(dc_) {
+        ::SelectObject(dc_, oldFont_);
+        ::ReleaseDC(hwnd_, dc_);
+    }
+}
+
+HDC WindowTextMeasurer::dc() {
+    if(!dc_) {
+        dc_ = ::GetDC(hwnd_);
+        oldFont_ = ::SelectObject(dc_, font_);
+    }
+    return dc_;
+}
+
+TextExtent WindowTextMeasurer::measure(const wchar_t* str, size_t len) {
+    SIZE size = {0};
+    ::GetTextExtentPoint32W(dc(), str, int(len), &size);
+    return TextExtent{size.cx, size.cy};
+}
+
+bool WindowTextMeasurer::charAdvances(wchar_t first, wchar_t last, int* advances) {
+    return ::GetCharWidth32W(dc(), first, last, advances) != FALSE;
+}
+
 ImeWindow::ImeWindow(TextService* service):
-    textService_(service) {
+    textService_(service),
+    pool_(service->windowPool()),
+    scheduler_(service->updateScheduler()),
+    needsLayout_(false),
+    hasPendingMove_(false),
+    pendingPos_{0, 0},
+    lastPaintGdiCreations_(0) {
 
     if(service->isImmersive()) { // windows 8 app mode
         margin_ = 10;
@@ -42,6 +85,45 @@ ImeWindow::ImeWindow(TextService* service):
 }
 
 ImeWindow::~ImeWindow(void) {
+    if(scheduler_)
+        scheduler_->cancel(this);
+    if(pool_ && hwnd_) {
+        // give the window, its font and measurements back to the pool for the next composition
+        PooledWindow window;
+        window.window = detach();
+        window.font = font_;
+        window.extents = std::move(extentCache_);
+        pool_->release(std::move(window));
+    }
+}
+
+bool ImeWindow::createWindow(HWND parent) {
+    if(!pool_)
+        return create(parent, WS_POPUP|WS_CLIPCHILDREN, WS_EX_TOOLWINDOW|WS_EX_TOPMOST);
+    PooledWindow window = pool_->acquire(parent);
+    attach((HWND)window.window);
+    if(window.font) { // reuse the font of the last user, setFont() keeps it if it's the same
+        font_ = (HFONT)window.font;
+        extentCache_ = std::move(window.extents);
+    }
+    return hwnd_ != NULL;
+}
+
+// virtual
+LRESULT ImeWindow::wndProc(UINT msg, WPARAM wp, LPARAM lp) {
+    switch(msg) {
+    case WM_SYSCOLORCHANGE:
+        // every top level window gets it, forgetting the colors more than once is harmless
+        gdiResources().onSystemColorsChanged();
+        scheduleUpdate(UPDATE_PAINT);
+        break;
+    case WM_DPICHANGED:
+        gdiResources().onDpiChanged();
+        extentCache_.clear();
+        scheduleUpdate(UPDATE_LAYOUT);
+        break;
+    }
+    return Window::wndProc(msg, wp, lp);
 }
 
 void ImeWindow::onLButtonDown(WPARAM wp, LPARAM lp) {
@@ -60,12 +142,66 @@ void ImeWindow::onMouseMove(WPARAM wp, LPARAM lp) {
     RECT rc;
     GetWindowRect(hwnd_, &rc);
     OffsetRect( &rc, (pt.x - oldPos.x), (pt.y - oldPos.y) );
-    move(rc.left, rc.top);
+    // dragging follows the mouse right away
+    moveNow(rc.left, rc.top);
 }
 
 void ImeWindow::move(int x, int y) {
+    hasPendingMove_ = true;
+    pendingPos_.x = x;
+    pendingPos_.y = y;
+    if(scheduler_)
+        scheduler_->schedule(this, UPDATE_LAYOUT);
+    else
+        runLayout();
+}
+
+void ImeWindow::show() {
+    updateNow();
+    Window::show();
+}
+
+void ImeWindow::size(int* width, int* height) {
+    updateNow();
+    Window::size(width, height);
+}
+
+void ImeWindow::updateNow() {
+    if(scheduler_)
+        scheduler_->flush(this);
+}
+
+void ImeWindow::scheduleUpdate(unsigned int kinds) {
+    if(kinds & UPDATE_LAYOUT)
+        needsLayout_ = true;
+    if(scheduler_) {
+        scheduler_->schedule(this, kinds);
+        return;
+    }
+    if(kinds & UPDATE_LAYOUT)
+        runLayout();
+    runPaint();
+}
+
+void ImeWindow::runLayout() {
+    if(needsLayout_) {
+        needsLayout_ = false;
+        recalculateSize();
+    }
+    if(hasPendingMove_) {
+        hasPendingMove_ = false;
+        moveNow(pendingPos_.x, pendingPos_.y);
+    }
+}
+
+void ImeWindow::runPaint() {
+    if(isVisible())
+        ::InvalidateRect(hwnd_, NULL, TRUE);
+}
+
+void ImeWindow::moveNow(int x, int y) {
     int w, h;
-    size(&w, &h);
+    Window::size(&w, &h);
     // ensure that the window does not fall outside of the screen.
     RECT rc = {x, y, x + w, y + h}; // current window rect
     // get the nearest monitor
@@ -87,12 +223,22 @@ void ImeWindow::move(int x, int y) {
 }
 
 void ImeWindow::setFont(HFONT f) {
-    if(font_)
+    if(f != font_ && font_ && f) {
+        // the same font as before (e.g. reused from the window pool), keep the measurements
+        LOGFONTW oldLogFont, newLogFont;
+        if(::GetObjectW(font_, sizeof(oldLogFont), &oldLogFont) == sizeof(oldLogFont)
+            && ::GetObjectW(f, sizeof(newLogFont), &newLogFont) == sizeof(newLogFont)
+            && memcmp(&oldLogFont, &newLogFont, offsetof(LOGFONTW, lfFaceName)) == 0
+            && wcscmp(oldLogFont.lfFaceName, newLogFont.lfFaceName) == 0) {
+            ::DeleteObject(f);
+            return;
+        }
+    }
+    if(font_ && font_ != f)
         ::DeleteObject(font_);
     font_ = f;
-    recalculateSize();
-    if(isVisible())
-        ::InvalidateRect(hwnd_, NULL, TRUE);
+    extentCache_.clear();
+    scheduleUpdate(UPDATE_LAYOUT);
 }
 
 // virtual
@@ -21,35 +21,109 @@
 #define IME_IME_WINDOW_H
 
 #include <windows.h>
+#include <memory>
 #include "window.h"
 #include "TextService.h"
+#include "TextExtentCache.h"
+#include "UpdateScheduler.h"
+
+// for Windows 8.1 per monitor DPI support
+#ifndef WM_DPICHANGED // this is defined in Win 8.1 SDK
+#define WM_DPICHANGED 0x02E0
+#endif
 
 namespace Ime {
 
 class TextService;
 
+// measures text with GDI, but only gets a DC when the extent cache really needs it.
+class WindowTextMeasurer: public TextMeasurer {
+public:
+    WindowTextMeasurer(HWND hwnd, HFONT font);
+    ~WindowTextMeasurer();
+
+    TextExtent measure(const wchar_t* str, size_t len) override;
+    bool charAdvances(wchar_t first, wchar_t last, int* advances) override;
+
+private:
+    HDC dc();
+
+private:
+    HWND hwnd_;
+    HFONT font_;
+    HDC dc_;
+    HGDIOBJ oldFont_;
+};
+
 // base class for all IME windows (candidate, tooltip, ...etc)
-class ImeWindow: public Window {
+// Setters do not measure or repaint right away. They schedule a layout pass
+// and a paint with the UpdateScheduler of the text service, which runs them
+// once after the key event, however many setters were called.
+class ImeWindow: public Window, public UpdateClient {
 public:
     ImeWindow(TextService* service);
     virtual ~ImeWindow(void);
+
+    // the window is moved after its size is updated, so it's kept inside the screen.
     void move(int x, int y);
+
+    // these need an up to date layout, so pending updates are run first.
+    void show() override;
+    void size(int* width, int* height);
+
+    // run the pending layout pass and paint of this window now.
+    void updateNow();
     bool isImmersive() {
         return textService_->isImmersive();
     }
 
+    // the window takes the ownership of the font.
     void setFont(HFONT f);
     virtual void recalculateSize();
 
+    // text extents measured with the current font
+    const TextExtentCache& extentCache() const {
+        return extentCache_;
+    }
+
+    // number of GDI objects created by the resource cache during the last WM_PAINT,
+    // which is 0 once the pens and brushes are cached.
+    size_t lastPaintGdiCreations() const {
+        return lastPaintGdiCreations_;
+    }
+
 protected:
+    // create the window, or take a hidden one from the window pool of the text service.
+    bool createWindow(HWND parent);
+
+    // ask for recalculateSize() (UPDATE_LAYOUT) and/or repainting (UPDATE_PAINT)
+    void scheduleUpdate(unsigned int kinds);
+
+    // UpdateClient
+    void runLayout() override;
+    // invalidate the window by default
+    void runPaint() override;
+
+    void moveNow(int x, int y);
+
+    // handle system color and DPI changes
+    LRESULT wndProc(UINT msg, WPARAM wp, LPARAM lp) override;
+
     void onLButtonDown(WPARAM wp, LPARAM lp);
     void onLButtonUp(WPARAM wp, LPARAM lp);
     void onMouseMove(WPARAM wp, LPARAM lp);
 
 protected:
     TextService* textService_;
+    std::shared_ptr<WindowPool> pool_;
+    std::shared_ptr<UpdateScheduler> scheduler_;
+    bool needsLayout_;
+    bool hasPendingMove_;
+    POINT pendingPos_;
+    size_t lastPaintGdiCreations_;
     POINTS oldPos;
     HFONT font_;
+    TextExtentCache extentCache_;
     int margin_;
 };
 
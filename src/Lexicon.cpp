@@ -0,0 +1,214 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "Lexicon.h"
+#include "CompletionIndex.h"
+#include "Utf.h"
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+
+namespace Ime {
+
+const uint32_t Lexicon::VERSION;
+
+Lexicon::Lexicon():
+    header_(nullptr),
+    ranges_(nullptr),
+    phrases_(nullptr),
+    text_(nullptr) {
+}
+
+bool Lexicon::attach(const DictionaryFile& file) {
+    header_ = nullptr;
+    std::string_view header = file.section(LEXICON_HEADER_SECTION);
+    if(header.size() != sizeof(LexiconHeader))
+        return false;
+    auto lexiconHeader = reinterpret_cast<const LexiconHeader*>(header.data());
+    if(lexiconHeader->version != VERSION)
+        return false;
+
+    // the sections start at page boundaries, so they are aligned
+    std::string_view ranges = file.section(LEXICON_RANGES_SECTION);
+    std::string_view phrases = file.section(LEXICON_PHRASES_SECTION);
+    std::string_view text = file.section(LEXICON_TEXT_SECTION);
+    if(ranges.size() != (uint64_t(lexiconHeader->readingCount) + 1) * sizeof(uint32_t)
+        || phrases.size() != uint64_t(lexiconHeader->phraseCount) * sizeof(LexiconPhrase)
+        || text.size() != uint64_t(lexiconHeader->textLength) * sizeof(char16_t))
+        return false;
+    if(!readings_.attach(file.section(LEXICON_READINGS_SECTION)))
+        return false;
+
+    header_ = lexiconHeader;
+    ranges_ = reinterpret_cast<const uint32_t*>(ranges.data());
+    phrases_ = reinterpret_cast<const LexiconPhrase*>(phrases.data());
+    text_ = reinterpret_cast<const char16_t*>(text.data());
+    return true;
+}
+
+LexiconPhrases Lexicon::phrasesOf(uint32_t readingIndex) const {
+    if(!header_ || readingIndex >= header_->readingCount)
+        return LexiconPhrases();
+    uint32_t begin = ranges_[readingIndex];
+    uint32_t end = ranges_[readingIndex + 1];
+    if(begin > end || end > header_->phraseCount)
+        return LexiconPhrases();
+    return LexiconPhrases(phrases_ + begin, phrases_ + end);
+}
+
+bool Lexicon::verify(std::string* error) const {
+    auto fail = [error](const char* reason) {
+        if(error)
+            *error = reason;
+        return false;
+    };
+    if(!header_)
+        return fail("no lexicon");
+    if(readings_.size() != header_->readingCount)
+        return fail("the number of readings does not match the header");
+    if(ranges_[0] != 0 || ranges_[header_->readingCount] != header_->phraseCount)
+        return fail("the phrase ranges do not cover all the phrases");
+    for(uint32_t i = 0; i < header_->readingCount; ++i) {
+        if(ranges_[i] >= ranges_[i + 1])
+            return fail("a reading has no phrases");
+    }
+    for(uint32_t i = 0; i < header_->phraseCount; ++i) {
+        const LexiconPhrase& phrase = phrases_[i];
+        if(phrase.textLength == 0 || uint64_t(phrase.textOffset) + phrase.textLength > header_->textLength)
+            return fail("a phrase is out of the text section");
+    }
+    // every reading is reachable in the trie, exactly once
+    std::vector<bool> seen(header_->readingCount, false);
+    bool valid = true;
+    readings_.forEachWithPrefix(std::u16string_view(), [this, &seen, &valid](std::u16string_view, uint32_t value) {
+        valid = value < header_->readingCount && !seen[value];
+        if(valid)
+            seen[value] = true;
+        return valid;
+    });
+    if(!valid || std::find(seen.begin(), seen.end(), false) != seen.end())
+        return fail("the readings trie does not match the phrase ranges");
+    return true;
+}
+
+void LexiconBuilder::add(std::u16string_view reading, std::u16string_view phrase, uint32_t frequency) {
+    if(reading.empty() || phrase.empty() || phrase.size() > 0xffff)
+        return;
+    entries_.push_back(Entry{std::u16string(reading), std::u16string(phrase), frequency});
+}
+
+bool LexiconBuilder::addText(std::string_view text, size_t* errorLine) {
+    std::u16string reading;
+    std::u16string phrase;
+    for(size_t lineNumber = 1; !text.empty(); ++lineNumber) {
+        size_t lineEnd = text.find('\n');
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+        if(!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        size_t tab = line.find('\t');
+        size_t secondTab = tab == std::string_view::npos ? tab : line.find('\t', tab + 1);
+        uint32_t frequency = 0;
+        bool valid = tab != std::string_view::npos
+            && utf8ToUtf16(line.substr(0, tab), reading)
+            && utf8ToUtf16(line.substr(tab + 1, secondTab == std::string_view::npos ? secondTab : secondTab - tab - 1), phrase)
+            && !reading.empty() && !phrase.empty() && phrase.size() <= 0xffff;
+        if(valid && secondTab != std::string_view::npos) {
+            std::string_view number = line.substr(secondTab + 1);
+            auto result = std::from_chars(number.data(), number.data() + number.size(), frequency);
+            valid = !number.empty() && result.ec == std::errc() && result.ptr == number.data() + number.size();
+        }
+        if(!valid) {
+            if(errorLine)
+                *errorLine = lineNumber;
+            return false;
+        }
+        add(reading, phrase, frequency);
+    }
+    return true;
+}
+
+void LexiconBuilder::addSectionsTo(DictionaryFileWriter& writer) const {
+    // keep the highest frequency of duplicated phrases
+    std::vector<const Entry*> entries;
+    entries.reserve(entries_.size());
+    for(const auto& entry: entries_)
+        entries.push_back(&entry);
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        if(a->reading != b->reading)
+            return a->reading < b->reading;
+        if(a->phrase != b->phrase)
+            return a->phrase < b->phrase;
+        return a->frequency > b->frequency;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->reading == b->reading && a->phrase == b->phrase;
+    }), entries.end());
+    // most frequent first in each reading
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        if(a->reading != b->reading)
+            return a->reading < b->reading;
+        return a->frequency > b->frequency;
+    });
+
+    DoubleArrayTrieBuilder readings;
+    std::vector<uint32_t> ranges;
+    std::vector<LexiconPhrase> phrases;
+    std::u16string text;
+    std::unordered_map<std::u16string_view, uint32_t> textOffsets;
+    for(size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = *entries[i];
+        if(i == 0 || entry.reading != entries[i - 1]->reading) {
+            readings.add(entry.reading, uint32_t(ranges.size()));
+            ranges.push_back(uint32_t(phrases.size()));
+        }
+        auto offset = textOffsets.emplace(entry.phrase, uint32_t(text.size()));
+        if(offset.second)
+            text += entry.phrase;
+        phrases.push_back(LexiconPhrase{offset.first->second, uint16_t(entry.phrase.size()), 0, entry.frequency});
+    }
+    ranges.push_back(uint32_t(phrases.size()));
+
+    std::string trie = readings.build();
+    DoubleArrayTrie readingTrie;
+    readingTrie.attach(trie);
+    std::vector<uint32_t> bestFrequencies;
+    bestFrequencies.reserve(ranges.size() - 1);
+    for(size_t i = 0; i + 1 < ranges.size(); ++i)
+        bestFrequencies.push_back(phrases[ranges[i]].frequency);
+
+    LexiconHeader header{Lexicon::VERSION, uint32_t(ranges.size() - 1), uint32_t(phrases.size()), uint32_t(text.size())};
+    writer.addSection(LEXICON_HEADER_SECTION, &header, sizeof(header));
+    writer.addSection(LEXICON_READINGS_SECTION, trie);
+    writer.addSection(LEXICON_RANGES_SECTION, ranges.data(), ranges.size() * sizeof(uint32_t));
+    writer.addSection(LEXICON_PHRASES_SECTION, phrases.data(), phrases.size() * sizeof(LexiconPhrase));
+    writer.addSection(LEXICON_TEXT_SECTION, text.data(), text.size() * sizeof(char16_t));
+    writer.addSection(LEXICON_COMPLETION_SECTION, CompletionIndex::buildTable(readingTrie, bestFrequencies));
+}
+
+std::string LexiconBuilder::build() const {
+    DictionaryFileWriter writer;
+    addSectionsTo(writer);
+    return writer.build();
+}
+
+} // namespace Ime
@@ -0,0 +1,186 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_LEXICON_H
+#define IME_LEXICON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DictionaryFile.h"
+#include "DoubleArrayTrie.h"
+
+namespace Ime {
+
+// Sections of a dictionary file holding a lexicon, a reading -> phrases map.
+//   LXHD  LexiconHeader
+//   LXTR  DoubleArrayTrie of the readings, the value of a reading is its index
+//   LXRG  uint32_t ranges[readingCount + 1]  the phrases of reading i are phrases[ranges[i], ranges[i + 1])
+//   LXPH  LexiconPhrase phrases[phraseCount]  most frequent first for each reading
+//   LXTX  char16_t text[textLength]  the phrases, shared by the readings of polyphones
+//   LXCP  CompletionNode nodes[unit count of LXTR]  for predictive completion, see CompletionIndex
+constexpr uint32_t LEXICON_HEADER_SECTION = dictionarySectionId("LXHD");
+constexpr uint32_t LEXICON_READINGS_SECTION = dictionarySectionId("LXTR");
+constexpr uint32_t LEXICON_RANGES_SECTION = dictionarySectionId("LXRG");
+constexpr uint32_t LEXICON_PHRASES_SECTION = dictionarySectionId("LXPH");
+constexpr uint32_t LEXICON_TEXT_SECTION = dictionarySectionId("LXTX");
+constexpr uint32_t LEXICON_COMPLETION_SECTION = dictionarySectionId("LXCP");
+
+struct LexiconHeader {
+    uint32_t version;
+    uint32_t readingCount;
+    uint32_t phraseCount;
+    uint32_t textLength;  // in UTF-16 units
+};
+
+struct LexiconPhrase {
+    uint32_t textOffset;  // in UTF-16 units
+    uint16_t textLength;
+    uint16_t reserved;
+    uint32_t frequency;
+};
+
+static_assert(sizeof(LexiconHeader) == 16, "unexpected padding");
+static_assert(sizeof(LexiconPhrase) == 12, "unexpected padding");
+
+// the phrases of a reading
+class LexiconPhrases {
+public:
+    LexiconPhrases(const LexiconPhrase* begin = nullptr, const LexiconPhrase* end = nullptr):
+        begin_(begin),
+        end_(end) {
+    }
+
+    const LexiconPhrase* begin() const {
+        return begin_;
+    }
+
+    const LexiconPhrase* end() const {
+        return end_;
+    }
+
+    size_t size() const {
+        return size_t(end_ - begin_);
+    }
+
+    bool empty() const {
+        return begin_ == end_;
+    }
+
+    const LexiconPhrase& operator[](size_t i) const {
+        return begin_[i];
+    }
+
+private:
+    const LexiconPhrase* begin_;
+    const LexiconPhrase* end_;
+};
+
+// A compiled lexicon used in place from a dictionary file: attaching it only
+// checks the sizes of the sections, nothing is parsed or allocated, and a
+// lookup is a trie walk.
+class Lexicon {
+public:
+    static const uint32_t VERSION = 1;
+
+    Lexicon();
+
+    // the dictionary must stay open while the lexicon is used.
+    // return false if it has no lexicon or the sections are inconsistent.
+    bool attach(const DictionaryFile& file);
+
+    bool isAttached() const {
+        return header_ != nullptr;
+    }
+
+    size_t readingCount() const {
+        return header_ ? header_->readingCount : 0;
+    }
+
+    size_t phraseCount() const {
+        return header_ ? header_->phraseCount : 0;
+    }
+
+    // the phrases of the reading, most frequent first
+    LexiconPhrases lookup(std::u16string_view reading) const {
+        return phrasesOf(readings_.find(reading));
+    }
+
+    // the phrases of the reading with the index, a value of the readings trie
+    LexiconPhrases phrasesOf(uint32_t readingIndex) const;
+
+    // the readings, for prefix and common prefix searches
+    const DoubleArrayTrie& readings() const {
+        return readings_;
+    }
+
+    // the text of a phrase, empty if it's out of the text section
+    std::u16string_view text(const LexiconPhrase& phrase) const {
+        if(uint64_t(phrase.textOffset) + phrase.textLength > header_->textLength)
+            return std::u16string_view();
+        return std::u16string_view(text_ + phrase.textOffset, phrase.textLength);
+    }
+
+    // Check everything which is only checked when it's used, in O(size of the lexicon).
+    // return false and the reason in error if something is out of range.
+    bool verify(std::string* error = nullptr) const;
+
+private:
+    const LexiconHeader* header_;
+    DoubleArrayTrie readings_;
+    const uint32_t* ranges_;
+    const LexiconPhrase* phrases_;
+    const char16_t* text_;
+};
+
+// Compiles a lexicon from its source.
+class LexiconBuilder {
+public:
+    // a phrase added several times for the same reading keeps its highest frequency.
+    void add(std::u16string_view reading, std::u16string_view phrase, uint32_t frequency);
+
+    // Add lines of UTF-8 text: reading<TAB>phrase[<TAB>frequency]. Empty lines and
+    // lines starting with # are skipped. return false on the first invalid line, whose
+    // number (from 1) is stored in errorLine if it's not null.
+    bool addText(std::string_view text, size_t* errorLine = nullptr);
+
+    // number of (reading, phrase) pairs
+    size_t size() const {
+        return entries_.size();
+    }
+
+    void addSectionsTo(DictionaryFileWriter& writer) const;
+
+    // a dictionary file with only the lexicon
+    std::string build() const;
+
+private:
+    struct Entry {
+        std::u16string reading;
+        std::u16string phrase;
+        uint32_t frequency;
+    };
+    std::vector<Entry> entries_;
+};
+
+}
+
+#endif
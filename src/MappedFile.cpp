@@ -0,0 +1,130 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "MappedFile.h"
+#include <cstdint>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Ime {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile():
+    data_(nullptr),
+    size_(0),
+    mapping_(nullptr) {
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if(::GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && uint64_t(fileSize.QuadPart) <= SIZE_MAX) {
+        // the mapping object keeps the file open, so the file handle is not needed afterwards.
+        mapping_ = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping_) {
+            data_ = static_cast<const unsigned char*>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if(data_) {
+                size_ = size_t(fileSize.QuadPart);
+            }
+            else {
+                ::CloseHandle(mapping_);
+                mapping_ = nullptr;
+            }
+        }
+    }
+    ::CloseHandle(file);
+    return data_ != nullptr;
+}
+
+void MappedFile::close() {
+    if(data_) {
+        ::UnmapViewOfFile(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+    if(mapping_) {
+        ::CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+}
+
+// static
+size_t MappedFile::pageSize() {
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+#else
+
+MappedFile::MappedFile():
+    data_(nullptr),
+    size_(0) {
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    if(::fstat(fd, &st) == 0 && st.st_size > 0) {
+        // a shared read-only mapping shares the page cache with other processes
+        void* addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if(addr != MAP_FAILED) {
+            data_ = static_cast<const unsigned char*>(addr);
+            size_ = size_t(st.st_size);
+        }
+    }
+    ::close(fd);
+    return data_ != nullptr;
+}
+
+void MappedFile::close() {
+    if(data_) {
+        ::munmap(const_cast<unsigned char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+// static
+size_t MappedFile::pageSize() {
+    return size_t(::sysconf(_SC_PAGESIZE));
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+} // namespace Ime
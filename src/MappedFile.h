@@ -0,0 +1,68 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_MAPPED_FILE_H
+#define IME_MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+
+namespace Ime {
+
+// A whole file mapped into memory read-only.
+// The pages are backed by the file itself (the OS page cache), so every process
+// mapping the same file shares the same physical memory and nothing is copied
+// or parsed when the file is opened.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const {
+        return data_ != nullptr;
+    }
+
+    const unsigned char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // size of a memory page of the system
+    static size_t pageSize();
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+#ifdef _WIN32
+    void* mapping_;  // HANDLE of the file mapping object
+#endif
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@
 #include "MessageWindow.h"
 #include "TextService.h"
 #include "DrawUtils.h"
+#include "GdiResources.h"
 
 namespace Ime {
 
@@ -27,7 +28,7 @@ MessageWindow::MessageWindow(TextService* service, EditSession* session):
     ImeWindow(service) {
 
     HWND parent = service->compositionWindow(session);
-    create(parent, WS_POPUP|WS_CLIPCHILDREN, WS_EX_TOOLWINDOW|WS_EX_TOPMOST);
+    createWindow(parent);
 }
 
 MessageWindow::~MessageWindow(void) {
@@ -35,23 +36,17 @@ MessageWindow::~MessageWindow(void) {
 
 // virtual
 void MessageWindow::recalculateSize() {
-    SIZE size = {0};
-    HDC dc = GetDC(hwnd_);
-    HGDIOBJ old_font = SelectObject(dc, font_);
-    GetTextExtentPointW(dc, text_.c_str(), text_.length(), &size);
-    SelectObject(dc, old_font);
-    ReleaseDC(hwnd_, dc);
+    WindowTextMeasurer measurer(hwnd_, font_);
+    TextExtent size = extentCache_.extent(text_.c_str(), text_.length(), measurer);
 
     SetWindowPos(hwnd_, HWND_TOPMOST, 0, 0,
-        size.cx + margin_ * 2, size.cy + margin_ * 2, SWP_NOACTIVATE|SWP_NOMOVE);
+        size.width + margin_ * 2, size.height + margin_ * 2, SWP_NOACTIVATE|SWP_NOMOVE);
 }
 
 void MessageWindow::setText(std::wstring text) {
     // FIXMEl: use different appearance under immersive mode
     text_ = text;
-    recalculateSize();
-    if(IsWindowVisible(hwnd_))
-        InvalidateRect(hwnd_, NULL, TRUE);
+    scheduleUpdate(UPDATE_LAYOUT);
 }
 
 LRESULT MessageWindow::wndProc(UINT msg, WPARAM wp, LPARAM lp) {
@@ -59,7 +54,9 @@ LRESULT MessageWindow::wndProc(UINT msg, WPARAM wp, LPARAM lp) {
     case WM_PAINT: {
             PAINTSTRUCT ps;
             BeginPaint(hwnd_, &ps);
+            size_t creations = gdiResources().stats().creations;
             onPaint(ps);
+            lastPaintGdiCreations_ = gdiResources().stats().creations - creations;
             EndPaint(hwnd_, &ps);
         }
         break;
@@ -80,29 +77,30 @@ void MessageWindow::onPaint(PAINTSTRUCT& ps) {
     // draw a 3d border in desktop mode
     HDC hDC = ps.hdc;
     HFONT oldFont = (HFONT)SelectObject(hDC, font_);
+    ResourceCache& resources = gdiResources();
 
     SetBkMode(hDC, TRANSPARENT);
     if(isImmersive()) {
-        SetTextColor(hDC, GetSysColor(COLOR_WINDOWTEXT));
-        SetBkColor(hDC, GetSysColor(COLOR_WINDOW));
-        HPEN pen = ::CreatePen(PS_SOLID, 3, RGB(0, 0, 0));
+        SetTextColor(hDC, resources.systemColor(COLOR_WINDOWTEXT));
+        SetBkColor(hDC, resources.systemColor(COLOR_WINDOW));
+        HPEN pen = (HPEN)resources.pen(RGB(0, 0, 0), 3, dpiOf(hDC));
         HGDIOBJ oldPen = ::SelectObject(hDC, pen);
         ::Rectangle(hDC, rc.left, rc.top, rc.right, rc.bottom);
         ::SelectObject(hDC, oldPen);
-        ::DeleteObject(pen);
     }
     else {
-        SetTextColor(hDC, GetSysColor(COLOR_INFOTEXT));
-        SetBkColor(hDC, GetSysColor(COLOR_INFOBK));
+        SetTextColor(hDC, resources.systemColor(COLOR_INFOTEXT));
+        SetBkColor(hDC, resources.systemColor(COLOR_INFOBK));
         // draw a 3d border in desktop mode
-        ::FillSolidRect(hDC, &rc, ::GetSysColor(COLOR_INFOBK));
-        ::Draw3DBorder(hDC, &rc, GetSysColor(COLOR_3DFACE), 0);
+        ::FillSolidRect(hDC, &rc, resources.systemColor(COLOR_INFOBK));
+        ::Draw3DBorder(hDC, &rc, resources.systemColor(COLOR_3DFACE), 0);
     }
 
-    SIZE size;
-    GetTextExtentPoint32W(hDC, text_.c_str(), len, &size);
-    rc.top += (rc.bottom - size.cy)/2;
-    rc.left += (rc.right - size.cx)/2;
+    // measured by recalculateSize() already
+    WindowTextMeasurer measurer(hwnd_, font_);
+    TextExtent size = extentCache_.extent(text_.c_str(), len, measurer);
+    rc.top += (rc.bottom - size.height)/2;
+    rc.left += (rc.right - size.width)/2;
     ExtTextOutW(hDC, rc.left, rc.top, 0, &textrc, text_.c_str(), len, NULL);
 
     SelectObject(hDC, oldFont);
@@ -0,0 +1,62 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_ONCE_INIT_H
+#define IME_ONCE_INIT_H
+
+#include <atomic>
+#include <mutex>
+
+namespace Ime {
+
+// Thread safe one-time initialization with a lock-free fast path.
+// Unlike std::call_once, a failed initialization (the function returns false)
+// is retried by the next caller, since things like CoCreateInstance() may
+// fail on one thread and succeed later on another.
+class OnceInit {
+public:
+    OnceInit():
+        done_(false) {
+    }
+
+    // call init() if no previous call succeeded. return true if initialized.
+    template<typename Func>
+    bool run(Func init) {
+        if(done_.load(std::memory_order_acquire))
+            return true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!done_.load(std::memory_order_relaxed)) {
+            if(init())
+                done_.store(true, std::memory_order_release);
+        }
+        return done_.load(std::memory_order_relaxed);
+    }
+
+    bool done() const {
+        return done_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> done_;
+    std::mutex mutex_;
+};
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_PAINT_BACKEND_H
+#define IME_PAINT_BACKEND_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ime {
+
+struct PaintRect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    bool isEmpty() const {
+        return right <= left || bottom <= top;
+    }
+
+    // the smallest rect containing both
+    void unite(const PaintRect& other) {
+        if(other.isEmpty())
+            return;
+        if(isEmpty()) {
+            *this = other;
+            return;
+        }
+        left = std::min(left, other.left);
+        top = std::min(top, other.top);
+        right = std::max(right, other.right);
+        bottom = std::max(bottom, other.bottom);
+    }
+
+    bool operator==(const PaintRect& other) const {
+        return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+    }
+};
+
+// colors are given by their role, the backend maps them to real colors (system colors on Windows).
+enum class PaintColor {
+    WINDOW,
+    WINDOW_TEXT,
+    SEL_KEY,
+    HIGHLIGHT,
+    HIGHLIGHT_TEXT
+};
+
+// Drawing operations used by the IME windows.
+// Everything is drawn to a back buffer, which is copied to the screen by present().
+class PaintBackend {
+public:
+    virtual ~PaintBackend() {}
+
+    // paint the background and the border of the whole window.
+    virtual void drawFrame(const PaintRect& rect) = 0;
+
+    // paint text with an opaque background filling the rect.
+    virtual void drawText(const PaintRect& rect, std::wstring_view text, PaintColor textColor, PaintColor bkColor) = 0;
+
+    // copy the rect from the back buffer to the window.
+    virtual void present(const PaintRect& rect) = 0;
+};
+
+// a backend which only records what is drawn, used by the tests.
+class RecordingPaintBackend: public PaintBackend {
+public:
+    enum OpType {
+        FRAME,
+        TEXT,
+        PRESENT
+    };
+
+    struct Op {
+        OpType type;
+        PaintRect rect;
+        std::wstring text;
+        PaintColor textColor;
+        PaintColor bkColor;
+    };
+
+    void drawFrame(const PaintRect& rect) override {
+        ops_.push_back(Op{FRAME, rect, std::wstring(), PaintColor::WINDOW_TEXT, PaintColor::WINDOW});
+    }
+
+    void drawText(const PaintRect& rect, std::wstring_view text, PaintColor textColor, PaintColor bkColor) override {
+        ops_.push_back(Op{TEXT, rect, std::wstring(text), textColor, bkColor});
+    }
+
+    void present(const PaintRect& rect) override {
+        ops_.push_back(Op{PRESENT, rect, std::wstring(), PaintColor::WINDOW_TEXT, PaintColor::WINDOW});
+    }
+
+    const std::vector<Op>& ops() const {
+        return ops_;
+    }
+
+    int count(OpType type) const {
+        return int(std::count_if(ops_.begin(), ops_.end(), [type](const Op& op) { return op.type == type; }));
+    }
+
+    void clear() {
+        ops_.clear();
+    }
+
+private:
+    std::vector<Op> ops_;
+};
+
+}
+
+#endif
@@ -0,0 +1,257 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "RegistrationPlan.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+namespace Ime {
+
+static const wchar_t userProfileKey[] = L"\\Control Panel\\International\\User Profile";
+
+static bool sameProfile(const LanguageProfile& a, const LanguageProfile& b) {
+    return a.langId == b.langId && a.profileGuid == b.profileGuid;
+}
+
+static std::wstring serverKey(const std::wstring& clsid) {
+    return L"CLSID\\" + clsid;
+}
+
+// name of the value recording a profile under ownedProfilesKey()
+static std::wstring ownedProfileName(const LanguageProfile& profile) {
+    wchar_t langId[8];
+    std::swprintf(langId, sizeof(langId) / sizeof(wchar_t), L"%04x", unsigned(profile.langId));
+    return langId + (L":" + profile.profileGuid);
+}
+
+RegistrationPlan::RegistrationPlan(RegistryBackend& backend):
+    backend_(backend) {
+}
+
+void RegistrationPlan::planRegister(const RegistrationSpec& spec) {
+    planServer(spec);
+    planProfiles(spec);
+    planCategories(spec);
+}
+
+void RegistrationPlan::planServer(const RegistrationSpec& spec) {
+    std::wstring key = serverKey(spec.clsid);
+    planValue(RegistryRoot::CLASSES_ROOT, key, L"", RegistryValue::string(spec.name));
+    key += L"\\InprocServer32";
+    planValue(RegistryRoot::CLASSES_ROOT, key, L"", RegistryValue::string(spec.modulePath));
+    planValue(RegistryRoot::CLASSES_ROOT, key, L"ThreadingModel", RegistryValue::string(L"Apartment"));
+}
+
+void RegistrationPlan::planProfiles(const RegistrationSpec& spec) {
+    auto current = backend_.languageProfiles(spec.clsid);
+    // registering an already registered text service does nothing
+    if(current.empty())
+        add(RegistrationOp::REGISTER_TEXT_SERVICE, spec.clsid, LanguageProfile());
+
+    std::wstring ownedKey = ownedProfilesKey(spec.clsid);
+    auto ownedNames = backend_.valueNames(RegistryRoot::CLASSES_ROOT, ownedKey);
+    std::set<std::wstring> owned(ownedNames.begin(), ownedNames.end());
+    std::set<std::wstring> desiredNames;
+    for(const auto& desired: spec.profiles) {
+        auto it = std::find_if(current.begin(), current.end(), [&](const LanguageProfile& p) {
+            return sameProfile(p, desired.profile);
+        });
+        if(it == current.end() || !(*it == desired.profile))
+            add(RegistrationOp::ADD_PROFILE, spec.clsid, desired.profile);
+        auto name = ownedProfileName(desired.profile);
+        if(!owned.count(name))
+            add(RegistrationOp::SET_VALUE, RegistryRoot::CLASSES_ROOT, ownedKey, name, RegistryValue::dword(1));
+        desiredNames.insert(name);
+    }
+
+    // only the profiles we registered before are removed
+    std::set<std::wstring> keptUserProfiles;
+    for(const auto& profile: current) {
+        auto it = std::find_if(spec.profiles.begin(), spec.profiles.end(), [&](const RegistrationProfile& p) {
+            return sameProfile(p.profile, profile);
+        });
+        if(it != spec.profiles.end())
+            continue;
+        if(owned.count(ownedProfileName(profile)))
+            add(RegistrationOp::REMOVE_PROFILE, spec.clsid, profile);
+        else
+            keptUserProfiles.insert(userProfileValueName(spec.clsid, profile));
+    }
+    for(const auto& name: owned) {
+        if(!desiredNames.count(name))
+            add(RegistrationOp::DELETE_VALUE, RegistryRoot::CLASSES_ROOT, ownedKey, name);
+    }
+
+    if(spec.userProfiles)
+        planUserProfiles(spec.clsid, spec.profiles, keptUserProfiles);
+}
+
+void RegistrationPlan::planCategories(const RegistrationSpec& spec) {
+    auto current = backend_.categories(spec.clsid);
+    for(const auto& category: spec.categories) {
+        if(std::find(current.begin(), current.end(), category) == current.end())
+            add(RegistrationOp::REGISTER_CATEGORY, spec.clsid, category);
+    }
+    // categories unknown to us are registered by someone else
+    for(const auto& category: current) {
+        if(std::find(spec.categories.begin(), spec.categories.end(), category) == spec.categories.end()
+            && std::find(spec.knownCategories.begin(), spec.knownCategories.end(), category) != spec.knownCategories.end())
+            add(RegistrationOp::UNREGISTER_CATEGORY, spec.clsid, category);
+    }
+}
+
+void RegistrationPlan::planUnregister(const std::wstring& clsid, bool userProfiles) {
+    for(const auto& category: backend_.categories(clsid)) {
+        add(RegistrationOp::UNREGISTER_CATEGORY, clsid, category);
+    }
+    if(!backend_.languageProfiles(clsid).empty())
+        add(RegistrationOp::UNREGISTER_TEXT_SERVICE, clsid, LanguageProfile());
+
+    std::wstring key = serverKey(clsid);
+    if(backend_.hasKey(RegistryRoot::CLASSES_ROOT, key))
+        add(RegistrationOp::DELETE_KEY, RegistryRoot::CLASSES_ROOT, key);
+
+    if(userProfiles)
+        planUserProfiles(clsid, std::vector<RegistrationProfile>());
+}
+
+bool RegistrationPlan::apply() {
+    bool success = true;
+    for(const auto& op: ops_) {
+        bool done = false;
+        switch(op.type) {
+        case RegistrationOp::SET_VALUE:
+            done = backend_.setValue(op.root, op.path, op.name, op.value);
+            break;
+        case RegistrationOp::DELETE_VALUE:
+            done = backend_.deleteValue(op.root, op.path, op.name);
+            break;
+        case RegistrationOp::DELETE_KEY:
+            done = backend_.deleteKey(op.root, op.path);
+            break;
+        case RegistrationOp::REGISTER_TEXT_SERVICE:
+            done = backend_.registerTextService(op.clsid);
+            break;
+        case RegistrationOp::UNREGISTER_TEXT_SERVICE:
+            done = backend_.unregisterTextService(op.clsid);
+            break;
+        case RegistrationOp::ADD_PROFILE:
+            done = backend_.addLanguageProfile(op.clsid, op.profile);
+            break;
+        case RegistrationOp::REMOVE_PROFILE:
+            done = backend_.removeLanguageProfile(op.clsid, op.profile);
+            break;
+        case RegistrationOp::REGISTER_CATEGORY:
+            done = backend_.registerCategory(op.clsid, op.category);
+            break;
+        case RegistrationOp::UNREGISTER_CATEGORY:
+            done = backend_.unregisterCategory(op.clsid, op.category);
+            break;
+        }
+        // keep going, so a failure does not leave more things behind
+        if(!done)
+            success = false;
+    }
+    return success;
+}
+
+// static
+std::wstring RegistrationPlan::userProfileValueName(const std::wstring& clsid, const LanguageProfile& profile) {
+    wchar_t langId[8];
+    std::swprintf(langId, sizeof(langId) / sizeof(wchar_t), L"%04x", unsigned(profile.langId));
+    return langId + (L":" + clsid) + profile.profileGuid;
+}
+
+// static
+std::wstring RegistrationPlan::ownedProfilesKey(const std::wstring& clsid) {
+    return serverKey(clsid) + L"\\LanguageProfiles";
+}
+
+void RegistrationPlan::planValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) {
+    RegistryValue current;
+    if(!backend_.readValue(root, path, name, current) || current != value)
+        add(RegistrationOp::SET_VALUE, root, path, name, value);
+}
+
+void RegistrationPlan::planUserProfiles(const std::wstring& clsid, const std::vector<RegistrationProfile>& profiles,
+    const std::set<std::wstring>& kept) {
+    // the profiles are listed in the control panel only if they are in HKEY_CURRENT_USER.
+    // So they are written to the hive of every user known to the machine, including the
+    // default user the new users are copied from.
+    std::set<std::wstring> desiredLocales;
+    for(const auto& profile: profiles) {
+        desiredLocales.insert(profile.locale);
+    }
+
+    for(const auto& sid: backend_.subKeys(RegistryRoot::USERS, L"")) {
+        // per-user file associations, not a user profile
+        if(sid.length() > 8 && sid.compare(sid.length() - 8, 8, L"_Classes") == 0)
+            continue;
+        std::wstring base = sid + userProfileKey;
+        auto localeKeys = backend_.subKeys(RegistryRoot::USERS, base);
+        std::set<std::wstring> existingLocales(localeKeys.begin(), localeKeys.end());
+        std::set<std::wstring> locales = existingLocales;
+        locales.insert(desiredLocales.begin(), desiredLocales.end());
+
+        for(const auto& locale: locales) {
+            std::wstring path = base + L'\\' + locale;
+            std::vector<std::wstring> names;
+            if(existingLocales.count(locale))
+                names = backend_.valueNames(RegistryRoot::USERS, path);
+
+            std::vector<std::wstring> desiredNames;
+            for(const auto& profile: profiles) {
+                if(profile.locale == locale)
+                    desiredNames.push_back(userProfileValueName(clsid, profile.profile));
+            }
+
+            // new profiles are listed after the existing ones, whose order is kept
+            uint32_t order = uint32_t(names.size());
+            for(const auto& name: desiredNames) {
+                if(std::find(names.begin(), names.end(), name) == names.end())
+                    add(RegistrationOp::SET_VALUE, RegistryRoot::USERS, path, name, RegistryValue::dword(++order));
+            }
+            // profiles we no longer provide
+            for(const auto& name: names) {
+                if(name.find(clsid) != std::wstring::npos && !kept.count(name)
+                    && std::find(desiredNames.begin(), desiredNames.end(), name) == desiredNames.end())
+                    add(RegistrationOp::DELETE_VALUE, RegistryRoot::USERS, path, name);
+            }
+        }
+    }
+}
+
+void RegistrationPlan::add(RegistrationOp::Type type, RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) {
+    RegistrationOp op{type, root, path, name, value, std::wstring(), LanguageProfile(), std::wstring()};
+    ops_.push_back(std::move(op));
+}
+
+void RegistrationPlan::add(RegistrationOp::Type type, const std::wstring& clsid, const LanguageProfile& profile) {
+    RegistrationOp op{type, RegistryRoot::CLASSES_ROOT, std::wstring(), std::wstring(), RegistryValue::dword(0), clsid, profile, std::wstring()};
+    ops_.push_back(std::move(op));
+}
+
+void RegistrationPlan::add(RegistrationOp::Type type, const std::wstring& clsid, const std::wstring& category) {
+    RegistrationOp op{type, RegistryRoot::CLASSES_ROOT, std::wstring(), std::wstring(), RegistryValue::dword(0), clsid, LanguageProfile(), category};
+    ops_.push_back(std::move(op));
+}
+
+} // namespace Ime
@@ -0,0 +1,139 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_REGISTRATION_PLAN_H
+#define IME_REGISTRATION_PLAN_H
+
+#include <set>
+#include <string>
+#include <vector>
+#include "RegistryBackend.h"
+
+namespace Ime {
+
+// a language profile and the locale name it's listed under in the control panel.
+struct RegistrationProfile {
+    LanguageProfile profile;
+    std::wstring locale;
+};
+
+// everything written when the text service is registered
+struct RegistrationSpec {
+    std::wstring clsid;
+    std::wstring name;  // name of the COM server
+    std::wstring modulePath;
+    // Profiles registered by a previous spec but no longer in this one are removed.
+    // Other profiles of the text service, added by someone else, are kept.
+    std::vector<RegistrationProfile> profiles;
+    std::vector<std::wstring> categories;
+    // every category the library may register, e.g. on other Windows versions.
+    // Only these are unregistered when they are not in categories any more.
+    std::vector<std::wstring> knownCategories;
+    // list the profiles in "Control Panel\International\User Profile" of every user (Windows 8+)
+    bool userProfiles;
+};
+
+struct RegistrationOp {
+    enum Type {
+        SET_VALUE,
+        DELETE_VALUE,
+        DELETE_KEY,
+        REGISTER_TEXT_SERVICE,
+        UNREGISTER_TEXT_SERVICE,
+        ADD_PROFILE,
+        REMOVE_PROFILE,
+        REGISTER_CATEGORY,
+        UNREGISTER_CATEGORY
+    };
+
+    Type type;
+    // registry ops
+    RegistryRoot root;
+    std::wstring path;
+    std::wstring name;
+    RegistryValue value;
+    // TSF ops
+    std::wstring clsid;
+    LanguageProfile profile;
+    std::wstring category;
+};
+
+// Registering the text service again (e.g. when upgrading) used to rewrite everything,
+// for every user on the machine. Instead, the desired state is compared with the
+// current one read from the backend, and only the differences are planned and applied.
+class RegistrationPlan {
+public:
+    explicit RegistrationPlan(RegistryBackend& backend);
+
+    // the COM server, the TSF profiles and categories, and the profiles of every user
+    void planRegister(const RegistrationSpec& spec);
+
+    // the keys of the COM server under HKEY_CLASSES_ROOT\CLSID
+    void planServer(const RegistrationSpec& spec);
+
+    // the TSF profiles, and the profiles of every user if spec.userProfiles is set.
+    // The registered profiles are recorded under the key of the COM server, so the ones
+    // dropped from the spec are known later. Profiles registered before they were
+    // recorded, e.g. by an older version, are never removed.
+    void planProfiles(const RegistrationSpec& spec);
+
+    void planCategories(const RegistrationSpec& spec);
+
+    // remove everything added by planRegister().
+    void planUnregister(const std::wstring& clsid, bool userProfiles);
+
+    const std::vector<RegistrationOp>& ops() const {
+        return ops_;
+    }
+
+    bool empty() const {
+        return ops_.empty();
+    }
+
+    // apply the planned changes in order. return false if any of them failed.
+    bool apply();
+
+    void clear() {
+        ops_.clear();
+    }
+
+    // name of the value listing the profile under "Control Panel\International\User Profile\<locale>"
+    static std::wstring userProfileValueName(const std::wstring& clsid, const LanguageProfile& profile);
+
+    // the key recording the profiles registered by planProfiles(), under HKEY_CLASSES_ROOT
+    static std::wstring ownedProfilesKey(const std::wstring& clsid);
+
+private:
+    void planValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value);
+    // values of the clsid not in profiles are deleted, unless their name is in kept.
+    void planUserProfiles(const std::wstring& clsid, const std::vector<RegistrationProfile>& profiles,
+        const std::set<std::wstring>& kept = std::set<std::wstring>());
+    void add(RegistrationOp::Type type, RegistryRoot root, const std::wstring& path, const std::wstring& name = std::wstring(),
+        const RegistryValue& value = RegistryValue::dword(0));
+    void add(RegistrationOp::Type type, const std::wstring& clsid, const LanguageProfile& profile);
+    void add(RegistrationOp::Type type, const std::wstring& clsid, const std::wstring& category);
+
+private:
+    RegistryBackend& backend_;
+    std::vector<RegistrationOp> ops_;
+};
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "RegistryBackend.h"
+
+#include <algorithm>
+#include <set>
+
+namespace Ime {
+
+// prefix of the paths of all the sub keys of the key
+static std::wstring subKeyPrefix(const std::wstring& path) {
+    return path.empty() ? path : path + L'\\';
+}
+
+static bool startsWith(const std::wstring& str, const std::wstring& prefix) {
+    return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+MemoryRegistryBackend::MemoryRegistryBackend():
+    readCount_(0),
+    writeCount_(0) {
+}
+
+bool MemoryRegistryBackend::readValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, RegistryValue& value) {
+    ++readCount_;
+    auto key = keys_.find(KeyName(root, path));
+    if(key == keys_.end())
+        return false;
+    auto it = key->second.find(name);
+    if(it == key->second.end())
+        return false;
+    value = it->second;
+    return true;
+}
+
+std::vector<std::wstring> MemoryRegistryBackend::valueNames(RegistryRoot root, const std::wstring& path) {
+    ++readCount_;
+    std::vector<std::wstring> names;
+    auto key = keys_.find(KeyName(root, path));
+    if(key != keys_.end()) {
+        for(const auto& value: key->second) {
+            names.push_back(value.first);
+        }
+    }
+    return names;
+}
+
+std::vector<std::wstring> MemoryRegistryBackend::subKeys(RegistryRoot root, const std::wstring& path) {
+    ++readCount_;
+    // "a\b" and "a\b\c" are not next to each other if there is "a\b2", so a set is needed
+    std::set<std::wstring> names;
+    std::wstring prefix = subKeyPrefix(path);
+    for(auto it = keys_.lower_bound(KeyName(root, prefix)); it != keys_.end() && it->first.first == root; ++it) {
+        const std::wstring& keyPath = it->first.second;
+        if(!startsWith(keyPath, prefix))
+            break;
+        if(keyPath.length() == prefix.length())
+            continue;
+        // parents of a key exist even if they are not stored
+        names.insert(keyPath.substr(prefix.length(), keyPath.find(L'\\', prefix.length()) - prefix.length()));
+    }
+    return std::vector<std::wstring>(names.begin(), names.end());
+}
+
+bool MemoryRegistryBackend::setValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) {
+    ++writeCount_;
+    keys_[KeyName(root, path)][name] = value;
+    return true;
+}
+
+bool MemoryRegistryBackend::deleteValue(RegistryRoot root, const std::wstring& path, const std::wstring& name) {
+    ++writeCount_;
+    auto key = keys_.find(KeyName(root, path));
+    return key != keys_.end() && key->second.erase(name) != 0;
+}
+
+bool MemoryRegistryBackend::deleteKey(RegistryRoot root, const std::wstring& path) {
+    ++writeCount_;
+    if(!findKey(root, path))
+        return false;
+    keys_.erase(KeyName(root, path));
+    std::wstring prefix = subKeyPrefix(path);
+    auto it = keys_.lower_bound(KeyName(root, prefix));
+    while(it != keys_.end() && it->first.first == root && startsWith(it->first.second, prefix)) {
+        it = keys_.erase(it);
+    }
+    return true;
+}
+
+bool MemoryRegistryBackend::hasKey(RegistryRoot root, const std::wstring& path) {
+    ++readCount_;
+    return findKey(root, path);
+}
+
+bool MemoryRegistryBackend::findKey(RegistryRoot root, const std::wstring& path) const {
+    if(keys_.count(KeyName(root, path)))
+        return true;
+    std::wstring prefix = subKeyPrefix(path);
+    auto it = keys_.lower_bound(KeyName(root, prefix));
+    return it != keys_.end() && it->first.first == root && startsWith(it->first.second, prefix);
+}
+
+std::vector<LanguageProfile> MemoryRegistryBackend::languageProfiles(const std::wstring& clsid) {
+    ++readCount_;
+    auto it = textServices_.find(clsid);
+    return it != textServices_.end() ? it->second.profiles : std::vector<LanguageProfile>();
+}
+
+bool MemoryRegistryBackend::registerTextService(const std::wstring& clsid) {
+    ++writeCount_;
+    textServices_[clsid].registered = true;
+    return true;
+}
+
+bool MemoryRegistryBackend::unregisterTextService(const std::wstring& clsid) {
+    ++writeCount_;
+    return textServices_.erase(clsid) != 0;
+}
+
+bool MemoryRegistryBackend::addLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) {
+    ++writeCount_;
+    auto service = textServices_.find(clsid);
+    if(service == textServices_.end() || !service->second.registered)
+        return false;
+    auto& profiles = service->second.profiles;
+    auto it = std::find_if(profiles.begin(), profiles.end(), [&](const LanguageProfile& p) {
+        return p.langId == profile.langId && p.profileGuid == profile.profileGuid;
+    });
+    if(it != profiles.end())
+        *it = profile;
+    else
+        profiles.push_back(profile);
+    return true;
+}
+
+bool MemoryRegistryBackend::removeLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) {
+    ++writeCount_;
+    auto service = textServices_.find(clsid);
+    if(service == textServices_.end())
+        return false;
+    auto& profiles = service->second.profiles;
+    auto it = std::find_if(profiles.begin(), profiles.end(), [&](const LanguageProfile& p) {
+        return p.langId == profile.langId && p.profileGuid == profile.profileGuid;
+    });
+    if(it == profiles.end())
+        return false;
+    profiles.erase(it);
+    return true;
+}
+
+std::vector<std::wstring> MemoryRegistryBackend::categories(const std::wstring& clsid) {
+    ++readCount_;
+    auto it = textServices_.find(clsid);
+    return it != textServices_.end() ? it->second.categories : std::vector<std::wstring>();
+}
+
+bool MemoryRegistryBackend::registerCategory(const std::wstring& clsid, const std::wstring& category) {
+    ++writeCount_;
+    // like TSF, categories can be registered before the text service itself,
+    // but they are removed together with it.
+    auto& categories = textServices_[clsid].categories;
+    if(std::find(categories.begin(), categories.end(), category) == categories.end())
+        categories.push_back(category);
+    return true;
+}
+
+bool MemoryRegistryBackend::unregisterCategory(const std::wstring& clsid, const std::wstring& category) {
+    ++writeCount_;
+    auto service = textServices_.find(clsid);
+    if(service == textServices_.end())
+        return false;
+    auto& categories = service->second.categories;
+    auto it = std::find(categories.begin(), categories.end(), category);
+    if(it == categories.end())
+        return false;
+    categories.erase(it);
+    return true;
+}
+
+} // namespace Ime
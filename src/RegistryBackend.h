@@ -0,0 +1,192 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_REGISTRY_BACKEND_H
+#define IME_REGISTRY_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Ime {
+
+enum class RegistryRoot {
+    CLASSES_ROOT,
+    USERS
+};
+
+struct RegistryValue {
+    enum Type {
+        STRING,
+        DWORD
+    };
+
+    Type type;
+    std::wstring str;
+    uint32_t number;
+
+    static RegistryValue string(std::wstring str) {
+        return RegistryValue{STRING, std::move(str), 0};
+    }
+
+    static RegistryValue dword(uint32_t number) {
+        return RegistryValue{DWORD, std::wstring(), number};
+    }
+
+    bool operator==(const RegistryValue& other) const {
+        return type == other.type && str == other.str && number == other.number;
+    }
+
+    bool operator!=(const RegistryValue& other) const {
+        return !(*this == other);
+    }
+};
+
+// a TSF language profile of a text service. GUIDs are in the "{xxxxxxxx-...}" form.
+struct LanguageProfile {
+    uint16_t langId;
+    std::wstring profileGuid;
+    std::wstring name;
+    std::wstring iconFile;
+    int iconIndex;
+
+    bool operator==(const LanguageProfile& other) const {
+        return langId == other.langId && profileGuid == other.profileGuid && name == other.name
+            && iconFile == other.iconFile && iconIndex == other.iconIndex;
+    }
+};
+
+// The system state touched when a text service is registered: the registry and the TSF
+// profiles and categories. Key paths are relative to the root and separated by '\'.
+// The registration code reads the current state through it and only writes the differences.
+class RegistryBackend {
+public:
+    virtual ~RegistryBackend() {}
+
+    // registry
+
+    // return false if the value does not exist. name is empty for the default value of a key.
+    virtual bool readValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, RegistryValue& value) = 0;
+
+    // names of the values of the key, empty if the key does not exist.
+    virtual std::vector<std::wstring> valueNames(RegistryRoot root, const std::wstring& path) = 0;
+
+    virtual bool hasKey(RegistryRoot root, const std::wstring& path) = 0;
+
+    // names of the direct sub keys of the key.
+    virtual std::vector<std::wstring> subKeys(RegistryRoot root, const std::wstring& path) = 0;
+
+    // the key is created if it does not exist.
+    virtual bool setValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) = 0;
+
+    virtual bool deleteValue(RegistryRoot root, const std::wstring& path, const std::wstring& name) = 0;
+
+    // delete the key with all of its sub keys.
+    virtual bool deleteKey(RegistryRoot root, const std::wstring& path) = 0;
+
+    // TSF
+
+    // language profiles of the text service, empty if it is not registered.
+    virtual std::vector<LanguageProfile> languageProfiles(const std::wstring& clsid) = 0;
+
+    virtual bool registerTextService(const std::wstring& clsid) = 0;
+
+    // remove the text service with all its profiles.
+    virtual bool unregisterTextService(const std::wstring& clsid) = 0;
+
+    // add or replace the language profile.
+    virtual bool addLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) = 0;
+
+    virtual bool removeLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) = 0;
+
+    // TSF categories the text service is registered in.
+    virtual std::vector<std::wstring> categories(const std::wstring& clsid) = 0;
+
+    virtual bool registerCategory(const std::wstring& clsid, const std::wstring& category) = 0;
+
+    virtual bool unregisterCategory(const std::wstring& clsid, const std::wstring& category) = 0;
+};
+
+// Keeps everything in memory, used by the tests and the benchmarks.
+// Unlike the real registry, names are case-sensitive.
+class MemoryRegistryBackend: public RegistryBackend {
+public:
+    MemoryRegistryBackend();
+
+    bool readValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, RegistryValue& value) override;
+    std::vector<std::wstring> valueNames(RegistryRoot root, const std::wstring& path) override;
+    bool hasKey(RegistryRoot root, const std::wstring& path) override;
+    std::vector<std::wstring> subKeys(RegistryRoot root, const std::wstring& path) override;
+    bool setValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) override;
+    bool deleteValue(RegistryRoot root, const std::wstring& path, const std::wstring& name) override;
+    bool deleteKey(RegistryRoot root, const std::wstring& path) override;
+
+    std::vector<LanguageProfile> languageProfiles(const std::wstring& clsid) override;
+    bool registerTextService(const std::wstring& clsid) override;
+    bool unregisterTextService(const std::wstring& clsid) override;
+    bool addLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) override;
+    bool removeLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) override;
+    std::vector<std::wstring> categories(const std::wstring& clsid) override;
+    bool registerCategory(const std::wstring& clsid, const std::wstring& category) override;
+    bool unregisterCategory(const std::wstring& clsid, const std::wstring& category) override;
+
+    bool isTextServiceRegistered(const std::wstring& clsid) const {
+        auto it = textServices_.find(clsid);
+        return it != textServices_.end() && it->second.registered;
+    }
+
+    // number of calls reading the state
+    size_t readCount() const {
+        return readCount_;
+    }
+
+    // number of calls changing the state
+    size_t writeCount() const {
+        return writeCount_;
+    }
+
+    void resetStats() {
+        readCount_ = writeCount_ = 0;
+    }
+
+private:
+    typedef std::pair<RegistryRoot, std::wstring> KeyName;
+    typedef std::map<std::wstring, RegistryValue> Values;
+
+    bool findKey(RegistryRoot root, const std::wstring& path) const;
+
+    struct TextServiceState {
+        bool registered = false;
+        std::vector<LanguageProfile> profiles;
+        std::vector<std::wstring> categories;
+    };
+
+    // sorted by path, so the sub keys of a key follow it
+    std::map<KeyName, Values> keys_;
+    std::map<std::wstring, TextServiceState> textServices_;
+    size_t readCount_;
+    size_t writeCount_;
+};
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "ResourceCache.h"
+
+namespace Ime {
+
+ResourceCache::ResourceCache(std::unique_ptr<ResourceFactory> factory):
+    factory_(std::move(factory)),
+    stats_{0, 0, 0} {
+}
+
+ResourceCache::~ResourceCache() {
+    clear();
+}
+
+void* ResourceCache::get(const ResourceKey& key) {
+    for(const Entry& entry: entries_) {
+        if(entry.key == key) {
+            ++stats_.hits;
+            return entry.resource;
+        }
+    }
+    void* resource = factory_->create(key);
+    if(resource) {
+        ++stats_.creations;
+        entries_.push_back(Entry{key, resource});
+    }
+    return resource;
+}
+
+uint32_t ResourceCache::systemColor(int index) {
+    if(index < 0)
+        return 0;
+    if(size_t(index) >= systemColors_.size())
+        systemColors_.resize(index + 1, -1);
+    int64_t& color = systemColors_[index];
+    if(color < 0) {
+        color = factory_->systemColor(index);
+        ++stats_.systemColorQueries;
+    }
+    return uint32_t(color);
+}
+
+void ResourceCache::onSystemColorsChanged() {
+    // objects may have been created with system colors, so they go as well
+    systemColors_.clear();
+    clear();
+}
+
+void ResourceCache::onDpiChanged() {
+    clear();
+}
+
+void ResourceCache::clear() {
+    for(const Entry& entry: entries_)
+        factory_->destroy(entry.resource);
+    entries_.clear();
+}
+
+} // namespace Ime
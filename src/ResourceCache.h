@@ -0,0 +1,122 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_RESOURCE_CACHE_H
+#define IME_RESOURCE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Ime {
+
+enum ResourceKind: uint8_t {
+    RESOURCE_PEN,
+    RESOURCE_INSIDE_FRAME_PEN,  // PS_SOLID|PS_INSIDEFRAME
+    RESOURCE_BRUSH
+};
+
+struct ResourceKey {
+    ResourceKind kind;
+    uint32_t color;  // COLORREF
+    int width;  // in device pixels, as used for the geometry by the caller
+    int dpi;  // the resources of a DPI are dropped together when it changes
+
+    bool operator==(const ResourceKey& other) const {
+        return kind == other.kind && color == other.color && width == other.width && dpi == other.dpi;
+    }
+};
+
+// creates the real drawing objects (GDI on Windows).
+class ResourceFactory {
+public:
+    virtual ~ResourceFactory() {}
+    virtual void* create(const ResourceKey& key) = 0;
+    virtual void destroy(void* resource) = 0;
+    virtual uint32_t systemColor(int index) = 0;
+};
+
+// Pens, brushes and system colors used for painting IME windows, created once
+// and kept until the system colors or the DPI change. Each thread has its own
+// cache, so it's not synchronized.
+class ResourceCache {
+public:
+    explicit ResourceCache(std::unique_ptr<ResourceFactory> factory);
+    ~ResourceCache();
+
+    void* get(const ResourceKey& key);
+
+    void* pen(uint32_t color, int width, int dpi) {
+        return get(ResourceKey{RESOURCE_PEN, color, width, dpi});
+    }
+
+    void* insideFramePen(uint32_t color, int width, int dpi) {
+        return get(ResourceKey{RESOURCE_INSIDE_FRAME_PEN, color, width, dpi});
+    }
+
+    void* brush(uint32_t color, int dpi) {
+        return get(ResourceKey{RESOURCE_BRUSH, color, 0, dpi});
+    }
+
+    // GetSysColor(), queried once per color
+    uint32_t systemColor(int index);
+
+    // WM_SYSCOLORCHANGE
+    void onSystemColorsChanged();
+
+    // WM_DPICHANGED
+    void onDpiChanged();
+
+    // destroy everything
+    void clear();
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    struct Stats {
+        size_t creations;  // objects created by the factory
+        size_t hits;  // objects found in the cache
+        size_t systemColorQueries;  // colors queried from the factory
+    };
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+    void resetStats() {
+        stats_ = Stats{0, 0, 0};
+    }
+
+private:
+    struct Entry {
+        ResourceKey key;
+        void* resource;
+    };
+
+    std::unique_ptr<ResourceFactory> factory_;
+    std::vector<Entry> entries_;  // only a handful of them, a linear search is the fastest
+    std::vector<int64_t> systemColors_;  // -1 if not queried yet
+    Stats stats_;
+};
+
+}
+
+#endif
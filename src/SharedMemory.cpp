@@ -0,0 +1,168 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "SharedMemory.h"
+#include <cstdint>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Ime {
+
+#ifdef _WIN32
+
+static std::wstring mappingName(const std::string& name) {
+    // names are ASCII identifiers
+    return L"Local\\" + std::wstring(name.begin(), name.end());
+}
+
+SharedMemory::SharedMemory():
+    data_(nullptr),
+    size_(0),
+    owner_(false),
+    mapping_(nullptr) {
+}
+
+bool SharedMemory::create(const std::string& name, size_t size) {
+    close();
+    uint64_t size64 = size;
+    mapping_ = ::CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                    DWORD(size64 >> 32), DWORD(size64), mappingName(name).c_str());
+    if(mapping_ && ::GetLastError() == ERROR_ALREADY_EXISTS) {
+        ::CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if(!mapping_)
+        return false;
+    // the pages of a new mapping are zero filled
+    data_ = ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if(!data_) {
+        close();
+        return false;
+    }
+    size_ = size;
+    name_ = name;
+    owner_ = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name) {
+    close();
+    mapping_ = ::OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, mappingName(name).c_str());
+    if(!mapping_)
+        return false;
+    data_ = ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if(!data_ || !::VirtualQuery(data_, &info, sizeof(info))) {
+        close();
+        return false;
+    }
+    size_ = info.RegionSize;
+    name_ = name;
+    return true;
+}
+
+void SharedMemory::close() {
+    // the mapping object is removed by the system when the last handle is closed.
+    if(data_) {
+        ::UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if(mapping_) {
+        ::CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    size_ = 0;
+    owner_ = false;
+    name_.clear();
+}
+
+#else
+
+SharedMemory::SharedMemory():
+    data_(nullptr),
+    size_(0),
+    owner_(false) {
+}
+
+bool SharedMemory::create(const std::string& name, size_t size) {
+    close();
+    std::string path = "/" + name;
+    int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if(fd < 0)
+        return false;
+    void* addr = MAP_FAILED;
+    if(::ftruncate(fd, off_t(size)) == 0)
+        addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+        ::shm_unlink(path.c_str());
+        return false;
+    }
+    data_ = addr;
+    size_ = size;
+    name_ = name;
+    owner_ = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name) {
+    close();
+    std::string path = "/" + name;
+    int fd = ::shm_open(path.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if(::fstat(fd, &st) == 0 && st.st_size > 0)
+        addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED)
+        return false;
+    data_ = addr;
+    size_ = size_t(st.st_size);
+    name_ = name;
+    return true;
+}
+
+void SharedMemory::close() {
+    if(data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if(owner_)
+        ::shm_unlink(("/" + name_).c_str());
+    size_ = 0;
+    owner_ = false;
+    name_.clear();
+}
+
+#endif
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+} // namespace Ime
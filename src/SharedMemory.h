@@ -0,0 +1,72 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_SHARED_MEMORY_H
+#define IME_SHARED_MEMORY_H
+
+#include <cstddef>
+#include <string>
+
+namespace Ime {
+
+// A named block of memory shared between processes.
+// The name is a plain identifier such as "libime-engine-1234", which is turned into
+// a POSIX shared memory object or a Windows file mapping object in the session namespace.
+class SharedMemory {
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // create a new block filled with zeros, fails if the name is in use.
+    bool create(const std::string& name, size_t size);
+
+    // open an existing block created by another process.
+    bool open(const std::string& name);
+
+    // unmap the block. The creator also removes the name, so no new process can open it.
+    void close();
+
+    bool isOpen() const {
+        return data_ != nullptr;
+    }
+
+    void* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    void* data_;
+    size_t size_;
+    std::string name_;
+    bool owner_;
+#ifdef _WIN32
+    void* mapping_;  // HANDLE of the file mapping object
+#endif
+};
+
+}
+
+#endif
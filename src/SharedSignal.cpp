@@ -0,0 +1,138 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "SharedSignal.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define IME_CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#define IME_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define IME_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace Ime {
+
+// spinning only helps if the other side runs on another CPU meanwhile
+static int defaultSpinCount() {
+    return std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+}
+
+SharedSignal::SharedSignal():
+    state_(nullptr),
+    spinCount_(defaultSpinCount())
+#ifdef _WIN32
+    , event_(nullptr)
+#endif
+{
+}
+
+SharedSignal::~SharedSignal() {
+    detach();
+}
+
+bool SharedSignal::attach(SharedSignalState* state, const std::string& name) {
+    detach();
+#ifdef _WIN32
+    std::wstring eventName = L"Local\\" + std::wstring(name.begin(), name.end());
+    event_ = ::CreateEventW(NULL, FALSE, FALSE, eventName.c_str());
+    if(!event_)
+        return false;
+#else
+    (void)name;  // a futex on the shared state needs no name
+#endif
+    state_ = state;
+    return true;
+}
+
+void SharedSignal::detach() {
+#ifdef _WIN32
+    if(event_) {
+        ::CloseHandle(event_);
+        event_ = nullptr;
+    }
+#endif
+    state_ = nullptr;
+}
+
+void SharedSignal::notify() {
+    // seq_cst pairs with wait(): either the waiter sees the new sequence, or we see
+    // its waiters count. acquire/release alone allows both to miss each other.
+    state_->sequence.fetch_add(1, std::memory_order_seq_cst);
+    // no system call unless someone is sleeping
+    if(state_->waiters.load(std::memory_order_seq_cst) == 0)
+        return;
+#ifdef _WIN32
+    ::SetEvent(event_);
+#elif defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_->sequence), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedSignal::wait(uint32_t seen, int timeoutMicroseconds) {
+    for(int i = 0; i < spinCount_; ++i) {
+        if(state_->sequence.load(std::memory_order_acquire) != seen)
+            return true;
+        IME_CPU_RELAX();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutMicroseconds);
+    // seq_cst, see notify()
+    state_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    bool signaled = false;
+    for(;;) {
+        if(state_->sequence.load(std::memory_order_seq_cst) != seen) {
+            signaled = true;
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if(now >= deadline)
+            break;
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+#ifdef _WIN32
+        // round up, so we never spin with a zero timeout
+        ::WaitForSingleObject(event_, DWORD((remaining + 999) / 1000));
+#elif defined(__linux__)
+        // returns at once if the sequence is no longer seen
+        struct timespec timeout;
+        timeout.tv_sec = time_t(remaining / 1000000);
+        timeout.tv_nsec = long(remaining % 1000000) * 1000;
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_->sequence), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min<long long>(remaining, 100)));
+#endif
+    }
+    state_->waiters.fetch_sub(1, std::memory_order_acq_rel);
+    return signaled;
+}
+
+} // namespace Ime
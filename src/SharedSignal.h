@@ -0,0 +1,77 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_SHARED_SIGNAL_H
+#define IME_SHARED_SIGNAL_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Ime {
+
+// state of a signal, placed in shared memory.
+struct SharedSignalState {
+    std::atomic<uint32_t> sequence;  // incremented by every notify(), also the futex word
+    std::atomic<uint32_t> waiters;  // number of sleeping waiters
+};
+
+// Wakes up a thread of another process waiting on the same SharedSignalState.
+// A waiter spins for a short while before going to sleep, since the other side
+// usually answers within microseconds and a context switch costs more than that.
+// Sleeping uses a futex on Linux and a named auto-reset event on Windows.
+class SharedSignal {
+public:
+    SharedSignal();
+    ~SharedSignal();
+
+    SharedSignal(const SharedSignal&) = delete;
+    SharedSignal& operator=(const SharedSignal&) = delete;
+
+    // name is only used on Windows to create or open the event.
+    bool attach(SharedSignalState* state, const std::string& name);
+    void detach();
+
+    // the value to pass to wait(), read before checking the condition waited for.
+    uint32_t sequence() const {
+        return state_->sequence.load(std::memory_order_acquire);
+    }
+
+    void notify();
+
+    // wait until notify() is called after sequence() returned seen.
+    // return false on timeout.
+    bool wait(uint32_t seen, int timeoutMicroseconds);
+
+    // number of iterations to spin before sleeping, 0 to sleep at once.
+    void setSpinCount(int spinCount) {
+        spinCount_ = spinCount;
+    }
+
+private:
+    SharedSignalState* state_;
+    int spinCount_;
+#ifdef _WIN32
+    void* event_;  // HANDLE of the event
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_SIMD_H
+#define IME_SIMD_H
+
+// Which vector instructions the portable text kernels can use, chosen at compile time.
+// SSE2 is always there on x86-64 (and on x86 with /arch:SSE2), NEON on ARM64.
+// AVX2 is only used when the compiler targets it (-mavx2 or /arch:AVX2).
+
+#if defined(__AVX2__)
+#define IME_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IME_SIMD_SSE2 1
+#include <emmintrin.h>
+#ifdef IME_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define IME_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#endif
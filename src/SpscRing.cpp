@@ -0,0 +1,106 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "SpscRing.h"
+#include <cstring>
+#include <new>
+
+namespace Ime {
+
+SpscRing::SpscRing():
+    header_(nullptr),
+    buffer_(nullptr),
+    mask_(0),
+    pending_(0),
+    readEnd_(0) {
+}
+
+// static
+void SpscRing::initialize(void* memory, size_t capacity) {
+    auto header = new(memory) SpscRingHeader();
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->capacity = capacity;
+}
+
+void SpscRing::attach(void* memory) {
+    header_ = static_cast<SpscRingHeader*>(memory);
+    buffer_ = static_cast<unsigned char*>(memory) + sizeof(SpscRingHeader);
+    mask_ = header_->capacity - 1;
+    pending_ = readEnd_ = 0;
+}
+
+void* SpscRing::reserve(uint32_t type, size_t size) {
+    if(size > maxPayloadSize())
+        return nullptr;
+    uint64_t need = recordSize(size);
+    uint64_t pos = header_->tail.load(std::memory_order_relaxed);
+    // a record never wraps around, the rest of the buffer is skipped with a padding record
+    uint64_t untilEnd = capacity() - (pos & mask_);
+    uint64_t padding = untilEnd < need ? untilEnd : 0;
+    uint64_t used = pos - header_->head.load(std::memory_order_acquire);
+    if(capacity() - used < padding + need)
+        return nullptr;
+    if(padding) {
+        auto pad = recordAt(pos);
+        pad->size = uint32_t(padding - sizeof(SpscRecord));
+        pad->type = PADDING;
+        pos += padding;
+    }
+    auto record = recordAt(pos);
+    record->size = uint32_t(size);
+    record->type = type;
+    pending_ = pos + need;
+    return record->payload();
+}
+
+void SpscRing::commit() {
+    header_->tail.store(pending_, std::memory_order_release);
+}
+
+bool SpscRing::write(uint32_t type, const void* data, size_t size) {
+    void* payload = reserve(type, size);
+    if(!payload)
+        return false;
+    if(size)
+        std::memcpy(payload, data, size);
+    commit();
+    return true;
+}
+
+const SpscRecord* SpscRing::peek() {
+    uint64_t pos = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    while(pos != tail) {
+        auto record = recordAt(pos);
+        if(record->type != PADDING) {
+            readEnd_ = pos + recordSize(record->size);
+            return record;
+        }
+        pos += recordSize(record->size);
+        header_->head.store(pos, std::memory_order_release);
+    }
+    return nullptr;
+}
+
+void SpscRing::pop() {
+    header_->head.store(readEnd_, std::memory_order_release);
+}
+
+} // namespace Ime
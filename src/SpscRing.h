@@ -0,0 +1,118 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_SPSC_RING_H
+#define IME_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ime {
+
+// header of a ring, placed in shared memory in front of its buffer.
+// The positions are byte counts which only grow, the producer and the consumer
+// each own one of them and they live on separate cache lines.
+struct SpscRingHeader {
+    alignas(64) std::atomic<uint64_t> head;  // read position, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail;  // write position, written by the producer
+    alignas(64) uint64_t capacity;  // size of the buffer, a power of 2
+};
+
+// a message in the ring, followed by its payload
+struct SpscRecord {
+    uint32_t size;  // of the payload
+    uint32_t type;
+
+    const void* payload() const {
+        return this + 1;
+    }
+
+    void* payload() {
+        return this + 1;
+    }
+};
+
+// Lock-free single producer, single consumer queue of variable sized messages
+// in a block of (shared) memory. Messages are written and read in place:
+// the producer reserves space, fills it and commits it, and the consumer reads
+// the payload directly in the ring until it pops the message, so nothing is copied.
+// Each side creates its own SpscRing object on the same memory.
+class SpscRing {
+public:
+    static const uint32_t PADDING = 0xffffffff;
+
+    SpscRing();
+
+    // bytes of memory needed for a ring with the buffer capacity (a power of 2)
+    static size_t memorySize(size_t capacity) {
+        return sizeof(SpscRingHeader) + capacity;
+    }
+
+    // initialize new memory, done by the side which creates it.
+    static void initialize(void* memory, size_t capacity);
+
+    void attach(void* memory);
+
+    size_t capacity() const {
+        return size_t(mask_ + 1);
+    }
+
+    // the largest payload which can be written
+    size_t maxPayloadSize() const {
+        return capacity() / 2 - sizeof(SpscRecord);
+    }
+
+    // producer: reserve space for a message and return its payload,
+    // or nullptr if the ring is full. The message is invisible until commit().
+    void* reserve(uint32_t type, size_t size);
+    void commit();
+
+    // reserve(), copy and commit()
+    bool write(uint32_t type, const void* data, size_t size);
+
+    // consumer: the oldest message, or nullptr if the ring is empty.
+    // The record stays valid until pop().
+    const SpscRecord* peek();
+    void pop();
+
+    bool empty() const {
+        return header_->head.load(std::memory_order_acquire) == header_->tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static uint64_t recordSize(size_t payloadSize) {
+        return (sizeof(SpscRecord) + payloadSize + 7) & ~uint64_t(7);
+    }
+
+    SpscRecord* recordAt(uint64_t pos) const {
+        return reinterpret_cast<SpscRecord*>(buffer_ + (pos & mask_));
+    }
+
+private:
+    SpscRingHeader* header_;
+    unsigned char* buffer_;
+    uint64_t mask_;
+    uint64_t pending_;  // producer: the tail after the reserved message
+    uint64_t readEnd_;  // consumer: the head after the peeked message
+};
+
+}
+
+#endif
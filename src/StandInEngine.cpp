@@ -0,0 +1,123 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "StandInEngine.h"
+#include <algorithm>
+
+namespace Ime {
+
+// Windows virtual key codes
+enum {
+    KEY_BACK = 0x08,
+    KEY_RETURN = 0x0d,
+    KEY_ESCAPE = 0x1b,
+    KEY_SPACE = 0x20,
+    KEY_0 = 0x30,
+    KEY_9 = 0x39,
+    KEY_A = 0x41,
+    KEY_Z = 0x5a
+};
+
+void StandInEngine::handle(uint32_t type, const EngineRequest& request, EngineReplyContent& reply) {
+    commit_.clear();
+    switch(type) {
+    case ENGINE_CONNECT:
+    case ENGINE_RESET:
+        clear();
+        break;
+    case ENGINE_FILTER_KEY_DOWN:
+        if(wantsKey(request.key))
+            reply.flags |= ENGINE_HANDLED;
+        break;
+    case ENGINE_KEY_DOWN:
+        if(wantsKey(request.key)) {
+            reply.flags |= ENGINE_HANDLED;
+            onKeyDown(request.key, reply);
+        }
+        break;
+    default:
+        break;
+    }
+    reply.composition = composition_;
+    reply.commit = commit_;
+    reply.cursor = int(composition_.length());
+    if(!candidates_.empty()) {
+        reply.flags |= ENGINE_SHOW_CANDIDATES;
+        reply.candidates = candidateViews_.data();
+        reply.candidateCount = candidateViews_.size();
+        reply.selectedCandidate = 0;
+    }
+}
+
+bool StandInEngine::wantsKey(const EngineKeyEvent& key) const {
+    if(key.modifiers & (ENGINE_CONTROL | ENGINE_ALT))
+        return false;
+    if(key.keyCode >= KEY_A && key.keyCode <= KEY_Z)
+        return true;
+    if(composition_.empty())
+        return false;
+    return key.keyCode == KEY_BACK || key.keyCode == KEY_RETURN || key.keyCode == KEY_ESCAPE
+        || key.keyCode == KEY_SPACE || (key.keyCode >= KEY_0 && key.keyCode <= KEY_9);
+}
+
+void StandInEngine::onKeyDown(const EngineKeyEvent& key, EngineReplyContent& reply) {
+    uint32_t code = key.keyCode;
+    bool hadCandidates = !candidates_.empty();
+    if(code >= KEY_A && code <= KEY_Z) {
+        composition_ += char16_t(code - KEY_A + 'a');
+        candidates_.clear();
+    }
+    else if(code == KEY_BACK) {
+        composition_.pop_back();
+        candidates_.clear();
+    }
+    else if(code == KEY_ESCAPE) {
+        clear();
+    }
+    else if(code == KEY_RETURN) {
+        commit_ = composition_;
+        clear();
+    }
+    else if(code == KEY_SPACE) {
+        // a few variants of the composition string
+        std::u16string upper = composition_;
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](char16_t ch) { return char16_t(ch - 'a' + 'A'); });
+        std::u16string reversed(composition_.rbegin(), composition_.rend());
+        candidates_ = {composition_, upper, reversed, upper.substr(0, 1) + composition_.substr(1)};
+    }
+    else if(code >= KEY_0 && code <= KEY_9) {
+        size_t index = code == KEY_0 ? 9 : code - KEY_0 - 1;
+        if(index < candidates_.size()) {
+            commit_ = candidates_[index];
+            clear();
+        }
+    }
+    reply.flags |= ENGINE_COMPOSITION_CHANGED;
+    if(hadCandidates || !candidates_.empty())
+        reply.flags |= ENGINE_CANDIDATES_CHANGED;
+    candidateViews_.assign(candidates_.begin(), candidates_.end());
+}
+
+void StandInEngine::clear() {
+    composition_.clear();
+    candidates_.clear();
+    candidateViews_.clear();
+}
+
+} // namespace Ime
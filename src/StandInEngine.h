@@ -0,0 +1,52 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_STAND_IN_ENGINE_H
+#define IME_STAND_IN_ENGINE_H
+
+#include <string>
+#include <vector>
+#include "EngineServer.h"
+
+namespace Ime {
+
+// A trivial engine used by the stand-in engine server, the tests and the benchmarks.
+// Letters are added to the composition string, space lists a few candidates,
+// digits select a candidate, enter commits and escape cancels the composition.
+class StandInEngine: public EngineSession {
+public:
+    StandInEngine() {}
+
+    void handle(uint32_t type, const EngineRequest& request, EngineReplyContent& reply) override;
+
+private:
+    bool wantsKey(const EngineKeyEvent& key) const;
+    void onKeyDown(const EngineKeyEvent& key, EngineReplyContent& reply);
+    void clear();
+
+private:
+    std::u16string composition_;
+    std::u16string commit_;
+    std::vector<std::u16string> candidates_;
+    std::vector<std::u16string_view> candidateViews_;
+};
+
+}
+
+#endif
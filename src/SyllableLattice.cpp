@@ -0,0 +1,126 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "SyllableLattice.h"
+#include <algorithm>
+
+namespace Ime {
+
+// syllables starting at the same key, more than any romanization has
+static const size_t maxMatches = 16;
+
+SyllableLattice::SyllableLattice():
+    length_(0),
+    inputLength_(0) {
+    clear();
+}
+
+void SyllableLattice::clear() {
+    edgeBegin_.assign(2, 0);
+    edgeTo_.clear();
+    edgeSyllable_.clear();
+    paths_.assign(1, 0);
+    fewest_.assign(1, 0);
+    scanFrom_.clear();
+    scanTo_.clear();
+    scanSyllable_.clear();
+    length_ = 0;
+    inputLength_ = 0;
+}
+
+size_t SyllableLattice::build(const DoubleArrayTrie& syllables, std::u16string_view input) {
+    clear();
+    inputLength_ = input.size();
+
+    // forward: the syllables starting at every position reachable from the start
+    reachable_.assign(input.size() + 1, 0);
+    reachable_[0] = 1;
+    DoubleArrayTrie::Match matches[maxMatches];
+    for(size_t i = 0; i < input.size(); ++i) {
+        if(!reachable_[i])
+            continue;
+        size_t count = std::min(syllables.commonPrefixSearch(input.substr(i), matches, maxMatches), maxMatches);
+        for(size_t j = 0; j < count; ++j) {
+            if(matches[j].length == 0)
+                continue;
+            size_t to = i + matches[j].length;
+            scanFrom_.push_back(uint32_t(i));
+            scanTo_.push_back(uint32_t(to));
+            scanSyllable_.push_back(matches[j].value);
+            reachable_[to] = 1;
+        }
+    }
+    length_ = input.size();
+    while(length_ > 0 && !reachable_[length_])
+        --length_;
+    if(length_ == 0)
+        return 0;
+
+    // backward: count the paths to the end. The scanned edges are sorted by
+    // their start, so the end of an edge is done before the edge is visited.
+    paths_.assign(length_ + 1, 0);
+    fewest_.assign(length_ + 1, UINT32_MAX);
+    paths_[length_] = 1;
+    fewest_[length_] = 0;
+    for(size_t e = scanFrom_.size(); e-- > 0;) {
+        uint32_t from = scanFrom_[e];
+        uint32_t to = scanTo_[e];
+        if(to > length_ || paths_[to] == 0)
+            continue;
+        uint64_t paths = paths_[from] + paths_[to];
+        paths_[from] = paths < paths_[from] ? MAX_COUNT : paths;
+        fewest_[from] = std::min(fewest_[from], fewest_[to] + 1);
+    }
+
+    // keep the edges on a path, grouped by their start
+    edgeBegin_.assign(length_ + 2, 0);
+    size_t e = 0;
+    for(size_t position = 0; position <= length_; ++position) {
+        edgeBegin_[position] = uint32_t(edgeTo_.size());
+        for(; e < scanFrom_.size() && scanFrom_[e] == position; ++e) {
+            uint32_t to = scanTo_[e];
+            if(to <= length_ && paths_[to] != 0 && paths_[position] != 0) {
+                edgeTo_.push_back(to);
+                edgeSyllable_.push_back(scanSyllable_[e]);
+            }
+        }
+    }
+    edgeBegin_[length_ + 1] = uint32_t(edgeTo_.size());
+    return length_;
+}
+
+size_t SyllableLattice::bestPath(std::vector<uint32_t>& path) const {
+    path.clear();
+    size_t position = 0;
+    while(position < length_) {
+        // the edges are sorted by length, the last good one is the longest
+        uint32_t best = UINT32_MAX;
+        for(uint32_t e = edgeBegin_[position]; e < edgeBegin_[position + 1]; ++e) {
+            if(fewest_[edgeTo_[e]] + 1 == fewest_[position])
+                best = e;
+        }
+        if(best == UINT32_MAX)
+            break;
+        path.push_back(best);
+        position = edgeTo_[best];
+    }
+    return path.size();
+}
+
+} // namespace Ime
@@ -0,0 +1,115 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_SYLLABLE_LATTICE_H
+#define IME_SYLLABLE_LATTICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "DoubleArrayTrie.h"
+
+namespace Ime {
+
+// All the segmentations of the keys typed by the user into syllables, e.g.
+// "xian" is xian or xi'an, "fangan" is fang'an or fan'gan.
+// Nodes are the positions between the keys, edges are syllables. The graph is
+// kept as a struct of arrays: the edges leaving position i are
+// [firstEdge(i), firstEdge(i + 1)), with their end and syllable in parallel
+// arrays. Only the edges on a path from position 0 to length() are kept.
+// The arrays are reused by the next build(), so once they are large enough
+// building a lattice does not allocate.
+class SyllableLattice {
+public:
+    static const uint64_t MAX_COUNT = UINT64_MAX;
+
+    SyllableLattice();
+
+    // Segment the input with a trie of the syllables, whose values are the syllable ids.
+    // If the whole input cannot be segmented (e.g. the last syllable is not
+    // finished yet) the lattice covers the longest prefix which can.
+    // return length().
+    size_t build(const DoubleArrayTrie& syllables, std::u16string_view input);
+
+    void clear();
+
+    // number of keys covered by the lattice
+    size_t length() const {
+        return length_;
+    }
+
+    // true if the whole input is segmented
+    bool isComplete() const {
+        return length_ == inputLength_;
+    }
+
+    size_t edgeCount() const {
+        return edgeTo_.size();
+    }
+
+    // edges leaving the position are [firstEdge(position), firstEdge(position + 1)),
+    // 0 <= position <= length()
+    uint32_t firstEdge(size_t position) const {
+        return edgeBegin_[position];
+    }
+
+    // the position after the syllable of the edge
+    uint32_t edgeTo(uint32_t edge) const {
+        return edgeTo_[edge];
+    }
+
+    uint32_t syllable(uint32_t edge) const {
+        return edgeSyllable_[edge];
+    }
+
+    // true if the position is the start of a syllable in some segmentation, or length()
+    bool isNode(size_t position) const {
+        return position <= length_ && paths_[position] != 0;
+    }
+
+    // number of segmentations, saturated at MAX_COUNT
+    uint64_t segmentationCount() const {
+        return length_ ? paths_[0] : 0;
+    }
+
+    // the segmentation with the fewest syllables, ties prefer longer syllables
+    // first. The edges are stored in path, return the number of syllables.
+    size_t bestPath(std::vector<uint32_t>& path) const;
+
+private:
+    std::vector<uint32_t> edgeBegin_;     // length_ + 2 entries
+    std::vector<uint32_t> edgeTo_;
+    std::vector<uint32_t> edgeSyllable_;
+    std::vector<uint64_t> paths_;         // number of paths from a position to length_
+    std::vector<uint32_t> fewest_;        // fewest syllables from a position to length_
+
+    // edges found by the forward pass, before the ones on no path are dropped
+    std::vector<uint32_t> scanFrom_;
+    std::vector<uint32_t> scanTo_;
+    std::vector<uint32_t> scanSyllable_;
+    std::vector<char> reachable_;
+
+    size_t length_;
+    size_t inputLength_;
+};
+
+}
+
+#endif
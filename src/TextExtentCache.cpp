@@ -0,0 +1,140 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "TextExtentCache.h"
+
+namespace Ime {
+
+// CJK symbols, kana, bopomofo, CJK extension A and CJK unified ideographs.
+static const wchar_t cjkFirst = 0x3000;
+static const wchar_t cjkLast = 0x9fff;
+static const size_t cjkBlockSize = 256;
+static const size_t cjkBlockCount = (size_t(cjkLast) - cjkFirst + 1) / cjkBlockSize;
+
+enum {
+    BLOCK_NOT_LOADED,
+    BLOCK_LOADED,
+    BLOCK_UNAVAILABLE
+};
+
+TextExtentCache::TextExtentCache(size_t capacity):
+    capacity_(capacity),
+    lineHeight_(-1),
+    hits_(0),
+    misses_(0) {
+}
+
+// static
+uint64_t TextExtentCache::hash(const wchar_t* str, size_t len) {
+    // 64-bit FNV-1a over the UTF-16 code units
+    uint64_t h = 14695981039346656037ULL;
+    for(size_t i = 0; i < len; ++i) {
+        h ^= uint16_t(str[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+TextExtent TextExtentCache::extent(const wchar_t* str, size_t len, uint64_t h, TextMeasurer& measurer) {
+    TextExtent result;
+    if(len == 0 && lineHeight_ >= 0) {
+        ++hits_;
+        return TextExtent{0, lineHeight_};
+    }
+
+    auto it = index_.find(h);
+    if(it != index_.end() && it->second->len == len) {
+        // move the entry to the front of the LRU list
+        lru_.splice(lru_.begin(), lru_, it->second);
+        ++hits_;
+        return it->second->extent;
+    }
+
+    bool loaded = false;
+    if(extentFromAdvances(str, len, measurer, result, loaded)) {
+        if(loaded)
+            ++misses_;
+        else
+            ++hits_;
+        return result;
+    }
+
+    ++misses_;
+    result = measurer.measure(str, len);
+    lineHeight_ = result.height;
+
+    if(capacity_ == 0)
+        return result;
+    if(it != index_.end()) { // hash collision, replace the old entry
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    else if(lru_.size() >= capacity_) { // evict the least recently used entry
+        index_.erase(lru_.back().hash);
+        lru_.pop_back();
+    }
+    lru_.push_front(Entry{h, len, result});
+    index_[h] = lru_.begin();
+    return result;
+}
+
+void TextExtentCache::clear() {
+    lru_.clear();
+    index_.clear();
+    cjkAdvances_.clear();
+    cjkBlockState_.clear();
+    lineHeight_ = -1;
+}
+
+bool TextExtentCache::extentFromAdvances(const wchar_t* str, size_t len, TextMeasurer& measurer, TextExtent& extent, bool& loaded) {
+    // the height of the text is only known after the first real measurement
+    if(lineHeight_ < 0 || len == 0)
+        return false;
+    int width = 0;
+    for(size_t i = 0; i < len; ++i) {
+        wchar_t ch = str[i];
+        if(ch < cjkFirst || ch > cjkLast)
+            return false;
+        size_t offset = size_t(ch) - cjkFirst;
+        if(!loadAdvanceBlock(offset / cjkBlockSize, measurer, loaded))
+            return false;
+        width += cjkAdvances_[offset];
+    }
+    extent.width = width;
+    extent.height = lineHeight_;
+    return true;
+}
+
+bool TextExtentCache::loadAdvanceBlock(size_t block, TextMeasurer& measurer, bool& loaded) {
+    if(cjkBlockState_.empty()) {
+        cjkBlockState_.resize(cjkBlockCount, BLOCK_NOT_LOADED);
+        cjkAdvances_.resize(cjkBlockCount * cjkBlockSize, 0);
+    }
+    char& state = cjkBlockState_[block];
+    if(state == BLOCK_NOT_LOADED) {
+        wchar_t first = wchar_t(cjkFirst + block * cjkBlockSize);
+        wchar_t last = wchar_t(first + cjkBlockSize - 1);
+        int* advances = &cjkAdvances_[block * cjkBlockSize];
+        state = measurer.charAdvances(first, last, advances) ? BLOCK_LOADED : BLOCK_UNAVAILABLE;
+        loaded = true;
+    }
+    return state == BLOCK_LOADED;
+}
+
+} // namespace Ime
@@ -0,0 +1,125 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_TEXT_EXTENT_CACHE_H
+#define IME_TEXT_EXTENT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace Ime {
+
+struct TextExtent {
+    int width;
+    int height;
+};
+
+// the thing which really measures the text (GDI on Windows).
+class TextMeasurer {
+public:
+    virtual ~TextMeasurer() {}
+
+    virtual TextExtent measure(const wchar_t* str, size_t len) = 0;
+
+    // get advance widths of all chars in [first, last].
+    // return false if this is not supported by the measurer.
+    virtual bool charAdvances(wchar_t /* first */, wchar_t /* last */, int* /* advances */) {
+        return false;
+    }
+};
+
+// Per-font cache of text extents.
+// Recently measured strings are kept in an LRU keyed by the hash of the string.
+// Strings made of CJK chars, which are mostly fixed width, are measured by
+// summing up the advance widths in a dense per-code point table instead.
+// The cache needs to be cleared whenever the font changes.
+class TextExtentCache {
+public:
+    explicit TextExtentCache(size_t capacity = 512);
+
+    TextExtent extent(const wchar_t* str, size_t len, TextMeasurer& measurer) {
+        return extent(str, len, hash(str, len), measurer);
+    }
+
+    // the hash of the string is already known (see CandidateArena::hash()).
+    TextExtent extent(const wchar_t* str, size_t len, uint64_t hash, TextMeasurer& measurer);
+
+    void clear();
+
+    size_t size() const {
+        return lru_.size();
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // number of extents returned without calling the measurer
+    size_t hits() const {
+        return hits_;
+    }
+
+    // number of extents which needed the measurer, either TextMeasurer::measure()
+    // or TextMeasurer::charAdvances() to load a block of the advance table
+    size_t misses() const {
+        return misses_;
+    }
+
+    double hitRate() const {
+        size_t total = hits_ + misses_;
+        return total ? double(hits_) / total : 0.0;
+    }
+
+    void resetStats() {
+        hits_ = misses_ = 0;
+    }
+
+    static uint64_t hash(const wchar_t* str, size_t len);
+
+private:
+    // loaded is set to true if a block of the table was loaded from the measurer
+    bool extentFromAdvances(const wchar_t* str, size_t len, TextMeasurer& measurer, TextExtent& extent, bool& loaded);
+    bool loadAdvanceBlock(size_t block, TextMeasurer& measurer, bool& loaded);
+
+private:
+    struct Entry {
+        uint64_t hash;
+        size_t len;
+        TextExtent extent;
+    };
+
+    size_t capacity_;
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+    // advance widths of chars in the CJK range, loaded on demand one block at a time
+    std::vector<int> cjkAdvances_;
+    std::vector<char> cjkBlockState_;
+    int lineHeight_;  // height of a line of text, which does not depend on its content
+
+    size_t hits_;
+    size_t misses_;
+};
+
+} // namespace Ime
+
+#endif
@@ -20,6 +20,7 @@
 #include "TextService.h"
 #include "EditSession.h"
 #include "CandidateWindow.h"
+#include "Window.h"
 #include "LangBarButton.h"
 #include "DisplayAttributeInfoEnum.h"
 #include "ImeModule.h"
@@ -32,6 +33,16 @@ using namespace std;
 
 namespace Ime {
 
+// the scheduler waiting for a tick on this thread
+static thread_local std::weak_ptr<UpdateScheduler> tickScheduler;
+
+static void CALLBACK onUpdateTick(HWND hwnd, UINT msg, UINT_PTR timerId, DWORD time) {
+    ::KillTimer(NULL, timerId);
+    if(auto scheduler = tickScheduler.lock()) {
+        scheduler->flush();
+    }
+}
+
 TextService::TextService(ImeModule* module):
     module_(module),
     displayAttributeProvider_{ComPtr<DisplayAttributeProvider>::make(module)},
@@ -39,7 +50,8 @@ TextService::TextService(ImeModule* module):
     clientId_(TF_CLIENTID_NULL),
     activateFlags_(0),
     isKeyboardOpened_(false),
-    langBarSinkCookie_(TF_INVALID_COOKIE) {
+    langBarSinkCookie_(TF_INVALID_COOKIE),
+    engineData_(module->engineData()) {
 
 }
 
@@ -51,6 +63,86 @@ TextService::~TextService(void) {
 
 // public methods
 
+bool TextService::connectEngine(const std::string& serverName) {
+    if(!engineClient_)
+        engineClient_ = std::make_unique<EngineClient>();
+    return engineClient_->connect(serverName);
+}
+
+void TextService::disconnectEngine() {
+    if(engineCandidateWindow_) {
+        engineCandidateWindow_->hide();
+        engineCandidateWindow_ = nullptr;
+    }
+    engineClient_ = nullptr;
+}
+
+bool TextService::requestEngine(uint32_t type, const KeyEvent& keyEvent, EngineReply& reply) {
+    // the client connects again by itself if the server timed out before
+    if(!engineClient_)
+        return false;
+    EngineKeyEvent key;
+    key.keyCode = keyEvent.keyCode();
+    key.charCode = keyEvent.charCode();
+    key.scanCode = keyEvent.scanCode();
+    key.modifiers = 0;
+    if(keyEvent.isKeyDown(VK_SHIFT))
+        key.modifiers |= ENGINE_SHIFT;
+    if(keyEvent.isKeyDown(VK_CONTROL))
+        key.modifiers |= ENGINE_CONTROL;
+    if(keyEvent.isKeyDown(VK_MENU))
+        key.modifiers |= ENGINE_ALT;
+    if(keyEvent.isKeyToggled(VK_CAPITAL))
+        key.modifiers |= ENGINE_CAPS_LOCK;
+    return engineClient_->request(type, key, reply);
+}
+
+const std::shared_ptr<WindowPool>& TextService::windowPool() {
+    if(!windowPool_) {
+        windowPool_ = std::make_shared<WindowPool>(std::unique_ptr<WindowBackend>(new Win32WindowBackend()));
+    }
+    return windowPool_;
+}
+
+const std::shared_ptr<UpdateScheduler>& TextService::updateScheduler() {
+    if(!updateScheduler_) {
+        updateScheduler_ = std::make_shared<UpdateScheduler>();
+        // IME windows keep the scheduler and may outlive the text service,
+        // so the tick handler does not refer to this.
+        std::weak_ptr<UpdateScheduler> scheduler = updateScheduler_;
+        updateScheduler_->setRequestTick([scheduler]() {
+            // WM_TIMER is only generated when the message queue is empty,
+            // so updates made while handling the pending input are coalesced.
+            tickScheduler = scheduler;
+            ::SetTimer(NULL, 0, USER_TIMER_MINIMUM, onUpdateTick);
+        });
+    }
+    return updateScheduler_;
+}
+
+void TextService::flushUpdates() {
+    if(updateScheduler_) {
+        updateScheduler_->flush();
+    }
+}
+
+void TextService::addUIElementWindow(CandidateWindow* window) {
+    if(std::find(uiElementWindows_.begin(), uiElementWindows_.end(), window) == uiElementWindows_.end())
+        uiElementWindows_.push_back(window);
+}
+
+void TextService::removeUIElementWindow(CandidateWindow* window) {
+    uiElementWindows_.erase(std::remove(uiElementWindows_.begin(), uiElementWindows_.end(), window), uiElementWindows_.end());
+}
+
+void TextService::endUIElements() {
+    // ending an element removes the window from the list, and may release it
+    std::vector<CandidateWindow*> windows;
+    windows.swap(uiElementWindows_);
+    for(CandidateWindow* window: windows)
+        window->endUIElement();
+}
+
 // language bar
 DWORD TextService::langBarStatus() const {
     if(langBarMgr_) {
@@ -183,6 +275,7 @@ void TextService::startComposition(ITfContext* context) {
 
                 if (range) {
                     composition_ = nullptr;
+                    compositionState_.reset();
                     if (contextComposition->StartComposition(cookie, range, (ITfCompositionSink*)this, &composition_) == S_OK) {
                         // according to the official TSF samples, we need to reset the current
                         // selection here. (maybe the range is altered by StartComposition()?
@@ -228,7 +321,9 @@ void TextService::endComposition(ITfContext* context) {
                 composition_->EndComposition(cookie);
                 // do some cleanup in the derived class here
                 onCompositionTerminated(false);
+                endUIElements();
                 composition_ = nullptr;
+                compositionState_.reset();
             }
         }
     );
@@ -258,36 +353,78 @@ std::wstring TextService::compositionString(EditSession* session) const {
 }
 
 void TextService::setCompositionString(EditSession* session, const wchar_t* str, int len) const {
+    setCompositionString(session, str, len, nullptr, 0);
+}
+
+// get the subrange [start, end) of the composition range
+static ComPtr<ITfRange> compositionSubRange(ITfRange* compositionRange, TfEditCookie editCookie, int start, int end) {
+    ComPtr<ITfRange> range;
+    if(compositionRange->Clone(&range) == S_OK) {
+        LONG moved;
+        range->Collapse(editCookie, TF_ANCHOR_START);
+        range->ShiftEnd(editCookie, (LONG)end, &moved, NULL);
+        range->ShiftStart(editCookie, (LONG)start, &moved, NULL);
+    }
+    return range;
+}
+
+void TextService::setCompositionString(EditSession* session, const wchar_t* str, int len,
+                                       const CompositionClause* clauses, int clauseCount) const {
     ITfContext* context = session->context();
-    if(context) {
-        TfEditCookie editCookie = session->editCookie();
+    if(!context || !composition_)
+        return;
+    TfEditCookie editCookie = session->editCookie();
+    ComPtr<ITfRange> compositionRange;
+    if(composition_->GetRange(&compositionRange) != S_OK)
+        return;
+
+    // the document may be changed by others, such as the undo of the application.
+    // rewrite everything if it no longer matches what we wrote last time.
+    if(auto rangeAcp = compositionRange.query<ITfRangeACP>()) {
+        LONG anchor, rangeLen;
+        if(rangeAcp->GetExtent(&anchor, &rangeLen) != S_OK || size_t(rangeLen) != compositionState_.text().length())
+            compositionState_.reset();
+    }
+
+    DWORD defaultAttr = module_->inputAttrib()->atom();
+    CompositionUpdate update;
+    compositionState_.update(std::wstring_view(str, len), clauses, clauseCount, defaultAttr, update);
+
+    if(update.textChanged()) {
+        // replace only the changed part of the composition string.
+        auto range = compositionSubRange(compositionRange, editCookie, update.textStart, update.textStart + update.removedLength);
+        if(range)
+            range->SetText(editCookie, TF_ST_CORRECTION, str + update.textStart, update.insertedLength);
+
+        // move the insertion point to end of the composition string
         TF_SELECTION selection;
         ULONG selectionNum;
-        // get current selection/insertion point
         if(context->GetSelection(editCookie, TF_DEFAULT_SELECTION, 1, &selection, &selectionNum) == S_OK) {
-            ComPtr<ITfRange> compositionRange;
-            if(composition_->GetRange(&compositionRange) == S_OK) {
-                bool selPosInComposition = true;
-                // if current insertion point is not covered by composition, we cannot insert text here.
-                if(selPosInComposition) {
-                    // replace context of composion area with the new string.
-                    compositionRange->SetText(editCookie, TF_ST_CORRECTION, str, len);
-
-                    // move the insertion point to end of the composition string
-                    selection.range->Collapse(editCookie, TF_ANCHOR_END);
-                    context->SetSelection(editCookie, 1, &selection);
-                }
+            selection.range->ShiftEndToRange(editCookie, compositionRange, TF_ANCHOR_END);
+            selection.range->Collapse(editCookie, TF_ANCHOR_END);
+            context->SetSelection(editCookie, 1, &selection);
+            selection.range->Release();
+        }
+    }
 
-                // set display attribute to the composition range
-                ComPtr<ITfProperty> dispAttrProp;
-                if(context->GetProperty(GUID_PROP_ATTRIBUTE, &dispAttrProp) == S_OK) {
+    // set display attributes of the changed clauses
+    if(!update.runs.empty()) {
+        ComPtr<ITfProperty> dispAttrProp;
+        if(context->GetProperty(GUID_PROP_ATTRIBUTE, &dispAttrProp) == S_OK) {
+            for(auto& run: update.runs) {
+                auto range = compositionSubRange(compositionRange, editCookie, run.start, run.end);
+                if(!range)
+                    continue;
+                if(run.attr == TF_INVALID_GUIDATOM) {
+                    dispAttrProp->Clear(editCookie, range);
+                }
+                else {
                     VARIANT val;
                     val.vt = VT_I4;
-                    val.lVal = module_->inputAttrib()->atom();
-                    dispAttrProp->SetValue(editCookie, compositionRange, &val);
+                    val.lVal = run.attr;
+                    dispAttrProp->SetValue(editCookie, range, &val);
                 }
             }
-            selection.range->Release();
         }
     }
 }
@@ -428,24 +565,92 @@ void TextService::onDeactivate() {
 
 // virtual
 bool TextService::filterKeyDown(KeyEvent& keyEvent) {
-    return false;
+    EngineReply reply;
+    return requestEngine(ENGINE_FILTER_KEY_DOWN, keyEvent, reply) && reply.isHandled();
 }
 
 // virtual
 bool TextService::onKeyDown(KeyEvent& keyEvent, EditSession* session) {
+    EngineReply reply;
+    if(requestEngine(ENGINE_KEY_DOWN, keyEvent, reply)) {
+        onEngineReply(reply, session);
+        return reply.isHandled();
+    }
     return false;
 }
 
 // virtual
 bool TextService::filterKeyUp(KeyEvent& keyEvent) {
-    return false;
+    EngineReply reply;
+    return requestEngine(ENGINE_FILTER_KEY_UP, keyEvent, reply) && reply.isHandled();
 }
 
 // virtual
 bool TextService::onKeyUp(KeyEvent& keyEvent, EditSession* session) {
+    EngineReply reply;
+    if(requestEngine(ENGINE_KEY_UP, keyEvent, reply)) {
+        onEngineReply(reply, session);
+        return reply.isHandled();
+    }
     return false;
 }
 
+// virtual
+void TextService::onEngineReply(const EngineReply& reply, EditSession* session) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "the engine protocol uses UTF-16");
+    ITfContext* context = session->context();
+    auto commit = reply.commitString();
+    if(!commit.empty()) {
+        if(!isComposing())
+            startComposition(context);
+        setCompositionString(session, reinterpret_cast<const wchar_t*>(commit.data()), int(commit.length()));
+        endComposition(context);
+    }
+    if(reply.flags() & ENGINE_COMPOSITION_CHANGED) {
+        auto composition = reply.compositionString();
+        if(!composition.empty()) {
+            if(!isComposing())
+                startComposition(context);
+            setCompositionString(session, reinterpret_cast<const wchar_t*>(composition.data()), int(composition.length()));
+            setCompositionCursor(session, reply.cursor());
+        }
+        else if(isComposing()) {
+            setCompositionString(session, L"", 0);
+            endComposition(context);
+        }
+    }
+    if(reply.flags() & (ENGINE_CANDIDATES_CHANGED | ENGINE_SHOW_CANDIDATES))
+        updateEngineCandidates(reply, session);
+}
+
+void TextService::updateEngineCandidates(const EngineReply& reply, EditSession* session) {
+    // the engine selects the candidates with the digit keys
+    static const std::vector<wchar_t> selKeys = {L'1', L'2', L'3', L'4', L'5', L'6', L'7', L'8', L'9'};
+    if(!(reply.flags() & ENGINE_SHOW_CANDIDATES) || reply.candidateCount() == 0) {
+        if(engineCandidateWindow_)
+            engineCandidateWindow_->hide();
+        return;
+    }
+    if(!engineCandidateWindow_)
+        engineCandidateWindow_ = ComPtr<CandidateWindow>::make(this, session);
+    CandidateWindow* window = engineCandidateWindow_;
+    if(reply.flags() & ENGINE_CANDIDATES_CHANGED) {
+        // reuse the memory of the previous list
+        CandidateArena items = window->recycleItems();
+        for(size_t i = 0; i < reply.candidateCount(); ++i) {
+            auto candidate = reply.candidate(i);
+            items.append(std::wstring_view(reinterpret_cast<const wchar_t*>(candidate.data()), candidate.length()));
+        }
+        window->setItems(std::move(items), selKeys);
+    }
+    if(reply.selectedCandidate() >= 0 && reply.selectedCandidate() < window->count())
+        window->setCurrentSel(reply.selectedCandidate());
+    RECT rect;
+    if(selectionRect(session, &rect))
+        window->move(rect.left, rect.bottom);
+    window->show();
+}
+
 // virtual
 bool TextService::onPreservedKey(const GUID& guid) {
     return false;
@@ -614,6 +819,13 @@ STDMETHODIMP TextService::Deactivate() {
     }
 
     onDeactivate();
+    endUIElements();
+    disconnectEngine();
+
+    // windows still in use are destroyed when they are released to the pool
+    if(windowPool_) {
+        windowPool_->trim();
+    }
 
     deactivateLanguageButtons();
     uninstallEventListeners();
@@ -706,10 +918,18 @@ STDMETHODIMP TextService::OnEndEdit(ITfContext *pContext, TfEditCookie ecReadOnl
 // ITfKeyEventSink
 STDMETHODIMP TextService::OnSetFocus(BOOL fForeground) {
     if (fForeground) {
+        // if the IME showed windows before, get them ready before the first key.
+        if (windowPool_ && windowPool_->created() > 0) {
+            windowPool_->prepare(2);
+        }
         onSetFocus();
     }
     else {
         onKillFocus();
+        // release the hidden windows while other applications are used.
+        if (windowPool_) {
+            windowPool_->trim();
+        }
     }
     return S_OK;
 }
@@ -750,6 +970,8 @@ STDMETHODIMP TextService::OnKeyDown(ITfContext *pContext, WPARAM wParam, LPARAM
             // KeyEditSession::DoEditSession() and TextService::doKeyEditSession() will be
             // called before RequestEditSession() returns.
             pContext->RequestEditSession(clientId_, session, TF_ES_SYNC|TF_ES_READWRITE, &sessionResult);
+            // one layout pass and paint for all the changes made to the windows by the key
+            flushUpdates();
         }
     }
     return S_OK;
@@ -784,6 +1006,8 @@ STDMETHODIMP TextService::OnKeyUp(ITfContext *pContext, WPARAM wParam, LPARAM lP
                 }
             );
             pContext->RequestEditSession(clientId_, session, TF_ES_SYNC|TF_ES_READWRITE, &sessionResult);
+            // one layout pass and paint for all the changes made to the windows by the key
+            flushUpdates();
         }
     }
     return S_OK;
@@ -803,7 +1027,15 @@ STDMETHODIMP TextService::OnCompositionTerminated(TfEditCookie ecWrite, ITfCompo
     // If we end the composition by calling ITfComposition::EndComposition() ourselves,
     // this event is not triggered.
     onCompositionTerminated(true);
+    endUIElements();
     composition_ = nullptr;
+    compositionState_.reset();
+    if(engineCandidateWindow_)
+        engineCandidateWindow_->hide();
+    if(isEngineConnected()) {
+        EngineReply reply;
+        engineClient_->request(ENGINE_RESET, EngineKeyEvent{}, reply);
+    }
     return S_OK;
 }
 
@@ -29,9 +29,15 @@
 #include "DisplayAttributeProvider.h"
 #include "SinkAdvice.h"
 #include "ComObject.h"
+#include "WindowPool.h"
+#include "UpdateScheduler.h"
+#include "CompositionState.h"
+#include "EngineClient.h"
+#include "EngineData.h"
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <string>
 
 // for Windows 8 support
@@ -41,6 +47,7 @@
 
 namespace Ime {
 
+class CandidateWindow;
 class ImeModule;
 class LangBarButton;
 
@@ -114,6 +121,44 @@ public:
 
     DWORD langBarStatus() const;
 
+    // hidden IME windows kept for reuse by the candidate and message windows of this thread.
+    // The pool is trimmed when the text service loses focus.
+    const std::shared_ptr<WindowPool>& windowPool();
+
+    // coalesces the layout and painting of the IME windows of this thread.
+    // Pending updates run after each key event, or on the next tick of the message loop.
+    const std::shared_ptr<UpdateScheduler>& updateScheduler();
+
+    // run the pending updates of all IME windows now.
+    void flushUpdates();
+
+    // Candidate windows are registered while their ITfCandidateListUIElement is
+    // begun. The elements are ended when the composition ends, since TSF keeps
+    // a reference to them until EndUIElement().
+    void addUIElementWindow(CandidateWindow* window);
+    void removeUIElementWindow(CandidateWindow* window);
+
+    // Engine client mode: key events are handled by an engine server in another process
+    // (see EngineServer) instead of overriding filterKeyDown() and onKeyDown(), so the host
+    // application does not load the dictionaries and is not crashed by the engine.
+    // Usually called in onActivate(). return false if the server is not running.
+    // If the server stops answering later, the next keys try to connect again.
+    bool connectEngine(const std::string& serverName);
+    void disconnectEngine();
+
+    bool isEngineConnected() const {
+        return engineClient_ && engineClient_->isConnected();
+    }
+
+    // the engine data published with ImeModule::engineData(), nullptr if there is none.
+    // Reading it does not lock, and it stays valid until the next call even if new
+    // data is published meanwhile. Keep the mutable state of the text service, such as
+    // the composition buffer, in the derived class.
+    template<typename Data>
+    const Data* engineData() {
+        return engineData_.get<Data>();
+    }
+
     // language bar buttons
     void addButton(LangBarButton* button);
     void removeButton(LangBarButton* button);
@@ -141,6 +186,11 @@ public:
 
     std::wstring compositionString(EditSession* session) const;
     void setCompositionString(EditSession* session, const wchar_t* str, int len) const;
+    // set the composition string with clauses displayed with different attributes (see ImeModule::convertedAttrib()).
+    // characters not covered by the clauses use ImeModule::inputAttrib().
+    // Only the changed text and the clauses whose attributes changed since the last call are written.
+    void setCompositionString(EditSession* session, const wchar_t* str, int len,
+                              const CompositionClause* clauses, int clauseCount) const;
     void setCompositionCursor(EditSession* session, int pos) const;
 
     // compartment handling
@@ -175,6 +225,19 @@ public:
 
     virtual bool onPreservedKey(const GUID& guid);
 
+    // called with the reply of the engine server to a key in engine client mode.
+    // The default implementation updates the composition string, commits text, and shows
+    // the candidates in a candidate window owned by the text service, see engineCandidateWindow().
+    // The strings of the reply are only valid during the call, so the candidates are
+    // copied once into the arena of the window, whose memory is reused for the next list.
+    virtual void onEngineReply(const EngineReply& reply, EditSession* session);
+
+    // the candidate window of the default onEngineReply(), nullptr if it never showed candidates.
+    // Derived classes can change its look, e.g. setCandPerRow().
+    CandidateWindow* engineCandidateWindow() const {
+        return engineCandidateWindow_;
+    }
+
     // called when a language button or menu item is clicked
     virtual bool onCommand(UINT id, CommandType type);
 
@@ -265,6 +328,16 @@ protected:
 protected: // COM object should not be deleted directly. calling Release() instead.
     virtual ~TextService(void);
 
+private:
+    // send a key to the engine server, return false if not in engine client mode.
+    bool requestEngine(uint32_t type, const KeyEvent& keyEvent, EngineReply& reply);
+
+    // show the candidates of the reply, or hide the window if there are none.
+    void updateEngineCandidates(const EngineReply& reply, EditSession* session);
+
+    // end the UI elements of all the candidate windows.
+    void endUIElements();
+
 private:
     ComPtr<ImeModule> module_;
     ComPtr<ITfDisplayAttributeProvider> displayAttributeProvider_;
@@ -281,9 +354,17 @@ private:
     DWORD langBarSinkCookie_;
 
     ComPtr<ITfComposition> composition_; // acquired when starting composition, released when ending composition
+    // the composition string and its attributes as written to the document
+    mutable CompositionState compositionState_;
     ComPtr<ITfLangBarMgr> langBarMgr_;
     std::vector<ComPtr<LangBarButton>> langBarButtons_;
     std::vector<PreservedKey> preservedKeys_;
+    std::shared_ptr<WindowPool> windowPool_;
+    std::shared_ptr<UpdateScheduler> updateScheduler_;
+    std::vector<CandidateWindow*> uiElementWindows_;
+    std::unique_ptr<EngineClient> engineClient_;
+    ComPtr<CandidateWindow> engineCandidateWindow_;
+    EngineDataReader engineData_;
 };
 
 }
@@ -0,0 +1,114 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+
+namespace Ime {
+
+UpdateScheduler::UpdateScheduler(std::function<void()> requestTick):
+    requestTick_(std::move(requestTick)),
+    tickRequested_(false),
+    layoutPasses_(0),
+    paintPasses_(0) {
+}
+
+std::vector<UpdateScheduler::Pending>::iterator UpdateScheduler::find(const UpdateClient* client) {
+    return std::find_if(pending_.begin(), pending_.end(), [client](const Pending& p) {
+        return p.client == client;
+    });
+}
+
+void UpdateScheduler::schedule(UpdateClient* client, unsigned int kinds) {
+    // a new layout always needs a repaint
+    if(kinds & UPDATE_LAYOUT)
+        kinds |= UPDATE_PAINT;
+    auto it = find(client);
+    if(it != pending_.end())
+        it->kinds |= kinds;
+    else
+        pending_.push_back(Pending{client, kinds});
+
+    if(!tickRequested_ && requestTick_) {
+        tickRequested_ = true;
+        requestTick_();
+    }
+}
+
+void UpdateScheduler::cancel(UpdateClient* client) {
+    auto it = find(client);
+    if(it != pending_.end())
+        pending_.erase(it);
+    // the client may be destroyed by the layout of another one
+    for(std::vector<Pending>* batch: running_) {
+        for(Pending& p: *batch) {
+            if(p.client == client)
+                p.client = nullptr;
+        }
+    }
+}
+
+bool UpdateScheduler::isPending(const UpdateClient* client) const {
+    return std::any_of(pending_.begin(), pending_.end(), [client](const Pending& p) {
+        return p.client == client;
+    });
+}
+
+void UpdateScheduler::flush() {
+    tickRequested_ = false;
+    // updates scheduled by the passes themselves are run in the same flush
+    while(!pending_.empty()) {
+        std::vector<Pending> pending;
+        pending.swap(pending_);
+        // cancel() clears the clients of the batch which are destroyed meanwhile
+        running_.push_back(&pending);
+        for(const Pending& p: pending) {
+            if(p.client && (p.kinds & UPDATE_LAYOUT)) {
+                ++layoutPasses_;
+                p.client->runLayout();
+            }
+        }
+        for(const Pending& p: pending) {
+            if(p.client && (p.kinds & UPDATE_PAINT)) {
+                ++paintPasses_;
+                p.client->runPaint();
+            }
+        }
+        running_.pop_back();
+    }
+}
+
+void UpdateScheduler::flush(UpdateClient* client) {
+    auto it = find(client);
+    if(it == pending_.end())
+        return;
+    unsigned int kinds = it->kinds;
+    pending_.erase(it);
+    if(kinds & UPDATE_LAYOUT) {
+        ++layoutPasses_;
+        client->runLayout();
+    }
+    if(kinds & UPDATE_PAINT) {
+        ++paintPasses_;
+        client->runPaint();
+    }
+}
+
+} // namespace Ime
@@ -0,0 +1,105 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_UPDATE_SCHEDULER_H
+#define IME_UPDATE_SCHEDULER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Ime {
+
+enum UpdateKind: unsigned int {
+    UPDATE_LAYOUT = 1,  // measure, resize and move
+    UPDATE_PAINT = 2  // invalidate what changed
+};
+
+// something updated by UpdateScheduler, such as an ImeWindow.
+class UpdateClient {
+public:
+    virtual ~UpdateClient() {}
+    virtual void runLayout() = 0;
+    virtual void runPaint() = 0;
+};
+
+// Coalesces the updates of all IME windows of a thread.
+// Setters only mark a window dirty, and flush() runs one layout pass and one
+// paint per dirty window, at the end of the key event or edit session, or on
+// the next tick of the message loop (requested by the tick handler when the
+// first window becomes dirty).
+class UpdateScheduler {
+public:
+    explicit UpdateScheduler(std::function<void()> requestTick = std::function<void()>());
+
+    // called when the first update is scheduled, to run flush() on the next tick
+    void setRequestTick(std::function<void()> requestTick) {
+        requestTick_ = std::move(requestTick);
+    }
+
+    void schedule(UpdateClient* client, unsigned int kinds);
+
+    // forget the pending updates of the client, which is being destroyed.
+    // This also works while flush() runs the updates of other clients.
+    void cancel(UpdateClient* client);
+
+    bool isPending(const UpdateClient* client) const;
+
+    bool hasPending() const {
+        return !pending_.empty();
+    }
+
+    // run all the pending updates, layout passes first, then the paints.
+    void flush();
+
+    // run the pending updates of one client now, because up to date geometry is needed.
+    void flush(UpdateClient* client);
+
+    size_t layoutPasses() const {
+        return layoutPasses_;
+    }
+
+    size_t paintPasses() const {
+        return paintPasses_;
+    }
+
+    void resetStats() {
+        layoutPasses_ = paintPasses_ = 0;
+    }
+
+private:
+    struct Pending {
+        UpdateClient* client;
+        unsigned int kinds;
+    };
+
+    std::vector<Pending>::iterator find(const UpdateClient* client);
+
+private:
+    std::function<void()> requestTick_;
+    std::vector<Pending> pending_;  // a few windows at most
+    std::vector<std::vector<Pending>*> running_;  // the batches being run by flush()
+    bool tickRequested_;
+    size_t layoutPasses_;
+    size_t paintPasses_;
+};
+
+}
+
+#endif
@@ -0,0 +1,387 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "Utf.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace Ime {
+
+// Convert the leading ASCII chars of in[0, n) with SIMD, a block at a time.
+// return the number of chars converted, the rest is left to the scalar code.
+static size_t asciiToUtf16(const unsigned char* in, size_t n, char16_t* out) {
+    size_t i = 0;
+#if defined(IME_SIMD_AVX2)
+    for(; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        if(_mm256_movemask_epi8(v))
+            break;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+    }
+#endif
+#if defined(IME_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if(_mm_movemask_epi8(v))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+#elif defined(IME_SIMD_NEON)
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(in + i);
+        if(vmaxvq_u8(v) >= 0x80)
+            break;
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i + 8), vmovl_high_u8(v));
+    }
+#endif
+    return i;
+}
+
+static size_t asciiToUtf8(const char16_t* in, size_t n, char* out) {
+    size_t i = 0;
+#if defined(IME_SIMD_AVX2)
+    const __m256i nonAscii256 = _mm256_set1_epi16(int16_t(0xff80));
+    for(; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        if(!_mm256_testz_si256(_mm256_or_si256(a, b), nonAscii256))
+            break;
+        // packus works within 128-bit lanes, so the 64-bit quarters are reordered
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+#endif
+#if defined(IME_SIMD_SSE2)
+    const __m128i nonAscii = _mm_set1_epi16(int16_t(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+        if(_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(IME_SIMD_NEON)
+    for(; i + 16 <= n; i += 16) {
+        uint16x8_t a = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+        uint16x8_t b = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i + 8));
+        if(vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+            break;
+        vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    }
+#endif
+    return i;
+}
+
+// lead and continuation bytes of 4 3-byte sequences, in the byte order of the machine
+struct TwelveBytes {
+    uint64_t a;
+    uint32_t b;
+
+    explicit TwelveBytes(const unsigned char (&bytes)[12]) {
+        memcpy(&a, bytes, 8);
+        memcpy(&b, bytes + 8, 4);
+    }
+};
+
+static const unsigned char threeByteMaskBytes[12] = {
+    0xf0, 0xc0, 0xc0, 0xf0, 0xc0, 0xc0, 0xf0, 0xc0, 0xc0, 0xf0, 0xc0, 0xc0
+};
+static const unsigned char threeBytePatternBytes[12] = {
+    0xe0, 0x80, 0x80, 0xe0, 0x80, 0x80, 0xe0, 0x80, 0x80, 0xe0, 0x80, 0x80
+};
+static const TwelveBytes threeByteMask(threeByteMaskBytes);
+static const TwelveBytes threeBytePattern(threeBytePatternBytes);
+
+static bool isSurrogate(uint32_t c) {
+    return c >= 0xd800 && c <= 0xdfff;
+}
+
+UtfResult convertUtf8ToUtf16(std::string_view in, char16_t* out, size_t outSize) {
+    auto s = reinterpret_cast<const unsigned char*>(in.data());
+    size_t n = in.size();
+    size_t i = 0;
+    size_t o = 0;
+    while(i < n) {
+        uint32_t c = s[i];
+        if(c < 0x80) {
+            size_t count = asciiToUtf16(s + i, std::min(n - i, outSize - o), out + o);
+            i += count;
+            o += count;
+            while(i < n && s[i] < 0x80) {
+                if(o == outSize)
+                    return UtfResult{UtfError::OUTPUT_FULL, i, o};
+                out[o++] = s[i++];
+            }
+            continue;
+        }
+
+        if((c & 0xf0) == 0xe0) {
+            // most CJK chars are 3 bytes, decode them in a tight loop
+            size_t start = i;
+            // 4 chars at a time: check the lead and continuation bytes of 12 bytes with two masks
+            while(n - i >= 12 && outSize - o >= 4) {
+                uint64_t a;
+                uint32_t b;
+                memcpy(&a, s + i, 8);
+                memcpy(&b, s + i + 8, 4);
+                if(((a & threeByteMask.a) != threeBytePattern.a) | ((b & threeByteMask.b) != threeBytePattern.b))
+                    break;
+                uint32_t bad = 0;
+                for(size_t k = 0; k < 4; ++k) {
+                    const unsigned char* p = s + i + k * 3;
+                    uint32_t cp = ((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+                    bad |= (cp < 0x800) | (cp - 0xd800 < 0x800);
+                    out[o + k] = char16_t(cp);
+                }
+                if(bad)
+                    break;
+                i += 12;
+                o += 4;
+            }
+            size_t end = i + std::min((n - i) / 3, outSize - o) * 3;
+            while(i < end) {
+                uint32_t c0 = s[i];
+                uint32_t c1 = s[i + 1];
+                uint32_t c2 = s[i + 2];
+                uint32_t cp = ((c0 & 0x0f) << 12) | ((c1 & 0x3f) << 6) | (c2 & 0x3f);
+                // one branch for all the checks
+                if(((c0 & 0xf0) != 0xe0) | ((c1 & 0xc0) != 0x80) | ((c2 & 0xc0) != 0x80) | (cp < 0x800) | (cp - 0xd800 < 0x800))
+                    break;
+                out[o++] = char16_t(cp);
+                i += 3;
+            }
+            if(i != start)
+                continue;
+        }
+
+        // everything else, with the errors
+        size_t len;
+        uint32_t cp;
+        uint32_t low = 0x80;  // range of the second byte
+        uint32_t high = 0xbf;
+        if(c >= 0xc2 && c <= 0xdf) {
+            len = 2;
+            cp = c & 0x1f;
+        }
+        else if((c & 0xf0) == 0xe0) {
+            len = 3;
+            cp = c & 0x0f;
+            if(c == 0xe0)
+                low = 0xa0;  // overlong
+            else if(c == 0xed)
+                high = 0x9f;  // surrogates
+        }
+        else if(c >= 0xf0 && c <= 0xf4) {
+            len = 4;
+            cp = c & 0x07;
+            if(c == 0xf0)
+                low = 0x90;  // overlong
+            else if(c == 0xf4)
+                high = 0x8f;  // above U+10FFFF
+        }
+        else {
+            return UtfResult{UtfError::INVALID, i, o};
+        }
+        for(size_t k = 1; k < len; ++k) {
+            if(i + k >= n)
+                return UtfResult{UtfError::TRUNCATED, i, o};
+            uint32_t b = s[i + k];
+            if(b < low || b > high)
+                return UtfResult{UtfError::INVALID, i, o};
+            low = 0x80;
+            high = 0xbf;
+            cp = (cp << 6) | (b & 0x3f);
+        }
+        if(cp >= 0x10000) {
+            if(outSize - o < 2)
+                return UtfResult{UtfError::OUTPUT_FULL, i, o};
+            cp -= 0x10000;
+            out[o++] = char16_t(0xd800 + (cp >> 10));
+            out[o++] = char16_t(0xdc00 + (cp & 0x3ff));
+        }
+        else {
+            if(o == outSize)
+                return UtfResult{UtfError::OUTPUT_FULL, i, o};
+            out[o++] = char16_t(cp);
+        }
+        i += len;
+    }
+    return UtfResult{UtfError::NONE, i, o};
+}
+
+UtfResult convertUtf16ToUtf8(std::u16string_view in, char* out, size_t outSize) {
+    const char16_t* s = in.data();
+    size_t n = in.size();
+    size_t i = 0;
+    size_t o = 0;
+    while(i < n) {
+        uint32_t c = s[i];
+        if(c < 0x80) {
+            size_t count = asciiToUtf8(s + i, std::min(n - i, outSize - o), out + o);
+            i += count;
+            o += count;
+            while(i < n && s[i] < 0x80) {
+                if(o == outSize)
+                    return UtfResult{UtfError::OUTPUT_FULL, i, o};
+                out[o++] = char(s[i++]);
+            }
+            continue;
+        }
+        if(c < 0x800) {
+            if(outSize - o < 2)
+                return UtfResult{UtfError::OUTPUT_FULL, i, o};
+            out[o++] = char(0xc0 | (c >> 6));
+            out[o++] = char(0x80 | (c & 0x3f));
+            ++i;
+            continue;
+        }
+        if(!isSurrogate(c)) {
+            // the rest of the BMP, mostly CJK
+            do {
+                if(outSize - o < 3)
+                    return UtfResult{UtfError::OUTPUT_FULL, i, o};
+                out[o++] = char(0xe0 | (c >> 12));
+                out[o++] = char(0x80 | ((c >> 6) & 0x3f));
+                out[o++] = char(0x80 | (c & 0x3f));
+                ++i;
+            } while(i < n && (c = s[i]) >= 0x800 && !isSurrogate(c));
+            continue;
+        }
+        if(c >= 0xdc00)  // low surrogate without a high one
+            return UtfResult{UtfError::INVALID, i, o};
+        if(i + 1 == n)
+            return UtfResult{UtfError::TRUNCATED, i, o};
+        uint32_t c2 = s[i + 1];
+        if(c2 < 0xdc00 || c2 > 0xdfff)
+            return UtfResult{UtfError::INVALID, i, o};
+        if(outSize - o < 4)
+            return UtfResult{UtfError::OUTPUT_FULL, i, o};
+        uint32_t cp = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+        out[o++] = char(0xf0 | (cp >> 18));
+        out[o++] = char(0x80 | ((cp >> 12) & 0x3f));
+        out[o++] = char(0x80 | ((cp >> 6) & 0x3f));
+        out[o++] = char(0x80 | (cp & 0x3f));
+        i += 2;
+    }
+    return UtfResult{UtfError::NONE, i, o};
+}
+
+bool utf8ToUtf16(std::string_view in, std::u16string& out) {
+    out.resize(utf16BufferSize(in.size()));
+    UtfResult result = convertUtf8ToUtf16(in, &out[0], out.size());
+    out.resize(result.ok() ? result.written : 0);
+    return result.ok();
+}
+
+bool utf16ToUtf8(std::u16string_view in, std::string& out) {
+    out.resize(utf8BufferSize(in.size()));
+    UtfResult result = convertUtf16ToUtf8(in, &out[0], out.size());
+    out.resize(result.ok() ? result.written : 0);
+    return result.ok();
+}
+
+// validating is converting to a small buffer which is thrown away
+bool isValidUtf8(std::string_view in) {
+    char16_t buf[1024];
+    for(;;) {
+        UtfResult result = convertUtf8ToUtf16(in, buf, 1024);
+        if(result.error != UtfError::OUTPUT_FULL)
+            return result.ok();
+        in.remove_prefix(result.read);
+    }
+}
+
+bool isValidUtf16(std::u16string_view in) {
+    char buf[1024];
+    for(;;) {
+        UtfResult result = convertUtf16ToUtf8(in, buf, 1024);
+        if(result.error != UtfError::OUTPUT_FULL)
+            return result.ok();
+        in.remove_prefix(result.read);
+    }
+}
+
+bool Utf8ToUtf16Stream::write(std::string_view chunk, std::u16string& out) {
+    if(pendingLength_) {
+        // complete the sequence left by the last chunk
+        char buf[4];
+        size_t extra = std::min(chunk.size(), sizeof(buf) - pendingLength_);
+        memcpy(buf, pending_, pendingLength_);
+        memcpy(buf + pendingLength_, chunk.data(), extra);
+        char16_t converted[4];
+        UtfResult result = convertUtf8ToUtf16(std::string_view(buf, pendingLength_ + extra), converted, 4);
+        if(result.error == UtfError::INVALID && result.read == 0) {
+            pendingLength_ = 0;
+            return false;
+        }
+        if(result.read == 0) {  // still incomplete
+            memcpy(pending_ + pendingLength_, chunk.data(), extra);
+            pendingLength_ += extra;
+            return true;
+        }
+        out.append(converted, result.written);
+        chunk.remove_prefix(result.read - pendingLength_);
+        pendingLength_ = 0;
+    }
+
+    size_t start = out.size();
+    out.resize(start + utf16BufferSize(chunk.size()));
+    UtfResult result = convertUtf8ToUtf16(chunk, &out[start], out.size() - start);
+    out.resize(start + result.written);
+    if(result.error == UtfError::TRUNCATED) {
+        pendingLength_ = chunk.size() - result.read;
+        memcpy(pending_, chunk.data() + result.read, pendingLength_);
+        return true;
+    }
+    return result.ok();
+}
+
+bool Utf16ToUtf8Stream::write(std::u16string_view chunk, std::string& out) {
+    if(pendingHighSurrogate_ && !chunk.empty()) {
+        char16_t pair[2] = {pendingHighSurrogate_, chunk[0]};
+        char converted[4];
+        UtfResult result = convertUtf16ToUtf8(std::u16string_view(pair, 2), converted, 4);
+        pendingHighSurrogate_ = 0;
+        if(!result.ok())
+            return false;
+        out.append(converted, result.written);
+        chunk.remove_prefix(1);
+    }
+
+    size_t start = out.size();
+    out.resize(start + utf8BufferSize(chunk.size()));
+    UtfResult result = convertUtf16ToUtf8(chunk, &out[start], out.size() - start);
+    out.resize(start + result.written);
+    if(result.error == UtfError::TRUNCATED) {
+        pendingHighSurrogate_ = chunk[result.read];
+        return true;
+    }
+    return result.ok();
+}
+
+} // namespace Ime
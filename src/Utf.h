@@ -0,0 +1,119 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_UTF_H
+#define IME_UTF_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Ime {
+
+// Conversion between UTF-8 and UTF-16 without the OS, used by the engine
+// protocol and the dictionaries. Inputs do not need to be null-terminated and
+// the output goes to a buffer given by the caller. Runs of ASCII are converted
+// with SIMD, and CJK text (3-byte UTF-8) has its own loop. Invalid input
+// (overlong forms, surrogates in UTF-8, unpaired surrogates in UTF-16, code
+// points above U+10FFFF) is rejected, nothing is replaced.
+
+enum class UtfError {
+    NONE,
+    INVALID,      // invalid sequence at `read`
+    TRUNCATED,    // the input ends in the middle of a sequence starting at `read`
+    OUTPUT_FULL   // the output buffer is too small, the sequence at `read` is not converted
+};
+
+struct UtfResult {
+    UtfError error;
+    size_t read;     // input code units converted
+    size_t written;  // output code units written
+
+    bool ok() const {
+        return error == UtfError::NONE;
+    }
+};
+
+// the largest output of a conversion, enough for any input of that length
+inline size_t utf16BufferSize(size_t utf8Length) {
+    return utf8Length;
+}
+
+inline size_t utf8BufferSize(size_t utf16Length) {
+    return utf16Length * 3;
+}
+
+UtfResult convertUtf8ToUtf16(std::string_view in, char16_t* out, size_t outSize);
+
+UtfResult convertUtf16ToUtf8(std::u16string_view in, char* out, size_t outSize);
+
+// convert all the input and replace the content of out, whose memory is reused.
+// return false if the input is invalid, out is then empty.
+bool utf8ToUtf16(std::string_view in, std::u16string& out);
+
+bool utf16ToUtf8(std::u16string_view in, std::string& out);
+
+bool isValidUtf8(std::string_view in);
+
+bool isValidUtf16(std::u16string_view in);
+
+// Convert a stream which is received in chunks, e.g. from a pipe.
+// A chunk may end in the middle of a sequence, which is completed by the next one.
+class Utf8ToUtf16Stream {
+public:
+    Utf8ToUtf16Stream():
+        pendingLength_(0) {
+    }
+
+    // convert the chunk and append it to out. return false if the input is invalid.
+    bool write(std::string_view chunk, std::u16string& out);
+
+    // return false if the stream ends in the middle of a sequence.
+    bool finish() {
+        bool complete = pendingLength_ == 0;
+        pendingLength_ = 0;
+        return complete;
+    }
+
+private:
+    char pending_[4];
+    size_t pendingLength_;
+};
+
+class Utf16ToUtf8Stream {
+public:
+    Utf16ToUtf8Stream():
+        pendingHighSurrogate_(0) {
+    }
+
+    bool write(std::u16string_view chunk, std::string& out);
+
+    bool finish() {
+        bool complete = pendingHighSurrogate_ == 0;
+        pendingHighSurrogate_ = 0;
+        return complete;
+    }
+
+private:
+    char16_t pendingHighSurrogate_;
+};
+
+}
+
+#endif
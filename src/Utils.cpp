@@ -18,36 +18,93 @@
 //
 
 #include "Utils.h"
+#include "Utf.h"
+#include "FullWidth.h"
+#include "ChineseConverter.h"
 #include <Windows.h>
 #include <Winnls.h>
 
-std::wstring utf8ToUtf16(const char* text) {
-    std::wstring wtext;
-    int wlen = ::MultiByteToWideChar(CP_UTF8, 0, text, -1, NULL, 0);
-    if(wlen > 1) { // length includes terminating null
-        wtext.resize(wlen - 1);
-        // well, this is a little bit dirty, but it works!
-        wlen = ::MultiByteToWideChar(CP_UTF8, 0, text, -1, &wtext[0], wlen);
+static_assert(sizeof(wchar_t) == sizeof(char16_t), "wchar_t is UTF-16 on Windows");
+
+std::wstring utf8ToUtf16(std::string_view text) {
+    std::wstring wtext(Ime::utf16BufferSize(text.size()), L'\0');
+    Ime::UtfResult result = Ime::convertUtf8ToUtf16(text, reinterpret_cast<char16_t*>(&wtext[0]), wtext.size());
+    if(result.ok()) {
+        wtext.resize(result.written);
+        return wtext;
     }
+    // invalid input, let Windows replace the invalid sequences with U+FFFD as before
+    int wlen = ::MultiByteToWideChar(CP_UTF8, 0, text.data(), int(text.size()), &wtext[0], int(wtext.size()));
+    wtext.resize(wlen);
     return wtext;
 }
 
-std::string utf16ToUtf8(const wchar_t* wtext) {
-    std::string text;
-    int len = ::WideCharToMultiByte(CP_UTF8, 0, wtext, -1, NULL, 0, NULL, NULL);
-    if(len > 1) { // length includes terminating null
-        text.resize(len - 1);
-        // well, this is a little bit dirty, but it works!
-        len = ::WideCharToMultiByte(CP_UTF8, 0, wtext, -1, &text[0], len, NULL, NULL);
+std::wstring utf8ToUtf16(const char* text) {
+    return utf8ToUtf16(std::string_view(text));
+}
+
+std::string utf16ToUtf8(std::wstring_view wtext) {
+    std::string text(Ime::utf8BufferSize(wtext.size()), '\0');
+    auto in = std::u16string_view(reinterpret_cast<const char16_t*>(wtext.data()), wtext.size());
+    Ime::UtfResult result = Ime::convertUtf16ToUtf8(in, &text[0], text.size());
+    if(result.ok()) {
+        text.resize(result.written);
+        return text;
     }
+    int len = ::WideCharToMultiByte(CP_UTF8, 0, wtext.data(), int(wtext.size()), &text[0], int(text.size()), NULL, NULL);
+    text.resize(len);
+    return text;
+}
+
+std::string utf16ToUtf8(const wchar_t* wtext) {
+    return utf16ToUtf8(std::wstring_view(wtext));
+}
+
+std::wstring toFullWidth(std::wstring_view text) {
+    std::wstring result(text.size(), L'\0');
+    Ime::toFullWidth(std::u16string_view(reinterpret_cast<const char16_t*>(text.data()), text.size()),
+        reinterpret_cast<char16_t*>(&result[0]));
+    return result;
+}
+
+std::wstring toHalfWidth(std::wstring_view text) {
+    std::wstring result(text.size(), L'\0');
+    Ime::toHalfWidth(std::u16string_view(reinterpret_cast<const char16_t*>(text.data()), text.size()),
+        reinterpret_cast<char16_t*>(&result[0]));
+    return result;
+}
+
+static std::wstring mapChinese(const std::wstring& text, LCID locale, DWORD flags) {
+    int len = ::LCMapStringW(locale, flags, text.c_str(), text.length(), NULL, 0);
+    std::wstring result;
+    result.resize(len);
+    if(::LCMapStringW(locale, flags, text.c_str(), text.length(), &result[0], len))
+        return result;
     return text;
 }
 
+static std::wstring convertChinese(const std::wstring& text, const Ime::ChineseConverter& converter) {
+    std::u16string result;
+    converter.convert(std::u16string_view(reinterpret_cast<const char16_t*>(text.data()), text.size()), result);
+    return std::wstring(reinterpret_cast<const wchar_t*>(result.data()), result.size());
+}
+
 std::wstring tradToSimpChinese(const std::wstring& trad) {
-    int len = ::LCMapStringW(0x0404, LCMAP_SIMPLIFIED_CHINESE, trad.c_str(), trad.length(), NULL, 0);
-    std::wstring simp;
-    simp.resize(len);
-    if(::LCMapStringW(0x0404, LCMAP_SIMPLIFIED_CHINESE, trad.c_str(), trad.length(), &simp[0], len))
-        return simp;
-    return trad;
+    return mapChinese(trad, 0x0404, LCMAP_SIMPLIFIED_CHINESE);
+}
+
+std::wstring simpToTradChinese(const std::wstring& simp) {
+    return mapChinese(simp, 0x0804, LCMAP_TRADITIONAL_CHINESE);
+}
+
+std::wstring tradToSimpChinese(const std::wstring& trad, const Ime::ChineseConverter& converter) {
+    if(!converter.isAttached())
+        return tradToSimpChinese(trad);
+    return convertChinese(trad, converter);
+}
+
+std::wstring simpToTradChinese(const std::wstring& simp, const Ime::ChineseConverter& converter) {
+    if(!converter.isAttached())
+        return simpToTradChinese(simp);
+    return convertChinese(simp, converter);
 }
@@ -22,12 +22,37 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+
+// Invalid sequences are replaced with U+FFFD. See Utf.h for the conversion to
+// caller buffers, validation, and streaming.
+std::wstring utf8ToUtf16(std::string_view text);
 
 std::wstring utf8ToUtf16(const char* text);
 
+std::string utf16ToUtf8(std::wstring_view wtext);
+
 std::string utf16ToUtf8(const wchar_t* wtext);
 
+// full-width <=> half-width forms of ASCII, see FullWidth.h for punctuation
+std::wstring toFullWidth(std::wstring_view text);
+
+std::wstring toHalfWidth(std::wstring_view text);
+
+namespace Ime {
+class ChineseConverter;
+}
+
 // convert traditional Chinese to simplified Chinese
 std::wstring tradToSimpChinese(const std::wstring& trad);
 
+// convert simplified Chinese to traditional Chinese
+std::wstring simpToTradChinese(const std::wstring& simp);
+
+// Convert with the table attached to the converter of the direction (see ChineseConverter.h),
+// which resolves one-to-many mappings by phrases. Without a table, LCMapStringW is used as above.
+std::wstring tradToSimpChinese(const std::wstring& trad, const Ime::ChineseConverter& converter);
+
+std::wstring simpToTradChinese(const std::wstring& simp, const Ime::ChineseConverter& converter);
+
 #endif
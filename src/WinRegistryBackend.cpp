@@ -0,0 +1,286 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "WinRegistryBackend.h"
+#include <memory>
+#include <Shlwapi.h>
+#include <ShlObj.h>
+
+namespace Ime {
+
+// where TSF keeps the language profiles of the text services
+static const wchar_t tipRegPath[] = L"SOFTWARE\\Microsoft\\CTF\\TIP\\";
+
+static bool parseGuid(const std::wstring& str, GUID& guid) {
+    return SUCCEEDED(::CLSIDFromString(str.c_str(), &guid));
+}
+
+WinRegistryBackend::WinRegistryBackend() {
+    ::CoCreateInstance(CLSID_TF_InputProcessorProfiles, NULL, CLSCTX_INPROC_SERVER, IID_ITfInputProcessorProfiles, (void**)&inputProcessorProfiles_);
+    ::CoCreateInstance(CLSID_TF_CategoryMgr, NULL, CLSCTX_INPROC_SERVER, IID_ITfCategoryMgr, (void**)&categoryMgr_);
+}
+
+WinRegistryBackend::~WinRegistryBackend() {
+    // unload the default user registry hive
+    if(!defaultUserHive_.empty())
+        ::RegUnLoadKeyW(HKEY_USERS, defaultUserHive_.c_str());
+}
+
+bool WinRegistryBackend::loadDefaultUserHive(const wchar_t* keyName) {
+    // The registry settings of all newly created users are based on the content of
+    // "C:\Users\Default User\ntuser.dat", so we need to write our settings to this file so
+    // the HKEY_CURRENT_USER key of newly created users can also contain our settings.
+    // In order to do this, we need to load the default "hive" to registry first.
+    // Reference: https://msdn.microsoft.com/zh-tw/library/windows/desktop/ms724889(v=vs.85).aspx
+    wchar_t *userProfilesDir = nullptr;
+    if(FAILED(::SHGetKnownFolderPath(FOLDERID_UserProfiles, 0, NULL, &userProfilesDir)))
+        return false;
+    // get the path of the default ntuser.dat file
+    std::wstring defaultRegFile = userProfilesDir;
+    ::CoTaskMemFree(userProfilesDir);
+    defaultRegFile += L"\\Default User\\ntuser.dat";
+
+    // loading registry file requires special privileges SE_RESTORE_NAME and SE_BACKUP_NAME.
+    // So let's do privilege elevation for our process.
+    HANDLE processToken = NULL;
+    ::OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES, &processToken);
+    DWORD bufLen = sizeof(TOKEN_PRIVILEGES) + sizeof(LUID_AND_ATTRIBUTES);
+    std::unique_ptr<char[]> buf(new char[bufLen]);
+    TOKEN_PRIVILEGES* privileges = reinterpret_cast<TOKEN_PRIVILEGES*>(buf.get());
+    privileges->PrivilegeCount = 2;
+    ::LookupPrivilegeValue(NULL, SE_RESTORE_NAME, &privileges->Privileges[0].Luid);
+    privileges->Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    ::LookupPrivilegeValue(NULL, SE_BACKUP_NAME, &privileges->Privileges[1].Luid);
+    privileges->Privileges[1].Attributes = SE_PRIVILEGE_ENABLED;
+    ::AdjustTokenPrivileges(processToken, FALSE, privileges, bufLen, NULL, NULL);
+    ::CloseHandle(processToken);
+
+    // load the default registry hive under the specified key name
+    if(::RegLoadKeyW(HKEY_USERS, keyName, defaultRegFile.c_str()) != ERROR_SUCCESS)
+        return false;
+    defaultUserHive_ = keyName;
+    return true;
+}
+
+bool WinRegistryBackend::readValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, RegistryValue& value) {
+    DWORD type = 0;
+    DWORD size = 0;
+    if(::RegGetValueW(rootKey(root), path.c_str(), name.c_str(), RRF_RT_REG_SZ | RRF_RT_REG_DWORD, &type, NULL, &size) != ERROR_SUCCESS)
+        return false;
+    if(type == REG_DWORD) {
+        DWORD number = 0;
+        size = sizeof(number);
+        if(::RegGetValueW(rootKey(root), path.c_str(), name.c_str(), RRF_RT_REG_DWORD, NULL, &number, &size) != ERROR_SUCCESS)
+            return false;
+        value = RegistryValue::dword(number);
+        return true;
+    }
+    std::wstring str(size / sizeof(wchar_t), L'\0');
+    if(::RegGetValueW(rootKey(root), path.c_str(), name.c_str(), RRF_RT_REG_SZ, NULL, &str[0], &size) != ERROR_SUCCESS)
+        return false;
+    str.resize(wcslen(str.c_str()));  // remove the terminating null
+    value = RegistryValue::string(std::move(str));
+    return true;
+}
+
+std::vector<std::wstring> WinRegistryBackend::valueNames(RegistryRoot root, const std::wstring& path) {
+    std::vector<std::wstring> names;
+    HKEY key = NULL;
+    if(::RegOpenKeyExW(rootKey(root), path.c_str(), 0, KEY_READ, &key) == ERROR_SUCCESS) {
+        wchar_t name[256];
+        for(DWORD i = 0; ; ++i) {
+            DWORD nameLen = sizeof(name) / sizeof(wchar_t);
+            LSTATUS err = ::RegEnumValueW(key, i, name, &nameLen, NULL, NULL, NULL, NULL);
+            if(err == ERROR_NO_MORE_ITEMS)
+                break;
+            if(err == ERROR_SUCCESS)
+                names.emplace_back(name, nameLen);
+        }
+        ::RegCloseKey(key);
+    }
+    return names;
+}
+
+bool WinRegistryBackend::hasKey(RegistryRoot root, const std::wstring& path) {
+    HKEY key = NULL;
+    if(::RegOpenKeyExW(rootKey(root), path.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS)
+        return false;
+    ::RegCloseKey(key);
+    return true;
+}
+
+std::vector<std::wstring> WinRegistryBackend::subKeys(RegistryRoot root, const std::wstring& path) {
+    std::vector<std::wstring> names;
+    HKEY key = NULL;
+    if(::RegOpenKeyExW(rootKey(root), path.c_str(), 0, KEY_READ, &key) == ERROR_SUCCESS) {
+        wchar_t name[256];
+        for(DWORD i = 0; ; ++i) {
+            DWORD nameLen = sizeof(name) / sizeof(wchar_t);
+            LSTATUS err = ::RegEnumKeyExW(key, i, name, &nameLen, NULL, NULL, NULL, NULL);
+            if(err == ERROR_NO_MORE_ITEMS)
+                break;
+            if(err == ERROR_SUCCESS)
+                names.emplace_back(name, nameLen);
+        }
+        ::RegCloseKey(key);
+    }
+    return names;
+}
+
+bool WinRegistryBackend::setValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) {
+    LSTATUS err;
+    if(value.type == RegistryValue::DWORD) {
+        DWORD number = value.number;
+        err = ::RegSetKeyValueW(rootKey(root), path.c_str(), name.c_str(), REG_DWORD, &number, sizeof(number));
+    }
+    else {
+        err = ::RegSetKeyValueW(rootKey(root), path.c_str(), name.c_str(), REG_SZ, value.str.c_str(), DWORD((value.str.length() + 1) * sizeof(wchar_t)));
+    }
+    return err == ERROR_SUCCESS;
+}
+
+bool WinRegistryBackend::deleteValue(RegistryRoot root, const std::wstring& path, const std::wstring& name) {
+    return ::RegDeleteKeyValueW(rootKey(root), path.c_str(), name.c_str()) == ERROR_SUCCESS;
+}
+
+bool WinRegistryBackend::deleteKey(RegistryRoot root, const std::wstring& path) {
+    return ::SHDeleteKeyW(rootKey(root), path.c_str()) == ERROR_SUCCESS;
+}
+
+std::vector<LanguageProfile> WinRegistryBackend::languageProfiles(const std::wstring& clsid) {
+    // The TSF API does not return the icon of a profile, so the profiles are read
+    // from HKEY_LOCAL_MACHINE\SOFTWARE\Microsoft\CTF\TIP\<clsid>\LanguageProfile\<langid>\<profile guid>
+    std::vector<LanguageProfile> profiles;
+    std::wstring basePath = tipRegPath + clsid + L"\\LanguageProfile";
+    HKEY baseKey = NULL;
+    if(::RegOpenKeyExW(HKEY_LOCAL_MACHINE, basePath.c_str(), 0, KEY_READ, &baseKey) != ERROR_SUCCESS)
+        return profiles;
+    wchar_t langIdStr[32];
+    for(DWORD i = 0; ; ++i) {
+        DWORD langIdLen = sizeof(langIdStr) / sizeof(wchar_t);
+        LSTATUS err = ::RegEnumKeyExW(baseKey, i, langIdStr, &langIdLen, NULL, NULL, NULL, NULL);
+        if(err == ERROR_NO_MORE_ITEMS)
+            break;
+        if(err != ERROR_SUCCESS)
+            continue;
+        // the key name is like "0x00000404"
+        uint16_t langId = uint16_t(wcstoul(langIdStr, NULL, 16));
+        std::wstring langPath = basePath + L'\\' + langIdStr;
+        HKEY langKey = NULL;
+        if(::RegOpenKeyExW(HKEY_LOCAL_MACHINE, langPath.c_str(), 0, KEY_READ, &langKey) != ERROR_SUCCESS)
+            continue;
+        wchar_t guid[64];
+        for(DWORD j = 0; ; ++j) {
+            DWORD guidLen = sizeof(guid) / sizeof(wchar_t);
+            err = ::RegEnumKeyExW(langKey, j, guid, &guidLen, NULL, NULL, NULL, NULL);
+            if(err == ERROR_NO_MORE_ITEMS)
+                break;
+            if(err != ERROR_SUCCESS)
+                continue;
+            LanguageProfile profile{langId, std::wstring(guid, guidLen), std::wstring(), std::wstring(), 0};
+            wchar_t str[MAX_PATH];
+            DWORD size = sizeof(str);
+            if(::RegGetValueW(langKey, guid, L"Description", RRF_RT_REG_SZ, NULL, str, &size) == ERROR_SUCCESS)
+                profile.name = str;
+            size = sizeof(str);
+            if(::RegGetValueW(langKey, guid, L"IconFile", RRF_RT_REG_SZ, NULL, str, &size) == ERROR_SUCCESS)
+                profile.iconFile = str;
+            DWORD iconIndex = 0;
+            size = sizeof(iconIndex);
+            if(::RegGetValueW(langKey, guid, L"IconIndex", RRF_RT_REG_DWORD, NULL, &iconIndex, &size) == ERROR_SUCCESS)
+                profile.iconIndex = int(iconIndex);
+            profiles.push_back(std::move(profile));
+        }
+        ::RegCloseKey(langKey);
+    }
+    ::RegCloseKey(baseKey);
+    return profiles;
+}
+
+bool WinRegistryBackend::registerTextService(const std::wstring& clsid) {
+    CLSID textServiceClsid;
+    return inputProcessorProfiles_ && parseGuid(clsid, textServiceClsid)
+        && inputProcessorProfiles_->Register(textServiceClsid) == S_OK;
+}
+
+bool WinRegistryBackend::unregisterTextService(const std::wstring& clsid) {
+    CLSID textServiceClsid;
+    return inputProcessorProfiles_ && parseGuid(clsid, textServiceClsid)
+        && inputProcessorProfiles_->Unregister(textServiceClsid) == S_OK;
+}
+
+bool WinRegistryBackend::addLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) {
+    CLSID textServiceClsid;
+    GUID profileGuid;
+    if(!inputProcessorProfiles_ || !parseGuid(clsid, textServiceClsid) || !parseGuid(profile.profileGuid, profileGuid))
+        return false;
+    return inputProcessorProfiles_->AddLanguageProfile(textServiceClsid, profile.langId, profileGuid,
+        profile.name.c_str(), ULONG(profile.name.length()), profile.iconFile.empty() ? NULL : profile.iconFile.c_str(),
+        ULONG(profile.iconFile.length()), profile.iconIndex) == S_OK;
+}
+
+bool WinRegistryBackend::removeLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) {
+    CLSID textServiceClsid;
+    GUID profileGuid;
+    if(!inputProcessorProfiles_ || !parseGuid(clsid, textServiceClsid) || !parseGuid(profile.profileGuid, profileGuid))
+        return false;
+    return inputProcessorProfiles_->RemoveLanguageProfile(textServiceClsid, profile.langId, profileGuid) == S_OK;
+}
+
+std::vector<std::wstring> WinRegistryBackend::categories(const std::wstring& clsid) {
+    std::vector<std::wstring> result;
+    CLSID textServiceClsid;
+    ComPtr<IEnumGUID> enumGuid;
+    if(categoryMgr_ && parseGuid(clsid, textServiceClsid)
+        && categoryMgr_->EnumCategoriesInItem(textServiceClsid, &enumGuid) == S_OK && enumGuid) {
+        GUID category;
+        while(enumGuid->Next(1, &category, NULL) == S_OK) {
+            result.push_back(guidString(category));
+        }
+    }
+    return result;
+}
+
+bool WinRegistryBackend::registerCategory(const std::wstring& clsid, const std::wstring& category) {
+    CLSID textServiceClsid;
+    GUID categoryGuid;
+    return categoryMgr_ && parseGuid(clsid, textServiceClsid) && parseGuid(category, categoryGuid)
+        && categoryMgr_->RegisterCategory(textServiceClsid, categoryGuid, textServiceClsid) == S_OK;
+}
+
+bool WinRegistryBackend::unregisterCategory(const std::wstring& clsid, const std::wstring& category) {
+    CLSID textServiceClsid;
+    GUID categoryGuid;
+    return categoryMgr_ && parseGuid(clsid, textServiceClsid) && parseGuid(category, categoryGuid)
+        && categoryMgr_->UnregisterCategory(textServiceClsid, categoryGuid, textServiceClsid) == S_OK;
+}
+
+// static
+std::wstring WinRegistryBackend::guidString(REFGUID guid) {
+    wchar_t str[40];
+    int len = ::StringFromGUID2(guid, str, 40);
+    return len > 0 ? std::wstring(str, len - 1) : std::wstring();
+}
+
+// static
+HKEY WinRegistryBackend::rootKey(RegistryRoot root) {
+    return root == RegistryRoot::USERS ? HKEY_USERS : HKEY_CLASSES_ROOT;
+}
+
+} // namespace Ime
@@ -0,0 +1,72 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_WIN_REGISTRY_BACKEND_H
+#define IME_WIN_REGISTRY_BACKEND_H
+
+#include <Windows.h>
+#include <msctf.h>
+#include <string>
+#include "ComPtr.h"
+#include "RegistryBackend.h"
+
+namespace Ime {
+
+// the real registry and TSF, used by ImeModule to register the text service.
+class WinRegistryBackend: public RegistryBackend {
+public:
+    WinRegistryBackend();
+    ~WinRegistryBackend();
+
+    // Load the registry hive of the default user (Default User\ntuser.dat) under HKEY_USERS\<keyName>,
+    // so the users created later get the settings written to it. It's unloaded by the destructor.
+    bool loadDefaultUserHive(const wchar_t* keyName);
+
+    bool readValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, RegistryValue& value) override;
+    std::vector<std::wstring> valueNames(RegistryRoot root, const std::wstring& path) override;
+    bool hasKey(RegistryRoot root, const std::wstring& path) override;
+    std::vector<std::wstring> subKeys(RegistryRoot root, const std::wstring& path) override;
+    bool setValue(RegistryRoot root, const std::wstring& path, const std::wstring& name, const RegistryValue& value) override;
+    bool deleteValue(RegistryRoot root, const std::wstring& path, const std::wstring& name) override;
+    bool deleteKey(RegistryRoot root, const std::wstring& path) override;
+
+    std::vector<LanguageProfile> languageProfiles(const std::wstring& clsid) override;
+    bool registerTextService(const std::wstring& clsid) override;
+    bool unregisterTextService(const std::wstring& clsid) override;
+    bool addLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) override;
+    bool removeLanguageProfile(const std::wstring& clsid, const LanguageProfile& profile) override;
+    std::vector<std::wstring> categories(const std::wstring& clsid) override;
+    bool registerCategory(const std::wstring& clsid, const std::wstring& category) override;
+    bool unregisterCategory(const std::wstring& clsid, const std::wstring& category) override;
+
+    // "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}"
+    static std::wstring guidString(REFGUID guid);
+
+private:
+    static HKEY rootKey(RegistryRoot root);
+
+private:
+    ComPtr<ITfInputProcessorProfiles> inputProcessorProfiles_;
+    ComPtr<ITfCategoryMgr> categoryMgr_;
+    std::wstring defaultUserHive_;
+};
+
+}
+
+#endif
@@ -24,8 +24,6 @@ namespace Ime {
 static TCHAR g_imeWindowClassName[] = _T("LibImeWindow");
 static HINSTANCE g_hinstance = NULL;
 
-std::map<HWND, Window*> Window::hwndMap_;
-
 Window::Window():
     hwnd_(NULL) {
 }
@@ -36,14 +34,10 @@ Window::~Window() {
 }
 
 bool Window::create(HWND parent, DWORD style, DWORD exStyle) {
+    // the object is associated with the hwnd in WM_NCCREATE, see _wndProc().
     hwnd_ = CreateWindowEx(exStyle, g_imeWindowClassName, NULL, style,
-                    0, 0, 0, 0, parent, NULL, g_hinstance, NULL);
-    if(hwnd_) {
-        // associate this object with the hwnd
-        hwndMap_[hwnd_] = this;
-        return true;
-    }
-    return false;
+                    0, 0, 0, 0, parent, NULL, g_hinstance, this);
+    return hwnd_ != NULL;
 }
 
 void Window::destroy(void) {
@@ -52,17 +46,42 @@ void Window::destroy(void) {
     hwnd_ = NULL;
 }
 
+void Window::attach(HWND hwnd) {
+    hwnd_ = hwnd;
+    if(hwnd_)
+        HandleRegistry::forCurrentThread().insert(hwnd_, this);
+}
+
+HWND Window::detach() {
+    HWND hwnd = hwnd_;
+    if(hwnd)
+        HandleRegistry::forCurrentThread().erase(hwnd);
+    hwnd_ = NULL;
+    return hwnd;
+}
+
 // static
 LRESULT Window::_wndProc(HWND hwnd , UINT msg, WPARAM wp , LPARAM lp) {
-    // get object pointer from the hwnd
-    Window* window = (Window*)hwndMap_[hwnd];
-    // FIXME: we cannot handle WM_CREATE in Window::wndProc member function
-    // because the message is sent before CreateWindow returns, and
-    // we do SetWindowLongPtr() only after CreateWindow().
+    HandleRegistry& registry = HandleRegistry::forCurrentThread();
+    Window* window;
+    if(msg == WM_NCCREATE) {
+        // the first message sent to the window, before CreateWindowEx() returns.
+        // associate the object passed to CreateWindowEx() with the hwnd.
+        window = static_cast<Window*>(reinterpret_cast<CREATESTRUCT*>(lp)->lpCreateParams);
+        if(window) {
+            window->hwnd_ = hwnd;
+            registry.insert(hwnd, window);
+        }
+    }
+    else {
+        // get object pointer from the hwnd.
+        // WM_GETMINMAXINFO is sent even before WM_NCCREATE and is not found.
+        window = static_cast<Window*>(registry.find(hwnd));
+    }
     if(window) {
         LRESULT result = window->wndProc(msg, wp, lp);
         if(msg == WM_NCDESTROY)
-            hwndMap_.erase(hwnd);
+            registry.erase(hwnd);
         return result;
     }
     return ::DefWindowProc(hwnd, msg, wp, lp);
@@ -96,4 +115,27 @@ bool Window::registerClass(HINSTANCE hinstance) {
     return true;
 }
 
+void* Win32WindowBackend::createWindow(void* parent) {
+    // no object is associated with the window until Window::attach()
+    return CreateWindowEx(WS_EX_TOOLWINDOW|WS_EX_TOPMOST, g_imeWindowClassName, NULL, WS_POPUP|WS_CLIPCHILDREN,
+                    0, 0, 0, 0, (HWND)parent, NULL, g_hinstance, NULL);
+}
+
+void Win32WindowBackend::setParent(void* window, void* parent) {
+    // the "parent" of a popup window is its owner
+    ::SetWindowLongPtr((HWND)window, GWLP_HWNDPARENT, (LONG_PTR)parent);
+}
+
+void Win32WindowBackend::hideWindow(void* window) {
+    ::ShowWindow((HWND)window, SW_HIDE);
+}
+
+void Win32WindowBackend::destroyWindow(void* window) {
+    ::DestroyWindow((HWND)window);
+}
+
+void Win32WindowBackend::destroyFont(void* font) {
+    ::DeleteObject((HFONT)font);
+}
+
 } // namespace Ime
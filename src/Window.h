@@ -26,7 +26,8 @@
 
 #include <windows.h>
 #include <tchar.h>
-#include <map>
+#include "HandleRegistry.h"
+#include "WindowPool.h"
 
 namespace Ime {
 
@@ -41,6 +42,11 @@ public:
     bool create(HWND parent, DWORD style, DWORD exStyle = 0);
     void destroy(void);
 
+    // use an existing window, such as one from a WindowPool.
+    void attach(HWND hwnd);
+    // stop handling messages of the window without destroying it.
+    HWND detach();
+
     bool isVisible(){
         return !!IsWindowVisible(hwnd_);
     }
@@ -68,20 +74,21 @@ public:
         ::GetWindowRect(hwnd_, rect);
     }
 
-    void show() {
+    // virtual, so windows such as CandidateWindow can keep some state in sync
+    virtual void show() {
         if( hwnd_ )
             ShowWindow(hwnd_, SW_SHOWNA);
     }
 
-    void hide(){ ShowWindow(hwnd_, SW_HIDE); }
+    virtual void hide(){ ShowWindow(hwnd_, SW_HIDE); }
 
     void refresh()    {    InvalidateRect( hwnd_, NULL, FALSE );    }
 
     static bool registerClass(HINSTANCE hinstance);
 
+    // only windows created by the calling thread can be found.
     static Window* fromHwnd(HWND hwnd) {
-        std::map<HWND, Window*>::iterator it = hwndMap_.find(hwnd);
-        return it != hwndMap_.end() ? it->second : NULL;
+        return static_cast<Window*>(HandleRegistry::forCurrentThread().find(hwnd));
     }
 
 protected:
@@ -90,7 +97,16 @@ protected:
 
 protected:
     HWND hwnd_;
-    static std::map<HWND, Window*> hwndMap_;
+};
+
+// creates the hidden popup windows of WindowPool with the window class of libIME.
+class Win32WindowBackend: public WindowBackend {
+public:
+    void* createWindow(void* parent) override;
+    void setParent(void* window, void* parent) override;
+    void hideWindow(void* window) override;
+    void destroyWindow(void* window) override;
+    void destroyFont(void* font) override;
 };
 
 }
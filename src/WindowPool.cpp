@@ -0,0 +1,93 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#include "WindowPool.h"
+
+namespace Ime {
+
+WindowPool::WindowPool(std::unique_ptr<WindowBackend> backend, size_t maxIdle):
+    backend_(std::move(backend)),
+    maxIdle_(maxIdle),
+    created_(0),
+    reused_(0) {
+}
+
+WindowPool::~WindowPool() {
+    trim(0);
+}
+
+PooledWindow WindowPool::acquire(void* parent) {
+    PooledWindow window;
+    if(!idle_.empty()) {
+        // the most recently used one, whose measurements are most likely still useful
+        window = std::move(idle_.back());
+        idle_.pop_back();
+        backend_->setParent(window.window, parent);
+        ++reused_;
+    }
+    else {
+        window.window = backend_->createWindow(parent);
+        if(window.window)
+            ++created_;
+    }
+    return window;
+}
+
+void WindowPool::release(PooledWindow&& window) {
+    if(!window.window)
+        return;
+    if(idle_.size() >= maxIdle_) {
+        destroy(window);
+        return;
+    }
+    backend_->hideWindow(window.window);
+    idle_.push_back(std::move(window));
+}
+
+void WindowPool::prepare(size_t n, void* parent) {
+    n = n < maxIdle_ ? n : maxIdle_;
+    while(idle_.size() < n) {
+        PooledWindow window;
+        window.window = backend_->createWindow(parent);
+        if(!window.window)
+            break;
+        ++created_;
+        // the least recently used end of the pool
+        idle_.insert(idle_.begin(), std::move(window));
+    }
+}
+
+void WindowPool::trim(size_t keep) {
+    // destroy the least recently used ones first
+    size_t n = idle_.size() > keep ? idle_.size() - keep : 0;
+    for(size_t i = 0; i < n; ++i)
+        destroy(idle_[i]);
+    idle_.erase(idle_.begin(), idle_.begin() + n);
+}
+
+void WindowPool::destroy(PooledWindow& window) {
+    backend_->destroyWindow(window.window);
+    if(window.font)
+        backend_->destroyFont(window.font);
+    window.window = nullptr;
+    window.font = nullptr;
+    window.extents.clear();
+}
+
+} // namespace Ime
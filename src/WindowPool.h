@@ -0,0 +1,114 @@
+//
+//    Copyright (C) 2013 - 2020 Hong Jen Yee (PCMan) <pcman.tw@gmail.com>
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Library General Public
+//    License as published by the Free Software Foundation; either
+//    version 2 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Library General Public License for more details.
+//
+//    You should have received a copy of the GNU Library General Public
+//    License along with this library; if not, write to the
+//    Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+//    Boston, MA  02110-1301, USA.
+//
+
+#ifndef IME_WINDOW_POOL_H
+#define IME_WINDOW_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "TextExtentCache.h"
+
+namespace Ime {
+
+// native window operations used by WindowPool (Win32 on Windows, fakes in the tests).
+// Handles are HWND and HFONT on Windows.
+class WindowBackend {
+public:
+    virtual ~WindowBackend() {}
+
+    // create a hidden IME popup window owned by parent.
+    virtual void* createWindow(void* parent) = 0;
+
+    // change the owner of the window.
+    virtual void setParent(void* window, void* parent) = 0;
+
+    virtual void hideWindow(void* window) = 0;
+
+    virtual void destroyWindow(void* window) = 0;
+
+    virtual void destroyFont(void* font) = 0;
+};
+
+// a native window, together with the font selected by its last user
+// and the text extents measured with that font.
+struct PooledWindow {
+    void* window = nullptr;
+    void* font = nullptr;  // owned by the pool while the window is idle
+    TextExtentCache extents;
+};
+
+// Keeps hidden windows (and their fonts and measurements) after a
+// composition ends, so the next candidate or message window does not pay
+// for creating a window, selecting a font and measuring text again.
+// A pool is not synchronized. Each text service, and so each UI thread,
+// owns one.
+class WindowPool {
+public:
+    explicit WindowPool(std::unique_ptr<WindowBackend> backend, size_t maxIdle = 4);
+    ~WindowPool();
+
+    // an idle window moved to the new parent, or a newly created one.
+    PooledWindow acquire(void* parent);
+
+    // hide the window and keep it for later, or destroy it if the pool is full.
+    void release(PooledWindow&& window);
+
+    // create windows in advance until there are n idle ones.
+    void prepare(size_t n, void* parent = nullptr);
+
+    // destroy idle windows until only keep of them are left.
+    void trim(size_t keep = 0);
+
+    size_t idleCount() const {
+        return idle_.size();
+    }
+
+    size_t maxIdle() const {
+        return maxIdle_;
+    }
+
+    // number of windows created by the pool
+    size_t created() const {
+        return created_;
+    }
+
+    // number of calls to acquire() which got an idle window
+    size_t reused() const {
+        return reused_;
+    }
+
+    WindowBackend& backend() {
+        return *backend_;
+    }
+
+private:
+    void destroy(PooledWindow& window);
+
+private:
+    std::unique_ptr<WindowBackend> backend_;
+    std::vector<PooledWindow> idle_;  // the most recently released last
+    size_t maxIdle_;
+    size_t created_;
+    size_t reused_;
+};
+
+}
+
+#endif
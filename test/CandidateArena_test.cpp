@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include "CandidateArena.h"
+#include "CandidateList.h"
+#include "TextExtentCache.h"
+
+#include <string>
+
+TEST(TestCandidateArena, AppendAndAccess)
+{
+    Ime::CandidateArena arena;
+    EXPECT_TRUE(arena.empty());
+    arena.append(L"中文");
+    arena.append(L"");
+    arena.append(L"輸入法");
+    EXPECT_EQ(arena.size(), 3);
+    EXPECT_EQ(arena.charCount(), 5);
+    EXPECT_TRUE(arena[0] == L"中文");
+    EXPECT_TRUE(arena[1].empty());
+    EXPECT_TRUE(arena[2] == L"輸入法");
+    EXPECT_EQ(arena.hash(2), Ime::TextExtentCache::hash(L"輸入法", 3));
+
+    arena.removeLast();
+    arena.append(L"字");
+    EXPECT_EQ(arena.size(), 3);
+    EXPECT_EQ(arena.charCount(), 3);
+    EXPECT_TRUE(arena[2] == L"字");
+}
+
+TEST(TestCandidateArena, ClearKeepsMemory)
+{
+    Ime::CandidateArena arena;
+    for (int i = 0; i < 1000; ++i) {
+        arena.append(std::to_wstring(i));
+    }
+    size_t memory = arena.memoryUsage();
+    arena.clear();
+    EXPECT_TRUE(arena.empty());
+    EXPECT_EQ(arena.memoryUsage(), memory);
+    for (int i = 0; i < 1000; ++i) {
+        arena.append(std::to_wstring(i));
+    }
+    EXPECT_EQ(arena.memoryUsage(), memory);
+}
+
+TEST(TestCandidateArena, RecycledByCandidateList)
+{
+    Ime::CandidateList list;
+    Ime::CandidateArena arena;
+    for (int i = 0; i < 100; ++i) {
+        arena.append(std::to_wstring(i));
+    }
+    size_t memory = arena.memoryUsage();
+    list.setItems(std::move(arena));
+    EXPECT_EQ(list.count(), 100);
+    EXPECT_TRUE(list.pageItem(3) == L"3");
+
+    // refreshing the list reuses the memory of the previous one.
+    arena = list.recycleItems();
+    EXPECT_EQ(list.count(), 0);
+    EXPECT_TRUE(arena.empty());
+    EXPECT_EQ(arena.memoryUsage(), memory);
+}
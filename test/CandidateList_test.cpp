@@ -0,0 +1,243 @@
+#include "gtest/gtest.h"
+
+#include "CandidateList.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::wstring> makeItems(int n) {
+    std::vector<std::wstring> items;
+    for (int i = 0; i < n; ++i) {
+        items.push_back(std::to_wstring(i));
+    }
+    return items;
+}
+
+}
+
+TEST(TestCandidateList, EvenPages)
+{
+    Ime::CandidateList list;
+    list.setItems(makeItems(25));
+    EXPECT_EQ(list.pageSize(), 10);
+    EXPECT_EQ(list.pageCount(), 3);
+    EXPECT_EQ(list.pageStart(2), 20);
+    EXPECT_EQ(list.pageEnd(2), 25);
+
+    list.setCandPerRow(3);
+    list.setRowsPerPage(2);
+    EXPECT_EQ(list.pageSize(), 6);
+    EXPECT_EQ(list.pageCount(), 5);
+    EXPECT_EQ(list.pageOf(13), 2);
+}
+
+TEST(TestCandidateList, EmptyListHasOnePage)
+{
+    Ime::CandidateList list;
+    EXPECT_EQ(list.count(), 0);
+    EXPECT_EQ(list.pageCount(), 1);
+    EXPECT_EQ(list.currentPageSize(), 0);
+    EXPECT_FALSE(list.nextPage());
+}
+
+TEST(TestCandidateList, PageItemsAndSelKeys)
+{
+    Ime::CandidateList list;
+    list.setItems(makeItems(25));
+    list.setSelKeys({ '1', '2', '3' });
+    // a page has one item per key
+    EXPECT_EQ(list.pageSize(), 3);
+    EXPECT_EQ(list.pageCount(), 9);
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_EQ(list.currentPage(), 1);
+    EXPECT_EQ(list.currentSel(), 3);
+    EXPECT_TRUE(list.pageItem(0) == L"3");
+    EXPECT_EQ(list.currentPageSize(), 3);
+    EXPECT_EQ(list.selKey(2), '3');
+    EXPECT_EQ(list.selKey(3), 0);
+}
+
+TEST(TestCandidateList, PageSizeLimitedBySelKeys)
+{
+    Ime::CandidateList list;
+    list.setCandPerRow(9);
+    list.setItems(makeItems(100));
+    EXPECT_EQ(list.pageSize(), 90);
+    list.setSelKeys({ '1', '2', '3', '4', '5', '6', '7', '8', '9' });
+    EXPECT_EQ(list.pageSize(), 9);
+    EXPECT_EQ(list.pageCount(), 12);
+    EXPECT_EQ(list.currentPageSize(), 9);
+    for (int slot = 0; slot < list.currentPageSize(); ++slot) {
+        EXPECT_NE(list.selKey(slot), 0);
+    }
+
+    // the keys repeat on every page when the items are added one by one
+    list.clear();
+    const wchar_t keys[] = L"123456789";
+    for (int i = 0; i < 20; ++i) {
+        list.add(std::to_wstring(i), keys[i % 9]);
+    }
+    EXPECT_EQ(list.selKeys().size(), 9u);
+    EXPECT_EQ(list.pageSize(), 9);
+    EXPECT_EQ(list.pageCount(), 3);
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_TRUE(list.pageItem(0) == L"9");
+    EXPECT_EQ(list.selKey(0), '1');
+}
+
+TEST(TestCandidateList, PageNavigationKeepsSlot)
+{
+    Ime::CandidateList list;
+    list.setItems(makeItems(25));
+    list.setCurrentSel(7);
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_EQ(list.currentSel(), 17);
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_EQ(list.currentSel(), 24);  // clamped to the last item
+    EXPECT_FALSE(list.nextPage());
+    EXPECT_TRUE(list.prevPage());
+    EXPECT_EQ(list.currentSel(), 14);
+}
+
+TEST(TestCandidateList, ArrowKeysFlipPages)
+{
+    Ime::CandidateList list;
+    list.setCandPerRow(3);
+    list.setRowsPerPage(2);
+    list.setItems(makeItems(10));  // pages: [0, 6), [6, 10)
+
+    EXPECT_FALSE(list.moveUp());
+    EXPECT_FALSE(list.moveLeft());
+    EXPECT_TRUE(list.moveDown());
+    EXPECT_EQ(list.currentSel(), 3);
+    EXPECT_TRUE(list.moveRight());
+    EXPECT_EQ(list.currentSel(), 4);
+    EXPECT_TRUE(list.moveDown());  // first row of the next page, same column
+    EXPECT_EQ(list.currentPage(), 1);
+    EXPECT_EQ(list.currentSel(), 7);
+    EXPECT_TRUE(list.moveDown());  // the last row has only one item
+    EXPECT_EQ(list.currentSel(), 9);
+    EXPECT_FALSE(list.moveDown());
+    EXPECT_TRUE(list.moveUp());
+    EXPECT_EQ(list.currentSel(), 6);
+    EXPECT_TRUE(list.moveUp());  // last row of the previous page
+    EXPECT_EQ(list.currentPage(), 0);
+    EXPECT_EQ(list.currentSel(), 3);
+    list.setCurrentSel(6);
+    EXPECT_TRUE(list.moveLeft());
+    EXPECT_EQ(list.currentSel(), 5);
+    EXPECT_EQ(list.currentPage(), 0);
+}
+
+TEST(TestCandidateList, CustomPageStarts)
+{
+    Ime::CandidateList list;
+    list.setItems(makeItems(25));
+    EXPECT_FALSE(list.setPageStarts({ 1, 5 }));  // must start with 0
+    EXPECT_FALSE(list.setPageStarts({ 0, 5, 5 }));  // must be increasing
+    EXPECT_FALSE(list.setPageStarts({ 0, 30 }));  // out of range
+    EXPECT_TRUE(list.setPageStarts({ 0, 4, 12 }));
+    EXPECT_EQ(list.pageCount(), 3);
+    EXPECT_EQ(list.pageOf(11), 1);
+    EXPECT_EQ(list.pageEnd(2), 25);
+    list.setCurrentSel(13);
+    EXPECT_EQ(list.currentPage(), 2);
+    EXPECT_EQ(list.currentSlot(), 1);
+
+    EXPECT_TRUE(list.setPageStarts({}));
+    EXPECT_EQ(list.pageCount(), 3);
+    EXPECT_EQ(list.pageStart(1), 10);
+}
+
+namespace {
+
+// generates candidates on demand like a ranked iterator, a few at a time.
+class GeneratingSource: public Ime::CandidateSource {
+public:
+    explicit GeneratingSource(int total): total_(total) {}
+
+    int count() override {
+        return generated_;
+    }
+
+    std::wstring get(int i) override {
+        ++gets;
+        return L"c" + std::to_wstring(i);
+    }
+
+    std::wstring annotation(int i) override {
+        return L"a" + std::to_wstring(i);
+    }
+
+    bool fetch(int n) override {
+        generated_ = std::min(n, total_);
+        return n <= total_;
+    }
+
+    bool isComplete() override {
+        return generated_ == total_;
+    }
+
+    int gets = 0;
+
+private:
+    int total_;
+    int generated_ = 0;
+};
+
+}
+
+TEST(TestCandidateList, PullsOnlyCurrentPage)
+{
+    Ime::CandidateList list;
+    auto source = std::make_shared<Ime::VectorCandidateSource>(makeItems(5000));
+    list.setSource(source);
+    EXPECT_EQ(list.count(), 5000);
+    EXPECT_EQ(list.pageCount(), 500);
+    EXPECT_EQ(list.currentPageSize(), 10);
+    EXPECT_TRUE(list.pageItem(9) == L"9");
+    list.setCurrentPage(321);
+    EXPECT_TRUE(list.pageItem(0) == L"3210");
+}
+
+TEST(TestCandidateList, GeneratesCandidatesOnDemand)
+{
+    Ime::CandidateList list;
+    auto source = std::make_shared<GeneratingSource>(25);
+    list.setSource(source);
+    // only the first page is generated and pulled
+    EXPECT_EQ(list.count(), 10);
+    EXPECT_EQ(source->gets, 10);
+    EXPECT_EQ(list.pageCount(), 1);
+    EXPECT_EQ(list.pageAnnotation(3), L"a3");
+
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_EQ(list.count(), 20);
+    EXPECT_TRUE(list.pageItem(0) == L"c10");
+    EXPECT_EQ(source->gets, 20);
+
+    list.setCurrentSel(19);
+    EXPECT_TRUE(list.moveRight());
+    EXPECT_EQ(list.currentPage(), 2);
+    EXPECT_EQ(list.count(), 25);
+    EXPECT_EQ(list.currentPageSize(), 5);
+    EXPECT_FALSE(list.nextPage());
+}
+
+TEST(TestCandidateList, AddItems)
+{
+    Ime::CandidateList list;
+    list.add(L"a", '1');
+    list.add(L"b", '2');
+    EXPECT_EQ(list.count(), 2);
+    EXPECT_EQ(list.currentPageSize(), 2);
+    EXPECT_TRUE(list.pageItem(1) == L"b");
+    EXPECT_EQ(list.selKey(1), '2');
+    list.clear();
+    EXPECT_EQ(list.count(), 0);
+    EXPECT_EQ(list.currentPageSize(), 0);
+}
@@ -0,0 +1,155 @@
+#include "gtest/gtest.h"
+
+#include "CandidateList.h"
+#include "CandidatePainter.h"
+
+#include <string>
+#include <vector>
+
+using Ime::PaintColor;
+using Ime::PaintRect;
+using Ime::RecordingPaintBackend;
+
+namespace {
+
+std::vector<std::wstring> makeItems(int n) {
+    std::vector<std::wstring> items;
+    for (int i = 0; i < n; ++i) {
+        items.push_back(std::to_wstring(i));
+    }
+    return items;
+}
+
+// one candidate per row, 10 rows per page
+Ime::CandidateLayout makeLayout(int itemCount) {
+    Ime::CandidateLayout layout;
+    layout.margin = 5;
+    layout.rowSpacing = 4;
+    layout.colSpacing = 8;
+    layout.selKeyWidth = 24;
+    layout.textWidth = 40;
+    layout.itemHeight = 20;
+    layout.candPerRow = 1;
+    layout.width = layout.margin * 2 + layout.selKeyWidth + layout.textWidth;
+    layout.height = layout.margin * 2 + itemCount * layout.itemHeight + (itemCount - 1) * layout.rowSpacing;
+    return layout;
+}
+
+class CandidatePainterTest: public ::testing::Test {
+protected:
+    void SetUp() override {
+        list.setItems(makeItems(25));
+        list.setSelKeys({ '1', '2', '3', '4', '5', '6', '7', '8', '9', '0' });
+        painter.setLayout(makeLayout(10));
+        painter.paint(list, true, backend);
+        backend.clear();
+    }
+
+    Ime::CandidateList list;
+    Ime::CandidatePainter painter;
+    RecordingPaintBackend backend;
+};
+
+}
+
+TEST(TestCandidatePainter, FirstPaintDrawsEverything)
+{
+    Ime::CandidateList list;
+    list.setItems(makeItems(3));
+    Ime::CandidatePainter painter;
+    painter.setLayout(makeLayout(3));
+    RecordingPaintBackend backend;
+    painter.paint(list, true, backend);
+
+    EXPECT_EQ(backend.count(RecordingPaintBackend::FRAME), 1);
+    // a selection key and a string per item
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 6);
+    ASSERT_EQ(backend.count(RecordingPaintBackend::PRESENT), 1);
+    EXPECT_TRUE(backend.ops().back().rect == PaintRect({0, 0, painter.layout().width, painter.layout().height}));
+
+    // the selected item is highlighted instead of inverted afterwards
+    EXPECT_EQ(backend.ops()[2].text, L"0");
+    EXPECT_EQ(backend.ops()[2].bkColor, PaintColor::HIGHLIGHT);
+    EXPECT_EQ(backend.ops()[4].text, L"1");
+    EXPECT_EQ(backend.ops()[4].bkColor, PaintColor::WINDOW);
+}
+
+TEST_F(CandidatePainterTest, NothingChanged)
+{
+    EXPECT_TRUE(painter.dirtyRect(list, true).isEmpty());
+    painter.paint(list, true, backend);
+    EXPECT_TRUE(backend.ops().empty());
+}
+
+TEST_F(CandidatePainterTest, ExposedAreaIsCopiedFromBackBuffer)
+{
+    PaintRect exposed = {0, 0, 30, 30};
+    painter.paint(list, true, backend, exposed);
+    ASSERT_EQ(backend.ops().size(), 1u);
+    EXPECT_EQ(backend.ops()[0].type, RecordingPaintBackend::PRESENT);
+    EXPECT_TRUE(backend.ops()[0].rect == exposed);
+}
+
+TEST_F(CandidatePainterTest, ArrowKeyRepaintsTwoItems)
+{
+    ASSERT_TRUE(list.moveDown());
+    PaintRect dirty = painter.dirtyRect(list, true);
+    PaintRect expected = painter.itemRect(0);
+    expected.unite(painter.itemRect(1));
+    EXPECT_TRUE(dirty == expected);
+
+    painter.paint(list, true, backend);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::FRAME), 0);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 4);
+    ASSERT_EQ(backend.count(RecordingPaintBackend::PRESENT), 1);
+    EXPECT_TRUE(backend.ops().back().rect == expected);
+    EXPECT_EQ(backend.ops()[1].text, L"0");
+    EXPECT_EQ(backend.ops()[1].bkColor, PaintColor::WINDOW);
+    EXPECT_EQ(backend.ops()[3].text, L"1");
+    EXPECT_EQ(backend.ops()[3].bkColor, PaintColor::HIGHLIGHT);
+
+    // painted already
+    backend.clear();
+    painter.paint(list, true, backend);
+    EXPECT_TRUE(backend.ops().empty());
+}
+
+TEST_F(CandidatePainterTest, HidingCursorRepaintsOneItem)
+{
+    painter.paint(list, false, backend);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 2);
+    EXPECT_TRUE(backend.ops().back().rect == painter.itemRect(0));
+}
+
+TEST_F(CandidatePainterTest, PageDownRepaintsChangedItems)
+{
+    // only the strings differ, the selection keys are the same
+    ASSERT_TRUE(list.nextPage());
+    painter.paint(list, true, backend);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::FRAME), 0);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 20);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::PRESENT), 1);
+
+    // the last page is shorter, the slots left empty need to be erased
+    backend.clear();
+    ASSERT_TRUE(list.nextPage());
+    painter.paint(list, true, backend);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::FRAME), 1);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 10);
+}
+
+TEST_F(CandidatePainterTest, NewLayoutRepaintsEverything)
+{
+    // the same layout keeps the back buffer
+    painter.setLayout(makeLayout(10));
+    EXPECT_FALSE(painter.needsFullRepaint());
+
+    Ime::CandidateLayout layout = makeLayout(10);
+    layout.textWidth += 16;
+    painter.setLayout(layout);
+    EXPECT_TRUE(painter.needsFullRepaint());
+    painter.paint(list, true, backend);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::FRAME), 1);
+    EXPECT_EQ(backend.count(RecordingPaintBackend::TEXT), 20);
+    EXPECT_FALSE(painter.needsFullRepaint());
+}
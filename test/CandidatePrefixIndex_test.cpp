@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+
+#include "CandidateList.h"
+#include "CandidatePrefixIndex.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// readings made of 4 bopomofo-like keys each, 'a' to 'h'
+std::wstring reading(int i) {
+    std::wstring key;
+    for (int j = 0; j < 4; ++j) {
+        key += wchar_t('a' + i % 8);
+        i /= 8;
+    }
+    return key;
+}
+
+std::shared_ptr<Ime::VectorCandidateSource> makeSource(int n) {
+    std::vector<std::wstring> items, readings;
+    for (int i = 0; i < n; ++i) {
+        items.push_back(std::to_wstring(i));
+        readings.push_back(reading(i));
+    }
+    return std::make_shared<Ime::VectorCandidateSource>(items, readings);
+}
+
+}
+
+TEST(TestCandidatePrefixIndex, MatchKeepsOriginalOrder)
+{
+    Ime::CandidatePrefixIndex index;
+    index.build({ L"ba", L"ab", L"abc", L"b", L"abd", L"a" });
+    EXPECT_EQ(index.match(L"ab"), std::vector<int>({ 1, 2, 4 }));
+    EXPECT_EQ(index.match(L"abc"), std::vector<int>({ 2 }));
+    EXPECT_EQ(index.match(L"b"), std::vector<int>({ 0, 3 }));
+    EXPECT_EQ(index.match(L""), std::vector<int>({ 0, 1, 2, 3, 4, 5 }));
+    EXPECT_TRUE(index.match(L"c").empty());
+    EXPECT_TRUE(index.match(L"abcd").empty());
+}
+
+TEST(TestCandidatePrefixIndex, NarrowingIsSublinear)
+{
+    const int n = 2000;
+    Ime::CandidatePrefixIndex index;
+    index.build(*makeSource(n));
+    ASSERT_EQ(index.size(), n);
+
+    std::wstring prefix;
+    std::vector<int> expected;
+    for (wchar_t key : reading(1234)) {
+        prefix += key;
+        index.resetStats();
+        std::vector<int> matches = index.match(prefix);
+
+        // a linear scan gives the same result
+        expected.clear();
+        for (int i = 0; i < n; ++i) {
+            if (reading(i).compare(0, prefix.length(), prefix) == 0)
+                expected.push_back(i);
+        }
+        EXPECT_EQ(matches, expected);
+        // two binary searches in at most n keys
+        EXPECT_LE(index.comparisons(), 2u * 12u);
+    }
+    EXPECT_EQ(expected, std::vector<int>({ 1234 }));
+}
+
+TEST(TestCandidatePrefixIndex, FilterCandidateList)
+{
+    Ime::CandidateList list;
+    list.setSource(makeSource(2000));
+    list.setSelKeys({ '1', '2', '3' });
+    ASSERT_TRUE(list.nextPage());
+    unsigned int version = list.itemsVersion();
+
+    // 'a' as the first key: 0, 8, 16, ...
+    EXPECT_EQ(list.filter(L"a"), 250);
+    EXPECT_TRUE(list.isFiltered());
+    EXPECT_NE(list.itemsVersion(), version);
+    EXPECT_EQ(list.currentSel(), 0);
+    EXPECT_EQ(list.currentPage(), 0);
+    EXPECT_TRUE(list.pageItem(1) == L"8");
+    EXPECT_TRUE(list.pageAnnotation(1) == L"abaa");
+    EXPECT_EQ(list.unfilteredIndex(1), 8);
+
+    EXPECT_EQ(list.filter(L"ab"), 32);
+    EXPECT_TRUE(list.pageItem(0) == L"8");
+    EXPECT_EQ(list.filter(L"abz"), 0);
+    EXPECT_EQ(list.pageCount(), 1);
+
+    // back to the whole list
+    EXPECT_EQ(list.filter(L""), 2000);
+    EXPECT_TRUE(list.pageItem(1) == L"1");
+    EXPECT_EQ(list.unfilteredIndex(1), 1);
+
+    list.clear();
+    EXPECT_FALSE(list.isFiltered());
+}
+
+TEST(TestCandidatePrefixIndex, AddResetsFilter)
+{
+    Ime::CandidateList list;
+    list.setItems({ L"x", L"y" });
+    EXPECT_EQ(list.filter(L"a"), 0);
+    list.add(L"z", '3');
+    EXPECT_FALSE(list.isFiltered());
+    EXPECT_EQ(list.count(), 3);
+}
+
+TEST(TestCandidatePrefixIndex, FilterItemsWithoutAnnotations)
+{
+    // the text of the candidates is used
+    Ime::CandidateList list;
+    list.setItems({ L"apple", L"banana", L"avocado", L"apricot" });
+    EXPECT_EQ(list.filter(L"a"), 3);
+    EXPECT_TRUE(list.pageItem(1) == L"avocado");
+    EXPECT_EQ(list.unfilteredIndex(1), 2);
+    EXPECT_EQ(list.filter(L"ap"), 2);
+    EXPECT_TRUE(list.pageItem(1) == L"apricot");
+    EXPECT_EQ(list.filter(L"b"), 1);
+
+    list.clear();
+    list.add(L"one", '1');
+    list.add(L"two", '2');
+    list.add(L"three", '3');
+    EXPECT_EQ(list.filter(L"t"), 2);
+    EXPECT_TRUE(list.pageItem(0) == L"two");
+}
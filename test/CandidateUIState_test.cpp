@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+
+#include "CandidateList.h"
+#include "CandidateUIState.h"
+
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+std::vector<std::wstring> makeItems(int n) {
+    std::vector<std::wstring> items;
+    for (int i = 0; i < n; ++i) {
+        items.push_back(std::to_wstring(i));
+    }
+    return items;
+}
+
+// behaves like a UI-less application: it reads the updated flags
+// while UpdateUIElement() is being called and refetches only those parts.
+class FakeUIElementMgr: public UIElementHost {
+public:
+    explicit FakeUIElementMgr(CandidateUIState& state, bool show = true):
+        state_(state),
+        show_(show),
+        begins(0),
+        updates(0),
+        ends(0) {
+    }
+
+    bool beginUIElement(uint32_t& elementId, bool& show) override {
+        ++begins;
+        beginFlags = state_.updatedFlags();
+        elementId = 42;
+        show = show_;
+        return true;
+    }
+
+    void updateUIElement(uint32_t elementId) override {
+        EXPECT_EQ(elementId, 42u);
+        ++updates;
+        flags.push_back(state_.updatedFlags());
+    }
+
+    void endUIElement(uint32_t elementId) override {
+        EXPECT_EQ(elementId, 42u);
+        ++ends;
+    }
+
+    CandidateUIState& state_;
+    bool show_;
+    int begins;
+    int updates;
+    int ends;
+    uint32_t beginFlags = 0;  // seen by the last begin
+    std::vector<uint32_t> flags;  // seen by each update
+};
+
+int docMgr1;
+int docMgr2;
+
+}
+
+TEST(TestCandidateUIState, BeginsOnce)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state);
+    state.sync(list, &docMgr1, mgr);
+    EXPECT_TRUE(state.isBegun());
+    EXPECT_EQ(state.elementId(), 42u);
+    EXPECT_EQ(mgr.begins, 1);
+    EXPECT_EQ(mgr.updates, 0);
+    // everything is new to the application
+    EXPECT_EQ(mgr.beginFlags, uint32_t(CANDIDATE_UI_ALL));
+    EXPECT_EQ(state.updatedFlags(), uint32_t(CANDIDATE_UI_ALL));
+
+    // nothing changed
+    state.sync(list, &docMgr1, mgr);
+    EXPECT_EQ(mgr.begins, 1);
+    EXPECT_EQ(mgr.updates, 0);
+
+    state.end(mgr);
+    EXPECT_EQ(mgr.ends, 1);
+    EXPECT_FALSE(state.isBegun());
+    state.end(mgr);
+    EXPECT_EQ(mgr.ends, 1);
+}
+
+TEST(TestCandidateUIState, SelectionOnly)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state);
+    state.sync(list, &docMgr1, mgr);
+
+    ASSERT_TRUE(list.moveDown());
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 1);
+    EXPECT_EQ(mgr.flags[0], uint32_t(CANDIDATE_UI_SELECTION));
+    // the flags are still there for applications asking later
+    EXPECT_EQ(state.updatedFlags(), uint32_t(CANDIDATE_UI_SELECTION));
+}
+
+TEST(TestCandidateUIState, PageFlip)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state);
+    state.sync(list, &docMgr1, mgr);
+
+    ASSERT_TRUE(list.nextPage());
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 1);
+    EXPECT_EQ(mgr.flags[0], uint32_t(CANDIDATE_UI_SELECTION | CANDIDATE_UI_CURRENTPAGE));
+
+    list.setCandPerRow(2);
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 2);
+    EXPECT_TRUE(mgr.flags[1] & CANDIDATE_UI_PAGEINDEX);
+    EXPECT_FALSE(mgr.flags[1] & (CANDIDATE_UI_STRING | CANDIDATE_UI_COUNT));
+}
+
+TEST(TestCandidateUIState, NewItems)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state);
+    state.sync(list, &docMgr1, mgr);
+
+    // same count, different strings
+    list.setItems(makeItems(25));
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 1);
+    EXPECT_EQ(mgr.flags[0], uint32_t(CANDIDATE_UI_STRING));
+
+    list.setItems(makeItems(3));
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 2);
+    EXPECT_EQ(mgr.flags[1], uint32_t(CANDIDATE_UI_COUNT | CANDIDATE_UI_STRING | CANDIDATE_UI_PAGEINDEX));
+
+    list.add(L"x", '4');
+    state.sync(list, &docMgr1, mgr);
+    ASSERT_EQ(mgr.updates, 3);
+    EXPECT_TRUE(mgr.flags[2] & CANDIDATE_UI_COUNT);
+    EXPECT_FALSE(mgr.flags[2] & CANDIDATE_UI_SELECTION);
+}
+
+TEST(TestCandidateUIState, DocumentMgr)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state);
+    state.sync(list, &docMgr1, mgr);
+    state.sync(list, &docMgr2, mgr);
+    ASSERT_EQ(mgr.updates, 1);
+    EXPECT_EQ(mgr.flags[0], uint32_t(CANDIDATE_UI_DOCUMENTMGR));
+}
+
+TEST(TestCandidateUIState, UiLessHost)
+{
+    CandidateList list;
+    list.setItems(makeItems(25));
+    CandidateUIState state;
+    FakeUIElementMgr mgr(state, false);
+    EXPECT_TRUE(state.shouldShow());
+    state.sync(list, &docMgr1, mgr);
+    EXPECT_FALSE(state.shouldShow());
+    state.end(mgr);
+    EXPECT_TRUE(state.shouldShow());
+}
@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+
+#include "ChineseConverter.h"
+
+#include <filesystem>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace Ime;
+
+namespace {
+
+std::string tradToSimpTable() {
+    ChineseConversionTableBuilder builder;
+    const char16_t* chars[][2] = {
+        {u"東", u"东"}, {u"車", u"车"}, {u"書", u"书"}, {u"學", u"学"}, {u"國", u"国"},
+        {u"語", u"语"}, {u"華", u"华"}, {u"發", u"发"}, {u"髮", u"发"}, {u"頭", u"头"},
+        {u"乾", u"干"}, {u"幹", u"干"}, {u"後", u"后"}, {u"麵", u"面"}
+    };
+    for (auto& c: chars) {
+        builder.add(c[0], c[1]);
+    }
+    builder.add(u"乾隆", u"乾隆");
+    builder.add(u"中華", u"中华");
+    builder.add(u"中華人民共和國", u"中华人民共和国");
+    // a non-BMP char, and a char mapped to several units (made up for the test)
+    builder.add(u"\U00020BB7", u"吉");
+    builder.add(u"咁", u"\U00020BB7");
+    return builder.build();
+}
+
+std::string simpToTradTable() {
+    ChineseConversionTableBuilder builder;
+    const char* text =
+        "# one-to-many chars use the most common one\n"
+        "发\t發 髮\n"
+        "干\t幹 乾 干\n"
+        "后\t後 后\n"
+        "头\t頭\n"
+        "净\t淨\n"
+        "\n"
+        "头发\t頭髮\n"
+        "理发\t理髮\r\n"
+        "干净\t乾淨\n"
+        "皇后\t皇后\n";
+    EXPECT_TRUE(builder.addText(text));
+    EXPECT_EQ(builder.size(), 9u);
+    return builder.build();
+}
+
+std::u16string convert(const ChineseConverter& converter, std::u16string_view in) {
+    std::u16string out;
+    converter.convert(in, out);
+    return out;
+}
+
+}
+
+TEST(TestChineseConverter, Chars)
+{
+    std::string table = tradToSimpTable();
+    ChineseConverter converter;
+    ASSERT_TRUE(converter.attach(table));
+    EXPECT_TRUE(convert(converter, u"東車書 abc 學國語") == u"东车书 abc 学国语");
+    EXPECT_TRUE(convert(converter, u"頭髮和發展") == u"头发和发展");
+    EXPECT_TRUE(convert(converter, u"\U00020BB7咁") == u"吉\U00020BB7");
+    // unpaired surrogates are kept
+    std::u16string broken = std::u16string(u"東") + char16_t(0xd842) + u"東" + char16_t(0xdfb7);
+    EXPECT_TRUE(convert(converter, broken) == std::u16string(u"东") + char16_t(0xd842) + u"东" + char16_t(0xdfb7));
+    EXPECT_TRUE(convert(converter, u"") == u"");
+}
+
+TEST(TestChineseConverter, LongestPhrase)
+{
+    std::string table = tradToSimpTable();
+    ChineseConverter converter;
+    ASSERT_TRUE(converter.attach(table));
+    EXPECT_EQ(converter.phraseCount(), 3u);
+    EXPECT_TRUE(convert(converter, u"乾隆乾燥") == u"乾隆干燥");
+    EXPECT_TRUE(convert(converter, u"中華人民共和國") == u"中华人民共和国");
+    // the longest phrase does not match, a shorter one does
+    EXPECT_TRUE(convert(converter, u"中華人民") == u"中华人民");
+    EXPECT_TRUE(convert(converter, u"中國") == u"中国");
+    EXPECT_TRUE(convert(converter, u"中") == u"中");
+}
+
+TEST(TestChineseConverter, OneToMany)
+{
+    std::string table = simpToTradTable();
+    ChineseConverter converter;
+    ASSERT_TRUE(converter.attach(table));
+    EXPECT_TRUE(convert(converter, u"头发") == u"頭髮");
+    EXPECT_TRUE(convert(converter, u"发展") == u"發展");
+    EXPECT_TRUE(convert(converter, u"去理发后很干净") == u"去理髮後很乾淨");
+    EXPECT_TRUE(convert(converter, u"皇后") == u"皇后");
+    EXPECT_TRUE(convert(converter, u"干部") == u"幹部");
+}
+
+TEST(TestChineseConverter, CallerBuffer)
+{
+    std::string table = tradToSimpTable();
+    ChineseConverter converter;
+    ASSERT_TRUE(converter.attach(table));
+    char16_t out[8];
+    auto result = converter.convert(u"東中華人民共和國", out, 6);
+    // the phrase does not fit, so it's not converted at all
+    EXPECT_EQ(result.read, 1u);
+    EXPECT_EQ(result.written, 1u);
+    result = converter.convert(u"咁", out, 1);
+    EXPECT_EQ(result.read, 0u);
+    result = converter.convert(u"東中華人民共和國", out, 8);
+    EXPECT_EQ(result.read, 8u);
+    EXPECT_TRUE(std::u16string(out, result.written) == u"东中华人民共和国");
+}
+
+TEST(TestChineseConverter, InvalidTables)
+{
+    ChineseConverter converter;
+    EXPECT_FALSE(converter.attach(std::string_view()));
+    std::string table = tradToSimpTable();
+    EXPECT_FALSE(converter.attach(std::string_view(table).substr(0, table.size() - 2)));
+    std::string badMagic = table;
+    badMagic[0] = 'X';
+    EXPECT_FALSE(converter.attach(badMagic));
+    EXPECT_FALSE(converter.isAttached());
+    // without a table, the text is copied
+    EXPECT_TRUE(convert(converter, u"東") == u"東");
+
+    ChineseConversionTableBuilder builder;
+    EXPECT_FALSE(builder.addText("no tab here\n"));
+}
+
+TEST(TestChineseConverter, MappedFromDictionaryFile)
+{
+    auto path = std::filesystem::temp_directory_path() / ("libime_zhconv_" + std::to_string(getpid()));
+    DictionaryFileWriter writer;
+    writer.addSection(TRAD_TO_SIMP_SECTION, tradToSimpTable());
+    writer.addSection(SIMP_TO_TRAD_SECTION, simpToTradTable());
+    ASSERT_TRUE(writer.write(path));
+
+    DictionaryFile dict;
+    ASSERT_EQ(dict.open(path), DictionaryError::NONE);
+    ChineseConverter t2s;
+    ChineseConverter s2t;
+    ASSERT_TRUE(t2s.attach(dict.section(TRAD_TO_SIMP_SECTION)));
+    ASSERT_TRUE(s2t.attach(dict.section(SIMP_TO_TRAD_SECTION)));
+    EXPECT_TRUE(convert(t2s, u"頭髮") == u"头发");
+    EXPECT_TRUE(convert(s2t, u"头发") == u"頭髮");
+    dict.close();
+    std::filesystem::remove(path);
+}
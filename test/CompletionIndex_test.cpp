@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+
+#include "CandidateList.h"
+#include "CompletionIndex.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace Ime;
+
+namespace {
+
+std::filesystem::path tempPath(const char* name) {
+    return std::filesystem::temp_directory_path() / (std::string("libime_") + name + "_" + std::to_string(getpid()));
+}
+
+const char* source =
+    "ㄓㄨㄥ\t中\t900\n"
+    "ㄓㄨㄥ\t鐘\t300\n"
+    "ㄓㄨㄥ\t忠\t500\n"
+    "ㄓㄨㄥㄨㄣˊ\t中文\t700\n"
+    "ㄓㄨㄥˋ\t中\t50\n"
+    "ㄓㄨㄥˋㄧㄠˋ\t重要\t800\n"
+    "ㄨㄣˊ\t文\t600\n";
+
+// a compiled lexicon and its completion index
+struct Fixture {
+    explicit Fixture(const LexiconBuilder& builder, const char* name):
+        path(tempPath(name)) {
+        DictionaryFileWriter writer;
+        builder.addSectionsTo(writer);
+        ok = writer.write(path) && file.open(path) == DictionaryError::NONE
+            && lexicon.attach(file) && index.attach(file, lexicon);
+    }
+
+    ~Fixture() {
+        file.close();
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+    DictionaryFile file;
+    Lexicon lexicon;
+    CompletionIndex index;
+    bool ok;
+};
+
+std::u16string texts(const CompletionIndex& index, const std::vector<Completion>& completions) {
+    std::u16string result;
+    for (const auto& completion : completions) {
+        if (!result.empty())
+            result += u' ';
+        result += index.lexicon().text(*completion.phrase);
+    }
+    return result;
+}
+
+}
+
+TEST(TestCompletionIndex, Complete)
+{
+    LexiconBuilder builder;
+    ASSERT_TRUE(builder.addText(source));
+    Fixture fixture(builder, "completion");
+    ASSERT_TRUE(fixture.ok);
+    const CompletionIndex& index = fixture.index;
+
+    auto completions = index.complete(u"ㄓ", 10);
+    EXPECT_TRUE(texts(index, completions) == u"中 重要 中文 忠 鐘 中");
+    EXPECT_EQ(900u, completions[0].phrase->frequency);
+    EXPECT_TRUE(index.reading(completions[0]) == u"ㄓㄨㄥ");
+    EXPECT_TRUE(index.reading(completions[1]) == u"ㄓㄨㄥˋㄧㄠˋ");
+    EXPECT_TRUE(index.reading(completions[2]) == u"ㄓㄨㄥㄨㄣˊ");
+    EXPECT_TRUE(index.reading(completions[5]) == u"ㄓㄨㄥˋ");
+
+    EXPECT_TRUE(texts(index, index.complete(u"ㄓㄨㄥ", 2)) == u"中 重要");
+    EXPECT_TRUE(texts(index, index.complete(u"ㄓㄨㄥˋ", 10)) == u"重要 中");
+    // a prefix ending in the tail of a leaf
+    EXPECT_TRUE(texts(index, index.complete(u"ㄓㄨㄥˋㄧ", 10)) == u"重要");
+    EXPECT_TRUE(texts(index, index.complete(u"ㄨ", 10)) == u"文");
+    EXPECT_TRUE(texts(index, index.complete(u"", 3)) == u"中 重要 中文");
+    EXPECT_TRUE(index.complete(u"ㄅ", 10).empty());
+    EXPECT_TRUE(index.complete(u"ㄓㄨㄥˋㄧㄡ", 10).empty());
+    EXPECT_TRUE(index.complete(u"ㄓ", 0).empty());
+
+    // dictionaries without the section
+    CompletionIndex other;
+    EXPECT_FALSE(other.attach(fixture.file, Lexicon()));
+    EXPECT_TRUE(other.complete(u"ㄓ", 10).empty());
+}
+
+TEST(TestCompletionIndex, SameAsSortingAllCompletions)
+{
+    std::mt19937 random(7);
+    const std::u16string units = u"ㄅㄆㄇㄈㄚㄛㄜˊˇ";
+    LexiconBuilder builder;
+    for (int i = 0; i < 3000; ++i) {
+        std::u16string reading;
+        size_t length = 1 + random() % 6;
+        for (size_t j = 0; j < length; ++j)
+            reading += units[random() % units.size()];
+        std::u16string phrase(1, char16_t(0x4e00 + random() % 500));
+        builder.add(reading, phrase, random() % 1000);
+    }
+    Fixture fixture(builder, "completion_random");
+    ASSERT_TRUE(fixture.ok);
+    const CompletionIndex& index = fixture.index;
+    const Lexicon& lexicon = fixture.lexicon;
+
+    for (std::u16string prefix : {u"", u"ㄅ", u"ㄚ", u"ㄇˊ", u"ㄅㄆㄇ", u"ㄜˇㄚ"}) {
+        std::vector<uint32_t> expected;
+        lexicon.readings().forEachWithPrefix(prefix, [&](std::u16string_view, uint32_t readingIndex) {
+            for (const auto& phrase : lexicon.phrasesOf(readingIndex))
+                expected.push_back(phrase.frequency);
+            return true;
+        });
+        std::sort(expected.begin(), expected.end(), std::greater<uint32_t>());
+
+        for (size_t k : {size_t(1), size_t(10), size_t(100), expected.size() + 1}) {
+            auto completions = index.complete(prefix, k);
+            ASSERT_EQ(std::min(k, expected.size()), completions.size());
+            for (size_t i = 0; i < completions.size(); ++i) {
+                EXPECT_EQ(expected[i], completions[i].phrase->frequency);
+                std::u16string reading = index.reading(completions[i]);
+                EXPECT_EQ(0u, reading.compare(0, prefix.size(), prefix));
+                EXPECT_EQ(completions[i].readingIndex, lexicon.readings().find(reading));
+                auto phrases = lexicon.lookup(reading);
+                EXPECT_TRUE(completions[i].phrase >= phrases.begin() && completions[i].phrase < phrases.end());
+            }
+        }
+    }
+}
+
+TEST(TestCompletionIndex, CandidateSource)
+{
+    LexiconBuilder builder;
+    for (int i = 0; i < 25; ++i)
+        builder.add(u"ㄅㄚ" + std::u16string(1, char16_t(u'a' + i)), std::u16string(1, char16_t(0x4e00 + i)), 100 - i);
+    Fixture fixture(builder, "completion_source");
+    ASSERT_TRUE(fixture.ok);
+
+    CandidateList list;
+    auto source = std::make_shared<CompletionCandidateSource>(fixture.index, u"ㄅ");
+    list.setSource(source);
+    // only the first page is searched
+    EXPECT_EQ(10, list.count());
+    EXPECT_FALSE(source->isComplete());
+    EXPECT_TRUE(list.pageItem(0) == L"\x4e00");
+    EXPECT_TRUE(list.pageAnnotation(1) == L"ㄅㄚb");
+
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_TRUE(list.nextPage());
+    EXPECT_EQ(25, list.count());
+    EXPECT_TRUE(list.pageItem(4) == L"\x4e18");
+    EXPECT_TRUE(source->isComplete());
+}
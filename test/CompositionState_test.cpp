@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "CompositionState.h"
+
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+const uint32_t INPUT = 1;
+const uint32_t CONVERTED = 2;
+const uint32_t TARGET = 3;
+
+// apply an update to a copy of the document, the way TextService does
+struct Document {
+    std::wstring text;
+    std::vector<uint32_t> attrs;
+
+    void apply(const std::wstring& newText, const CompositionUpdate& update) {
+        text.replace(update.textStart, update.removedLength, newText, update.textStart, update.insertedLength);
+        // replaced text loses its properties
+        attrs.erase(attrs.begin() + update.textStart, attrs.begin() + update.textStart + update.removedLength);
+        attrs.insert(attrs.begin() + update.textStart, update.insertedLength, 0);
+        for (auto& run: update.runs) {
+            for (int i = run.start; i < run.end; ++i) {
+                attrs[i] = run.attr;
+            }
+        }
+    }
+};
+
+}
+
+TEST(TestCompositionState, FirstUpdateWritesEverything)
+{
+    CompositionState state;
+    CompositionUpdate update;
+    state.update(L"abc", nullptr, 0, INPUT, update);
+    EXPECT_EQ(update.textStart, 0);
+    EXPECT_EQ(update.removedLength, 0);
+    EXPECT_EQ(update.insertedLength, 3);
+    ASSERT_EQ(update.runs.size(), 1u);
+    EXPECT_EQ(update.runs[0].start, 0);
+    EXPECT_EQ(update.runs[0].end, 3);
+    EXPECT_EQ(update.runs[0].attr, INPUT);
+
+    // nothing changed
+    state.update(L"abc", nullptr, 0, INPUT, update);
+    EXPECT_TRUE(update.empty());
+}
+
+TEST(TestCompositionState, TypingOnlyTouchesTheNewChar)
+{
+    CompositionState state;
+    CompositionUpdate update;
+    state.update(L"ab", nullptr, 0, INPUT, update);
+    state.update(L"abc", nullptr, 0, INPUT, update);
+    EXPECT_EQ(update.textStart, 2);
+    EXPECT_EQ(update.removedLength, 0);
+    EXPECT_EQ(update.insertedLength, 1);
+    ASSERT_EQ(update.runs.size(), 1u);
+    EXPECT_EQ(update.runs[0].start, 2);
+    EXPECT_EQ(update.runs[0].end, 3);
+}
+
+TEST(TestCompositionState, OnlyChangedClausesAreApplied)
+{
+    CompositionState state;
+    CompositionUpdate update;
+    std::wstring text = L"你好嗎ㄅ";
+    CompositionClause clauses1[] = {{0, 3, CONVERTED}};
+    state.update(text, clauses1, 1, INPUT, update);
+
+    // select the second char as the conversion target
+    CompositionClause clauses2[] = {{0, 1, CONVERTED}, {1, 2, TARGET}, {2, 3, CONVERTED}};
+    state.update(text, clauses2, 3, INPUT, update);
+    EXPECT_FALSE(update.textChanged());
+    ASSERT_EQ(update.runs.size(), 1u);
+    EXPECT_EQ(update.runs[0].start, 1);
+    EXPECT_EQ(update.runs[0].end, 2);
+    EXPECT_EQ(update.runs[0].attr, TARGET);
+
+    EXPECT_EQ(state.attrs(), (std::vector<uint32_t>{CONVERTED, TARGET, CONVERTED, INPUT}));
+}
+
+TEST(TestCompositionState, ReplacingTextInTheMiddle)
+{
+    CompositionState state;
+    CompositionUpdate update;
+    CompositionClause clauses[] = {{0, 2, CONVERTED}, {2, 4, INPUT}};
+    state.update(L"abcd", clauses, 2, INPUT, update);
+    state.update(L"aXcd", clauses, 2, INPUT, update);
+    EXPECT_EQ(update.textStart, 1);
+    EXPECT_EQ(update.removedLength, 1);
+    EXPECT_EQ(update.insertedLength, 1);
+    ASSERT_EQ(update.runs.size(), 1u);
+    EXPECT_EQ(update.runs[0].start, 1);
+    EXPECT_EQ(update.runs[0].end, 2);
+    EXPECT_EQ(update.runs[0].attr, CONVERTED);
+}
+
+TEST(TestCompositionState, SurrogatePairsAreNotSplit)
+{
+    CompositionState state;
+    CompositionUpdate update;
+    state.update(L"a\xd840\xdc00", nullptr, 0, INPUT, update);
+    state.update(L"a\xd840\xdc01", nullptr, 0, INPUT, update);
+    EXPECT_EQ(update.textStart, 1);
+    EXPECT_EQ(update.removedLength, 2);
+    EXPECT_EQ(update.insertedLength, 2);
+}
+
+TEST(TestCompositionState, UpdatesReproduceTheComposition)
+{
+    // a sequence of edits, applied incrementally, ends with the same document as writing it at once
+    struct Step {
+        std::wstring text;
+        std::vector<CompositionClause> clauses;
+    };
+    std::vector<Step> steps = {
+        {L"ㄅ", {}},
+        {L"ㄅㄆ", {}},
+        {L"你", {{0, 1, CONVERTED}}},
+        {L"你ㄅ", {{0, 1, CONVERTED}}},
+        {L"你好", {{0, 2, CONVERTED}}},
+        {L"你好", {{0, 1, TARGET}, {1, 2, CONVERTED}}},
+        {L"妳好", {{0, 1, TARGET}, {1, 2, CONVERTED}}},
+        {L"妳", {{0, 1, CONVERTED}}},
+        {L"", {}},
+        {L"xyz", {{1, 10, 0}}},
+    };
+    CompositionState state;
+    CompositionUpdate update;
+    Document doc;
+    for (auto& step: steps) {
+        state.update(step.text, step.clauses.data(), int(step.clauses.size()), INPUT, update);
+        doc.apply(step.text, update);
+        EXPECT_EQ(doc.text, step.text);
+        EXPECT_EQ(doc.attrs, state.attrs());
+    }
+    EXPECT_EQ(doc.attrs, (std::vector<uint32_t>{INPUT, 0, 0}));
+
+    state.reset();
+    state.update(L"xyz", nullptr, 0, INPUT, update);
+    EXPECT_EQ(update.removedLength, 0);
+    EXPECT_EQ(update.insertedLength, 3);
+}
@@ -0,0 +1,252 @@
+#include "gtest/gtest.h"
+
+#include "DictionaryFile.h"
+#include "DictionaryService.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Ime;
+
+namespace {
+
+const uint32_t KEYS = dictionarySectionId("KEYS");
+const uint32_t VALS = dictionarySectionId("VALS");
+
+std::filesystem::path tempPath(const char* name) {
+    return std::filesystem::temp_directory_path() / (std::string("libime_") + name + "_" + std::to_string(getpid()));
+}
+
+}
+
+TEST(TestDictionaryFile, WriteAndOpen)
+{
+    auto path = tempPath("dict");
+    DictionaryFileWriter writer;
+    writer.addSection(KEYS, std::string("abc"));
+    writer.addSection(VALS, std::string(5000, 'x'));
+    ASSERT_TRUE(writer.write(path));
+
+    DictionaryFile dict;
+    ASSERT_EQ(dict.open(path), DictionaryError::NONE);
+    EXPECT_EQ(dict.sectionCount(), 2u);
+    EXPECT_EQ(dict.section(KEYS), "abc");
+    EXPECT_EQ(dict.section(VALS), std::string(5000, 'x'));
+    EXPECT_TRUE(dict.section(dictionarySectionId("NONE")).empty());
+    // sections start at page boundaries, so they can be used in place
+    EXPECT_EQ(dict.sections()[0].offset % DictionaryFile::SECTION_ALIGNMENT, 0u);
+    EXPECT_EQ(dict.sections()[1].offset % DictionaryFile::SECTION_ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(dict.section(KEYS).data()) % DictionaryFile::SECTION_ALIGNMENT, 0u);
+    dict.close();
+    std::filesystem::remove(path);
+}
+
+TEST(TestDictionaryFile, RejectsBrokenFiles)
+{
+    DictionaryFileWriter writer;
+    writer.addSection(KEYS, std::string("abc"));
+    std::string image = writer.build();
+    auto data = reinterpret_cast<const unsigned char*>(image.data());
+    EXPECT_EQ(DictionaryFile::validate(data, image.size()), DictionaryError::NONE);
+
+    EXPECT_EQ(DictionaryFile::validate(data, 10), DictionaryError::BAD_HEADER);
+    // truncated
+    EXPECT_EQ(DictionaryFile::validate(data, image.size() - 1), DictionaryError::BAD_HEADER);
+
+    std::string bad = image;
+    bad[0] = 'X';
+    EXPECT_EQ(DictionaryFile::validate(reinterpret_cast<const unsigned char*>(bad.data()), bad.size()), DictionaryError::BAD_HEADER);
+
+    bad = image;
+    uint32_t version = DictionaryFile::VERSION + 1;
+    std::memcpy(&bad[offsetof(DictionaryHeader, version)], &version, sizeof(version));
+    EXPECT_EQ(DictionaryFile::validate(reinterpret_cast<const unsigned char*>(bad.data()), bad.size()), DictionaryError::UNSUPPORTED_VERSION);
+
+    bad = image;
+    uint64_t size = 1 << 20;
+    std::memcpy(&bad[sizeof(DictionaryHeader) + offsetof(DictionarySectionEntry, size)], &size, sizeof(size));
+    EXPECT_EQ(DictionaryFile::validate(reinterpret_cast<const unsigned char*>(bad.data()), bad.size()), DictionaryError::BAD_SECTION_TABLE);
+
+    DictionaryFile dict;
+    EXPECT_EQ(dict.open(tempPath("missing")), DictionaryError::OPEN_FAILED);
+    EXPECT_FALSE(dict.isOpen());
+}
+
+TEST(TestDictionaryFile, Checksums)
+{
+    EXPECT_EQ(dictionaryChecksum("123456789"), 0xcbf43926u);
+    EXPECT_EQ(dictionaryChecksum(""), 0u);
+
+    auto path = tempPath("checksum");
+    DictionaryFileWriter writer;
+    writer.addSection(KEYS, std::string("abc"));
+    writer.addSection(VALS, std::string(5000, 'x'));
+    std::string image = writer.build();
+    {
+        std::ofstream(path, std::ios::binary).write(image.data(), image.size());
+    }
+    DictionaryFile dict;
+    ASSERT_EQ(dict.open(path), DictionaryError::NONE);
+    EXPECT_EQ(dict.sections()[0].checksum, dictionaryChecksum("abc"));
+    EXPECT_EQ(dict.verify(), DictionaryError::NONE);
+    dict.close();
+
+    // a flipped bit in a section is only found by verify(), open() does not read the sections
+    image[image.size() - 1] ^= 1;
+    {
+        std::ofstream(path, std::ios::binary).write(image.data(), image.size());
+    }
+    ASSERT_EQ(dict.open(path), DictionaryError::NONE);
+    EXPECT_EQ(dict.verify(), DictionaryError::BAD_CHECKSUM);
+    dict.close();
+    std::filesystem::remove(path);
+}
+
+TEST(TestDictionaryService, SharesOpenDictionaries)
+{
+    auto path = tempPath("service");
+    DictionaryFileWriter writer;
+    writer.addSection(KEYS, std::string("abc"));
+    ASSERT_TRUE(writer.write(path));
+
+    DictionaryService service;
+    auto a = service.open(path);
+    auto b = service.open(path);
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(service.openCount(), 1u);
+    a.reset();
+    b.reset();
+    EXPECT_EQ(service.openCount(), 0u);
+
+    DictionaryError error;
+    EXPECT_FALSE(service.open(tempPath("missing"), &error));
+    EXPECT_EQ(error, DictionaryError::OPEN_FAILED);
+    std::filesystem::remove(path);
+}
+
+#ifdef __linux__
+
+namespace {
+
+// private (not shared with other processes) memory of the calling process in KB
+long privateMemoryKB() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    long total = -1;
+    while (std::getline(smaps, line)) {
+        long kb;
+        if (std::sscanf(line.c_str(), "Private_Clean: %ld kB", &kb) == 1 || std::sscanf(line.c_str(), "Private_Dirty: %ld kB", &kb) == 1) {
+            total = (total < 0 ? 0 : total) + kb;
+        }
+    }
+    return total;
+}
+
+}
+
+TEST(TestDictionaryService, ProcessesSharePages)
+{
+    if (privateMemoryKB() < 0) {
+        GTEST_SKIP() << "/proc/self/smaps_rollup is not available";
+    }
+
+    // a dictionary of 32 MB
+    auto path = tempPath("shared");
+    const size_t dictSize = 32 << 20;
+    std::string values(dictSize, '\0');
+    for (size_t i = 0; i < dictSize; ++i) {
+        values[i] = char(i * 2654435761u >> 24);
+    }
+    DictionaryFileWriter writer;
+    writer.addSection(VALS, values);
+    ASSERT_TRUE(writer.write(path));
+    values.clear();
+    values.shrink_to_fit();
+
+    // every process maps the dictionary and reads all of it, then waits until all of
+    // them did so before measuring its private memory. The processes stay alive until
+    // all the measurements are done, so the pages are mapped by all of them meanwhile.
+    const int processCount = 4;
+    int ready[2], measure[2], measured[2], quit[2];
+    ASSERT_EQ(pipe(ready), 0);
+    ASSERT_EQ(pipe(measure), 0);
+    ASSERT_EQ(pipe(measured), 0);
+    ASSERT_EQ(pipe(quit), 0);
+    std::vector<pid_t> children;
+    for (int i = 0; i < processCount; ++i) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            long before = privateMemoryKB();
+            DictionaryService service;
+            auto dict = service.open(path);
+            if (!dict)
+                _exit(2);
+            auto section = dict->section(VALS);
+            unsigned sum = 0;
+            for (size_t offset = 0; offset < section.size(); offset += 512) {
+                sum += uint8_t(section[offset]);
+            }
+            char c = char(sum);
+            if (write(ready[1], &c, 1) != 1 || read(measure[0], &c, 1) != 1)
+                _exit(3);
+            // reported to the parent, which checks it
+            long growth = privateMemoryKB() - before;
+            if (write(measured[1], &growth, sizeof(growth)) != sizeof(growth) || read(quit[0], &c, 1) != 1)
+                _exit(3);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    auto barrier = [&](int done, int next) {
+        char c = 0;
+        for (int i = 0; i < processCount; ++i) {
+            ASSERT_EQ(read(done, &c, 1), 1);
+        }
+        for (int i = 0; i < processCount; ++i) {
+            ASSERT_EQ(write(next, &c, 1), 1);
+        }
+    };
+    barrier(ready[0], measure[1]);
+    // the growth of every process, in the order they were measured
+    std::vector<long> growths;
+    for (int i = 0; i < processCount; ++i) {
+        long growth = 0;
+        ASSERT_EQ(read(measured[0], &growth, sizeof(growth)), ssize_t(sizeof(growth)));
+        growths.push_back(growth);
+    }
+    for (int i = 0; i < processCount; ++i) {
+        char c = 0;
+        ASSERT_EQ(write(quit[1], &c, 1), 1);
+    }
+    for (long growth: growths) {
+        // a copy of the dictionary would be 32768 KB
+        EXPECT_LT(growth, 1024) << "private memory growth of a process in KB";
+    }
+    for (pid_t pid: children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+    for (int* fds: {ready, measure, measured, quit}) {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    std::filesystem::remove(path);
+}
+
+#endif
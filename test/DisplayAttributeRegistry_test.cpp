@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include "DisplayAttributeRegistry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+typedef DisplayAttributeRegistry<std::shared_ptr<int>> Registry;
+
+AttributeGuid guid(uint32_t n) {
+    struct {
+        uint32_t data1;
+        uint16_t data2;
+        uint16_t data3;
+        uint8_t data4[8];
+    } raw = {n, 0xb3, 0x4b73, {0xa3, 0xd0, 0x2c, 0x52, 0x1e, 0xfa, 0x8b, 0xe5}};
+    return AttributeGuid::from(raw);
+}
+
+}
+
+TEST(TestDisplayAttributeRegistry, AddAndFind)
+{
+    Registry registry;
+    EXPECT_TRUE(registry.add(guid(1), std::make_shared<int>(1)));
+    EXPECT_TRUE(registry.add(guid(2), std::make_shared<int>(2)));
+    EXPECT_FALSE(registry.add(guid(1), std::make_shared<int>(3)));
+    EXPECT_EQ(registry.size(), 2u);
+
+    std::shared_ptr<int> info;
+    ASSERT_TRUE(registry.find(guid(1), info));
+    EXPECT_EQ(*info, 1);
+    ASSERT_TRUE(registry.find(guid(2), info));
+    EXPECT_EQ(*info, 2);
+    EXPECT_FALSE(registry.find(guid(3), info));
+
+    // a batch publishes only one snapshot and skips duplicates
+    auto before = registry.snapshot();
+    std::vector<Registry::Entry> batch;
+    batch.push_back(Registry::Entry{guid(3), std::make_shared<int>(3)});
+    batch.push_back(Registry::Entry{guid(2), std::make_shared<int>(4)});
+    batch.push_back(Registry::Entry{guid(4), std::make_shared<int>(4)});
+    EXPECT_EQ(registry.addAll(std::move(batch)), 2u);
+    EXPECT_EQ(before->size(), 2u);
+    EXPECT_EQ(registry.size(), 4u);
+    EXPECT_EQ(*registry.snapshot()->entries[3].info, 4);
+}
+
+TEST(TestDisplayAttributeRegistry, CursorKeepsItsSnapshot)
+{
+    Registry registry;
+    registry.add(guid(1), std::make_shared<int>(1));
+    registry.add(guid(2), std::make_shared<int>(2));
+
+    auto cursor = registry.cursor();
+    std::vector<int> seen;
+    auto collect = [&](const std::shared_ptr<int>& info) { seen.push_back(*info); };
+    EXPECT_EQ(cursor.next(1, collect), 1u);
+
+    // attributes added later are not visible to the cursor
+    registry.add(guid(3), std::make_shared<int>(3));
+    EXPECT_EQ(cursor.next(10, collect), 1u);
+    EXPECT_EQ(seen, (std::vector<int>{1, 2}));
+    EXPECT_EQ(cursor.next(1, collect), 0u);
+
+    // a copy shares the snapshot and the position
+    cursor.reset();
+    EXPECT_EQ(cursor.skip(1), 1u);
+    auto clone = cursor;
+    EXPECT_EQ(clone.pos(), 1u);
+    EXPECT_EQ(clone.skip(5), 1u);
+    EXPECT_EQ(cursor.pos(), 1u);
+
+    EXPECT_EQ(registry.cursor().snapshot().size(), 3u);
+}
+
+TEST(TestDisplayAttributeRegistry, EnumerateWhileAdding)
+{
+    Registry registry;
+    const uint32_t total = 2000;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for(uint32_t i = 0; i < total; ++i) {
+            registry.add(guid(i), std::make_shared<int>(int(i)));
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    std::atomic<int> failures{0};
+    for(int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            size_t lastSize = 0;
+            while(!done) {
+                auto cursor = registry.cursor();
+                size_t size = cursor.snapshot().size();
+                // snapshots only grow, and every snapshot is a consistent prefix
+                if(size < lastSize || cursor.snapshot().index.size() != size)
+                    ++failures;
+                lastSize = size;
+                int expected = 0;
+                size_t n = cursor.next(size + 10, [&](const std::shared_ptr<int>& info) {
+                    if(*info != expected++)
+                        ++failures;
+                });
+                if(n != size)
+                    ++failures;
+                std::shared_ptr<int> info;
+                if(size && (!registry.find(guid(uint32_t(size - 1)), info) || *info != int(size - 1)))
+                    ++failures;
+            }
+        });
+    }
+
+    writer.join();
+    for(auto& reader: readers) {
+        reader.join();
+    }
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(registry.size(), total);
+}
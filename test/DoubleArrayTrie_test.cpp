@@ -0,0 +1,198 @@
+#include "gtest/gtest.h"
+
+#include "DoubleArrayTrie.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+// random keys made of a few units, so they share a lot of prefixes
+std::map<std::u16string, uint32_t> randomKeys(size_t count, const std::u16string& alphabet, std::mt19937& random) {
+    std::map<std::u16string, uint32_t> keys;
+    while (keys.size() < count) {
+        std::u16string key;
+        size_t length = 1 + random() % 8;
+        for (size_t i = 0; i < length; ++i) {
+            key += alphabet[random() % alphabet.size()];
+        }
+        keys[key] = uint32_t(random());
+    }
+    return keys;
+}
+
+std::string build(const std::map<std::u16string, uint32_t>& keys) {
+    DoubleArrayTrieBuilder builder;
+    for (const auto& key : keys) {
+        builder.add(key.first, key.second);
+    }
+    return builder.build();
+}
+
+}
+
+TEST(TestDoubleArrayTrie, Readings)
+{
+    DoubleArrayTrieBuilder builder;
+    builder.add(u"ㄓㄨㄥ", 1);
+    builder.add(u"ㄓㄨㄥㄨㄣˊ", 2);
+    builder.add(u"ㄓ", 3);
+    builder.add(u"ㄨㄣˊ", 4);
+    builder.add(u"ㄓㄨㄥ", 5);  // replaces 1
+    builder.add(u"", 6);  // ignored
+    std::string table = builder.build();
+
+    DoubleArrayTrie trie;
+    ASSERT_TRUE(trie.attach(table));
+    EXPECT_EQ(4u, trie.size());
+    EXPECT_EQ(5u, trie.find(u"ㄓㄨㄥ"));
+    EXPECT_EQ(2u, trie.find(u"ㄓㄨㄥㄨㄣˊ"));
+    EXPECT_EQ(3u, trie.find(u"ㄓ"));
+    EXPECT_EQ(4u, trie.find(u"ㄨㄣˊ"));
+    EXPECT_EQ(DoubleArrayTrie::NOT_FOUND, trie.find(u"ㄓㄨ"));
+    EXPECT_EQ(DoubleArrayTrie::NOT_FOUND, trie.find(u"ㄨ"));
+    EXPECT_EQ(DoubleArrayTrie::NOT_FOUND, trie.find(u"abc"));
+    EXPECT_EQ(DoubleArrayTrie::NOT_FOUND, trie.find(u""));
+
+    DoubleArrayTrie::Match matches[4];
+    ASSERT_EQ(3u, trie.commonPrefixSearch(u"ㄓㄨㄥㄨㄣˊㄕ", matches, 4));
+    EXPECT_EQ(1u, matches[0].length);
+    EXPECT_EQ(3u, matches[0].value);
+    EXPECT_EQ(3u, matches[1].length);
+    EXPECT_EQ(5u, matches[1].value);
+    EXPECT_EQ(6u, matches[2].length);
+    EXPECT_EQ(2u, matches[2].value);
+    // the count of all the matches is returned even if they don't fit
+    EXPECT_EQ(3u, trie.commonPrefixSearch(u"ㄓㄨㄥㄨㄣˊ", matches, 1));
+    EXPECT_EQ(0u, trie.commonPrefixSearch(u"ㄨㄣ", matches, 4));
+
+    auto results = trie.withPrefix(u"ㄓ");
+    ASSERT_EQ(3u, results.size());
+    EXPECT_TRUE(results[0].first == u"ㄓ");
+    EXPECT_TRUE(results[1].first == u"ㄓㄨㄥ");
+    EXPECT_TRUE(results[2].first == u"ㄓㄨㄥㄨㄣˊ");
+    EXPECT_EQ(2u, trie.withPrefix(u"", 2).size());
+    EXPECT_EQ(4u, trie.withPrefix(u"").size());
+    EXPECT_TRUE(trie.withPrefix(u"ㄕ").empty());
+}
+
+TEST(TestDoubleArrayTrie, SameAsMap)
+{
+    std::mt19937 random(1);
+    // UTF-16 readings, and syllable ids spread over the whole 16-bit range
+    std::u16string readings = u"ㄅㄆㄇㄈㄉㄊㄋㄌㄍㄎㄏㄐㄑㄒㄓㄔㄕㄖㄗㄘㄙㄧㄨㄩㄚㄛㄜㄝㄞㄟㄠㄡㄢㄣㄤㄥㄦˊˇˋ˙";
+    std::u16string syllables;
+    for (uint32_t id = 1; id < 0x10000; id += 97) {
+        syllables += char16_t(id);
+    }
+    for (const std::u16string& alphabet : {readings, syllables}) {
+        auto keys = randomKeys(20000, alphabet, random);
+        std::string table = build(keys);
+        DoubleArrayTrie trie;
+        ASSERT_TRUE(trie.attach(table));
+        EXPECT_EQ(keys.size(), trie.size());
+
+        for (const auto& key : keys) {
+            ASSERT_EQ(key.second, trie.find(key.first));
+            std::u16string longer = key.first + alphabet[0];
+            auto it = keys.find(longer);
+            ASSERT_EQ(it != keys.end() ? it->second : DoubleArrayTrie::NOT_FOUND, trie.find(longer));
+
+            DoubleArrayTrie::Match matches[16];
+            size_t count = trie.commonPrefixSearch(longer, matches, 16);
+            std::vector<DoubleArrayTrie::Match> expected;
+            for (size_t length = 1; length <= longer.size(); ++length) {
+                auto prefix = keys.find(longer.substr(0, length));
+                if (prefix != keys.end())
+                    expected.push_back(DoubleArrayTrie::Match{length, prefix->second});
+            }
+            ASSERT_EQ(expected.size(), count);
+            for (size_t i = 0; i < count; ++i) {
+                ASSERT_EQ(expected[i].length, matches[i].length);
+                ASSERT_EQ(expected[i].value, matches[i].value);
+            }
+        }
+
+        // enumerate everything, then a few prefixes
+        std::vector<std::pair<std::u16string, uint32_t>> all(keys.begin(), keys.end());
+        EXPECT_TRUE(trie.withPrefix(u"") == all);
+        for (size_t i = 0; i < 50; ++i) {
+            std::u16string prefix = all[random() % all.size()].first.substr(0, 1 + i % 3);
+            std::vector<std::pair<std::u16string, uint32_t>> expected;
+            for (auto it = keys.lower_bound(prefix); it != keys.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+                expected.push_back(*it);
+            }
+            ASSERT_TRUE(trie.withPrefix(prefix) == expected);
+        }
+    }
+}
+
+TEST(TestDoubleArrayTrie, StopEnumeration)
+{
+    DoubleArrayTrieBuilder builder;
+    for (char16_t c = u'a'; c <= u'z'; ++c) {
+        builder.add(std::u16string(2, c), c);
+    }
+    std::string table = builder.build();
+    DoubleArrayTrie trie;
+    ASSERT_TRUE(trie.attach(table));
+    std::u16string visited;
+    trie.forEachWithPrefix(u"", [&visited](std::u16string_view /* key */, uint32_t value) {
+        visited += char16_t(value);
+        return value != u'e';
+    });
+    EXPECT_TRUE(visited == u"abcde");
+}
+
+TEST(TestDoubleArrayTrie, Empty)
+{
+    std::string table = DoubleArrayTrieBuilder().build();
+    DoubleArrayTrie trie;
+    ASSERT_TRUE(trie.attach(table));
+    EXPECT_EQ(0u, trie.size());
+    EXPECT_EQ(DoubleArrayTrie::NOT_FOUND, trie.find(u"a"));
+    EXPECT_TRUE(trie.withPrefix(u"").empty());
+    DoubleArrayTrie::Match match;
+    EXPECT_EQ(0u, trie.commonPrefixSearch(u"a", &match, 1));
+}
+
+TEST(TestDoubleArrayTrie, InvalidTables)
+{
+    DoubleArrayTrieBuilder builder;
+    builder.add(u"key", 1);
+    std::string table = builder.build();
+    DoubleArrayTrie trie;
+    EXPECT_FALSE(trie.attach(std::string_view(table).substr(0, table.size() - 1)));
+    EXPECT_FALSE(trie.isAttached());
+
+    std::string badMagic = table;
+    badMagic[0] = 'X';
+    EXPECT_FALSE(trie.attach(badMagic));
+
+    std::string badVersion = table;
+    reinterpret_cast<DoubleArrayTrieHeader*>(&badVersion[0])->version = DoubleArrayTrie::VERSION + 1;
+    EXPECT_FALSE(trie.attach(badVersion));
+
+    std::string badCode = table;
+    reinterpret_cast<DoubleArrayTrieHeader*>(&badCode[0])->codeCount = 1;
+    EXPECT_FALSE(trie.attach(badCode));
+
+    // corrupted units don't crash the lookups
+    std::string corrupted = table;
+    auto header = reinterpret_cast<const DoubleArrayTrieHeader*>(corrupted.data());
+    size_t unitsOffset = corrupted.size() - header->unitCount * (sizeof(DoubleArrayUnit) + sizeof(DoubleArrayLink));
+    for (size_t i = unitsOffset; i < corrupted.size(); i += 3) {
+        corrupted[i] = char(0xa5);
+    }
+    ASSERT_TRUE(trie.attach(corrupted));
+    trie.find(u"key");
+    trie.withPrefix(u"");
+
+    EXPECT_TRUE(trie.attach(table));
+    EXPECT_EQ(1u, trie.find(u"key"));
+}
@@ -0,0 +1,190 @@
+#include "gtest/gtest.h"
+
+#include "EngineClient.h"
+#include "EngineServer.h"
+#include "StandInEngine.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace Ime;
+
+namespace {
+
+std::string serverName(const char* test) {
+    return std::string("libime-test-") + test + "-" + std::to_string(EngineChannel::currentProcessId());
+}
+
+EngineKeyEvent key(uint32_t keyCode) {
+    return EngineKeyEvent{keyCode, 0, 0, 0};
+}
+
+std::unique_ptr<EngineSession> makeStandIn() {
+    return std::make_unique<StandInEngine>();
+}
+
+// takes its time to handle a key, like a server loading its dictionaries
+class SlowEngine: public StandInEngine {
+public:
+    void handle(uint32_t type, const EngineRequest& request, EngineReplyContent& reply) override {
+        if (type == ENGINE_KEY_DOWN && request.key.keyCode == 'S')
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        StandInEngine::handle(type, request, reply);
+    }
+};
+
+}
+
+TEST(TestEngineReply, WriteAndParse)
+{
+    std::u16string_view candidates[] = {u"你好", u"", u"abc"};
+    EngineReplyContent content;
+    content.flags = ENGINE_HANDLED | ENGINE_SHOW_CANDIDATES;
+    content.cursor = 1;
+    content.composition = u"ni";
+    content.commit = u"x";
+    content.candidates = candidates;
+    content.candidateCount = 3;
+    content.selectedCandidate = 2;
+
+    size_t size = EngineReply::payloadSize(content);
+    std::vector<uint64_t> buffer(size / sizeof(uint64_t) + 1);
+    EngineReply::write(7, content, buffer.data());
+
+    EngineReply reply;
+    ASSERT_TRUE(reply.parse(buffer.data(), size));
+    EXPECT_EQ(reply.serial(), 7u);
+    EXPECT_TRUE(reply.isHandled());
+    EXPECT_EQ(reply.cursor(), 1);
+    EXPECT_EQ(reply.compositionString(), u"ni");
+    EXPECT_EQ(reply.commitString(), u"x");
+    ASSERT_EQ(reply.candidateCount(), 3u);
+    EXPECT_EQ(reply.candidate(0), u"你好");
+    EXPECT_EQ(reply.candidate(1), u"");
+    EXPECT_EQ(reply.candidate(2), u"abc");
+    EXPECT_EQ(reply.selectedCandidate(), 2);
+
+    EXPECT_FALSE(reply.parse(buffer.data(), size - 1));
+    EXPECT_FALSE(reply.parse(buffer.data(), 4));
+}
+
+TEST(TestEngineChannel, RoundTrip)
+{
+    EngineServer server;
+    ASSERT_TRUE(server.create(serverName("roundtrip"), 2, 4096));
+    server.start(makeStandIn);
+
+    EngineClient client;
+    ASSERT_TRUE(client.connect(serverName("roundtrip")));
+
+    EngineReply reply;
+    ASSERT_TRUE(client.request(ENGINE_FILTER_KEY_DOWN, key('1'), reply));
+    EXPECT_FALSE(reply.isHandled());
+
+    for (char ch: std::string("NIHAO")) {
+        ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key(ch), reply));
+        EXPECT_TRUE(reply.isHandled());
+    }
+    EXPECT_EQ(reply.compositionString(), u"nihao");
+    EXPECT_EQ(reply.cursor(), 5);
+
+    ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key(' '), reply));
+    EXPECT_TRUE(reply.flags() & ENGINE_SHOW_CANDIDATES);
+    ASSERT_EQ(reply.candidateCount(), 4u);
+    EXPECT_EQ(reply.candidate(1), u"NIHAO");
+    EXPECT_EQ(reply.candidate(2), u"oahin");
+
+    ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key('2'), reply));
+    EXPECT_EQ(reply.commitString(), u"NIHAO");
+    EXPECT_EQ(reply.compositionString(), u"");
+    EXPECT_EQ(reply.candidateCount(), 0u);
+
+    // many round trips, the rings wrap around
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key('A' + i % 26), reply));
+        if (i % 20 == 19) {
+            ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key(' '), reply));
+            ASSERT_EQ(reply.candidateCount(), 4u);
+            ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key(0x1b), reply));
+        }
+    }
+    server.stop();
+}
+
+TEST(TestEngineChannel, ClientsClaimSeparateChannels)
+{
+    EngineServer server;
+    ASSERT_TRUE(server.create(serverName("claim"), 2, 4096));
+    server.start(makeStandIn);
+
+    EngineClient a, b, c;
+    ASSERT_TRUE(a.connect(serverName("claim")));
+    ASSERT_TRUE(b.connect(serverName("claim")));
+    // all the channels are in use
+    EXPECT_FALSE(c.connect(serverName("claim")));
+
+    EngineReply reply;
+    ASSERT_TRUE(a.request(ENGINE_KEY_DOWN, key('A'), reply));
+    ASSERT_TRUE(b.request(ENGINE_KEY_DOWN, key('B'), reply));
+    ASSERT_TRUE(a.request(ENGINE_KEY_DOWN, key('C'), reply));
+    EXPECT_EQ(reply.compositionString(), u"ac");
+
+    // a new client of a channel starts with a fresh session
+    a.disconnect();
+    ASSERT_TRUE(c.connect(serverName("claim")));
+    ASSERT_TRUE(c.request(ENGINE_KEY_DOWN, key('D'), reply));
+    EXPECT_EQ(reply.compositionString(), u"d");
+    server.stop();
+}
+
+TEST(TestEngineChannel, ServerGone)
+{
+    EngineClient client;
+    EXPECT_FALSE(client.connect(serverName("none")));
+
+    auto server = std::make_unique<EngineServer>();
+    ASSERT_TRUE(server->create(serverName("gone"), 1, 4096));
+    server->start(makeStandIn);
+    ASSERT_TRUE(client.connect(serverName("gone")));
+    // the server stops answering, but its channels are still there
+    server->stop();
+
+    client.setTimeout(20000);
+    EngineReply reply;
+    EXPECT_FALSE(client.request(ENGINE_KEY_DOWN, key('A'), reply));
+    EXPECT_FALSE(client.isConnected());
+    EXPECT_FALSE(client.request(ENGINE_KEY_DOWN, key('A'), reply));
+}
+
+TEST(TestEngineChannel, ReconnectAfterSlowReply)
+{
+    EngineServer server;
+    ASSERT_TRUE(server.create(serverName("slow"), 1, 4096));
+    server.start([]() -> std::unique_ptr<EngineSession> { return std::make_unique<SlowEngine>(); });
+
+    EngineClient client;
+    ASSERT_TRUE(client.connect(serverName("slow")));
+    client.setTimeout(20000);
+    client.setReconnectDelay(50000, 50000);
+
+    EngineReply reply;
+    EXPECT_FALSE(client.request(ENGINE_KEY_DOWN, key('S'), reply));
+    EXPECT_FALSE(client.isConnected());
+    // too early to try again
+    EXPECT_FALSE(client.request(ENGINE_KEY_DOWN, key('A'), reply));
+    EXPECT_FALSE(client.isConnected());
+
+    // the server answers again, the late reply to the slow key is skipped
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    ASSERT_TRUE(client.request(ENGINE_KEY_DOWN, key('A'), reply));
+    EXPECT_TRUE(client.isConnected());
+    EXPECT_EQ(reply.compositionString(), u"a");
+
+    // an explicit disconnect is final
+    client.disconnect();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_FALSE(client.request(ENGINE_KEY_DOWN, key('A'), reply));
+    server.stop();
+}
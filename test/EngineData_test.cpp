@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+
+#include "EngineData.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+std::atomic<int> liveDictionaries{0};
+
+// a dictionary of "words" whose content depends on its version
+struct Dictionary: public EngineData {
+    explicit Dictionary(int version):
+        version(version) {
+        for (int i = 0; i < 1000; ++i) {
+            std::string word;
+            for (int n = i * 7 + version; n; n /= 26) {
+                word += char('a' + n % 26);
+            }
+            words.push_back(word);
+        }
+        std::sort(words.begin(), words.end());
+        ++liveDictionaries;
+    }
+
+    ~Dictionary() {
+        --liveDictionaries;
+    }
+
+    int version;
+    std::vector<std::string> words;
+};
+
+// the mutable state of one text service
+struct Session {
+    explicit Session(const EngineDataStore& store):
+        reader(store) {
+    }
+
+    EngineDataReader reader;
+    std::string composition;
+    int matches = 0;
+};
+
+}
+
+TEST(TestEngineData, ReaderFollowsPublishedData)
+{
+    EngineDataStore store;
+    EngineDataReader reader(store);
+    EXPECT_EQ(reader.get(), nullptr);
+
+    store.publish(std::make_shared<Dictionary>(1));
+    auto first = reader.get<Dictionary>();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->version, 1);
+    EXPECT_EQ(reader.get<Dictionary>(), first);
+    EXPECT_EQ(reader.refreshes(), 2u);
+
+    // the old data stays alive until the reader moves on
+    store.publish(std::make_shared<Dictionary>(2));
+    EXPECT_EQ(liveDictionaries, 2);
+    EXPECT_EQ(first->version, 1);
+    EXPECT_EQ(reader.get<Dictionary>()->version, 2);
+    EXPECT_EQ(liveDictionaries, 1);
+}
+
+TEST(TestEngineData, ConcurrentTyping)
+{
+    // 32 UI threads typing while the configuration is reloaded
+    const int threadCount = 32;
+    const int keys = 20000;
+    const int publishCount = 200;
+    {
+        EngineDataStore store;
+        store.publish(std::make_shared<Dictionary>(0));
+
+        std::atomic<int> errors{0};
+        std::atomic<int> finished{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                Session session(store);
+                int lastVersion = -1;
+                for (int i = 0; i < keys; ++i) {
+                    // a key event: read the data once, and use it for the whole event
+                    auto dict = session.reader.get<Dictionary>();
+                    if (!dict || dict->version < lastVersion || dict->words.size() != 1000)
+                        ++errors;
+                    lastVersion = dict->version;
+                    session.composition += char('a' + (i * 31 + t) % 26);
+                    if (session.composition.size() > 3)
+                        session.composition.erase(0, 1);
+                    auto it = std::lower_bound(dict->words.begin(), dict->words.end(), session.composition);
+                    if (it != dict->words.end() && it->compare(0, session.composition.size(), session.composition) == 0)
+                        ++session.matches;
+                }
+                // no more locking than one refresh per publish
+                if (session.reader.refreshes() > uint64_t(publishCount + 1))
+                    ++errors;
+                ++finished;
+            });
+        }
+
+        for (int version = 1; version <= publishCount && finished < threadCount; ++version) {
+            store.publish(std::make_shared<Dictionary>(version));
+            std::this_thread::yield();
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        EXPECT_EQ(errors, 0);
+        // all the old dictionaries were freed once the readers moved on
+        EXPECT_EQ(liveDictionaries, 1);
+    }
+    EXPECT_EQ(liveDictionaries, 0);
+}
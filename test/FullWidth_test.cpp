@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include "FullWidth.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace Ime;
+
+namespace {
+
+// every UTF-16 code unit, in an order which puts all kinds of chars at every position of the SIMD blocks
+std::u16string allCodeUnits() {
+    std::u16string text;
+    for (uint32_t i = 0; i < 0x10000; ++i) {
+        text += char16_t((i * 40503u) & 0xffff);
+    }
+    return text;
+}
+
+// the replacement of every char, one char at a time
+std::u16string convertOneByOne(const PunctuationMap& map, std::u16string_view text) {
+    std::u16string result;
+    for (char16_t c : text) {
+        auto replacement = map.lookup(c);
+        if (replacement.empty())
+            result += c;
+        else
+            result += replacement;
+    }
+    return result;
+}
+
+}
+
+TEST(TestFullWidth, Chars)
+{
+    EXPECT_EQ(u'Ａ', toFullWidth(u'A'));
+    EXPECT_EQ(u'～', toFullWidth(u'~'));
+    EXPECT_EQ(u'！', toFullWidth(u'!'));
+    EXPECT_EQ(u'　', toFullWidth(u' '));
+    EXPECT_EQ(u'￥', toFullWidth(u'¥'));
+    EXPECT_EQ(u'中', toFullWidth(u'中'));
+    EXPECT_EQ(u'\n', toFullWidth(u'\n'));
+
+    EXPECT_EQ(u'A', toHalfWidth(u'Ａ'));
+    EXPECT_EQ(u' ', toHalfWidth(u'　'));
+    EXPECT_EQ(u'₩', toHalfWidth(u'￦'));
+    EXPECT_EQ(u'ｱ', toHalfWidth(u'ｱ'));
+    EXPECT_EQ(u'。', toHalfWidth(u'。'));
+}
+
+TEST(TestFullWidth, EveryCodeUnit)
+{
+    std::u16string text = allCodeUnits();
+    // start at every alignment
+    for (size_t start = 0; start < 17; ++start) {
+        std::u16string_view in = std::u16string_view(text).substr(start);
+        std::u16string full(in.size(), u'\0');
+        std::u16string half(in.size(), u'\0');
+        toFullWidth(in, &full[0]);
+        toHalfWidth(in, &half[0]);
+        for (size_t i = 0; i < in.size(); ++i) {
+            ASSERT_EQ(toFullWidth(in[i]), full[i]) << std::hex << uint32_t(in[i]);
+            ASSERT_EQ(toHalfWidth(in[i]), half[i]) << std::hex << uint32_t(in[i]);
+        }
+    }
+}
+
+TEST(TestFullWidth, RoundTrip)
+{
+    for (uint32_t c = 0; c < 0x10000; ++c) {
+        char16_t full = toFullWidth(char16_t(c));
+        if (full != c) {
+            EXPECT_EQ(c, toHalfWidth(full));
+        }
+    }
+
+    std::u16string text = u"Hello, World! 1 + 2 = 3 ¥100 (中文)";
+    std::u16string converted = text;
+    toFullWidth(converted, &converted[0]);  // in place
+    EXPECT_TRUE(converted == u"Ｈｅｌｌｏ，　Ｗｏｒｌｄ！　１　＋　２　＝　３　￥１００　（中文）");
+    toHalfWidth(converted, &converted[0]);
+    EXPECT_TRUE(converted == text);
+}
+
+TEST(TestFullWidth, ChinesePunctuation)
+{
+    PunctuationMap map = PunctuationMap::chinese();
+    std::u16string out;
+    map.convert(u"ok, 好的. a<b>[c]{d}\\e^_!?x9", out);
+    EXPECT_TRUE(out == u"ok， 好的。 a《b》「c」『d』、e……——！？x9");
+
+    map.set(u'.', u"．");
+    map.remove(u'!');
+    map.convert(u"a.b!", out);
+    EXPECT_TRUE(out == u"a．b!");
+}
+
+TEST(TestFullWidth, MapAnyChar)
+{
+    PunctuationMap map;
+    EXPECT_TRUE(map.empty());
+    map.set(u'。', u"．");
+    map.set(u'、', u",");
+    map.set(u'A', u"<A>");
+    EXPECT_FALSE(map.empty());
+
+    std::u16string text = allCodeUnits();
+    for (size_t start = 0; start < 17; ++start) {
+        std::u16string_view in = std::u16string_view(text).substr(start);
+        std::u16string out;
+        map.convert(in, out);
+        ASSERT_TRUE(out == convertOneByOne(map, in)) << start;
+    }
+
+    map.remove(u'。');
+    map.remove(u'、');
+    map.remove(u'A');
+    EXPECT_TRUE(map.empty());
+    std::u16string out;
+    map.convert(text, out);
+    EXPECT_TRUE(out == text);
+}
+
+TEST(TestFullWidth, CallerBuffer)
+{
+    PunctuationMap map = PunctuationMap::chinese();
+    std::u16string in = u"abcdefghijklmnopqrstuvwxyz^abc";
+    char16_t out[32];
+    // the buffer ends in the middle of the replacement of ^
+    auto result = map.convert(in, out, 27);
+    EXPECT_EQ(26u, result.read);
+    EXPECT_EQ(26u, result.written);
+    result = map.convert(in, out, 28);
+    EXPECT_EQ(27u, result.read);
+    EXPECT_EQ(28u, result.written);
+    result = map.convert(in, out, 3);
+    EXPECT_EQ(3u, result.read);
+    EXPECT_EQ(3u, result.written);
+    EXPECT_TRUE(std::u16string(out, 3) == u"abc");
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include "HandleRegistry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Ime::HandleRegistry;
+
+namespace {
+
+// fake handles, aligned like real ones
+const void* handle(uintptr_t n) {
+    return reinterpret_cast<const void*>(n * 8 + 0x10000);
+}
+
+void* object(uintptr_t n) {
+    return reinterpret_cast<void*>(n * 16 + 0x20000);
+}
+
+}
+
+TEST(TestHandleRegistry, InsertFindErase)
+{
+    HandleRegistry registry;
+    EXPECT_EQ(registry.find(handle(1)), nullptr);
+    EXPECT_EQ(registry.find(nullptr), nullptr);
+    // lookups never insert
+    EXPECT_TRUE(registry.empty());
+
+    registry.insert(handle(1), object(1));
+    registry.insert(handle(2), object(2));
+    EXPECT_EQ(registry.size(), 2u);
+    EXPECT_EQ(registry.find(handle(1)), object(1));
+    EXPECT_EQ(registry.find(handle(2)), object(2));
+
+    registry.insert(handle(1), object(3));
+    EXPECT_EQ(registry.size(), 2u);
+    EXPECT_EQ(registry.find(handle(1)), object(3));
+
+    EXPECT_TRUE(registry.erase(handle(1)));
+    EXPECT_FALSE(registry.erase(handle(1)));
+    EXPECT_EQ(registry.find(handle(1)), nullptr);
+    EXPECT_EQ(registry.find(handle(2)), object(2));
+    EXPECT_EQ(registry.size(), 1u);
+}
+
+TEST(TestHandleRegistry, MatchesStdMap)
+{
+    // random inserts and erases, which exercise growing and backward shifting
+    HandleRegistry registry;
+    std::map<const void*, void*> expected;
+    std::mt19937 random(1234);
+    for (int i = 0; i < 100000; ++i) {
+        uintptr_t n = random() % 500;
+        if (random() % 3) {
+            registry.insert(handle(n), object(i));
+            expected[handle(n)] = object(i);
+        }
+        else {
+            EXPECT_EQ(registry.erase(handle(n)), expected.erase(handle(n)) == 1);
+        }
+        ASSERT_EQ(registry.size(), expected.size());
+    }
+    for (uintptr_t n = 0; n < 500; ++n) {
+        auto it = expected.find(handle(n));
+        EXPECT_EQ(registry.find(handle(n)), it != expected.end() ? it->second : nullptr);
+    }
+    EXPECT_LE(registry.capacity(), 2048u);
+}
+
+TEST(TestHandleRegistry, ThreadsHaveTheirOwnRegistry)
+{
+    // like UI threads creating, looking up and destroying windows at the same time
+    const int threadCount = 32;
+    const int windowCount = 200;
+    const int rounds = 50;
+    std::atomic<int> errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([t, &errors]() {
+            HandleRegistry& registry = HandleRegistry::forCurrentThread();
+            if (!registry.empty())
+                ++errors;
+            // all threads use the same handle values, they must not see each other's
+            for (int r = 0; r < rounds; ++r) {
+                for (uintptr_t n = 0; n < windowCount; ++n)
+                    registry.insert(handle(n), object(n * threadCount + t));
+                for (int k = 0; k < 10; ++k) {
+                    for (uintptr_t n = 0; n < windowCount; ++n) {
+                        if (registry.find(handle(n)) != object(n * threadCount + t))
+                            ++errors;
+                    }
+                }
+                for (uintptr_t n = 0; n < windowCount; n += 2)
+                    registry.erase(handle(n));
+                for (uintptr_t n = 0; n < windowCount; ++n) {
+                    void* expected = n % 2 ? object(n * threadCount + t) : nullptr;
+                    if (registry.find(handle(n)) != expected)
+                        ++errors;
+                }
+                for (uintptr_t n = 1; n < windowCount; n += 2)
+                    registry.erase(handle(n));
+                if (!registry.empty())
+                    ++errors;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(errors.load(), 0);
+}
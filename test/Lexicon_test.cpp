@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+
+#include "Lexicon.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace Ime;
+
+namespace {
+
+std::filesystem::path tempPath(const char* name) {
+    return std::filesystem::temp_directory_path() / (std::string("libime_") + name + "_" + std::to_string(getpid()));
+}
+
+const char* source =
+    "# reading\tphrase\tfrequency\n"
+    "ㄓㄨㄥ\t中\t900\n"
+    "ㄓㄨㄥ\t鐘\t300\n"
+    "ㄓㄨㄥ\t忠\t500\r\n"
+    "ㄓㄨㄥㄨㄣˊ\t中文\t700\n"
+    "\n"
+    "ㄓㄨㄥˋ\t中\t50\n"
+    "ㄓㄨㄥ\t鐘\t100\n"  // the highest frequency is kept
+    "ㄨㄣˊ\t文\n";
+
+std::u16string text(const Lexicon& lexicon, const LexiconPhrases& phrases) {
+    std::u16string result;
+    for (const auto& phrase : phrases) {
+        if (!result.empty())
+            result += u' ';
+        result += lexicon.text(phrase);
+    }
+    return result;
+}
+
+}
+
+TEST(TestLexicon, CompileAndLookup)
+{
+    LexiconBuilder builder;
+    ASSERT_TRUE(builder.addText(source));
+    EXPECT_EQ(7u, builder.size());
+
+    auto path = tempPath("lexicon");
+    DictionaryFileWriter writer;
+    builder.addSectionsTo(writer);
+    ASSERT_TRUE(writer.write(path));
+
+    DictionaryFile file;
+    ASSERT_EQ(DictionaryError::NONE, file.open(path));
+    EXPECT_EQ(DictionaryError::NONE, file.verify());
+    Lexicon lexicon;
+    ASSERT_TRUE(lexicon.attach(file));
+    std::string error;
+    EXPECT_TRUE(lexicon.verify(&error)) << error;
+    EXPECT_EQ(4u, lexicon.readingCount());
+    EXPECT_EQ(6u, lexicon.phraseCount());
+
+    auto phrases = lexicon.lookup(u"ㄓㄨㄥ");
+    ASSERT_EQ(3u, phrases.size());
+    EXPECT_TRUE(text(lexicon, phrases) == u"中 忠 鐘");
+    EXPECT_EQ(900u, phrases[0].frequency);
+    EXPECT_EQ(300u, phrases[2].frequency);
+    EXPECT_TRUE(text(lexicon, lexicon.lookup(u"ㄨㄣˊ")) == u"文");
+    EXPECT_EQ(0u, lexicon.lookup(u"ㄨㄣˊ")[0].frequency);
+    EXPECT_TRUE(lexicon.lookup(u"ㄓㄨ").empty());
+    EXPECT_TRUE(lexicon.lookup(u"").empty());
+
+    // polyphones share their text
+    EXPECT_EQ(lexicon.lookup(u"ㄓㄨㄥˋ")[0].textOffset, phrases[0].textOffset);
+
+    // the words at the start of the input
+    DoubleArrayTrie::Match matches[4];
+    ASSERT_EQ(2u, lexicon.readings().commonPrefixSearch(u"ㄓㄨㄥㄨㄣˊㄕ", matches, 4));
+    EXPECT_TRUE(text(lexicon, lexicon.phrasesOf(matches[1].value)) == u"中文");
+
+    file.close();
+    std::filesystem::remove(path);
+}
+
+TEST(TestLexicon, InvalidSource)
+{
+    LexiconBuilder builder;
+    size_t line = 0;
+    EXPECT_FALSE(builder.addText("ㄓㄨㄥ\t中\n# ok\nno tab\n", &line));
+    EXPECT_EQ(3u, line);
+    EXPECT_FALSE(builder.addText("ㄓㄨㄥ\t中\tmany\n", &line));
+    EXPECT_EQ(1u, line);
+    EXPECT_FALSE(builder.addText("\t中\n", &line));
+    EXPECT_FALSE(builder.addText("ㄓㄨㄥ\t\xff\n", &line));
+    EXPECT_TRUE(builder.addText("ㄓㄨㄥ\t中\t1"));
+}
+
+TEST(TestLexicon, InvalidDictionaries)
+{
+    LexiconBuilder builder;
+    ASSERT_TRUE(builder.addText(source));
+    std::string image = builder.build();
+    auto path = tempPath("lexicon_invalid");
+    auto open = [&path](const std::string& image, DictionaryFile& file) {
+        std::ofstream(path, std::ios::binary).write(image.data(), image.size());
+        return file.open(path) == DictionaryError::NONE;
+    };
+    // finds the section in the image
+    auto section = [](std::string& image, uint32_t id) {
+        auto entries = reinterpret_cast<DictionarySectionEntry*>(&image[sizeof(DictionaryHeader)]);
+        for (uint32_t i = 0; ; ++i) {
+            if (entries[i].id == id)
+                return &image[size_t(entries[i].offset)];
+        }
+    };
+
+    Lexicon lexicon;
+    {
+        // no lexicon at all
+        DictionaryFileWriter writer;
+        writer.addSection(dictionarySectionId("ZHTS"), std::string("abc"));
+        DictionaryFile file;
+        ASSERT_TRUE(open(writer.build(), file));
+        EXPECT_FALSE(lexicon.attach(file));
+    }
+    {
+        std::string bad = image;
+        reinterpret_cast<LexiconHeader*>(section(bad, LEXICON_HEADER_SECTION))->phraseCount += 1;
+        DictionaryFile file;
+        ASSERT_TRUE(open(bad, file));
+        EXPECT_FALSE(lexicon.attach(file));
+    }
+    {
+        // out of range offsets are found by verify(), and lookups don't use them
+        std::string bad = image;
+        reinterpret_cast<LexiconPhrase*>(section(bad, LEXICON_PHRASES_SECTION))[0].textOffset = 1000;
+        reinterpret_cast<uint32_t*>(section(bad, LEXICON_RANGES_SECTION))[1] = 1000;
+        DictionaryFile file;
+        ASSERT_TRUE(open(bad, file));
+        ASSERT_TRUE(lexicon.attach(file));
+        std::string error;
+        EXPECT_FALSE(lexicon.verify(&error));
+        EXPECT_FALSE(error.empty());
+        for (uint32_t i = 0; i < lexicon.readingCount(); ++i) {
+            for (const auto& phrase : lexicon.phrasesOf(i))
+                lexicon.text(phrase);
+        }
+        EXPECT_NE(DictionaryError::NONE, file.verify());
+    }
+    std::filesystem::remove(path);
+}
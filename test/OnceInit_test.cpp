@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include "OnceInit.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Ime;
+
+TEST(TestOnceInit, RunsOnce)
+{
+    OnceInit once;
+    int calls = 0;
+    EXPECT_FALSE(once.done());
+    EXPECT_TRUE(once.run([&] { ++calls; return true; }));
+    EXPECT_TRUE(once.run([&] { ++calls; return true; }));
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(once.done());
+}
+
+TEST(TestOnceInit, RetriesAfterFailure)
+{
+    OnceInit once;
+    int calls = 0;
+    EXPECT_FALSE(once.run([&] { ++calls; return false; }));
+    EXPECT_FALSE(once.done());
+    EXPECT_TRUE(once.run([&] { ++calls; return true; }));
+    EXPECT_TRUE(once.run([&] { ++calls; return true; }));
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(TestOnceInit, ConcurrentCallers)
+{
+    OnceInit once;
+    std::atomic<int> calls{0};
+    std::atomic<int> value{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                bool ok = once.run([&] {
+                    ++calls;
+                    std::this_thread::yield();
+                    value = 42;
+                    return true;
+                });
+                // everyone returning from run() sees the initialized state
+                if (!ok || value != 42)
+                    ++failures;
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(failures, 0);
+}
@@ -0,0 +1,259 @@
+#include "gtest/gtest.h"
+
+#include "RegistrationPlan.h"
+
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+const wchar_t clsid[] = L"{11111111-2222-3333-4444-555555555555}";
+const wchar_t otherClsid[] = L"{99999999-8888-7777-6666-555555555555}";
+
+RegistrationSpec makeSpec() {
+    RegistrationSpec spec;
+    spec.clsid = clsid;
+    spec.name = L"Test IME";
+    spec.modulePath = L"C:\\Program Files\\TestIME\\TestIME.dll";
+    spec.profiles = {
+        {LanguageProfile{0x0404, L"{AAAAAAAA-0000-0000-0000-000000000001}", L"Test TW", L"icon.ico", 0}, L"zh-Hant-TW"},
+        {LanguageProfile{0x0804, L"{AAAAAAAA-0000-0000-0000-000000000002}", L"Test CN", L"icon.ico", 1}, L"zh-Hans-CN"}
+    };
+    spec.categories = {L"{CAT-KEYBOARD}", L"{CAT-DISPLAYATTRIBUTEPROVIDER}"};
+    spec.knownCategories = {L"{CAT-KEYBOARD}", L"{CAT-DISPLAYATTRIBUTEPROVIDER}", L"{CAT-UIELEMENTENABLED}"};
+    spec.userProfiles = true;
+    return spec;
+}
+
+void addUsers(MemoryRegistryBackend& backend) {
+    const wchar_t* sids[] = {L".DEFAULT", L"S-1-5-21-1001", L"S-1-5-21-1001_Classes", L"S-1-5-21-1002"};
+    for (auto sid: sids) {
+        backend.setValue(RegistryRoot::USERS, std::wstring(sid) + L"\\Environment", L"TEMP", RegistryValue::string(L"C:\\Temp"));
+    }
+}
+
+int count(const RegistrationPlan& plan, RegistrationOp::Type type) {
+    int n = 0;
+    for (const auto& op: plan.ops()) {
+        if (op.type == type)
+            ++n;
+    }
+    return n;
+}
+
+std::wstring userProfilePath(const std::wstring& sid, const std::wstring& locale) {
+    return sid + L"\\Control Panel\\International\\User Profile\\" + locale;
+}
+
+}
+
+TEST(TestRegistrationPlan, FreshInstall)
+{
+    MemoryRegistryBackend backend;
+    addUsers(backend);
+    auto spec = makeSpec();
+
+    RegistrationPlan plan(backend);
+    plan.planRegister(spec);
+    EXPECT_EQ(count(plan, RegistrationOp::REGISTER_TEXT_SERVICE), 1);
+    EXPECT_EQ(count(plan, RegistrationOp::ADD_PROFILE), 2);
+    EXPECT_EQ(count(plan, RegistrationOp::REGISTER_CATEGORY), 2);
+    // 3 values of the COM server, 2 recorded profiles, 2 profiles for 3 users (the _Classes key is skipped)
+    EXPECT_EQ(count(plan, RegistrationOp::SET_VALUE), 3 + 2 + 2 * 3);
+    EXPECT_TRUE(plan.apply());
+
+    RegistryValue value;
+    ASSERT_TRUE(backend.readValue(RegistryRoot::CLASSES_ROOT, std::wstring(L"CLSID\\") + clsid + L"\\InprocServer32", L"ThreadingModel", value));
+    EXPECT_EQ(value, RegistryValue::string(L"Apartment"));
+    EXPECT_TRUE(backend.isTextServiceRegistered(clsid));
+    EXPECT_EQ(backend.languageProfiles(clsid).size(), 2u);
+    auto name = RegistrationPlan::userProfileValueName(clsid, spec.profiles[0].profile);
+    EXPECT_EQ(name, std::wstring(L"0404:") + clsid + L"{AAAAAAAA-0000-0000-0000-000000000001}");
+    EXPECT_TRUE(backend.readValue(RegistryRoot::USERS, userProfilePath(L"S-1-5-21-1002", L"zh-Hant-TW"), name, value));
+    EXPECT_FALSE(backend.hasKey(RegistryRoot::USERS, L"S-1-5-21-1001_Classes\\Control Panel"));
+}
+
+TEST(TestRegistrationPlan, ReinstallChangesNothing)
+{
+    MemoryRegistryBackend backend;
+    addUsers(backend);
+    auto spec = makeSpec();
+    RegistrationPlan install(backend);
+    install.planRegister(spec);
+    ASSERT_TRUE(install.apply());
+
+    backend.resetStats();
+    RegistrationPlan reinstall(backend);
+    reinstall.planRegister(spec);
+    EXPECT_TRUE(reinstall.empty());
+    EXPECT_TRUE(reinstall.apply());
+    EXPECT_EQ(backend.writeCount(), 0u);
+}
+
+TEST(TestRegistrationPlan, UpgradeOnlyWritesDifferences)
+{
+    MemoryRegistryBackend backend;
+    addUsers(backend);
+    auto spec = makeSpec();
+    RegistrationPlan install(backend);
+    install.planRegister(spec);
+    ASSERT_TRUE(install.apply());
+
+    // the user has reordered the input methods, which should be kept
+    auto twName = RegistrationPlan::userProfileValueName(clsid, spec.profiles[0].profile);
+    auto twPath = userProfilePath(L"S-1-5-21-1001", L"zh-Hant-TW");
+    backend.setValue(RegistryRoot::USERS, twPath, L"0404:{OTHER-IME}", RegistryValue::dword(1));
+    backend.setValue(RegistryRoot::USERS, twPath, twName, RegistryValue::dword(2));
+
+    // new module path, renamed TW profile, dropped CN profile, one more category
+    auto upgraded = spec;
+    upgraded.modulePath = L"C:\\Program Files\\TestIME 2\\TestIME.dll";
+    upgraded.profiles[0].profile.name = L"Test TW 2";
+    upgraded.profiles.pop_back();
+    upgraded.categories.push_back(L"{CAT-UIELEMENTENABLED}");
+
+    RegistrationPlan upgrade(backend);
+    upgrade.planRegister(upgraded);
+    EXPECT_EQ(count(upgrade, RegistrationOp::SET_VALUE), 1);
+    EXPECT_EQ(count(upgrade, RegistrationOp::REGISTER_TEXT_SERVICE), 0);
+    EXPECT_EQ(count(upgrade, RegistrationOp::ADD_PROFILE), 1);
+    EXPECT_EQ(count(upgrade, RegistrationOp::REMOVE_PROFILE), 1);
+    EXPECT_EQ(count(upgrade, RegistrationOp::REGISTER_CATEGORY), 1);
+    EXPECT_EQ(count(upgrade, RegistrationOp::UNREGISTER_CATEGORY), 0);
+    // the CN profile is no longer recorded, nor listed for any of the 3 users
+    EXPECT_EQ(count(upgrade, RegistrationOp::DELETE_VALUE), 1 + 3);
+    ASSERT_TRUE(upgrade.apply());
+
+    RegistryValue value;
+    ASSERT_TRUE(backend.readValue(RegistryRoot::USERS, twPath, twName, value));
+    EXPECT_EQ(value, RegistryValue::dword(2));
+    auto profiles = backend.languageProfiles(clsid);
+    ASSERT_EQ(profiles.size(), 1u);
+    EXPECT_EQ(profiles[0].name, L"Test TW 2");
+
+    RegistrationPlan again(backend);
+    again.planRegister(upgraded);
+    EXPECT_TRUE(again.empty());
+}
+
+TEST(TestRegistrationPlan, UpgradeKeepsOthersProfilesAndCategories)
+{
+    MemoryRegistryBackend backend;
+    addUsers(backend);
+    auto spec = makeSpec();
+    RegistrationPlan install(backend);
+    install.planRegister(spec);
+    ASSERT_TRUE(install.apply());
+
+    // added to our text service by someone else
+    LanguageProfile extra{0x0411, L"{BBBBBBBB-0000-0000-0000-000000000001}", L"Extra JP", L"extra.ico", 0};
+    ASSERT_TRUE(backend.addLanguageProfile(clsid, extra));
+    ASSERT_TRUE(backend.registerCategory(clsid, L"{CAT-EXTRA}"));
+    auto extraName = RegistrationPlan::userProfileValueName(clsid, extra);
+    auto jpPath = userProfilePath(L"S-1-5-21-1001", L"ja-JP");
+    backend.setValue(RegistryRoot::USERS, jpPath, extraName, RegistryValue::dword(1));
+
+    // the CN profile is dropped
+    auto upgraded = spec;
+    upgraded.profiles.pop_back();
+
+    RegistrationPlan upgrade(backend);
+    upgrade.planRegister(upgraded);
+    EXPECT_EQ(count(upgrade, RegistrationOp::REMOVE_PROFILE), 1);
+    EXPECT_EQ(count(upgrade, RegistrationOp::UNREGISTER_CATEGORY), 0);
+    ASSERT_TRUE(upgrade.apply());
+
+    auto profiles = backend.languageProfiles(clsid);
+    ASSERT_EQ(profiles.size(), 2u);
+    EXPECT_TRUE(std::find(profiles.begin(), profiles.end(), extra) != profiles.end());
+    auto categories = backend.categories(clsid);
+    EXPECT_TRUE(std::find(categories.begin(), categories.end(), L"{CAT-EXTRA}") != categories.end());
+    RegistryValue value;
+    EXPECT_TRUE(backend.readValue(RegistryRoot::USERS, jpPath, extraName, value));
+
+    // a category we used to register is still removed
+    backend.registerCategory(clsid, L"{CAT-UIELEMENTENABLED}");
+    RegistrationPlan again(backend);
+    again.planRegister(upgraded);
+    EXPECT_EQ(count(again, RegistrationOp::UNREGISTER_CATEGORY), 1);
+    EXPECT_EQ(count(again, RegistrationOp::REMOVE_PROFILE), 0);
+}
+
+TEST(TestRegistrationPlan, NewProfilesAreListedLast)
+{
+    MemoryRegistryBackend backend;
+    auto path = userProfilePath(L"S-1-5-21-1001", L"zh-Hant-TW");
+    backend.setValue(RegistryRoot::USERS, path, L"CachedLanguageName", RegistryValue::string(L"@Winlangdb.dll,-1121"));
+    backend.setValue(RegistryRoot::USERS, path, L"0404:{OTHER-IME}", RegistryValue::dword(1));
+
+    auto spec = makeSpec();
+    LanguageProfile second = spec.profiles[0].profile;
+    second.profileGuid = L"{AAAAAAAA-0000-0000-0000-000000000003}";
+    spec.profiles.push_back({second, L"zh-Hant-TW"});
+
+    RegistrationPlan plan(backend);
+    plan.planProfiles(spec);
+    ASSERT_TRUE(plan.apply());
+
+    RegistryValue value;
+    ASSERT_TRUE(backend.readValue(RegistryRoot::USERS, path, RegistrationPlan::userProfileValueName(clsid, spec.profiles[0].profile), value));
+    EXPECT_EQ(value, RegistryValue::dword(3));
+    ASSERT_TRUE(backend.readValue(RegistryRoot::USERS, path, RegistrationPlan::userProfileValueName(clsid, second), value));
+    EXPECT_EQ(value, RegistryValue::dword(4));
+}
+
+TEST(TestRegistrationPlan, Unregister)
+{
+    MemoryRegistryBackend backend;
+    addUsers(backend);
+    auto spec = makeSpec();
+    RegistrationPlan install(backend);
+    install.planRegister(spec);
+    ASSERT_TRUE(install.apply());
+
+    // things which are not ours
+    auto otherSpec = spec;
+    otherSpec.clsid = otherClsid;
+    RegistrationPlan other(backend);
+    other.planRegister(otherSpec);
+    ASSERT_TRUE(other.apply());
+
+    RegistrationPlan uninstall(backend);
+    uninstall.planUnregister(clsid, true);
+    EXPECT_EQ(count(uninstall, RegistrationOp::UNREGISTER_CATEGORY), 2);
+    EXPECT_EQ(count(uninstall, RegistrationOp::UNREGISTER_TEXT_SERVICE), 1);
+    EXPECT_EQ(count(uninstall, RegistrationOp::DELETE_KEY), 1);
+    EXPECT_EQ(count(uninstall, RegistrationOp::DELETE_VALUE), 2 * 3);
+    ASSERT_TRUE(uninstall.apply());
+
+    EXPECT_FALSE(backend.isTextServiceRegistered(clsid));
+    EXPECT_TRUE(backend.categories(clsid).empty());
+    EXPECT_FALSE(backend.hasKey(RegistryRoot::CLASSES_ROOT, std::wstring(L"CLSID\\") + clsid));
+    EXPECT_TRUE(backend.isTextServiceRegistered(otherClsid));
+    EXPECT_TRUE(backend.hasKey(RegistryRoot::CLASSES_ROOT, std::wstring(L"CLSID\\") + otherClsid));
+    EXPECT_EQ(backend.valueNames(RegistryRoot::USERS, userProfilePath(L".DEFAULT", L"zh-Hant-TW")).size(), 1u);
+
+    RegistrationPlan again(backend);
+    again.planUnregister(clsid, true);
+    EXPECT_TRUE(again.empty());
+}
+
+TEST(TestRegistrationPlan, MemoryBackendKeys)
+{
+    MemoryRegistryBackend backend;
+    backend.setValue(RegistryRoot::USERS, L"a\\b\\c", L"x", RegistryValue::dword(1));
+    backend.setValue(RegistryRoot::USERS, L"a\\b2", L"y", RegistryValue::dword(2));
+    backend.setValue(RegistryRoot::CLASSES_ROOT, L"a\\z", L"", RegistryValue::dword(3));
+
+    EXPECT_EQ(backend.subKeys(RegistryRoot::USERS, L""), std::vector<std::wstring>{L"a"});
+    EXPECT_EQ(backend.subKeys(RegistryRoot::USERS, L"a"), (std::vector<std::wstring>{L"b", L"b2"}));
+    EXPECT_TRUE(backend.hasKey(RegistryRoot::USERS, L"a\\b"));
+    EXPECT_FALSE(backend.hasKey(RegistryRoot::USERS, L"a\\b\\c\\d"));
+
+    EXPECT_TRUE(backend.deleteKey(RegistryRoot::USERS, L"a\\b"));
+    EXPECT_FALSE(backend.hasKey(RegistryRoot::USERS, L"a\\b\\c"));
+    EXPECT_TRUE(backend.hasKey(RegistryRoot::USERS, L"a\\b2"));
+    EXPECT_TRUE(backend.hasKey(RegistryRoot::CLASSES_ROOT, L"a\\z"));
+}
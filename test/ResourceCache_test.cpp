@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+
+#include "ResourceCache.h"
+
+#include <cstdint>
+#include <memory>
+#include <set>
+
+using namespace Ime;
+
+namespace {
+
+struct FakeObjects {
+    std::set<void*> live;
+    int created = 0;
+    uint32_t colorBase = 0x100;
+};
+
+class FakeResourceFactory: public ResourceFactory {
+public:
+    explicit FakeResourceFactory(FakeObjects& objects):
+        objects_(objects) {
+    }
+
+    void* create(const ResourceKey& /* key */) override {
+        void* object = reinterpret_cast<void*>(uintptr_t(++objects_.created) * 16);
+        objects_.live.insert(object);
+        return object;
+    }
+
+    void destroy(void* resource) override {
+        EXPECT_EQ(objects_.live.erase(resource), 1u);
+    }
+
+    uint32_t systemColor(int index) override {
+        return objects_.colorBase + index;
+    }
+
+private:
+    FakeObjects& objects_;
+};
+
+}
+
+TEST(TestResourceCache, KeyedByKindColorWidthAndDpi)
+{
+    FakeObjects objects;
+    {
+        ResourceCache cache(std::unique_ptr<ResourceFactory>(new FakeResourceFactory(objects)));
+        void* pen = cache.pen(0, 3, 96);
+        // one paint after another
+        for (int i = 0; i < 10; ++i)
+            EXPECT_EQ(cache.pen(0, 3, 96), pen);
+        EXPECT_EQ(cache.stats().creations, 1u);
+        EXPECT_EQ(cache.stats().hits, 10u);
+
+        EXPECT_NE(cache.insideFramePen(0, 3, 96), pen);
+        EXPECT_NE(cache.pen(1, 3, 96), pen);
+        EXPECT_NE(cache.pen(0, 1, 96), pen);
+        EXPECT_NE(cache.pen(0, 3, 144), pen);
+        EXPECT_NE(cache.brush(0, 96), pen);
+        EXPECT_EQ(cache.size(), 6u);
+        EXPECT_EQ(objects.live.size(), 6u);
+    }
+    EXPECT_TRUE(objects.live.empty());
+}
+
+TEST(TestResourceCache, SystemColorChange)
+{
+    FakeObjects objects;
+    ResourceCache cache(std::unique_ptr<ResourceFactory>(new FakeResourceFactory(objects)));
+    EXPECT_EQ(cache.systemColor(5), 0x105u);
+    EXPECT_EQ(cache.systemColor(5), 0x105u);
+    EXPECT_EQ(cache.stats().systemColorQueries, 1u);
+    void* pen = cache.pen(cache.systemColor(5), 1, 96);
+
+    // WM_SYSCOLORCHANGE
+    objects.colorBase = 0x200;
+    cache.onSystemColorsChanged();
+    EXPECT_TRUE(objects.live.empty());
+    EXPECT_EQ(cache.systemColor(5), 0x205u);
+    EXPECT_EQ(cache.stats().systemColorQueries, 2u);
+    cache.pen(cache.systemColor(5), 1, 96);
+    EXPECT_EQ(cache.stats().creations, 2u);
+    EXPECT_FALSE(objects.live.count(pen));
+}
+
+TEST(TestResourceCache, DpiChange)
+{
+    FakeObjects objects;
+    ResourceCache cache(std::unique_ptr<ResourceFactory>(new FakeResourceFactory(objects)));
+    cache.pen(0, 3, 96);
+    cache.brush(0, 96);
+    cache.resetStats();
+    cache.onDpiChanged();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_TRUE(objects.live.empty());
+
+    // the first paint at the new DPI creates them again, the next one nothing
+    cache.pen(0, 3, 144);
+    cache.brush(0, 144);
+    EXPECT_EQ(cache.stats().creations, 2u);
+    cache.resetStats();
+    cache.pen(0, 3, 144);
+    cache.brush(0, 144);
+    EXPECT_EQ(cache.stats().creations, 0u);
+}
@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include "SpscRing.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+struct Ring {
+    explicit Ring(size_t capacity):
+        memory(SpscRing::memorySize(capacity) / sizeof(uint64_t) + 1) {
+        SpscRing::initialize(memory.data(), capacity);
+        producer.attach(memory.data());
+        consumer.attach(memory.data());
+    }
+
+    std::vector<uint64_t> memory;  // aligned
+    SpscRing producer;
+    SpscRing consumer;
+};
+
+}
+
+TEST(TestSpscRing, WriteAndRead)
+{
+    Ring ring(256);
+    EXPECT_TRUE(ring.consumer.empty());
+    EXPECT_EQ(ring.consumer.peek(), nullptr);
+
+    ASSERT_TRUE(ring.producer.write(1, "hello", 5));
+    char* payload = static_cast<char*>(ring.producer.reserve(2, 3));
+    ASSERT_NE(payload, nullptr);
+    std::memcpy(payload, "abc", 3);
+    // not visible before commit()
+    auto record = ring.consumer.peek();
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->type, 1u);
+    EXPECT_EQ(std::string(static_cast<const char*>(record->payload()), record->size), "hello");
+    ring.consumer.pop();
+    EXPECT_EQ(ring.consumer.peek(), nullptr);
+
+    ring.producer.commit();
+    record = ring.consumer.peek();
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->type, 2u);
+    EXPECT_EQ(std::string(static_cast<const char*>(record->payload()), record->size), "abc");
+    ring.consumer.pop();
+    EXPECT_TRUE(ring.consumer.empty());
+}
+
+TEST(TestSpscRing, FullAndWrapAround)
+{
+    Ring ring(256);
+    EXPECT_EQ(ring.producer.reserve(1, ring.producer.maxPayloadSize() + 1), nullptr);
+
+    // fill the ring, then keep writing and reading so the records wrap around
+    unsigned char data[64] = {};
+    int written = 0;
+    while (ring.producer.write(0, data, 40)) {
+        ++written;
+    }
+    EXPECT_EQ(written, 256 / 48);
+
+    // the payloads are filled with their type, which is the sequence number
+    auto consume = [&](uint32_t expected) {
+        auto record = ring.consumer.peek();
+        ASSERT_NE(record, nullptr);
+        ASSERT_EQ(record->type, expected);
+        auto payload = static_cast<const unsigned char*>(record->payload());
+        for (uint32_t j = 0; j < record->size; ++j) {
+            ASSERT_EQ(payload[j], record->type & 0xff);
+        }
+        ring.consumer.pop();
+    };
+    for (int i = 0; i < written; ++i) {
+        consume(0);
+    }
+    EXPECT_TRUE(ring.consumer.empty());
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        // sizes which do not divide the capacity need padding records at the end
+        size_t size = 1 + i % 60;
+        std::memset(data, int(i & 0xff), size);
+        while (!ring.producer.write(i, data, size)) {
+            consume(next++);
+        }
+    }
+    while (next < 1000) {
+        consume(next++);
+    }
+    EXPECT_TRUE(ring.consumer.empty());
+}
+
+TEST(TestSpscRing, ProducerAndConsumerThreads)
+{
+    Ring ring(4096);
+    const uint32_t count = 200000;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count;) {
+            // variable sized messages holding their sequence number
+            size_t size = sizeof(uint32_t) * (1 + i % 13);
+            auto payload = static_cast<uint32_t*>(ring.producer.reserve(i, size));
+            if (!payload) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t j = 0; j < size / sizeof(uint32_t); ++j) {
+                payload[j] = i;
+            }
+            ring.producer.commit();
+            ++i;
+        }
+    });
+
+    uint32_t expected = 0;
+    int errors = 0;
+    while (expected < count) {
+        auto record = ring.consumer.peek();
+        if (!record) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto payload = static_cast<const uint32_t*>(record->payload());
+        if (record->type != expected || record->size != sizeof(uint32_t) * (1 + expected % 13))
+            ++errors;
+        for (size_t j = 0; j < record->size / sizeof(uint32_t); ++j) {
+            if (payload[j] != expected)
+                ++errors;
+        }
+        ring.consumer.pop();
+        ++expected;
+    }
+    producer.join();
+    EXPECT_EQ(errors, 0);
+    EXPECT_TRUE(ring.consumer.empty());
+}
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+
+#include "SyllableLattice.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+const char16_t* syllableNames[] = {
+    u"a", u"an", u"fa", u"fan", u"fang", u"gan", u"xi", u"xian", u"ni", u"hao", u"e", u"er"
+};
+
+DoubleArrayTrie makeSyllables(std::string& table) {
+    DoubleArrayTrieBuilder builder;
+    for (uint32_t i = 0; i < sizeof(syllableNames) / sizeof(syllableNames[0]); ++i)
+        builder.add(syllableNames[i], i);
+    table = builder.build();
+    DoubleArrayTrie trie;
+    trie.attach(table);
+    return trie;
+}
+
+// the syllables of a path separated by '
+std::u16string names(const SyllableLattice& lattice, const std::vector<uint32_t>& path) {
+    std::u16string result;
+    for (uint32_t edge : path) {
+        if (!result.empty())
+            result += u'\'';
+        result += syllableNames[lattice.syllable(edge)];
+    }
+    return result;
+}
+
+// count the segmentations by trying every syllable at every position
+uint64_t countSegmentations(const DoubleArrayTrie& syllables, std::u16string_view input) {
+    if (input.empty())
+        return 1;
+    uint64_t count = 0;
+    for (size_t length = 1; length <= input.size(); ++length) {
+        if (syllables.find(input.substr(0, length)) != DoubleArrayTrie::NOT_FOUND)
+            count += countSegmentations(syllables, input.substr(length));
+    }
+    return count;
+}
+
+}
+
+TEST(TestSyllableLattice, Segmentations)
+{
+    std::string table;
+    DoubleArrayTrie syllables = makeSyllables(table);
+    SyllableLattice lattice;
+    std::vector<uint32_t> path;
+
+    EXPECT_EQ(4u, lattice.build(syllables, u"xian"));
+    EXPECT_TRUE(lattice.isComplete());
+    EXPECT_EQ(2u, lattice.segmentationCount());
+    ASSERT_EQ(3u, lattice.edgeCount());
+    // xi and xian from 0, an from 2
+    EXPECT_EQ(0u, lattice.firstEdge(0));
+    EXPECT_EQ(2u, lattice.firstEdge(1));
+    EXPECT_EQ(2u, lattice.firstEdge(2));
+    EXPECT_EQ(3u, lattice.firstEdge(3));
+    EXPECT_EQ(2u, lattice.edgeTo(0));
+    EXPECT_EQ(4u, lattice.edgeTo(1));
+    EXPECT_EQ(4u, lattice.edgeTo(2));
+    EXPECT_TRUE(lattice.isNode(2));
+    EXPECT_FALSE(lattice.isNode(1));
+    EXPECT_EQ(1u, lattice.bestPath(path));
+    EXPECT_TRUE(names(lattice, path) == u"xian");
+
+    // fa'ngan is not a segmentation, fa is dropped
+    lattice.build(syllables, u"fangan");
+    EXPECT_EQ(2u, lattice.segmentationCount());
+    EXPECT_EQ(4u, lattice.edgeCount());
+    EXPECT_EQ(2u, lattice.bestPath(path));
+    EXPECT_TRUE(names(lattice, path) == u"fang'an");
+
+    // the last syllable is not finished
+    EXPECT_EQ(5u, lattice.build(syllables, u"nihaox"));
+    EXPECT_FALSE(lattice.isComplete());
+    EXPECT_EQ(1u, lattice.segmentationCount());
+    EXPECT_EQ(2u, lattice.bestPath(path));
+    EXPECT_TRUE(names(lattice, path) == u"ni'hao");
+
+    EXPECT_EQ(0u, lattice.build(syllables, u"q"));
+    EXPECT_EQ(0u, lattice.segmentationCount());
+    EXPECT_EQ(0u, lattice.edgeCount());
+    EXPECT_EQ(0u, lattice.bestPath(path));
+    EXPECT_EQ(0u, lattice.build(syllables, u""));
+    EXPECT_TRUE(lattice.isComplete());
+}
+
+TEST(TestSyllableLattice, SameAsEnumeration)
+{
+    std::string table;
+    DoubleArrayTrie syllables = makeSyllables(table);
+    SyllableLattice lattice;
+    std::mt19937 random(3);
+    const std::u16string keys = u"aefghinrx";
+    std::vector<uint32_t> path;
+    for (int i = 0; i < 500; ++i) {
+        // concatenated syllables with a random key sometimes
+        std::u16string input;
+        size_t count = 1 + random() % 8;
+        for (size_t j = 0; j < count; ++j) {
+            if (random() % 10 == 0)
+                input += keys[random() % keys.size()];
+            else
+                input += syllableNames[random() % (sizeof(syllableNames) / sizeof(syllableNames[0]))];
+        }
+        size_t length = lattice.build(syllables, input);
+        EXPECT_EQ(length ? countSegmentations(syllables, input.substr(0, length)) : 0u, lattice.segmentationCount()) << i;
+
+        // every edge is a syllable of the input on a path to the end
+        for (size_t position = 0; position <= length; ++position) {
+            for (uint32_t e = lattice.firstEdge(position); e < lattice.firstEdge(position + 1); ++e) {
+                uint32_t to = lattice.edgeTo(e);
+                EXPECT_TRUE(input.substr(position, to - position) == syllableNames[lattice.syllable(e)]);
+                EXPECT_TRUE(lattice.isNode(to));
+            }
+        }
+        // the best path covers the lattice
+        lattice.bestPath(path);
+        size_t end = 0;
+        for (uint32_t edge : path) {
+            EXPECT_TRUE(edge >= lattice.firstEdge(end) && edge < lattice.firstEdge(end + 1));
+            end = lattice.edgeTo(edge);
+        }
+        EXPECT_EQ(length, end);
+    }
+}
@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+
+#include "TextExtentCache.h"
+
+#include <string>
+
+namespace {
+
+// A fake fixed-pitch font: every char is 8 pixels wide and CJK chars are 16.
+class FakeMeasurer: public Ime::TextMeasurer {
+public:
+    Ime::TextExtent measure(const wchar_t* str, size_t len) override {
+        ++measureCalls;
+        int width = 0;
+        for (size_t i = 0; i < len; ++i) {
+            width += advance(str[i]);
+        }
+        return Ime::TextExtent{ width, 20 };
+    }
+
+    bool charAdvances(wchar_t first, wchar_t last, int* advances) override {
+        ++advanceCalls;
+        if (!supportsAdvances) {
+            return false;
+        }
+        for (wchar_t ch = first; ch <= last; ++ch) {
+            advances[ch - first] = advance(ch);
+        }
+        return true;
+    }
+
+    static int advance(wchar_t ch) {
+        return ch >= 0x3000 ? 16 : 8;
+    }
+
+    int measureCalls = 0;
+    int advanceCalls = 0;
+    bool supportsAdvances = true;
+};
+
+}
+
+TEST(TestTextExtentCache, MeasuresOnlyOnce)
+{
+    Ime::TextExtentCache cache;
+    FakeMeasurer measurer;
+    std::wstring str = L"abc";
+
+    auto extent = cache.extent(str.c_str(), str.length(), measurer);
+    EXPECT_EQ(extent.width, 24);
+    EXPECT_EQ(extent.height, 20);
+    EXPECT_EQ(measurer.measureCalls, 1);
+
+    extent = cache.extent(str.c_str(), str.length(), measurer);
+    EXPECT_EQ(extent.width, 24);
+    EXPECT_EQ(measurer.measureCalls, 1);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_DOUBLE_EQ(cache.hitRate(), 0.5);
+}
+
+TEST(TestTextExtentCache, EvictsLeastRecentlyUsed)
+{
+    Ime::TextExtentCache cache(2);
+    FakeMeasurer measurer;
+    cache.extent(L"a", 1, measurer);
+    cache.extent(L"bb", 2, measurer);
+    cache.extent(L"a", 1, measurer);  // "a" becomes the most recently used one
+    cache.extent(L"ccc", 3, measurer);  // "bb" is evicted
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(measurer.measureCalls, 3);
+
+    cache.extent(L"a", 1, measurer);
+    EXPECT_EQ(measurer.measureCalls, 3);
+    cache.extent(L"bb", 2, measurer);
+    EXPECT_EQ(measurer.measureCalls, 4);
+}
+
+TEST(TestTextExtentCache, CjkStringsUseAdvanceTable)
+{
+    Ime::TextExtentCache cache;
+    FakeMeasurer measurer;
+    // the first measurement tells the cache the line height.
+    cache.extent(L"1. ", 3, measurer);
+    EXPECT_EQ(measurer.measureCalls, 1);
+
+    std::wstring candidates[] = { L"中文", L"中", L"文字輸入" };
+    for (const auto& candidate : candidates) {
+        auto extent = cache.extent(candidate.c_str(), candidate.length(), measurer);
+        EXPECT_EQ(extent.width, 16 * int(candidate.length()));
+        EXPECT_EQ(extent.height, 20);
+    }
+    EXPECT_EQ(measurer.measureCalls, 1);
+    // one call per 256 code points block of the advance table:
+    // U+4E2D, U+6587, U+5B57, U+8F38, U+5165.
+    EXPECT_EQ(measurer.advanceCalls, 5);
+
+    // "1. ", then "中文" and "文字輸入" which loaded blocks of the table
+    EXPECT_EQ(cache.misses(), 3);
+    EXPECT_EQ(cache.hits(), 1);
+
+    // U+4E00 lies in an already loaded block.
+    cache.extent(L"一", 1, measurer);
+    EXPECT_EQ(measurer.measureCalls, 1);
+    EXPECT_EQ(measurer.advanceCalls, 5);
+    EXPECT_EQ(cache.hits(), 2);
+}
+
+TEST(TestTextExtentCache, FallsBackWithoutAdvances)
+{
+    Ime::TextExtentCache cache;
+    FakeMeasurer measurer;
+    measurer.supportsAdvances = false;
+    cache.extent(L"1. ", 3, measurer);
+    auto extent = cache.extent(L"中文", 2, measurer);
+    EXPECT_EQ(extent.width, 32);
+    EXPECT_EQ(measurer.measureCalls, 2);
+    // the table is not queried again after it is found to be unavailable.
+    cache.extent(L"中", 1, measurer);
+    EXPECT_EQ(measurer.advanceCalls, 1);
+}
+
+TEST(TestTextExtentCache, ClearForgetsEverything)
+{
+    Ime::TextExtentCache cache;
+    FakeMeasurer measurer;
+    cache.extent(L"abc", 3, measurer);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    cache.extent(L"abc", 3, measurer);
+    EXPECT_EQ(measurer.measureCalls, 2);
+}
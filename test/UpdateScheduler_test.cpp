@@ -0,0 +1,175 @@
+#include "gtest/gtest.h"
+
+#include "UpdateScheduler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+// a window whose setters schedule updates like ImeWindow does
+class FakeWindow: public UpdateClient {
+public:
+    explicit FakeWindow(UpdateScheduler& scheduler):
+        scheduler_(scheduler),
+        layouts(0),
+        paints(0) {
+    }
+
+    ~FakeWindow() {
+        scheduler_.cancel(this);
+    }
+
+    void setText(std::wstring text) {
+        text_ = std::move(text);
+        scheduler_.schedule(this, UPDATE_LAYOUT);
+    }
+
+    void setCandPerRow(int /* n */) {
+        scheduler_.schedule(this, UPDATE_LAYOUT);
+    }
+
+    void move(int /* x */, int /* y */) {
+        scheduler_.schedule(this, UPDATE_LAYOUT);
+    }
+
+    void setCurrentSel(int /* sel */) {
+        scheduler_.schedule(this, UPDATE_PAINT);
+    }
+
+    void runLayout() override {
+        ++layouts;
+    }
+
+    void runPaint() override {
+        ++paints;
+    }
+
+    UpdateScheduler& scheduler_;
+    std::wstring text_;
+    int layouts;
+    int paints;
+};
+
+}
+
+TEST(TestUpdateScheduler, BurstOfUpdatesRunsOneLayoutPass)
+{
+    int ticks = 0;
+    UpdateScheduler scheduler([&ticks]() { ++ticks; });
+    FakeWindow candidates(scheduler);
+    FakeWindow message(scheduler);
+
+    // what an IME typically does for one keystroke
+    candidates.setText(L"a");
+    candidates.setCandPerRow(3);
+    candidates.setCurrentSel(2);
+    candidates.move(100, 200);
+    message.setText(L"b");
+    message.move(100, 180);
+    EXPECT_EQ(ticks, 1);
+    EXPECT_EQ(candidates.layouts, 0);
+    EXPECT_TRUE(scheduler.hasPending());
+
+    scheduler.flush();
+    EXPECT_FALSE(scheduler.hasPending());
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(candidates.paints, 1);
+    EXPECT_EQ(message.layouts, 1);
+    EXPECT_EQ(message.paints, 1);
+    EXPECT_EQ(scheduler.layoutPasses(), 2u);
+    EXPECT_EQ(scheduler.paintPasses(), 2u);
+
+    // the next keystroke asks for a new tick
+    candidates.setCurrentSel(3);
+    EXPECT_EQ(ticks, 2);
+    scheduler.flush();
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(candidates.paints, 2);
+
+    // a tick with nothing to do
+    scheduler.flush();
+    EXPECT_EQ(scheduler.paintPasses(), 3u);
+}
+
+TEST(TestUpdateScheduler, FlushOneWindow)
+{
+    UpdateScheduler scheduler;
+    FakeWindow candidates(scheduler);
+    FakeWindow message(scheduler);
+    candidates.setText(L"a");
+    message.setText(L"b");
+
+    // for example, the size of the window is needed to position it
+    scheduler.flush(&candidates);
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(message.layouts, 0);
+    EXPECT_FALSE(scheduler.isPending(&candidates));
+    EXPECT_TRUE(scheduler.isPending(&message));
+
+    scheduler.flush();
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(message.layouts, 1);
+}
+
+TEST(TestUpdateScheduler, DestroyedWindowIsForgotten)
+{
+    UpdateScheduler scheduler;
+    {
+        FakeWindow candidates(scheduler);
+        candidates.setText(L"a");
+        EXPECT_TRUE(scheduler.hasPending());
+    }
+    EXPECT_FALSE(scheduler.hasPending());
+    scheduler.flush();
+    EXPECT_EQ(scheduler.layoutPasses(), 0u);
+}
+
+TEST(TestUpdateScheduler, UpdatesScheduledWhileFlushing)
+{
+    UpdateScheduler scheduler;
+    FakeWindow message(scheduler);
+
+    // the layout of one window changes another one
+    struct Owner: public FakeWindow {
+        Owner(UpdateScheduler& scheduler, FakeWindow& other): FakeWindow(scheduler), other_(other) {}
+        void runLayout() override {
+            FakeWindow::runLayout();
+            other_.move(0, 0);
+        }
+        FakeWindow& other_;
+    } candidates(scheduler, message);
+
+    candidates.setText(L"a");
+    scheduler.flush();
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(message.layouts, 1);
+    EXPECT_FALSE(scheduler.hasPending());
+}
+
+TEST(TestUpdateScheduler, WindowDestroyedWhileFlushing)
+{
+    UpdateScheduler scheduler;
+    auto message = std::make_unique<FakeWindow>(scheduler);
+
+    // the layout of one window destroys another one which is in the same batch
+    struct Owner: public FakeWindow {
+        Owner(UpdateScheduler& scheduler, std::unique_ptr<FakeWindow>& other): FakeWindow(scheduler), other_(other) {}
+        void runLayout() override {
+            FakeWindow::runLayout();
+            other_ = nullptr;
+        }
+        std::unique_ptr<FakeWindow>& other_;
+    } candidates(scheduler, message);
+
+    candidates.setText(L"a");
+    message->setText(L"b");
+    scheduler.flush();
+    EXPECT_EQ(candidates.layouts, 1);
+    EXPECT_EQ(candidates.paints, 1);
+    EXPECT_EQ(scheduler.layoutPasses(), 1u);
+    EXPECT_EQ(scheduler.paintPasses(), 1u);
+}
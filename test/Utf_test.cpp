@@ -0,0 +1,265 @@
+#include "gtest/gtest.h"
+
+#include "Utf.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Ime;
+
+namespace {
+
+// straightforward encoders used as the reference
+void appendUtf8(std::string& s, uint32_t cp) {
+    if (cp < 0x80) {
+        s += char(cp);
+    }
+    else if (cp < 0x800) {
+        s += char(0xc0 | (cp >> 6));
+        s += char(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000) {
+        s += char(0xe0 | (cp >> 12));
+        s += char(0x80 | ((cp >> 6) & 0x3f));
+        s += char(0x80 | (cp & 0x3f));
+    }
+    else {
+        s += char(0xf0 | (cp >> 18));
+        s += char(0x80 | ((cp >> 12) & 0x3f));
+        s += char(0x80 | ((cp >> 6) & 0x3f));
+        s += char(0x80 | (cp & 0x3f));
+    }
+}
+
+void appendUtf16(std::u16string& s, uint32_t cp) {
+    if (cp < 0x10000) {
+        s += char16_t(cp);
+    }
+    else {
+        cp -= 0x10000;
+        s += char16_t(0xd800 + (cp >> 10));
+        s += char16_t(0xdc00 + (cp & 0x3ff));
+    }
+}
+
+// ASCII runs of different lengths mixed with other chars, so the SIMD blocks
+// start at every alignment and end at every position.
+void makeMixedText(std::string& utf8, std::u16string& utf16) {
+    const uint32_t others[] = {0xe9, 0x4e2d, 0x6587, 0x1f600, 0xff01, 0x7ff, 0x800, 0xffff, 0x10000, 0x10ffff};
+    for (int run = 0; run < 70; ++run) {
+        for (int i = 0; i < run; ++i) {
+            uint32_t ascii = 0x20 + (run * 7 + i) % 95;
+            appendUtf8(utf8, ascii);
+            appendUtf16(utf16, ascii);
+        }
+        uint32_t other = others[run % 10];
+        appendUtf8(utf8, other);
+        appendUtf16(utf16, other);
+    }
+}
+
+UtfError utf8Error(const std::string& s, size_t* read = nullptr) {
+    std::vector<char16_t> out(s.size() + 1);
+    UtfResult result = convertUtf8ToUtf16(s, out.data(), out.size());
+    if (read)
+        *read = result.read;
+    return result.error;
+}
+
+UtfError utf16Error(const std::u16string& s, size_t* read = nullptr) {
+    std::vector<char> out(s.size() * 3 + 1);
+    UtfResult result = convertUtf16ToUtf8(s, out.data(), out.size());
+    if (read)
+        *read = result.read;
+    return result.error;
+}
+
+}
+
+TEST(TestUtf, EveryCodePointRoundTrips)
+{
+    std::string utf8;
+    std::u16string utf16;
+    for (uint32_t cp = 0; cp <= 0x10ffff; ++cp) {
+        if (cp >= 0xd800 && cp <= 0xdfff)
+            continue;
+        appendUtf8(utf8, cp);
+        appendUtf16(utf16, cp);
+    }
+
+    std::u16string converted16;
+    ASSERT_TRUE(utf8ToUtf16(utf8, converted16));
+    EXPECT_TRUE(converted16 == utf16);
+    std::string converted8;
+    ASSERT_TRUE(utf16ToUtf8(utf16, converted8));
+    EXPECT_TRUE(converted8 == utf8);
+}
+
+TEST(TestUtf, EveryCodePointAlone)
+{
+    char16_t out16[2];
+    char out8[4];
+    for (uint32_t cp = 0; cp <= 0x10ffff; ++cp) {
+        if (cp >= 0xd800 && cp <= 0xdfff)
+            continue;
+        std::string utf8;
+        std::u16string utf16;
+        appendUtf8(utf8, cp);
+        appendUtf16(utf16, cp);
+        UtfResult r16 = convertUtf8ToUtf16(utf8, out16, 2);
+        ASSERT_TRUE(r16.ok()) << cp;
+        ASSERT_EQ(std::u16string(out16, r16.written), utf16) << cp;
+        UtfResult r8 = convertUtf16ToUtf8(utf16, out8, 4);
+        ASSERT_TRUE(r8.ok()) << cp;
+        ASSERT_EQ(std::string(out8, r8.written), utf8) << cp;
+    }
+}
+
+TEST(TestUtf, MixedAsciiRuns)
+{
+    std::string utf8;
+    std::u16string utf16;
+    makeMixedText(utf8, utf16);
+    // shift the text, so the vector loads are not aligned
+    for (size_t shift = 0; shift < 40; ++shift) {
+        std::string text = std::string(shift, 'x') + utf8;
+        std::u16string converted16;
+        ASSERT_TRUE(utf8ToUtf16(text, converted16));
+        EXPECT_TRUE(converted16 == std::u16string(shift, u'x') + utf16);
+        std::string back;
+        ASSERT_TRUE(utf16ToUtf8(converted16, back));
+        EXPECT_EQ(back, text);
+    }
+    std::u16string converted16;
+    ASSERT_TRUE(utf8ToUtf16(utf8, converted16));
+    EXPECT_TRUE(converted16 == utf16);
+}
+
+TEST(TestUtf, InvalidUtf8)
+{
+    const char* invalid[] = {
+        "\x80",               // continuation byte without a lead byte
+        "\xc0\x80",           // overlong NUL
+        "\xc1\xbf",           // overlong
+        "\xe0\x80\x80",       // overlong
+        "\xe0\x9f\xbf",       // overlong
+        "\xed\xa0\x80",       // high surrogate
+        "\xed\xbf\xbf",       // low surrogate
+        "\xf0\x80\x80\x80",   // overlong
+        "\xf0\x8f\xbf\xbf",   // overlong
+        "\xf4\x90\x80\x80",   // above U+10FFFF
+        "\xf5\x80\x80\x80",
+        "\xff",
+        "\xe4\xb8\x41",       // bad continuation byte
+        "\xc3\x28",
+    };
+    for (auto s: invalid) {
+        std::string text = std::string("abc") + s + "def";
+        size_t read = 0;
+        EXPECT_EQ(utf8Error(text, &read), UtfError::INVALID) << text;
+        EXPECT_EQ(read, 3u);
+        EXPECT_FALSE(isValidUtf8(text));
+        std::u16string out = u"junk";
+        EXPECT_FALSE(utf8ToUtf16(text, out));
+        EXPECT_TRUE(out.empty());
+    }
+    EXPECT_TRUE(isValidUtf8("abc\xe4\xb8\xad\xf0\x9f\x98\x80"));
+
+    // inside a run of 3-byte chars, which are checked 4 at a time
+    size_t read = 0;
+    std::string cjk = "\xe4\xb8\xad\xe4\xb8\xad\xe4\xb8\xad";
+    EXPECT_EQ(utf8Error(cjk + "\xed\xa0\x80" + cjk + cjk, &read), UtfError::INVALID);
+    EXPECT_EQ(read, 9u);
+    EXPECT_EQ(utf8Error(cjk + "\xe0\x80\x80" + cjk + cjk, &read), UtfError::INVALID);
+    EXPECT_EQ(read, 9u);
+}
+
+TEST(TestUtf, TruncatedUtf8)
+{
+    const char* truncated[] = {"\xc3", "\xe4", "\xe4\xb8", "\xf0\x9f", "\xf0\x9f\x98"};
+    for (auto s: truncated) {
+        size_t read = 0;
+        EXPECT_EQ(utf8Error(std::string("ab") + s, &read), UtfError::TRUNCATED);
+        EXPECT_EQ(read, 2u);
+    }
+    // an invalid prefix is not reported as truncated
+    EXPECT_EQ(utf8Error("\xe0\x80"), UtfError::INVALID);
+}
+
+TEST(TestUtf, InvalidUtf16)
+{
+    size_t read = 0;
+    EXPECT_EQ(utf16Error(u"ab\xdc00" u"cd", &read), UtfError::INVALID);
+    EXPECT_EQ(read, 2u);
+    EXPECT_EQ(utf16Error(std::u16string(u"ab") + char16_t(0xd800) + u"cd", &read), UtfError::INVALID);
+    EXPECT_EQ(read, 2u);
+    EXPECT_EQ(utf16Error(std::u16string(u"ab") + char16_t(0xd800), &read), UtfError::TRUNCATED);
+    EXPECT_EQ(read, 2u);
+    EXPECT_FALSE(isValidUtf16(std::u16string(1, char16_t(0xdfff))));
+    EXPECT_TRUE(isValidUtf16(u"中\U0001f600"));
+}
+
+TEST(TestUtf, OutputFull)
+{
+    std::string utf8 = "abcdefghijklmnopqrstuvwxyz\xe4\xb8\xad\xf0\x9f\x98\x80";
+    char16_t out16[32];
+    UtfResult r = convertUtf8ToUtf16(utf8, out16, 20);
+    EXPECT_EQ(r.error, UtfError::OUTPUT_FULL);
+    EXPECT_EQ(r.read, 20u);
+    EXPECT_EQ(r.written, 20u);
+    // the surrogate pair does not fit
+    r = convertUtf8ToUtf16(utf8, out16, 28);
+    EXPECT_EQ(r.error, UtfError::OUTPUT_FULL);
+    EXPECT_EQ(r.read, 29u);
+    EXPECT_EQ(r.written, 27u);
+
+    std::u16string utf16 = u"abcdefghijklmnopqrstuvwxyz中";
+    char out8[32];
+    UtfResult r8 = convertUtf16ToUtf8(utf16, out8, 28);
+    EXPECT_EQ(r8.error, UtfError::OUTPUT_FULL);
+    EXPECT_EQ(r8.read, 26u);
+    EXPECT_EQ(r8.written, 26u);
+}
+
+TEST(TestUtf, StreamsSplitAnywhere)
+{
+    std::string utf8;
+    std::u16string utf16;
+    makeMixedText(utf8, utf16);
+    for (size_t chunkSize = 1; chunkSize <= 9; ++chunkSize) {
+        Utf8ToUtf16Stream stream16;
+        std::u16string out16;
+        for (size_t i = 0; i < utf8.size(); i += chunkSize) {
+            ASSERT_TRUE(stream16.write(std::string_view(utf8).substr(i, chunkSize), out16));
+        }
+        EXPECT_TRUE(stream16.finish());
+        EXPECT_TRUE(out16 == utf16);
+
+        Utf16ToUtf8Stream stream8;
+        std::string out8;
+        for (size_t i = 0; i < utf16.size(); i += chunkSize) {
+            ASSERT_TRUE(stream8.write(std::u16string_view(utf16).substr(i, chunkSize), out8));
+        }
+        EXPECT_TRUE(stream8.finish());
+        EXPECT_EQ(out8, utf8);
+    }
+}
+
+TEST(TestUtf, StreamErrors)
+{
+    Utf8ToUtf16Stream stream16;
+    std::u16string out16;
+    EXPECT_TRUE(stream16.write("a\xe4", out16));
+    EXPECT_TRUE(stream16.write("\xb8", out16));
+    EXPECT_FALSE(stream16.finish());
+
+    EXPECT_TRUE(stream16.write("\xe4", out16));
+    EXPECT_FALSE(stream16.write("x", out16));
+
+    Utf16ToUtf8Stream stream8;
+    std::string out8;
+    EXPECT_TRUE(stream8.write(std::u16string(1, char16_t(0xd83d)), out8));
+    EXPECT_FALSE(stream8.write(u"x", out8));
+    EXPECT_TRUE(stream8.finish());
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include "WindowPool.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+
+using namespace Ime;
+
+namespace {
+
+struct FakeWindows {
+    std::map<void*, void*> parents;  // live windows and their owners
+    std::set<void*> hidden;
+    std::set<void*> deletedFonts;
+    int creates = 0;
+    int reparents = 0;
+};
+
+class FakeWindowBackend: public WindowBackend {
+public:
+    explicit FakeWindowBackend(FakeWindows& windows):
+        windows_(windows) {
+    }
+
+    void* createWindow(void* parent) override {
+        void* window = reinterpret_cast<void*>(uintptr_t(0x1000 + ++windows_.creates));
+        windows_.parents[window] = parent;
+        windows_.hidden.insert(window);
+        return window;
+    }
+
+    void setParent(void* window, void* parent) override {
+        EXPECT_TRUE(windows_.parents.count(window));
+        windows_.parents[window] = parent;
+        ++windows_.reparents;
+    }
+
+    void hideWindow(void* window) override {
+        windows_.hidden.insert(window);
+    }
+
+    void destroyWindow(void* window) override {
+        EXPECT_EQ(windows_.parents.erase(window), 1u);
+        windows_.hidden.erase(window);
+    }
+
+    void destroyFont(void* font) override {
+        windows_.deletedFonts.insert(font);
+    }
+
+private:
+    FakeWindows& windows_;
+};
+
+void* parent1 = reinterpret_cast<void*>(uintptr_t(0x10));
+void* parent2 = reinterpret_cast<void*>(uintptr_t(0x20));
+void* font1 = reinterpret_cast<void*>(uintptr_t(0x100));
+
+struct FixedMeasurer: public TextMeasurer {
+    int calls = 0;
+    TextExtent measure(const wchar_t* /* str */, size_t len) override {
+        ++calls;
+        return TextExtent{int(len) * 10, 20};
+    }
+};
+
+}
+
+TEST(TestWindowPool, ReusesReleasedWindow)
+{
+    FakeWindows windows;
+    WindowPool pool(std::unique_ptr<WindowBackend>(new FakeWindowBackend(windows)));
+
+    PooledWindow first = pool.acquire(parent1);
+    ASSERT_NE(first.window, nullptr);
+    EXPECT_EQ(first.font, nullptr);
+    EXPECT_EQ(windows.parents[first.window], parent1);
+    void* handle = first.window;
+
+    // the window keeps its font and measurements for the next composition
+    FixedMeasurer measurer;
+    first.font = font1;
+    first.extents.extent(L"abc", 3, measurer);
+    windows.hidden.erase(handle);  // shown by the IME
+    pool.release(std::move(first));
+    EXPECT_EQ(pool.idleCount(), 1u);
+    EXPECT_TRUE(windows.hidden.count(handle));
+
+    PooledWindow second = pool.acquire(parent2);
+    EXPECT_EQ(second.window, handle);
+    EXPECT_EQ(second.font, font1);
+    EXPECT_EQ(windows.parents[handle], parent2);
+    second.extents.extent(L"abc", 3, measurer);
+    EXPECT_EQ(measurer.calls, 1);
+    EXPECT_EQ(pool.created(), 1u);
+    EXPECT_EQ(pool.reused(), 1u);
+    EXPECT_EQ(windows.creates, 1);
+    pool.release(std::move(second));
+}
+
+TEST(TestWindowPool, TrimDestroysIdleWindows)
+{
+    FakeWindows windows;
+    {
+        WindowPool pool(std::unique_ptr<WindowBackend>(new FakeWindowBackend(windows)), 2);
+        PooledWindow a = pool.acquire(parent1);
+        PooledWindow b = pool.acquire(parent1);
+        PooledWindow c = pool.acquire(parent1);
+        a.font = font1;
+        void* handleA = a.window;
+        pool.release(std::move(a));
+        pool.release(std::move(b));
+        // more than maxIdle
+        pool.release(std::move(c));
+        EXPECT_EQ(pool.idleCount(), 2u);
+        EXPECT_EQ(windows.parents.size(), 2u);
+
+        // the least recently used window goes first
+        pool.trim(1);
+        EXPECT_EQ(pool.idleCount(), 1u);
+        EXPECT_FALSE(windows.parents.count(handleA));
+        EXPECT_TRUE(windows.deletedFonts.count(font1));
+
+        pool.trim();
+        EXPECT_EQ(pool.idleCount(), 0u);
+        EXPECT_TRUE(windows.parents.empty());
+
+        // prepared windows are handed out without creating new ones
+        pool.prepare(5);
+        EXPECT_EQ(pool.idleCount(), 2u);
+        int creates = windows.creates;
+        PooledWindow d = pool.acquire(parent2);
+        EXPECT_EQ(windows.creates, creates);
+        EXPECT_EQ(windows.parents[d.window], parent2);
+        pool.release(std::move(d));
+    }
+    // the pool destroys everything it keeps
+    EXPECT_TRUE(windows.parents.empty());
+}
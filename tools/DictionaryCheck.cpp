@@ -0,0 +1,64 @@
+// Validates compiled dictionary files: the header and the section table, the
+// checksums of the sections, and the lexicon if there is one.
+//
+// usage: ime-dictcheck file.dict...
+// The exit code is 0 if all the files are valid.
+
+#include "DictionaryFile.h"
+#include "Lexicon.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+std::string sectionName(uint32_t id) {
+    std::string name;
+    for (int i = 0; i < 4; ++i) {
+        char c = char(id >> (i * 8));
+        name += c >= 0x20 && c < 0x7f ? c : '?';
+    }
+    return name;
+}
+
+bool check(const char* path) {
+    Ime::DictionaryFile file;
+    Ime::DictionaryError error = file.open(path);
+    if (error == Ime::DictionaryError::NONE)
+        error = file.verify();
+    if (error != Ime::DictionaryError::NONE) {
+        std::printf("%s: %s\n", path, Ime::dictionaryErrorString(error));
+        return false;
+    }
+    std::printf("%s: version %u, %zu bytes\n", path, file.header().version, file.size());
+    for (size_t i = 0; i < file.sectionCount(); ++i) {
+        const auto& section = file.sections()[i];
+        std::printf("  %s %10llu bytes at %llu, checksum %08x\n", sectionName(section.id).c_str(),
+            (unsigned long long)section.size, (unsigned long long)section.offset, section.checksum);
+    }
+
+    if (file.hasSection(Ime::LEXICON_HEADER_SECTION)) {
+        Ime::Lexicon lexicon;
+        std::string reason = "inconsistent sections";
+        if (!lexicon.attach(file) || !lexicon.verify(&reason)) {
+            std::printf("%s: invalid lexicon: %s\n", path, reason.c_str());
+            return false;
+        }
+        std::printf("  lexicon: %zu readings, %zu phrases\n", lexicon.readingCount(), lexicon.phraseCount());
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: ime-dictcheck file.dict...\n");
+        return 2;
+    }
+    bool valid = true;
+    for (int i = 1; i < argc; ++i) {
+        valid = check(argv[i]) && valid;
+    }
+    return valid ? 0 : 1;
+}
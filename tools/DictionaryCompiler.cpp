@@ -0,0 +1,73 @@
+// Compiles source lexicons into a dictionary file which the input methods map
+// and use in place (see Lexicon.h), instead of parsing text when they start.
+//
+// usage: ime-dictc -o output.dict source.txt...
+// A source has one reading<TAB>phrase[<TAB>frequency] per line, in UTF-8.
+
+#include "Lexicon.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool readFile(const char* path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+    return bool(file);
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: ime-dictc -o output.dict source.txt...\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* output = nullptr;
+    std::vector<const char*> sources;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+            sources.push_back(argv[i]);
+    }
+    if (!output || sources.empty()) {
+        usage();
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Ime::LexiconBuilder builder;
+    std::string content;
+    for (const char* source : sources) {
+        if (!readFile(source, content)) {
+            std::fprintf(stderr, "%s: cannot read the file\n", source);
+            return 1;
+        }
+        size_t line = 0;
+        if (!builder.addText(content, &line)) {
+            std::fprintf(stderr, "%s:%zu: expected reading<TAB>phrase[<TAB>frequency] in UTF-8\n", source, line);
+            return 1;
+        }
+    }
+
+    Ime::DictionaryFileWriter writer;
+    builder.addSectionsTo(writer);
+    if (!writer.write(output)) {
+        std::fprintf(stderr, "%s: cannot write the file\n", output);
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%s: %zu phrases compiled in %.2f s\n", output, builder.size(), elapsed.count());
+    return 0;
+}
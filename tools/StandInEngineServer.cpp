@@ -0,0 +1,60 @@
+// A stand-in engine server serving the text services in engine client mode
+// (see TextService::connectEngine()) with the trivial StandInEngine.
+//
+// usage: ime-engine-standin [server name] [number of channels]
+// The server runs until it's interrupted with Ctrl+C.
+
+#include "EngineServer.h"
+#include "StandInEngine.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string name = argc > 1 ? argv[1] : "libime-engine";
+    int channelCount = argc > 2 ? std::atoi(argv[2]) : 8;
+    if (channelCount <= 0) {
+        std::fprintf(stderr, "invalid number of channels: %s\n", argv[2]);
+        return 1;
+    }
+
+    Ime::EngineServer server;
+    if (!server.create(name, channelCount)) {
+        std::fprintf(stderr, "cannot create the channels of %s, is another server running?\n", name.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    server.start([]() { return std::make_unique<Ime::StandInEngine>(); });
+    std::printf("serving %s with %d channels, press Ctrl+C to quit\n", name.c_str(), channelCount);
+
+    while (!stopRequested) {
+#ifdef _WIN32
+        ::Sleep(100);
+#else
+        ::usleep(100000);
+#endif
+    }
+    server.stop();
+    std::printf("%llu requests served\n", (unsigned long long)server.requestCount());
+    return 0;
+}